@@ -1,6 +1,5 @@
 from communication.World_Parser import World_Parser
-from itertools import count
-from select import select
+from cpp.socket_reader import socket_reader
 from sys import exit
 from world.World import World
 import socket
@@ -12,8 +11,6 @@ class Server_Comm():
     def __init__(self, host:str, agent_port:int, monitor_port:int, unum:int, robot_type:int, team_name:str,
                  world_parser:World_Parser, world:World, other_players, wait_for_server=True) -> None:
 
-        self.BUFFER_SIZE = 8192
-        self.rcv_buff = bytearray(self.BUFFER_SIZE)
         self.send_buff = []
         self.world_parser = world_parser
         self.unum = unum
@@ -39,6 +36,9 @@ class Server_Comm():
                 print(".",end="",flush=True)
         print("Connected agent", unum, self.socket.getsockname())
 
+        # Frames are received by the native reader (the socket object is still used to send and close)
+        self.reader = socket_reader.Reader(self.socket.fileno())
+
         self.send_immediate(b'(scene rsg/agent/nao/nao_hetero.rsg ' + str(robot_type).encode() + b')')
         self._receive_async(other_players, True)
 
@@ -75,48 +75,49 @@ class Server_Comm():
             self.receive()
             return
 
-        self.socket.setblocking(0)
         if first_pass: print("Async agent",self.unum,"initialization", end="", flush=True)
 
         while True:
-            try:
-                print(".",end="",flush=True)
-                self.receive()
-                break
-            except:
-                pass
+            print(".",end="",flush=True)
+            if self.receive(block=False): break
             for p in other_players:          
                 p.scom.send_immediate(b'(syn)')
             for p in other_players:   
                 p.scom.receive()
 
-        self.socket.setblocking(1)
         if not first_pass: print("Done!")
 
 
-    def receive(self, update=True):
+    def receive(self, update=True, block=True) -> bool:
+        '''
+        Receive and parse all queued messages (the GIL is released while waiting for the server)
+        Returns False if block is False and no complete message was available
+        '''
 
-        for i in count(): # parse all messages and perform value updates, but heavy computation is only done once at the end 
-            try:
-                if self.socket.recv_into(self.rcv_buff, nbytes=4) != 4: raise ConnectionResetError()
-                msg_size = int.from_bytes(self.rcv_buff[:4], byteorder='big', signed=False)
-                if self.socket.recv_into(self.rcv_buff, nbytes=msg_size, flags=socket.MSG_WAITALL) != msg_size: raise ConnectionResetError()      
-            except ConnectionResetError:
-                print("\nError: socket was closed by rcssserver3d!")
-                exit()
+        frames = self.reader.receive(block)
+        if frames < 0:
+            print("\nError: socket was closed by rcssserver3d!")
+            exit()
+        if frames == 0:
+            return False
 
-            self.world_parser.parse(self.rcv_buff[:msg_size])
-            if len(select([self.socket],[],[], 0.0)[0]) == 0: break
+        # parse all messages and perform value updates, but heavy computation is only done once at the end
+        # (the frames are zero-copy views of the reader's buffer, valid until the next receive)
+        for i in range(frames):
+            self.world_parser.parse(self.reader.frame(i))
 
         if update:
-            if i==1: self.world.log( "Server_Comm.py: The agent lost 1 packet! Is syncmode enabled?")
-            if  i>1: self.world.log(f"Server_Comm.py: The agent lost {i} consecutive packets! Is syncmode disabled?")
+            lost = frames - 1
+            if lost==1: self.world.log( "Server_Comm.py: The agent lost 1 packet! Is syncmode enabled?")
+            if lost >1: self.world.log(f"Server_Comm.py: The agent lost {lost} consecutive packets! Is syncmode disabled?")
             self.world.update()
 
-            if len(select([self.socket],[],[], 0.0)[0]) != 0:
+            if self.reader.pending():
                 self.world.log("Server_Comm.py: Received a new packet while on world.update()!")
                 self.receive()
 
+        return True
+
 
     def send_immediate(self, msg:bytes) -> None:
         ''' Commit and send immediately '''
@@ -129,7 +130,7 @@ class Server_Comm():
 
     def send(self) -> None:
         ''' Send all committed messages '''
-        if len(select([self.socket],[],[], 0.0)[0]) == 0:
+        if not self.reader.pending():
             self.send_buff.append(b'(syn)')
             self.send_immediate( b''.join(self.send_buff) )
         else:
@@ -276,6 +277,50 @@ class Server_Comm():
         msg = f"(kill (unum {unum}) (team {'Left' if team_side_is_left else 'Right'}))".encode()
         self.monitor_socket.send( (len(msg)).to_bytes(4,byteorder='big') + msg )
 
+    def unofficial_set_scenario(self, agents=(), ball_pos3d=None, ball_vel3d=(0,0,0), play_mode=None, time_in_s=None) -> None:
+        '''
+        Unofficial command to set up a whole scenario at once, applied by the server before the next physics step
+        e.g. unofficial_set_scenario([(3, True, (-5,0,0.5), 0, {"he1":30})], (0,0,0.042), play_mode="PlayOn")
+
+        Parameters
+        ----------
+        agents : list
+            (unum, team_side_is_left, pos3d, rot, joints) per player, where pos3d and rot (degrees, 0 points forward)
+            may be None, and joints maps joint perceptor/effector names to angles in degrees
+        ball_pos3d : array_like
+            Absolute 3D ball position, or None to keep the ball
+        ball_vel3d : array_like
+            Absolute 3D ball velocity
+        play_mode : str
+            Play mode, or None to keep it
+        time_in_s : float
+            Game time in seconds, or None to keep it
+
+        (negative X is always our half of the field, no matter our side)
+        '''
+        s = 1 if self.world.team_side_is_left else -1
+        msg = "(scenario"
+
+        if play_mode is not None:
+            msg += f" (playMode {play_mode})"
+        if time_in_s is not None:
+            msg += f" (time {time_in_s})"
+        if ball_pos3d is not None:
+            msg += f" (ball (pos {s*ball_pos3d[0]} {s*ball_pos3d[1]} {ball_pos3d[2]}) (vel {s*ball_vel3d[0]} {s*ball_vel3d[1]} {ball_vel3d[2]}))"
+
+        for unum, team_side_is_left, pos3d, rot, joints in agents:
+            msg += f" (agent (team {'Left' if team_side_is_left else 'Right'}) (unum {unum})"
+            if pos3d is not None:
+                msg += f" (pos {s*pos3d[0]} {s*pos3d[1]} {pos3d[2]})"
+            if rot is not None:
+                msg += f" (rot {rot-90 if s==1 else rot+90})"
+            if joints:
+                msg += " (joints" + "".join(f" ({name} {angle})" for name, angle in joints.items()) + ")"
+            msg += ")"
+
+        msg = (msg + ")").encode()
+        self.monitor_socket.send( (len(msg)).to_bytes(4,byteorder='big') + msg )
+
     def close(self, close_monitor_socket = False):
         ''' Close agent socket, and optionally the monitor socket (shared by players running on the same thread) '''
         self.socket.close()
@@ -1,104 +1,229 @@
+#include <algorithm>
 #include <cmath>
 #include "ball_predictor.h"
 
+constexpr double Ball_Predictor::STEP;
+
+
+bool Ball_Predictor::add_sample(double x, double y, double z, double vx, double vy, double vz, bool rolling){
+
+    if(len >= MAX_STEPS) return false;
+
+    if(len > 0){
+        // abort when displacement is low (rolling only) or ball is out of bounds
+        double dx = x - pos[len-1][0];
+        double dy = y - pos[len-1][1];
+        if ((rolling and fabs(dx) < min_displacement and fabs(dy) < min_displacement) or fabs(x) > max_x or fabs(y) > max_y){
+            return false;
+        }
+    }
+
+    // store as 32b
+    pos[len][0] = x;
+    pos[len][1] = y;
+    height[len] = z;
+    vel[len][0] = vx;
+    vel[len][1] = vy;
+    vel_z[len] = vz;
+    spd[len] = sqrt(vx*vx+vy*vy);
+    len++;
+    return true;
+}
 
-float ball_pos_pred[600]; // ball position   (x,y) prediction for 300*0.02s = 6s 
-float ball_vel_pred[600]; // ball velocity   (x,y) prediction for 300*0.02s = 6s 
-float ball_spd_pred[300]; // ball linear speed (s) prediction for 300*0.02s = 6s 
-int pos_pred_len=0;
 
 /**
- * @brief Get intersection with moving ball (intersection point and distance)
- * @param x robot position (x)
- * @param y robot position (y)
- * @param max_robot_sp_per_step maximum speed per step
- * @param ball_pos imported ball positions (possibly modified version of ball_pos_pred)
- * @param ball_pos_len length of ball_pos
- * @param ret_x returned position (x) of intersection point
- * @param ret_y returned position (y) of intersection point
- * @param ret_d returned distance between robot and intersection point
+ * @brief Get ln(1+u)/u, using a series if u is known to be small (u < 0.003, error < u^3/4)
  */
-void get_intersection_with_ball(float x, float y, float max_robot_sp_per_step, float ball_pos[], float ball_pos_len,
-                                float &ret_x, float &ret_y, float &ret_d){
-
-    float robot_max_displacement = 0.2; // robot has an immediate reach radius of 0.2m
-    int j=0;
-    
-    while(1){
-        float vec_x = ball_pos[j++] - x;
-        float vec_y = ball_pos[j++] - y;
-        float b_dist_sq = vec_x*vec_x + vec_y*vec_y; // squared ball distance
-        
-        // If robot has reached the ball, or the ball has stopped but the robot is still not there
-        if (b_dist_sq <= robot_max_displacement*robot_max_displacement or j>=ball_pos_len){
-            float d = sqrtf(b_dist_sq);
-            ret_d = d; 
-            ret_x = ball_pos[j-2];
-            ret_y = ball_pos[j-1];
+template<bool SMALL_U>
+static inline double log1p_over(double u){
+    if(SMALL_U){
+        return 1 - u * (0.5 - u * (1.0/3));
+    }
+    return (u > 0) ? log1p(u) / u : 1;
+}
+
+
+template<bool SMALL_U>
+void Ball_Predictor::roll_samples(){
+
+    // After t = j*STEP, the velocity is v(t) = v0 * e(t) / (1 + k1*|v0|*g(t)),
+    //      with e(t) = e^(-k2*t) and g(t) = (1-e(t))/k2 (= t for k2 = 0, the limit of the formula).
+    // Both follow from the previous sample: e(t+STEP) = e(t)*e1, g(t+STEP) = g1 + e1*g(t), where e1 = e(STEP), g1 = g(STEP).
+    // Over one step from a velocity v, the ball moves x' - x = v*g1 * ln(1+u)/u, with u = k1*|v|*g1.
+    // Unlike stepping the velocity itself, the samples don't wait for each other's division.
+    const double e1 = exp(-k2 * STEP);
+    const double g1 = (k2 != 0) ? -expm1(-k2 * STEP) / k2 : STEP;
+
+    // the parameters are copied, so that they are not reloaded after every store to the sample arrays
+    const double k1_ = k1;
+    const double z = ball_radius;
+    const double min_d = min_displacement;
+    const double lim_x = max_x;
+    const double lim_y = max_y;
+
+    // initial state: last sample
+    int n = len;
+    double x = pos[n-1][0];
+    double y = pos[n-1][1];
+    double vx = vel[n-1][0];
+    double vy = vel[n-1][1];
+
+    const double vx0 = vx;
+    const double vy0 = vy;
+    const double ax = k1_ * fabs(vx0);
+    const double ay = k1_ * fabs(vy0);
+    double e = 1;
+    double g = 0;
+
+    for(; n < MAX_STEPS; n++){
+        const double dx = vx * g1 * log1p_over<SMALL_U>(k1_ * fabs(vx) * g1);
+        const double dy = vy * g1 * log1p_over<SMALL_U>(k1_ * fabs(vy) * g1);
+
+        x += dx;
+        y += dy;
+
+        // abort when displacement is low or ball is out of bounds (as in add_sample)
+        if ((fabs(dx) < min_d and fabs(dy) < min_d) or fabs(x) > lim_x or fabs(y) > lim_y){
             break;
         }
-        robot_max_displacement += max_robot_sp_per_step;
+
+        e *= e1;
+        g = g1 + e1 * g;
+        vx = vx0 * e / (1 + ax * g);
+        vy = vy0 * e / (1 + ay * g);
+
+        // store as 32b
+        pos[n][0] = x;
+        pos[n][1] = y;
+        height[n] = z;
+        vel[n][0] = vx;
+        vel[n][1] = vy;
+        vel_z[n] = 0;
+        spd[n] = sqrt(vx*vx+vy*vy);
     }
+
+    len = n;
 }
 
 
-/**
- * @brief Predict ball position/velocity until the ball stops or gets out of bounds (up to 6s)
- * Adequate when the ball is rolling on the ground
- * @param bx ball position (x)
- * @param by ball position (y)
- * @param vx ball velocity (x)
- * @param vy ball velocity (y)
- */
-void predict_rolling_ball_pos_vel_spd(double bx, double by, double vx, double vy){
+void Ball_Predictor::roll(){
+
+    // u = k1*|v|*g1 only shrinks while the ball rolls (g1 <= STEP), it is below 0.003 up to 15 m/s with the default k1
+    const double v0 = std::max(fabs(vel[len-1][0]), fabs(vel[len-1][1]));
+    if(k1 >= 0 and k2 >= 0 and k1 * v0 * STEP < 0.003){
+        roll_samples<true>();
+    }else{
+        roll_samples<false>();
+    }
+}
 
-    // acceleration = Rolling Drag Force * mass (constant = 0.026 kg)
-    // acceleration = k1 * velocity^2 + k2 * velocity
-    const double k1 = -0.01;
-    const double k2 = -1;
 
-    const double k1_x = (vx < 0) ? -k1 : k1; // invert k1 if vx is negative, because vx^2 absorbs the sign
-    const double k1_y = (vy < 0) ? -k1 : k1; // invert k1 if vy is negative, because vy^2 absorbs the sign
-    
-    ball_pos_pred[0] = bx; // current ball position
-    ball_pos_pred[1] = by;
-    ball_vel_pred[0] = vx; // current ball velocity
-    ball_vel_pred[1] = vy;
-    ball_spd_pred[0] = sqrt(vx*vx+vy*vy);
+int Ball_Predictor::predict_rolling(double bx, double by, double vx, double vy){
 
-    int counter = 2;
+    len = 0;
+    landing_step = 0;
+    add_sample(bx, by, ball_radius, vx, vy, 0, true); // current ball state
+    roll();
+    return len;
+}
 
-    while(counter < 600){
 
-        // acceleration
-        double acc_x = vx*vx*k1_x + vx*k2;
-        double acc_y = vy*vy*k1_y + vy*k2;
+int Ball_Predictor::predict(const double p[3], const double v[3]){
 
-        // second equation of motion: displacement = v0*t + 0.5*a*t^2
-        double dx = vx*0.02 + acc_x*0.0002; // 0.5*0.02^2 = 0.0002
-        double dy = vy*0.02 + acc_y*0.0002; // 0.5*0.02^2 = 0.0002
+    if(p[2] <= ball_radius + airborne_height and fabs(v[2]) <= airborne_vel_z){
+        return predict_rolling(p[0], p[1], v[0], v[1]);
+    }
 
-        // position
-        bx += dx;
-        by += dy;
+    len = 0;
+    add_sample(p[0], p[1], p[2], v[0], v[1], v[2], false); // current ball state
+
+    double x = p[0], y = p[1], z = p[2];
+    double vx = v[0], vy = v[1], vz = v[2];
+    const double drag = exp(-air_drag * STEP);
+
+    while(len < MAX_STEPS){
+
+        // ballistic flight: gravity is integrated exactly, drag is applied once per step
+        x += vx * STEP;
+        y += vy * STEP;
+        z += vz * STEP - 0.5 * gravity * STEP * STEP;
+        vz -= gravity * STEP;
+        vx *= drag;
+        vy *= drag;
+        vz *= drag;
+
+        bool landed = false;
+        if(z <= ball_radius){
+            if(-vz < min_bounce_vel){ // the ball stays on the ground
+                z = ball_radius;
+                vz = 0;
+                landed = true;
+            }else{                    // bounce
+                z = ball_radius + (ball_radius - z) * bounce;
+                vz = -vz * bounce;
+            }
+        }
 
-        // abort when displacement is low or ball is out of bounds
-        if ((fabs(dx) < 0.0005 and fabs(dy) < 0.0005) or fabs(bx) > 15 or fabs(by) > 10){
+        if(!add_sample(x, y, z, vx, vy, vz, false)){
             break;
         }
 
-        // velocity
-        vx += acc_x*0.02;
-        vy += acc_y*0.02;
+        if(landed){
+            landing_step = len-1;
+            roll();
+            return len;
+        }
+    }
 
-        // store as 32b
-        ball_spd_pred[counter/2] = sqrt(vx*vx+vy*vy);
-        ball_vel_pred[counter] = vx;
-        ball_pos_pred[counter++] = bx;
-        ball_vel_pred[counter] = vy;
-        ball_pos_pred[counter++] = by;
-        
+    landing_step = len;
+    return len;
+}
+
+
+void Ball_Predictor::intersect_batch(const float* traj, int traj_len, const float* robots, const float* max_sp_per_step,
+                                     int n, float* ret_xyd, int* ret_step){
+
+    enum { BLOCK = 32 }; // robots per pass, so that the temporary arrays stay on the stack
+
+    if(n > BLOCK){
+        intersect_batch(traj, traj_len, robots, max_sp_per_step, BLOCK, ret_xyd, ret_step);
+        intersect_batch(traj, traj_len, robots + BLOCK*2, max_sp_per_step + BLOCK, n - BLOCK, ret_xyd + BLOCK*3, ret_step + BLOCK);
+        return;
     }
 
-    pos_pred_len = counter;
-}
\ No newline at end of file
+    const float reach_0 = 0.2; // robot has an immediate reach radius of 0.2m
+    const int last = traj_len - 1;
+    int pending = n;
+
+    float dist_sq[BLOCK];
+    float reach[BLOCK];
+
+    for(int i=0; i<n; i++){
+        ret_step[i] = -1;
+        reach[i] = reach_0;
+    }
+
+    for(int j=0; j<traj_len and pending > 0; j++){
+        const float bx = traj[j*2];
+        const float by = traj[j*2+1];
+
+        // squared ball distance of all robots (vectorized)
+        for(int i=0; i<n; i++){
+            const float vec_x = bx - robots[i*2];
+            const float vec_y = by - robots[i*2+1];
+            dist_sq[i] = vec_x*vec_x + vec_y*vec_y;
+        }
+
+        // If robot has reached the ball, or the ball has stopped but the robot is still not there
+        for(int i=0; i<n; i++){
+            if(ret_step[i] < 0 and (dist_sq[i] <= reach[i]*reach[i] or j == last)){
+                ret_step[i] = j;
+                ret_xyd[i*3]   = bx;
+                ret_xyd[i*3+1] = by;
+                ret_xyd[i*3+2] = sqrtf(dist_sq[i]);
+                pending--;
+            }
+            reach[i] += max_sp_per_step[i];
+        }
+    }
+}
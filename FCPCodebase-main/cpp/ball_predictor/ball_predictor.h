@@ -1,10 +1,87 @@
 #pragma once
 
-extern float ball_pos_pred[600]; // ball position   (x,y) prediction for 300*0.02s = 6s 
-extern float ball_vel_pred[600]; // ball velocoty   (x,y) prediction for 300*0.02s = 6s 
-extern float ball_spd_pred[300]; // ball linear speed (s) prediction for 300*0.02s = 6s 
-extern int pos_pred_len;
-
-extern void get_intersection_with_ball(float x, float y, float max_robot_sp_per_step, float ball_pos[], float ball_pos_len,
-                                       float &ret_x, float &ret_y, float &ret_d);
-extern void predict_rolling_ball_pos_vel_spd(double bx, double by, double vx, double vy);
+/**
+ * Reentrant ball trajectory predictor
+ *
+ * Each Ball_Predictor owns its prediction, so several predictions (e.g. for different hypotheses)
+ * can coexist. The trajectory is sampled every STEP seconds, for up to MAX_STEPS samples (6s).
+ *
+ * Rolling model (per axis, same as before): acceleration = -k1*v*|v| - k2*v
+ *      It is solved in closed form:  x(t) = x0 + sign(v0) * ln(1 + k1*|v0|/k2 * (1-e^(-k2*t))) / k1
+ *                                    v(t) = k2*v0*e^(-k2*t) / (k2 + k1*|v0|*(1-e^(-k2*t)))
+ *      and evaluated step by step, without a log per sample (see roll()). k1 = 0 and/or k2 = 0 are valid
+ *      (the limits of the formulas, e.g. a ball without drag keeps its velocity).
+ * Airborne model: ballistic flight with linear air drag, bouncing on the ground with the server's
+ *      bounce parameters, until the ball rolls.
+ */
+class Ball_Predictor {
+public:
+
+    enum { MAX_STEPS = 300 };               // 300*0.02s = 6s
+    static constexpr double STEP = 0.02;    // time between samples (s)
+
+    // ================================================= model parameters
+
+    double k1 = 0.01;                       // quadratic rolling drag
+    double k2 = 1;                          // linear rolling drag
+    double ball_radius = 0.042;             // height of the ball's center when rolling (m)
+    double gravity = 9.81;                  // m/s^2
+    double air_drag = 0.01;                 // linear air drag (1/s)
+    double bounce = 0.8;                    // vertical restitution on ground contact
+    double min_bounce_vel = 0.8;            // below this vertical speed the ball does not bounce (m/s)
+    double airborne_height = 0.1;           // the ball is airborne if its center is higher than ball_radius + this
+    double airborne_vel_z = 1.0;            // the ball is airborne if it moves up/down faster than this (m/s)
+    double max_x = 15;                      // prediction stops when the ball leaves |x| <= max_x
+    double max_y = 10;                      // prediction stops when the ball leaves |y| <= max_y
+    double min_displacement = 0.0005;       // prediction stops when the ball moves less per step in x and y
+
+    // ================================================= prediction (valid up to len)
+
+    int len = 0;                            // number of samples, sample 0 is the current state
+    int landing_step = 0;                   // first sample where the ball rolls (len if it never lands)
+    float pos[MAX_STEPS][2];                // ball position (x,y)
+    float height[MAX_STEPS];                // ball position (z)
+    float vel[MAX_STEPS][2];                // ball velocity (x,y)
+    float vel_z[MAX_STEPS];                 // ball velocity (z)
+    float spd[MAX_STEPS];                   // ball horizontal speed
+
+    /**
+     * @brief Predict the ball, assuming it is rolling on the ground
+     * @return number of samples
+     */
+    int predict_rolling(double bx, double by, double vx, double vy);
+
+    /**
+     * @brief Predict the ball, including an airborne phase if the ball is above the ground or moving vertically
+     * @param p ball position (x,y,z)
+     * @param v ball velocity (x,y,z)
+     * @return number of samples
+     */
+    int predict(const double p[3], const double v[3]);
+
+    /**
+     * @brief Get intersection with a moving ball for many robots at once
+     * A robot reaches the ball in sample j if the ball is within 0.2 + j*max_sp_per_step of the robot.
+     * If a robot never reaches the ball, the last sample is returned.
+     * @param traj ball positions (x,y) * traj_len
+     * @param traj_len number of ball positions (>=1)
+     * @param robots robot positions (x,y) * n
+     * @param max_sp_per_step maximum robot displacement per step * n
+     * @param n number of robots
+     * @param ret_xyd returned intersection point (x,y) and distance between robot and intersection point * n
+     * @param ret_step returned index of the intersection sample * n
+     */
+    static void intersect_batch(const float* traj, int traj_len, const float* robots, const float* max_sp_per_step,
+                                int n, float* ret_xyd, int* ret_step);
+
+private:
+
+    /** appends a sample, returns false if the prediction must stop before it (a rolling ball also stops when it is slow) */
+    bool add_sample(double x, double y, double z, double vx, double vy, double vz, bool rolling);
+
+    /** appends the rolling trajectory that starts at the last sample */
+    void roll();
+
+    /** implements roll(), SMALL_U selects a series instead of log1p (see ball_predictor.cpp) */
+    template<bool SMALL_U> void roll_samples();
+};
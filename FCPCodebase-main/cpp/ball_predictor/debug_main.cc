@@ -1,5 +1,6 @@
 #include "ball_predictor.h"
 #include <chrono>
+#include <cmath>
 #include <iostream>
 #include <iomanip>
 
@@ -7,9 +8,12 @@ using std::cout;
 using std::chrono::high_resolution_clock;
 using std::chrono::duration_cast;
 using std::chrono::microseconds;
+using std::chrono::nanoseconds;
 
 std::chrono::_V2::system_clock::time_point t1,t2;
 
+Ball_Predictor predictor;
+
 int main(){
 
     // ================================================= 1. Generate data
@@ -22,33 +26,81 @@ int main(){
     // ================================================= 2. Compute prediction
 
     t1 = high_resolution_clock::now();
-    predict_rolling_ball_pos_vel_spd(px, py, vx, vy);
+    predictor.predict_rolling(px, py, vx, vy);
     t2 = high_resolution_clock::now();
 
     cout << std::fixed << std::setprecision(8);
 
-    for(int i=0; i<pos_pred_len; i+=2){
-        cout << i/2 << " pos:" << ball_pos_pred[i] << "," << ball_pos_pred[i+1] <<
-                       " vel:" << ball_vel_pred[i] << "," << ball_vel_pred[i+1] <<
-                       " spd:" << ball_spd_pred[i/2] << "\n";
+    for(int i=0; i<predictor.len; i++){
+        cout << i << " pos:" << predictor.pos[i][0] << "," << predictor.pos[i][1] <<
+                     " vel:" << predictor.vel[i][0] << "," << predictor.vel[i][1] <<
+                     " spd:" << predictor.spd[i] << "\n";
     }    
 
     cout << "\n\n" << duration_cast<microseconds>(t2 - t1).count() << "us for prediction\n";
 
-    // ================================================= 3. Generate data
+    // ================================================= 3. Lofted kick
+
+    const double kick_pos[3] = {0, 0, 0.042};
+    const double kick_vel[3] = {8, 1, 5};
+
+    t1 = high_resolution_clock::now();
+    predictor.predict(kick_pos, kick_vel);
+    t2 = high_resolution_clock::now();
+
+    const int landing = (predictor.landing_step < predictor.len) ? predictor.landing_step : predictor.len-1; // len: never lands
+
+    cout << duration_cast<microseconds>(t2 - t1).count() << "us for lofted prediction, " << predictor.len <<
+            " samples, lands at sample " << predictor.landing_step << " pos:" << predictor.pos[landing][0] <<
+            "," << predictor.pos[landing][1] << " stops at " << predictor.pos[predictor.len-1][0] <<
+            "," << predictor.pos[predictor.len-1][1] << "\n\n";
+
+    // ================================================= 4. Without linear drag (k2 = 0), compared with the limit of the formula
+
+    Ball_Predictor no_k2;
+    no_k2.k2 = 0;
+    no_k2.predict_rolling(px, py, vx, vy);
+
+    const double t_last = (no_k2.len - 1) * Ball_Predictor::STEP;
+    const double x_last = px - log1p(no_k2.k1 * fabs(vx) * t_last) / no_k2.k1;
+    const bool k2_ok = no_k2.len > 1 and std::isfinite(no_k2.pos[no_k2.len-1][0]) and fabs(no_k2.pos[no_k2.len-1][0] - x_last) < 1e-3;
+
+    cout << "k2 = 0: " << no_k2.len << " samples, last x:" << no_k2.pos[no_k2.len-1][0] << " expected:" << x_last <<
+            (k2_ok ? " ok" : " FAILED") << "\n\n";
+
+    predictor.predict_rolling(px, py, vx, vy);
+
+    // ================================================= 5. Generate data (22 robots)
+
+    const int n = 22;
+    float robots[n*2];
+    float max_speed_per_step[n];
+    float ret_xyd[n*3];
+    int ret_step[n];
 
-    float robot_x = -1;
-    float robot_y = 1;
-    float max_speed_per_step = 0.7*0.02;
-    float ret_x, ret_y, ret_d;
+    for(int i=0; i<n; i++){
+        robots[i*2]   = -10 + i;
+        robots[i*2+1] = (i % 2) ? 3 : -3;
+        max_speed_per_step[i] = 0.7*0.02;
+    }
+    robots[0] = -1; // same robot as the single intersection of v1
+    robots[1] = 1;
 
-    // ================================================= 4. Compute intersection
+    // ================================================= 6. Compute intersections
 
+    const int repetitions = 10000;
     t1 = high_resolution_clock::now();
-    get_intersection_with_ball(robot_x, robot_y, max_speed_per_step, ball_pos_pred, pos_pred_len, ret_x, ret_y, ret_d);
+    for(int r=0; r<repetitions; r++){
+        Ball_Predictor::intersect_batch(&predictor.pos[0][0], predictor.len, robots, max_speed_per_step, n, ret_xyd, ret_step);
+    }
     t2 = high_resolution_clock::now();
 
-    cout << duration_cast<microseconds>(t2 - t1).count() << "us for intersection\n\n";
-    cout << "Intersection: " << ret_x << "," << ret_y << " dist: " << ret_d << "\n\n";
+    cout << duration_cast<nanoseconds>(t2 - t1).count() / repetitions << "ns for " << n << " intersections\n\n";
+    for(int i=0; i<n; i++){
+        cout << "Robot " << robots[i*2] << "," << robots[i*2+1] << " intersection: " << ret_xyd[i*3] << "," << ret_xyd[i*3+1] <<
+                " dist: " << ret_xyd[i*3+2] << " time: " << ret_step[i] * Ball_Predictor::STEP << "s\n";
+    }
+    cout << "\n";
 
+    return k2_ok ? 0 : 1;
 }
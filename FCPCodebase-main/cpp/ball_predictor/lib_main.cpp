@@ -1,90 +1,76 @@
 #include "ball_predictor.h"
 #include <pybind11/pybind11.h>
 #include <pybind11/numpy.h>
+#include <vector>
 
 namespace py = pybind11;
 using namespace std;
 
 
 /**
- * @brief Predict rolling ball position, velocity, linear speed
- * 
- * @param parameters 
- *        ball_x, ball_y, ball_vel_x, ball_vel_y
- * @return ball_pos_pred, ball_vel_pred, ball_spd_pred
+ * @brief Numpy view of the first len samples of an array that lives inside the predictor (no copy)
+ * The predictor object is kept alive as the base of the returned array.
+ * The view is overwritten by the next prediction of the same predictor.
  */
-py::array_t<float> predict_rolling_ball( py::array_t<float> parameters ){
-
-    // ================================================= 1. Parse data
-    
-    py::buffer_info parameters_buf = parameters.request();
-    float* parameters_ptr = (float*)parameters_buf.ptr;
-
-    float px = parameters_ptr[0];
-    float py = parameters_ptr[1];
-    float vx = parameters_ptr[2];
-    float vy = parameters_ptr[3];
-
-    // ================================================= 2. Compute path
-
-    predict_rolling_ball_pos_vel_spd(px, py, vx, vy);
-    
-    // ================================================= 3. Prepare data to return
-    
-    py::array_t<float> retval = py::array_t<float>(pos_pred_len+pos_pred_len+pos_pred_len/2); //allocate
-    py::buffer_info buff = retval.request();
-    float *ptr = (float *) buff.ptr;
-
-    for(int i=0; i<pos_pred_len; i++){
-        ptr[i] = ball_pos_pred[i];
-    }
-    ptr+=pos_pred_len;
-    for(int i=0; i<pos_pred_len; i++){
-        ptr[i] = ball_vel_pred[i];
-    }
-    ptr+=pos_pred_len;
-    for(int i=0; i<pos_pred_len/2; i++){
-        ptr[i] = ball_spd_pred[i];
+template<typename T>
+py::array_t<T> view(py::object self, T* data, std::vector<py::ssize_t> shape){
+    return py::array_t<T>(shape, data, self);
+}
+
+typedef py::array_t<float, py::array::c_style | py::array::forcecast> float_array;
+
+static const char* VIEW_DOC = "View of the predictor's memory (no copy). WARNING: the next predict() or predict_rolling() "
+                              "of this predictor overwrites it, use .copy() to keep it";
+
+
+/**
+ * @brief Predict the ball, including an airborne phase for lofted balls
+ *
+ * @param pos ball position (x,y,z)
+ * @param vel ball velocity (x,y,z)
+ * @return number of samples
+ */
+int predict(Ball_Predictor& p, float_array pos, float_array vel){
+
+    if (pos.size() < 3 or vel.size() < 3){
+        throw py::value_error("pos and vel must have 3 elements");
     }
-    return retval;
+
+    const float* pos_ptr = pos.data();
+    const float* vel_ptr = vel.data();
+    const double p3[3] = {pos_ptr[0], pos_ptr[1], pos_ptr[2]};
+    const double v3[3] = {vel_ptr[0], vel_ptr[1], vel_ptr[2]};
+    return p.predict(p3, v3);
 }
 
 
 /**
- * @brief Get point of intersection with moving ball
- * 
- * @param parameters 
- *        robot_x, robot_y, robot_max_speed_per_step
- * @return intersection_x, intersection_y, intersection_distance
+ * @brief Get points of intersection with moving ball for many robots at once
+ *
+ * @param trajectory ball positions, shape (m,2), e.g. the predictor's pos (or a slice of it)
+ * @param robots robot positions, shape (n,2)
+ * @param max_sp_per_step maximum robot displacement per step, shape (n,)
+ * @return intersection points and distances, shape (n,3), and intersection sample indices, shape (n,)
  */
-py::array_t<float> get_intersection( py::array_t<float> parameters ){
-
-    // ================================================= 1. Parse data
-    
-    py::buffer_info parameters_buf = parameters.request();
-    float* parameters_ptr = (float*)parameters_buf.ptr;
-    int params_len = parameters_buf.shape[0];
-
-    float x = parameters_ptr[0];
-    float y = parameters_ptr[1];
-    float max_sp = parameters_ptr[2];
-    float* ball_pos = parameters_ptr + 3;
-    float ret_x, ret_y, ret_d;
-
-    // ================================================= 2. Compute path
-
-    get_intersection_with_ball(x, y, max_sp, ball_pos, params_len-3, ret_x, ret_y, ret_d);
-    
-    // ================================================= 3. Prepare data to return
-    
-    py::array_t<float> retval = py::array_t<float>(3); //allocate
-    py::buffer_info buff = retval.request();
-    float *ptr = (float *) buff.ptr;
-
-    ptr[0] = ret_x;
-    ptr[1] = ret_y;
-    ptr[2] = ret_d;
-    return retval;
+py::tuple intersect_batch(float_array trajectory, float_array robots, float_array max_sp_per_step){
+
+    const py::ssize_t traj_len = trajectory.size() / 2;
+    const py::ssize_t n = robots.size() / 2;
+
+    if (traj_len < 1){
+        throw py::value_error("trajectory is empty");
+    }
+    if (max_sp_per_step.size() != n){
+        throw py::value_error("robots and max_sp_per_step have different lengths");
+    }
+
+    py::array_t<float> ret_xyd({n, (py::ssize_t)3});
+    py::array_t<int> ret_step(n);
+
+    Ball_Predictor::intersect_batch(trajectory.data(), traj_len, robots.data(), max_sp_per_step.data(), n,
+                                    ret_xyd.mutable_data(), ret_step.mutable_data());
+
+    return py::make_tuple(ret_xyd, ret_step);
 }
 
 
@@ -93,8 +79,36 @@ using namespace pybind11::literals; // to add informative argument names as -> "
 PYBIND11_MODULE(ball_predictor, m) {  // the python module name, m is the interface to create bindings
     m.doc() = "Ball predictor"; // optional module docstring
 
-    // optional arguments names
-    m.def("predict_rolling_ball", &predict_rolling_ball, "Predict rolling ball", "parameters"_a); 
-    m.def("get_intersection", &get_intersection, "Get point of intersection with moving ball", "parameters"_a); 
+    m.attr("STEP") = Ball_Predictor::STEP;
+
+    typedef Ball_Predictor P;
+
+    py::class_<P>(m, "Predictor")
+        .def(py::init<>())
+        .def("predict_rolling", &P::predict_rolling, "Predict rolling ball, returns number of samples",
+             "ball_x"_a, "ball_y"_a, "ball_vel_x"_a, "ball_vel_y"_a)
+        .def("predict", &predict, "Predict ball (rolling or airborne), returns number of samples", "pos"_a, "vel"_a)
+
+        // model parameters
+        .def_readwrite("k1", &P::k1)
+        .def_readwrite("k2", &P::k2)
+        .def_readwrite("ball_radius", &P::ball_radius)
+        .def_readwrite("gravity", &P::gravity)
+        .def_readwrite("air_drag", &P::air_drag)
+        .def_readwrite("bounce", &P::bounce)
+        .def_readwrite("min_bounce_vel", &P::min_bounce_vel)
+        .def_readwrite("airborne_height", &P::airborne_height)
+        .def_readwrite("airborne_vel_z", &P::airborne_vel_z)
+
+        // prediction: views of the predictor's memory, the next prediction OVERWRITES them (copy what must be kept)
+        .def_readonly("len", &P::len)
+        .def_readonly("landing_step", &P::landing_step)
+        .def_property_readonly("pos",    [](py::object s){ P& p = s.cast<P&>(); return view(s, &p.pos[0][0], {p.len, 2}); }, VIEW_DOC)
+        .def_property_readonly("height", [](py::object s){ P& p = s.cast<P&>(); return view(s, p.height,     {p.len}); },    VIEW_DOC)
+        .def_property_readonly("vel",    [](py::object s){ P& p = s.cast<P&>(); return view(s, &p.vel[0][0], {p.len, 2}); }, VIEW_DOC)
+        .def_property_readonly("vel_z",  [](py::object s){ P& p = s.cast<P&>(); return view(s, p.vel_z,      {p.len}); },    VIEW_DOC)
+        .def_property_readonly("spd",    [](py::object s){ P& p = s.cast<P&>(); return view(s, p.spd,        {p.len}); },    VIEW_DOC);
+
+    m.def("intersect_batch", &intersect_batch, "Get points of intersection with moving ball for many robots",
+          "trajectory"_a, "robots"_a, "max_sp_per_step"_a);
 }
-
@@ -3,8 +3,6 @@
 #include "World.h"
 
 
-static World& world = SWorld::getInstance();
-
 //=================================================================================================
 //=========================================================================== constexpr definitions
 //=================================================================================================
@@ -24,9 +22,6 @@ decltype(Field::cPenaltyWidth) constexpr Field::cPenaltyWidth;
 decltype(Field::cFieldLineSegments::list) constexpr Field::cFieldLineSegments::list;
 decltype(Field::cFieldPoints::list) constexpr Field::cFieldPoints::list;
 
-//non-constexpr definitions
-decltype(Field::list_8_landmarks::list) Field::list_8_landmarks::list;
-
 //=================================================================================================
 //=============================================================================== Drawing utilities
 //=================================================================================================
@@ -294,14 +289,14 @@ void Field::update(){
         sFixedMarker *l8;
         const sFieldPoint *fp;
         World::sLMark *l = &world.landmark[i];
-        if     (l->pos.x == -15 && l->pos.y == -10) {l8 = &list_8_landmarks::_corner_mm; fp = &cFieldPoints::corner_mm;}
-        else if(l->pos.x == -15 && l->pos.y == +10) {l8 = &list_8_landmarks::_corner_mp; fp = &cFieldPoints::corner_mp;}
-        else if(l->pos.x == +15 && l->pos.y == -10) {l8 = &list_8_landmarks::_corner_pm; fp = &cFieldPoints::corner_pm;}
-        else if(l->pos.x == +15 && l->pos.y == +10) {l8 = &list_8_landmarks::_corner_pp; fp = &cFieldPoints::corner_pp;}
-        else if(l->pos.x == -15 && l->pos.y < 0)    {l8 = &list_8_landmarks::_goal_mm;   fp = &cFieldPoints::goal_mm;  }
-        else if(l->pos.x == -15 && l->pos.y > 0)    {l8 = &list_8_landmarks::_goal_mp;   fp = &cFieldPoints::goal_mp;  }
-        else if(l->pos.x == +15 && l->pos.y < 0)    {l8 = &list_8_landmarks::_goal_pm;   fp = &cFieldPoints::goal_pm;  }
-        else if(l->pos.x == +15 && l->pos.y > 0)    {l8 = &list_8_landmarks::_goal_pp;   fp = &cFieldPoints::goal_pp;  }
+        if     (l->pos.x == -15 && l->pos.y == -10) {l8 = &landmarks_8._corner_mm; fp = &cFieldPoints::corner_mm;}
+        else if(l->pos.x == -15 && l->pos.y == +10) {l8 = &landmarks_8._corner_mp; fp = &cFieldPoints::corner_mp;}
+        else if(l->pos.x == +15 && l->pos.y == -10) {l8 = &landmarks_8._corner_pm; fp = &cFieldPoints::corner_pm;}
+        else if(l->pos.x == +15 && l->pos.y == +10) {l8 = &landmarks_8._corner_pp; fp = &cFieldPoints::corner_pp;}
+        else if(l->pos.x == -15 && l->pos.y < 0)    {l8 = &landmarks_8._goal_mm;   fp = &cFieldPoints::goal_mm;  }
+        else if(l->pos.x == -15 && l->pos.y > 0)    {l8 = &landmarks_8._goal_mp;   fp = &cFieldPoints::goal_mp;  }
+        else if(l->pos.x == +15 && l->pos.y < 0)    {l8 = &landmarks_8._goal_pm;   fp = &cFieldPoints::goal_pm;  }
+        else if(l->pos.x == +15 && l->pos.y > 0)    {l8 = &landmarks_8._goal_pp;   fp = &cFieldPoints::goal_pp;  }
         else{ return; } 
 
         if(l->seen){   
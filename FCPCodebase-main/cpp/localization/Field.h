@@ -7,9 +7,9 @@
 
 #pragma once
 #include "Vector3f.h"
-#include "Singleton.h"
 #include "Matrix4D.h"
 #include "Line6f.h"
+#include "World.h"
 #include <vector>
 #include <array>
 
@@ -17,15 +17,27 @@ using namespace std;
 
 
 class Field {
-    friend class Singleton<Field>;
 
 private:
 
-    Field(){};
     void gather_ground_markers();
 
+    /**
+     * World data of the robot this field map belongs to
+     */
+    World& world;
+
 public:
 
+    /**
+     * Constructor
+     * @param world_ world data of the robot, it must outlive the field map
+     */
+    Field(World& world_) : world(world_) {};
+
+    Field(const Field&) = delete;
+    Field& operator=(const Field&) = delete;
+
 //=================================================================================================
 //====================================================================================== Structures
 //=================================================================================================
@@ -427,27 +439,32 @@ public:
     class list_8_landmarks{
         friend class Field;
         private:
-            static sFixedMarker list[8];
-            //static std::array<sFixedMarker,8> list;
-            static constexpr sFixedMarker &_corner_mm = list[0];
-            static constexpr sFixedMarker &_corner_mp = list[1];
-            static constexpr sFixedMarker &_corner_pm = list[2];
-            static constexpr sFixedMarker &_corner_pp = list[3];
-            static constexpr sFixedMarker &_goal_mm   = list[4];
-            static constexpr sFixedMarker &_goal_mp   = list[5];
-            static constexpr sFixedMarker &_goal_pm   = list[6];
-            static constexpr sFixedMarker &_goal_pp   = list[7];
+            sFixedMarker list[8];
+            sFixedMarker &_corner_mm = list[0];
+            sFixedMarker &_corner_mp = list[1];
+            sFixedMarker &_corner_pm = list[2];
+            sFixedMarker &_corner_pp = list[3];
+            sFixedMarker &_goal_mm   = list[4];
+            sFixedMarker &_goal_mp   = list[5];
+            sFixedMarker &_goal_pm   = list[6];
+            sFixedMarker &_goal_pp   = list[7];
         public:
-            static constexpr const sFixedMarker &corner_mm = list[0];
-            static constexpr const sFixedMarker &corner_mp = list[1];
-            static constexpr const sFixedMarker &corner_pm = list[2];
-            static constexpr const sFixedMarker &corner_pp = list[3];
-            static constexpr const sFixedMarker &goal_mm   = list[4];
-            static constexpr const sFixedMarker &goal_mp   = list[5];
-            static constexpr const sFixedMarker &goal_pm   = list[6];
-            static constexpr const sFixedMarker &goal_pp   = list[7];
+            list_8_landmarks(){};
+            list_8_landmarks(const list_8_landmarks&) = delete;
+            list_8_landmarks& operator=(const list_8_landmarks&) = delete;
+
+            const sFixedMarker &corner_mm = list[0];
+            const sFixedMarker &corner_mp = list[1];
+            const sFixedMarker &corner_pm = list[2];
+            const sFixedMarker &corner_pp = list[3];
+            const sFixedMarker &goal_mm   = list[4];
+            const sFixedMarker &goal_mp   = list[5];
+            const sFixedMarker &goal_pm   = list[6];
+            const sFixedMarker &goal_pp   = list[7];
     };
 
+    list_8_landmarks landmarks_8;
+
 
 
 //=================================================================================================
@@ -498,6 +515,4 @@ public:
         return 3.14159265f-fabsf(fmod(fabsf(rad), 6.28318531f) - 3.14159265f);
     }
 
-};
-
-typedef Singleton<Field> SField;
\ No newline at end of file
+};
\ No newline at end of file
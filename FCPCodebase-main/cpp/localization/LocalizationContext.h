@@ -0,0 +1,30 @@
+/**
+ * FILENAME:     LocalizationContext
+ * DESCRIPTION:  Localization state of one robot
+ *
+ * The world data, the field map and the localizer of one robot.
+ * Different contexts share no state, so they can be used by different threads
+ * (a single context must not be used by two threads at the same time).
+ * Drawing (Field::draw_visible) uses the shared RobovizLogger and is not thread safe.
+ */
+
+#pragma once
+#include "World.h"
+#include "Field.h"
+#include "LocalizerV2.h"
+
+
+class LocalizationContext {
+
+public:
+
+    LocalizationContext() : field(world), loc(world, field) {};
+
+    LocalizationContext(const LocalizationContext&) = delete;
+    LocalizationContext& operator=(const LocalizationContext&) = delete;
+
+    World world;        // input data, written before each run
+    Field field;        // field map, built from world
+    LocalizerV2 loc;    // localizer, reads world and field
+
+};
@@ -2,10 +2,48 @@
 #include "math.h"
 #include "iostream"
 #include "World.h"
+#include <chrono>
 
 using namespace std;
 
-static World& world = SWorld::getInstance();
+
+LocalizerV2::LocalizerV2(World& world_, Field& fd_) : world(world_), fd(fd_) {
+
+	const gsl_multimin_fminimizer_type *T = gsl_multimin_fminimizer_nmsimplex2;
+
+	tune_ws = gsl_multimin_fminimizer_alloc(T, 3);
+	tune_x  = gsl_vector_alloc(3);
+	tune_ss = gsl_vector_alloc(3);
+
+	for(int i=0; i<4; i++){
+		guess_ws[i] = gsl_multimin_fminimizer_alloc(T, 2);
+		guess_x[i]  = gsl_vector_alloc(2);
+		guess_ss[i] = gsl_vector_alloc(2);
+	}
+
+	plane_A    = gsl_matrix_alloc(32, 3);
+	plane_V    = gsl_matrix_alloc(3, 3);
+	plane_S    = gsl_vector_alloc(3);
+	plane_work = gsl_vector_alloc(3);
+}
+
+LocalizerV2::~LocalizerV2(){
+
+	gsl_multimin_fminimizer_free(tune_ws);
+	gsl_vector_free(tune_x);
+	gsl_vector_free(tune_ss);
+
+	for(int i=0; i<4; i++){
+		gsl_multimin_fminimizer_free(guess_ws[i]);
+		gsl_vector_free(guess_x[i]);
+		gsl_vector_free(guess_ss[i]);
+	}
+
+	gsl_matrix_free(plane_A);
+	gsl_matrix_free(plane_V);
+	gsl_vector_free(plane_S);
+	gsl_vector_free(plane_work);
+}
 
 
 /**
@@ -13,12 +51,12 @@ static World& world = SWorld::getInstance();
  * */
 void LocalizerV2::run(){
 
-	Field& fd = SField::getInstance();
-
 	stats_change_state(RUNNING);
+	const auto start_time = chrono::steady_clock::now();
 
 	//------------------ WORKFLOW: 0
 
+	used_warm_start = false;
 	_is_uptodate = false;
 	_is_head_z_uptodate = false;
 	_steps_since_last_update++;
@@ -38,9 +76,9 @@ void LocalizerV2::run(){
 
 	if( ! find_z_axis_orient_vec() ){ return; }
 
-	//------------------ WORKFLOW: 3-4
+	//------------------ WORKFLOW: 3-4 (or warm start)
 
-	if(!(  landmarks_no >1 ? find_xy() : guess_xy()  )){ return; }
+	if(!(  warm_start_xy() || (landmarks_no >1 ? find_xy() : guess_xy())  )){ return; }
 
 	//------------------ Update public variables
 
@@ -48,6 +86,9 @@ void LocalizerV2::run(){
 
 	stats_change_state(DONE);
 
+	time_sum[used_warm_start] += chrono::duration<double, micro>(chrono::steady_clock::now() - start_time).count();
+	time_counter[used_warm_start]++;
+
 	//------------------ Statistics
 
 	//Ball position stats
@@ -78,14 +119,11 @@ void add_gsl_regression_sample(gsl_matrix* m, gsl_vector* v, int sample_no, cons
 }
 
 template<std::size_t SIZE>
-gsl_vector* create_gsl_vector(const std::array<double, SIZE> &content){
+void set_gsl_vector(gsl_vector* v, const std::array<double, SIZE> &content){
 
-	gsl_vector* v = gsl_vector_alloc (SIZE);
-	
-	for(int i=0; i<SIZE; i++){
+	for(size_t i=0; i<SIZE; i++){
 		gsl_vector_set(v, i, content[i]);
 	}
-	return v;
 }
 
 
@@ -228,8 +266,6 @@ void fast_compute_XYvec_from_Zvec(const Vector3f& Zvec, float agent_angle, Vecto
  */ 
 bool LocalizerV2::find_z_axis_orient_vec(){
 
-	Field& fd = SField::getInstance();
-
 	const int goalNo = fd.list_landmarks_goalposts.size();
 
 	if(fd.non_collinear_ground_markers >= 3){
@@ -300,10 +336,10 @@ bool LocalizerV2::find_z_axis_orient_vec(){
 
 	Vector3f crossbar_left_vec, crossbar_midp; //this crossbar vector points left if seen from the midfield (this is important for the cross product)
 
-	const auto& goal_mm = Field::list_8_landmarks::goal_mm;
-	const auto& goal_mp = Field::list_8_landmarks::goal_mp;
-	const auto& goal_pm = Field::list_8_landmarks::goal_pm;
-	const auto& goal_pp = Field::list_8_landmarks::goal_pp;
+	const auto& goal_mm = fd.landmarks_8.goal_mm;
+	const auto& goal_mp = fd.landmarks_8.goal_mp;
+	const auto& goal_pm = fd.landmarks_8.goal_pm;
+	const auto& goal_pp = fd.landmarks_8.goal_pp;
 
 	if(                     goal_mm.visible   && goal_mp.visible){
 		crossbar_left_vec = goal_mm.relPosCart - goal_mp.relPosCart;
@@ -352,20 +388,19 @@ bool LocalizerV2::find_z_axis_orient_vec(){
  */
 void LocalizerV2::fit_ground_plane(){
 
-	Field& fd = SField::getInstance();
-
 	const auto& ground_markers = fd.list_weighted_ground_markers;
 	const int ground_m_size = ground_markers.size();
 
 	//------------------------------------ Compute groundmarks plane (if we have at least 3 groundmarks)
 
-	gsl_matrix *A, *V;
-	gsl_vector *S, *work;
-
-	A = gsl_matrix_alloc(ground_m_size, 3); 
-	V = gsl_matrix_alloc(3, 3); 
-	S = gsl_vector_alloc(3); 
-	work = gsl_vector_alloc(3);
+	//Use the first rows of the preallocated matrix (which grows if there are more ground markers than rows)
+	if(plane_A->size1 < (size_t)ground_m_size){
+		gsl_matrix_free(plane_A);
+		plane_A = gsl_matrix_alloc(ground_m_size * 2, 3);
+	}
+	gsl_matrix_view A_view = gsl_matrix_submatrix(plane_A, 0, 0, ground_m_size, 3);
+	gsl_matrix *A = &A_view.matrix, *V = plane_V;
+	gsl_vector *S = plane_S, *work = plane_work;
 
 	// Find the centroid
 	Vector3f centroid(0,0,0);
@@ -399,11 +434,6 @@ void LocalizerV2::fit_ground_plane(){
 
 	//Note: |d| is an estimate of the agent's height, but we can do better by including aerial references in the prediction later
 
-	gsl_matrix_free (A);
-	gsl_matrix_free (V);
-	gsl_vector_free (S);
-	gsl_vector_free (work);
-
 	/**
 	 * Unfortunately, the normal vector doesn't always point up
 	 * The plane is defined by (ax + by + cz - d = 0)
@@ -457,8 +487,6 @@ void LocalizerV2::fit_ground_plane(){
  */
 void LocalizerV2::find_z(const Vector3f& Zvec){
 
-	Field& fd = SField::getInstance();
-
 	Vector3f zsum;
 	for(const auto& g: fd.list_weighted_ground_markers){
 		zsum += g.relPosCart;
@@ -484,16 +512,17 @@ void LocalizerV2::find_z(const Vector3f& Zvec){
 double LocalizerV2::map_error_logprob(const gsl_vector *v, void *params){
 
 	float angle;
-	Field& fd = SField::getInstance();
+	const sErrorParams& p = *(const sErrorParams *)params;
+	const Field& fd = p.loc->fd;
 
 	//Get angle from optimization vector, or from params (as a constant)
 	if(v->size == 3){
 		angle = gsl_vector_get(v,2);
 	}else{
-		angle = *(float *)params;
+		angle = p.angle;
 	}
 
-	Matrix4D& transfMat = SLocalizerV2::getInstance().prelimHeadToField;
+	Matrix4D& transfMat = p.loc->prelimHeadToField;
 	Vector3f Zvec(transfMat.get(2,0), transfMat.get(2,1), transfMat.get(2,2));
 	
 	Vector3f Xvec, Yvec;
@@ -566,16 +595,17 @@ double LocalizerV2::map_error_logprob(const gsl_vector *v, void *params){
 double LocalizerV2::map_error_2d(const gsl_vector *v, void *params){
 
 	float angle;
-	Field& fd = SField::getInstance();
+	const sErrorParams& p = *(const sErrorParams *)params;
+	const Field& fd = p.loc->fd;
 
 	//Get angle from optimization vector, or from params (as a constant)
 	if(v->size == 3){
 		angle = gsl_vector_get(v,2);
 	}else{
-		angle = *(float *)params;
+		angle = p.angle;
 	}
 
-	Matrix4D& transfMat = SLocalizerV2::getInstance().prelimHeadToField;
+	Matrix4D& transfMat = p.loc->prelimHeadToField;
 	Vector3f Zvec(transfMat.get(2,0), transfMat.get(2,1), transfMat.get(2,2));
 	
 	Vector3f Xvec, Yvec;
@@ -692,22 +722,25 @@ double LocalizerV2::map_error_2d(const gsl_vector *v, void *params){
 
 /**
  * Apply fine tuning directly on the prelimHeadToField matrix
- * 1st - improve map fitting
+ * 1st - improve map fitting (skipped after a warm start, which already did it with Gauss-Newton)
  * 2nd - identify line segments and their endpoints
  * 3rd - fine tune again using known markers
  * @param initial_angle initial angle of Xvec around Zvec
  * @param initial_x initial translation in x
  * @param initial_y initial translation in y
+ * @param warm_start true if the initial parameters were obtained by warm start
  */
-bool LocalizerV2::fine_tune(float initial_angle, float initial_x, float initial_y){
-
-	Field& fd = SField::getInstance();
+bool LocalizerV2::fine_tune(float initial_angle, float initial_x, float initial_y, bool warm_start){
 
 	//Statistics before fine tune
 	counter_fineTune += stats_sample_position_error(Vector3f(initial_x,initial_y,prelimHeadToField.get(11)), world.my_cheat_abs_cart_pos, errorSum_fineTune_before);
 
 	//Fine tune, changing the initial parameters directly
-	if(!fine_tune_aux(initial_angle, initial_x, initial_y, false)) return false;
+	if(warm_start){
+		set_prelim_xy(initial_angle, initial_x, initial_y);
+	}else{
+		if(!fine_tune_aux(initial_angle, initial_x, initial_y, false)) return false;
+	}
 	
 	//Statistics for 1st fine tune
 	stats_sample_position_error(Vector3f(initial_x,initial_y,prelimHeadToField.get(11)), world.my_cheat_abs_cart_pos, errorSum_fineTune_euclidianDist);
@@ -716,7 +749,8 @@ bool LocalizerV2::fine_tune(float initial_angle, float initial_x, float initial_
 	fd.update_from_transformation(prelimHeadToField);
 
 	//Probabilistic fine tune
-	fine_tune_aux(initial_angle, initial_x, initial_y, true);
+	fine_tune_aux(initial_angle, initial_x, initial_y, true, warm_start);
+	prelim_angle = initial_angle;
 
 	//Statistics for 2nd fine tune
 	stats_sample_position_error(prelimHeadToField.toVector3f(), world.my_cheat_abs_cart_pos, errorSum_fineTune_probabilistic);
@@ -731,23 +765,30 @@ bool LocalizerV2::fine_tune(float initial_angle, float initial_x, float initial_
 /**
  * Apply fine tuning:
  * - directly on: initial_angle, initial_x, initial_y (if use_probabilities == false)
- * - directly on the prelimHeadToField matrix using probabilities (if use_probabilities == true)
+ * - directly on the prelimHeadToField matrix using probabilities (if use_probabilities == true),
+ *   the best solution is also written to initial_angle, initial_x, initial_y
  * @param initial_angle initial angle of Xvec around Zvec
  * @param initial_x initial translation in x
  * @param initial_y initial translation in y
+ * @param warm_start if true, the initial parameters are already close to the solution, so the initial step sizes
+ *                   are smaller and the probabilistic tune stops when it converges (instead of always doing 40 iterations)
  */
-bool LocalizerV2::fine_tune_aux(float &initial_angle, float &initial_x, float &initial_y, bool use_probabilities){
+bool LocalizerV2::fine_tune_aux(float &initial_angle, float &initial_x, float &initial_y, bool use_probabilities, bool warm_start){
 
 	int status, iter=0;
-	gsl_vector* x =  create_gsl_vector<3>({initial_x, initial_y, initial_angle}); // Initial transformation 
-	gsl_vector* ss = create_gsl_vector<3>({0.02, 0.02, 0.03});                    // Set initial step sizes 
-	gsl_multimin_function minex_func = {map_error_2d, 3, nullptr};                // error func, variables no., params
+	gsl_vector* x = tune_x;
+	gsl_vector* ss = tune_ss;
+	set_gsl_vector<3>(x, {initial_x, initial_y, initial_angle});                   // Initial transformation 
+	if(warm_start) set_gsl_vector<3>(ss, {0.01, 0.01, 0.01});                      // Set initial step sizes 
+	else           set_gsl_vector<3>(ss, {0.02, 0.02, 0.03});
+	sErrorParams params = {this, 0};
+	gsl_multimin_function minex_func = {map_error_2d, 3, &params};                // error func, variables no., params
 	if(use_probabilities) minex_func.f = map_error_logprob;				          // probablity-based error function
 
-	const gsl_multimin_fminimizer_type *T = gsl_multimin_fminimizer_nmsimplex2;   // algorithm type
-	gsl_multimin_fminimizer *s = gsl_multimin_fminimizer_alloc (T, 3);            // allocate workspace
+	gsl_multimin_fminimizer *s = tune_ws;                                         // preallocated workspace
   	gsl_multimin_fminimizer_set (s, &minex_func, x, ss);                          // set workspace
 
+	const bool always_iterate = use_probabilities && !warm_start;
 	float best_x, best_y, best_ang;
 
 
@@ -766,14 +807,10 @@ bool LocalizerV2::fine_tune_aux(float &initial_angle, float &initial_x, float &i
 		status = gsl_multimin_test_size (size, 1e-3); //This size can be used as a stopping criteria, as the simplex contracts itself near the minimum
 
     }
-	while ((status == GSL_CONTINUE || use_probabilities) && iter < 40);
+	while ((status == GSL_CONTINUE || always_iterate) && iter < 40);
 
 	float best_map_error = s->fval;
 
-	gsl_vector_free(x);
-	gsl_vector_free(ss);
-	gsl_multimin_fminimizer_free (s);
-
 	if(!use_probabilities){
 		if(best_map_error > 0.10){
 			stats_change_state(FAILtune);
@@ -791,24 +828,216 @@ bool LocalizerV2::fine_tune_aux(float &initial_angle, float &initial_x, float &i
 	 * Note: The transformations are directly tested on prelimHeadToField but it currently
 	 * holds the last test, so we set it manually here to the best found solution
 	 */
+	set_prelim_xy(best_ang, best_x, best_y);
+
+	initial_angle = best_ang;
+	initial_x = best_x;
+	initial_y = best_y;
+
+	return true;
+}
+
+
+/**
+ * Set the first 2 rows of prelimHeadToField from the angle of Xvec around Zvec and the XY translation
+ */
+void LocalizerV2::set_prelim_xy(float angle, float x, float y){
 
 	//Convert angle into Xvec and Yvec
 	Vector3f Zvec(prelimHeadToField.get(2,0), prelimHeadToField.get(2,1), prelimHeadToField.get(2,2));
 	Vector3f Xvec, Yvec;
-	fast_compute_XYvec_from_Zvec(Zvec, best_ang, Xvec, Yvec );
+	fast_compute_XYvec_from_Zvec(Zvec, angle, Xvec, Yvec );
 
 	prelimHeadToField.set(0,0, Xvec.x);
 	prelimHeadToField.set(0,1, Xvec.y);
 	prelimHeadToField.set(0,2, Xvec.z);
-	prelimHeadToField.set(0,3, best_x);
+	prelimHeadToField.set(0,3, x);
 	prelimHeadToField.set(1,0, Yvec.x);
 	prelimHeadToField.set(1,1, Yvec.y);
 	prelimHeadToField.set(1,2, Yvec.z);
-	prelimHeadToField.set(1,3, best_y);
+	prelimHeadToField.set(1,3, y);
+}
+
+
+/**
+ * Closest point of a field line segment to a 2D point
+ */
+static Vector field_segment_closest_point(const Field::sFieldSegment& s, const Vector& p){
+
+	const Vector a(s.point[0]->pt.x, s.point[0]->pt.y);
+	const Vector b(s.point[1]->pt.x, s.point[1]->pt.y);
+	const Vector v(b - a);
 
+	float t = (p - a).innerProduct(v) / (float)(s.length * s.length);
+	if(t < 0) t = 0;
+	else if(t > 1) t = 1;
+
+	return a + v * t;
+}
+
+
+/**
+ * Refine XY translation/rotation with Gauss-Newton, starting from a nearby estimate
+ * Residuals:
+ * - 2D distance between each landmark and its known position (x and y separately)
+ * - 2D distance between each endpoint of a seen line and the field line that best matches that line,
+ *   using the same matching criteria as map_error_2d (the correspondences are updated in every iteration)
+ * The derivatives of the rotated coordinates with respect to the angle are computed numerically
+ * @param angle angle of Xvec around Zvec (input: initial estimate, output: solution)
+ * @param x translation in x (input: initial estimate, output: solution)
+ * @param y translation in y (input: initial estimate, output: solution)
+ * @param avg_error average mapping error per point (same weight as map_error_2d, without the landmark penalty)
+ * @return false if a seen line could not be matched or the system is degenerate
+ */
+bool LocalizerV2::gauss_newton_xy(float &angle, float &x, float &y, float &avg_error){
+
+	Vector3f Zvec(prelimHeadToField.get(2,0), prelimHeadToField.get(2,1), prelimHeadToField.get(2,2));
+
+	const float d_angle = 1e-3f;
+	const int maximum_iterations = 6;
+
+	for(int iter=0; iter<maximum_iterations; iter++){
+
+		Vector3f Xvec, Yvec, Xvec_d, Yvec_d;
+		fast_compute_XYvec_from_Zvec(Zvec, angle, Xvec, Yvec );
+		fast_compute_XYvec_from_Zvec(Zvec, angle + d_angle, Xvec_d, Yvec_d );
+
+		//Normal equations (J^T J) delta = -(J^T r), where J^T J is symmetric
+		double A[3][3] = {{0}}, b[3] = {0};
+		float total_err = 0;
+		int total_err_cnt = 0;
+
+		auto add_residual = [&](double r, double jx, double jy, double ja){
+			const double j[3] = {jx, jy, ja};
+			for(int i=0; i<3; i++){
+				for(int k=i; k<3; k++) A[i][k] += j[i] * j[k];
+				b[i] -= j[i] * r;
+			}
+		};
+
+		//Absolute 2D position of a relative point, and its derivative with respect to the angle
+		auto to_abs = [&](const Vector3f& p, Vector& abs, Vector& d_abs){
+			abs = Vector(Xvec.innerProduct(p) + x, Yvec.innerProduct(p) + y);
+			d_abs = Vector((Xvec_d.innerProduct(p) - Xvec.innerProduct(p)) / d_angle,
+			               (Yvec_d.innerProduct(p) - Yvec.innerProduct(p)) / d_angle);
+		};
+
+		//------------------------------------------------ Landmarks
+
+		for(const Field::sMarker& m : fd.list_landmarks){
+			Vector abs, d_abs;
+			to_abs(m.relPosCart, abs, d_abs);
+
+			const float ex = abs.x - m.absPos.x;
+			const float ey = abs.y - m.absPos.y;
+			add_residual(ex, 1, 0, d_abs.x);
+			add_residual(ey, 0, 1, d_abs.y);
+
+			total_err += sqrtf(ex*ex + ey*ey);
+			total_err_cnt++;
+		}
+
+		//------------------------------------------------ Lines
+
+		for(const Line6f& l : fd.list_segments){
+
+			Vector ls, le, d_ls, d_le;
+			to_abs(l.startc, ls, d_ls);
+			to_abs(l.endc,   le, d_le);
+
+			//Only long lines have a reliable orientation (see map_error_2d)
+			float l_angle = atan2f(le.y - ls.y, le.x - ls.x);
+			if(l_angle < 0) { l_angle += 3.14159265f; }
+			const float l_angle_tolerance = l.length > 0.8 ? 0.35f : 10;
+
+			const Field::sFieldSegment* best = nullptr;
+			float min_err = 1e6f;
+			for(const auto& s : Field::cFieldLineSegments::list){
+				if( l.length > (s.length + 0.7) ){ continue; }
+
+				float angle_difference = fabsf(l_angle - s.angle);
+				if(angle_difference > 1.57079632f) angle_difference = 3.14159265f - angle_difference;
+				if(angle_difference > l_angle_tolerance) continue;
+
+				float err = Field::fieldLineSegmentDistToCart2DPoint(s,ls) + Field::fieldLineSegmentDistToCart2DPoint(s,le);
+				if(err < min_err){ min_err = err; best = &s; }
+			}
+
+			if(best == nullptr) return false; //the line does not match the estimated pose
+
+			const Vector* pts[2] = {&ls, &le};
+			const Vector* d_pts[2] = {&d_ls, &d_le};
+			for(int i=0; i<2; i++){
+				Vector diff = *pts[i] - field_segment_closest_point(*best, *pts[i]);
+				float r = diff.length();
+				if(r > 1e-6f){
+					Vector u = diff / r; //gradient of the distance
+					add_residual(r, u.x, u.y, u.innerProduct(*d_pts[i]));
+				}
+			}
+
+			total_err += min_err;
+			total_err_cnt += 2; //a line has 2 points, double the weight of a single landmark
+		}
+
+		avg_error = total_err / total_err_cnt;
+
+		//------------------------------------------------ Solve 3x3 system (Cramer's rule)
+
+		A[1][0] = A[0][1]; A[2][0] = A[0][2]; A[2][1] = A[1][2];
+
+		double det = A[0][0]*(A[1][1]*A[2][2] - A[1][2]*A[2][1]) 
+		           - A[0][1]*(A[1][0]*A[2][2] - A[1][2]*A[2][0]) 
+		           + A[0][2]*(A[1][0]*A[2][1] - A[1][1]*A[2][0]);
+
+		if(fabs(det) < 1e-9) return false; //degenerate (e.g. only parallel lines)
+
+		double dx = (b[0]*(A[1][1]*A[2][2] - A[1][2]*A[2][1]) - A[0][1]*(b[1]*A[2][2] - A[1][2]*b[2]) + A[0][2]*(b[1]*A[2][1] - A[1][1]*b[2])) / det;
+		double dy = (A[0][0]*(b[1]*A[2][2] - A[1][2]*b[2]) - b[0]*(A[1][0]*A[2][2] - A[1][2]*A[2][0]) + A[0][2]*(A[1][0]*b[2] - b[1]*A[2][0])) / det;
+		double da = (A[0][0]*(A[1][1]*b[2] - b[1]*A[2][1]) - A[0][1]*(A[1][0]*b[2] - b[1]*A[2][0]) + b[0]*(A[1][0]*A[2][1] - A[1][1]*A[2][0])) / det;
+
+		x += dx;
+		y += dy;
+		angle += da;
+
+		if(fabs(dx) + fabs(dy) < 1e-4 && fabs(da) < 1e-4) break; //converged
+	}
+
+	return gsl_finite(x) && gsl_finite(y) && gsl_finite(angle);
+}
+
+
+/**
+ * Propagate the last pose and refine it with Gauss-Newton (see workflow description)
+ * The previous pose is only trusted if it was computed in one of the last 2 visual steps
+ */
+bool LocalizerV2::warm_start_xy(){
+
+	if(!warm_start_enabled || !has_pose || _steps_since_last_update > 2) return false;
+
+	//Propagate last pose (constant velocity)
+	const float n = _steps_since_last_update;
+	float angle = final_angle + step_angular_velocity * n;
+	float x = final_translation.x + step_velocity.x * n;
+	float y = final_translation.y + step_velocity.y * n;
+	Vector predicted(x,y);
+
+	counter_warmStart += stats_sample_position_error(Vector3f(x,y,prelimHeadToField.get(11)), world.my_cheat_abs_cart_pos, errorSum_warmStart);
+
+	float avg_error;
+	if(!gauss_newton_xy(angle, x, y, avg_error) || avg_error > 0.10 || predicted.getDistanceTo(Vector(x,y)) > 0.3){
+		stats_change_state(FAILwarm);
+		return false;
+	}
+
+	if(!fine_tune(angle, x, y, true)) return false;
+
+	used_warm_start = true;
+	stats_change_state(WARM);
 	return true;
 }
 
+
 /**
  * Find XY translation/rotation
  * A unique solution is guaranteed if Zvec points in the right direction
@@ -816,8 +1045,6 @@ bool LocalizerV2::fine_tune_aux(float &initial_angle, float &initial_x, float &i
  */
 bool LocalizerV2::find_xy(){
 
-	Field& fd = SField::getInstance();
-
 	Vector3f Zvec(prelimHeadToField.get(2,0), prelimHeadToField.get(2,1), prelimHeadToField.get(2,2));
 
 	Field::sMarker *m1 = nullptr, *m2 = nullptr;
@@ -871,8 +1098,6 @@ bool LocalizerV2::find_xy(){
 }
 
 bool LocalizerV2::guess_xy(){
-	Field& fd = SField::getInstance();
-
 	//Get Zvec from previous steps
 	Vector3f Zvec(prelimHeadToField.get(2,0), prelimHeadToField.get(2,1), prelimHeadToField.get(2,2));
 	Vector last_known_position(head_position.x, head_position.y);
@@ -945,25 +1170,25 @@ bool LocalizerV2::guess_xy(){
 	//------------------------------------------------------------ Optimize XY rotation for each possible orientation
 
 
-	const gsl_multimin_fminimizer_type *T = gsl_multimin_fminimizer_nmsimplex2;
-	gsl_multimin_fminimizer *s[4] = {nullptr,nullptr,nullptr,nullptr};
-	gsl_vector *ss[4], *x[4];
+	gsl_multimin_fminimizer **s = guess_ws; //preallocated workspaces
+	gsl_vector **ss = guess_ss, **x = guess_x;
 	gsl_multimin_function minex_func[4];
+	sErrorParams params[4];
 
 	size_t iter = 0;
 	int status;
 	double size;
 
 	for(int i=0; i<4; i++){
-		x[i]  = create_gsl_vector<2>({initial_x[i], initial_y[i]}); // Initial transformation 
-		ss[i] = create_gsl_vector<2>({1, 1}); //Set initial step sizes to 1
+		set_gsl_vector<2>(x[i], {initial_x[i], initial_y[i]}); // Initial transformation 
+		set_gsl_vector<2>(ss[i], {1, 1}); //Set initial step sizes to 1
 
 		/* Initialize method */
 		minex_func[i].n = 2;
 		minex_func[i].f = map_error_2d;
-		minex_func[i].params = &fixed_angle[i];	
+		params[i] = {this, fixed_angle[i]};
+		minex_func[i].params = &params[i];
 
-		s[i] = gsl_multimin_fminimizer_alloc (T, 2);
   		gsl_multimin_fminimizer_set (s[i], &minex_func[i], x[i], ss[i]);
 	}
 
@@ -1009,12 +1234,6 @@ bool LocalizerV2::guess_xy(){
 
     } while (iter < maximum_iterations && (running[0] || running[1] || running[2] || running[3]));
 
-	for(int i=0; i<4; i++){
-		gsl_vector_free(x[i]);
-		gsl_vector_free(ss[i]);
-		gsl_multimin_fminimizer_free (s[i]);
-	}
-
 
 	//At this point, a solution is plausible if it converged to a local minimum
 	//So, we apply the remaining criteria for plausiblity
@@ -1063,6 +1282,18 @@ bool LocalizerV2::guess_xy(){
  */
 void LocalizerV2::commit_everything(){
 
+	//Update motion estimate used by the warm start (only if the last pose is recent)
+	const Vector3f new_translation = prelimHeadToField.toVector3f();
+	if(has_pose && _steps_since_last_update <= 2){
+		step_velocity = (new_translation - final_translation) / (float)_steps_since_last_update;
+		step_angular_velocity = remainderf(prelim_angle - final_angle, 6.28318531f) / _steps_since_last_update; //signed difference in [-pi,pi]
+	}else{
+		step_velocity = Vector3f(0,0,0);
+		step_angular_velocity = 0;
+	}
+	final_angle = prelim_angle;
+	has_pose = true;
+
 	final_headTofieldTransform = prelimHeadToField; //Full transformation (relative to absolute)
 
 	final_headTofieldTransform.inverse_tranformation_matrix( final_fieldToheadTransform ); //Full transformation (absolute to relative)
@@ -1169,13 +1400,24 @@ void LocalizerV2::print_report() const{
 	}
 	float e4[] = { ptr[3]/cb, sqrt(e4_2d_var), ptr[5]/cb, sqrt(e4_3d_var), ptr[0]/cb, ptr[1]/cb, ptr[2]/cb };
 
+	const int &cw = counter_warmStart;
+	const int cw1 = cw-1;
+	ptr = errorSum_warmStart;
+	float e5_2d_var=0, e5_3d_var=0;
+	if(cw1 > 0){
+		e5_2d_var = (ptr[4] - (ptr[3]*ptr[3]) / cw) / cw1;
+		e5_3d_var = (ptr[6] - (ptr[5]*ptr[5]) / cw) / cw1;
+	}
+	float e5[] = { ptr[3]/cw, sqrt(e5_2d_var), ptr[5]/cw, sqrt(e5_3d_var), ptr[0]/cw, ptr[1]/cw, ptr[2]/cw };
+
 	const int* st = state_counter;
 	printf("---------------------------------- LocalizerV2 Report ----------------------------------\n");
 	printf("SAMPLING STAGE              2D-MAE  2D-STD  3D-MAE  3D-STD   x-MBE    y-MBE    z-MBE\n");
 	printf("Before fine-tune:           %.4f  %.4f  %.4f  %.4f  %7.4f  %7.4f  %7.4f\n",   e1[0],e1[1],e1[2],e1[3],e1[4],e1[5],e1[6]);
 	printf("After Euclidian dist. fit:  %.4f  %.4f  %.4f  %.4f  %7.4f  %7.4f  %7.4f\n",   e2[0],e2[1],e2[2],e2[3],e2[4],e2[5],e2[6]);
 	printf("After probabilistic fit:    %.4f  %.4f  %.4f  %.4f  %7.4f  %7.4f  %7.4f\n",   e3[0],e3[1],e3[2],e3[3],e3[4],e3[5],e3[6]);
-	printf("Ball:                       %.4f  %.4f  %.4f  %.4f  %7.4f  %7.4f  %7.4f\n\n", e4[0],e4[1],e4[2],e4[3],e4[4],e4[5],e4[6]);
+	printf("Ball:                       %.4f  %.4f  %.4f  %.4f  %7.4f  %7.4f  %7.4f\n",   e4[0],e4[1],e4[2],e4[3],e4[4],e4[5],e4[6]);
+	printf("Warm start prediction:      %.4f  %.4f  %.4f  %.4f  %7.4f  %7.4f  %7.4f\n\n", e5[0],e5[1],e5[2],e5[3],e5[4],e5[5],e5[6]);
 	printf("* MBE(Mean Bias Error) MAE(Mean Abs Error) STD(Standard Deviation)\n");
 	printf("* Note: the cheat positions should be active in server (preferably with >2 decimal places)\n\n");
 	printf("------------------LocalizerV2::run calls analysis:\n");
@@ -1189,6 +1431,10 @@ void LocalizerV2::print_report() const{
 	printf("--- >1 solution:       %i \n", st[FAILguessMany]);
 	printf("--- Weak solution:     %i \n", st[FAILguessTest]);
 	printf("- Eucl. tune fail:     %i \n", st[FAILtune]); //Euclidian distance tune error above 6cm
+	printf("- Warm start:          %i (rejected: %i)\n", st[WARM], st[FAILwarm]);
+	printf("------------------Average time of successful runs:\n");
+	printf("- Full search:         %.1fus (%i runs)\n", time_counter[0] ? time_sum[0]/time_counter[0] : 0, time_counter[0]);
+	printf("- Warm start:          %.1fus (%i runs)\n", time_counter[1] ? time_sum[1]/time_counter[1] : 0, time_counter[1]);
 	printf("----------------------------------------------------------------------------------------\n");
 
 }
@@ -1196,10 +1442,17 @@ void LocalizerV2::print_report() const{
 void LocalizerV2::stats_reset(){
 
 	counter_fineTune = 0;
+	counter_warmStart = 0;
 	for(int i=0; i<sizeof(errorSum_fineTune_before)/sizeof(errorSum_fineTune_before[0]); i++){
 		errorSum_fineTune_before[i] = 0;
 		errorSum_fineTune_euclidianDist[i] = 0;
 		errorSum_fineTune_probabilistic[i] = 0;
+		errorSum_warmStart[i] = 0;
+	}
+
+	for(int i=0; i<2; i++){
+		time_sum[i] = 0;
+		time_counter[i] = 0;
 	}
 
 	for(int i=0; i<STATE::ENUMSIZE; i++){
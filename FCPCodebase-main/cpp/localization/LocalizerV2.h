@@ -144,6 +144,16 @@
  * 4. Identify visible elements and perform 2nd fine tune based on distance probabilites
  *              
  * -----------------------------------------------------------------------------------
+ * WARM START (replaces step 3 when the last pose is recent)
+ *
+ *      If the pose was computed in one of the last visual steps, it is propagated (constant velocity, based on the last
+ *      two poses) and refined with Gauss-Newton, using the landmarks and the closest matching field line of each seen
+ *      line as correspondences. The solution is accepted if the mapping error is <0.10m/point (as in the 1st fine tune)
+ *      and it is <0.3m away from the propagated pose (as for a likely solution in 3.B). The 1st (Euclidian) fine tune is
+ *      then skipped and the probabilistic fine tune starts from the Gauss-Newton solution with smaller steps.
+ *      Otherwise, the full search (3.A or 3.B) is performed.
+ *
+ * -----------------------------------------------------------------------------------
  * Last step. Analyze preliminary transformation matrix to update final matrices
  * 
  * 		For the reasons stated in the beginning (see warning), if the preliminary matrix was not entirely set, the
@@ -192,7 +202,7 @@
  * */
 
 #pragma once
-#include "Singleton.h"
+#include "World.h"
 #include "Field.h"
 #include "Matrix4D.h"
 #include "FieldNoise.h"
@@ -202,9 +212,20 @@
 #include <gsl/gsl_multimin.h> //Multidimensional minimization
 
 class LocalizerV2 {
-    friend class Singleton<LocalizerV2>;
 
 public:
+
+    /**
+     * Constructor
+     * @param world_ world data of the robot
+     * @param fd_ field map of the robot (built from world_)
+     * Both must outlive the localizer
+     */
+    LocalizerV2(World& world_, Field& fd_);
+    ~LocalizerV2();
+
+    LocalizerV2(const LocalizerV2&) = delete;
+    LocalizerV2& operator=(const LocalizerV2&) = delete;
  
     /**
      * Compute 3D position and 3D orientation
@@ -298,8 +319,16 @@ public:
      */
     float get_last_head_z() const {return last_z;}
 
+    /**
+     * Enable/disable the warm start (enabled by default, see workflow description)
+     */
+    void set_warm_start(bool enable){ warm_start_enabled = enable; }
+
 
 private:
+
+    World& world;
+    Field& fd;
     
     //=================================================================================================
     //============================================================================ main private methods
@@ -311,9 +340,21 @@ private:
     void find_z(const Vector3f& Zvec);
     bool find_xy();
     bool guess_xy();
+    bool warm_start_xy();
+    bool gauss_newton_xy(float &angle, float &x, float &y, float &avg_error);
 
-    bool fine_tune_aux(float &initial_angle, float &initial_x, float &initial_y, bool use_probabilities);
-    bool fine_tune(float initial_angle, float initial_x, float initial_y);
+    bool fine_tune_aux(float &initial_angle, float &initial_x, float &initial_y, bool use_probabilities, bool warm_start=false);
+    bool fine_tune(float initial_angle, float initial_x, float initial_y, bool warm_start=false);
+    void set_prelim_xy(float angle, float x, float y);
+
+    /**
+     * Parameters of the error functions: the localizer whose preliminary matrix is optimized
+     * and the fixed angle (only used if the angle is not optimized)
+     */
+    struct sErrorParams {
+        LocalizerV2* loc;
+        float angle;
+    };
 
     static double map_error_logprob(const gsl_vector *v, void *params);
     static double map_error_2d(const gsl_vector *v, void *params);
@@ -340,6 +381,27 @@ private:
 
     float final_z; //independent z translation (may be updated more often)
 
+    //=================================================================================================
+    //======================================================================== warm start & workspaces
+    //=================================================================================================
+
+    bool warm_start_enabled = true;
+    bool has_pose = false;            // true after the first commit
+    float prelim_angle = 0;           // rotation of Xvec around Zvec (set by fine_tune)
+    float final_angle = 0;            // rotation of Xvec around Zvec (committed)
+    Vector3f step_velocity;           // translation per visual step, based on the last two committed poses
+    float step_angular_velocity = 0;  // rotation per visual step, based on the last two committed poses
+    bool used_warm_start = false;     // true if the current pose was obtained by warm start
+
+    //Solver workspaces are allocated once (they are reinitialized by gsl_multimin_fminimizer_set)
+    gsl_multimin_fminimizer *tune_ws;      // fine tune (x,y,angle)
+    gsl_vector *tune_x, *tune_ss;
+    gsl_multimin_fminimizer *guess_ws[4];  // guess_xy (x,y), one per possible orientation
+    gsl_vector *guess_x[4], *guess_ss[4];
+    gsl_matrix *plane_A = nullptr;         // fit_ground_plane (rows grow on demand)
+    gsl_matrix *plane_V;
+    gsl_vector *plane_S, *plane_work;
+
     //=================================================================================================
     //=============================================================================== useful statistics
     //=================================================================================================
@@ -364,16 +426,18 @@ private:
     double errorSum_fineTune_euclidianDist[7] = {0}; //[0,1,2]- xyz err sum, [3]-2D err sum, [4]-2D err sq sum, [5]-3D err sum, [6]-3D err sq sum
     double errorSum_fineTune_probabilistic[7] = {0}; //[0,1,2]- xyz err sum, [3]-2D err sum, [4]-2D err sq sum, [5]-3D err sum, [6]-3D err sq sum
     double errorSum_ball[7] = {0};                   //[0,1,2]- xyz err sum, [3]-2D err sum, [4]-2D err sq sum, [5]-3D err sum, [6]-3D err sq sum
+    double errorSum_warmStart[7] = {0};              //[0,1,2]- xyz err sum, [3]-2D err sum, [4]-2D err sq sum, [5]-3D err sum, [6]-3D err sq sum
     int counter_fineTune = 0;
     int counter_ball = 0;
+    int counter_warmStart = 0;
+
+    double time_sum[2] = {0};  //run time sum in microseconds: [0]-full search, [1]-warm start (successful runs only)
+    int time_counter[2] = {0};
 
-    enum STATE{NONE, RUNNING, MINFAIL, BLIND, FAILzNOgoal, FAILzLine, FAILz, FAILtune, FAILguessLine, FAILguessNone, FAILguessMany, FAILguessTest, DONE, ENUMSIZE};
+    enum STATE{NONE, RUNNING, MINFAIL, BLIND, FAILzNOgoal, FAILzLine, FAILz, FAILtune, FAILguessLine, FAILguessNone, FAILguessMany, FAILguessTest, FAILwarm, WARM, DONE, ENUMSIZE};
     STATE state = NONE;
 
     void stats_change_state(enum STATE s);
     int state_counter[STATE::ENUMSIZE] = {0};
 
-};
-
-
-typedef Singleton<LocalizerV2> SLocalizerV2;
\ No newline at end of file
+};
\ No newline at end of file
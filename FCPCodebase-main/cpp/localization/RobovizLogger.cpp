@@ -51,16 +51,121 @@ int RobovizLogger::init() {
 }
 
 void RobovizLogger::destroy() {
+    if (is_initialized) flush();
     freeaddrinfo(servinfo);
     servinfo=NULL;
     close(sockfd);
 }
 
+void RobovizLogger::queueCommand(unsigned char* buf, int bufSize, const string* setName) {
+    PendingSet& set = pendingSets[(setName != NULL) ? *setName : string()];
+    set.commands.append((const char*) buf, bufSize);
+    set.sizes.push_back(bufSize);
+}
+
+void RobovizLogger::appendCommand(const char* buf, int bufSize) {
+    // RoboViz parses any number of commands from one datagram; a
+    // command larger than a datagram is sent alone
+    if (numDatagrams == 0 ||
+            datagrams[numDatagrams - 1].size() + bufSize > ROBOVIZ_MAX_DATAGRAM) {
+        if (numDatagrams == datagrams.size())
+            datagrams.push_back(string());
+        datagrams[numDatagrams++].clear();
+    }
+
+    datagrams[numDatagrams - 1].append(buf, bufSize);
+}
+
+bool RobovizLogger::acceptSwap(const string& setName) {
+    auto rate = maxSwapRates.find(setName);
+    float maxRate = (rate != maxSwapRates.end()) ? rate->second : defaultMaxSwapRate;
+    if (maxRate <= 0) return true;
+
+    auto now = std::chrono::steady_clock::now();
+    auto last = lastSwapTimes.find(setName);
+
+    // allow 10% jitter, so that a set swapped every cycle at the
+    // limit is not throttled by timer noise
+    if (last != lastSwapTimes.end() &&
+            std::chrono::duration<float>(now - last->second).count() < 0.9f / maxRate)
+        return false;
+
+    lastSwapTimes[setName] = now;
+    return true;
+}
+
+void RobovizLogger::flush() {
+    if (numDatagrams == 0) return;
+
+#ifdef __linux__
+    std::vector<struct mmsghdr> msgs(numDatagrams);
+    std::vector<struct iovec> iovs(numDatagrams);
+    memset(&msgs[0], 0, numDatagrams * sizeof(struct mmsghdr));
+
+    for (size_t i = 0; i < numDatagrams; i++) {
+        iovs[i].iov_base = (void*) datagrams[i].data();
+        iovs[i].iov_len = datagrams[i].size();
+        msgs[i].msg_hdr.msg_name = p->ai_addr;
+        msgs[i].msg_hdr.msg_namelen = p->ai_addrlen;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    size_t sent = 0;
+    while (sent < numDatagrams) {
+        int n = sendmmsg(sockfd, &msgs[sent], numDatagrams - sent, 0);
+        if (n <= 0) break;
+        sent += n;
+    }
+#else
+    for (size_t i = 0; i < numDatagrams; i++)
+        sendto(sockfd, datagrams[i].data(), datagrams[i].size(), 0, p->ai_addr, p->ai_addrlen);
+#endif
+
+    numDatagrams = 0;
+}
+
+void RobovizLogger::beginFrame() {
+    ++frameDepth;
+}
+
+void RobovizLogger::endFrame() {
+    if (frameDepth > 0 && --frameDepth == 0) flush();
+}
+
+void RobovizLogger::setMaxSwapRate(float swapsPerSecond, const string* setName) {
+    if (setName == NULL)
+        defaultMaxSwapRate = swapsPerSecond;
+    else
+        maxSwapRates[*setName] = swapsPerSecond;
+}
+
 void RobovizLogger::swapBuffers(const string* setName) {
-    int bufSize = -1;
-    unsigned char* buf = newBufferSwap(setName, &bufSize);
-    sendto(sockfd, buf, bufSize, 0, p->ai_addr, p->ai_addrlen);
-    delete[] buf;
+    string name = (setName != NULL) ? *setName : string();
+    bool accept = acceptSwap(name);
+
+    // RoboViz swaps every set whose name starts with setName
+    auto it = pendingSets.lower_bound(name);
+    while (it != pendingSets.end() && it->first.compare(0, name.length(), name) == 0) {
+        if (accept) {
+            const PendingSet& set = it->second;
+            size_t offset = 0;
+            for (int size : set.sizes) {
+                appendCommand(set.commands.data() + offset, size);
+                offset += size;
+            }
+        }
+        it = pendingSets.erase(it);
+    }
+
+    if (accept) {
+        int bufSize = -1;
+        unsigned char* buf = newBufferSwap(setName, &bufSize);
+        appendCommand((const char*) buf, bufSize);
+        delete[] buf;
+    }
+
+    if (frameDepth == 0) flush();
 }
 
 void RobovizLogger::drawLine(float x1, float y1, float z1, float x2, float y2, float z2,
@@ -71,7 +176,7 @@ void RobovizLogger::drawLine(float x1, float y1, float z1, float x2, float y2, f
 
     int bufSize = -1;
     unsigned char* buf = newLine(pa, pb, thickness, color, setName, &bufSize);
-    sendto(sockfd, buf, bufSize, 0, p->ai_addr, p->ai_addrlen);
+    queueCommand(buf, bufSize, setName);
     delete[] buf;
 }
 
@@ -82,7 +187,7 @@ void RobovizLogger::drawCircle(float x, float y, float radius, float thickness,
 
     int bufSize = -1;
     unsigned char* buf = newCircle(center, radius, thickness, color, setName, &bufSize);
-    sendto(sockfd, buf, bufSize, 0, p->ai_addr, p->ai_addrlen);
+    queueCommand(buf, bufSize, setName);
     delete[] buf;
 }
 
@@ -93,7 +198,7 @@ void RobovizLogger::drawSphere(float x, float y, float z, float radius,
 
     int bufSize = -1;
     unsigned char* buf = newSphere(center, radius, color, setName, &bufSize);
-    sendto(sockfd, buf, bufSize, 0, p->ai_addr, p->ai_addrlen);
+    queueCommand(buf, bufSize, setName);
     delete[] buf;
 }
 
@@ -104,7 +209,7 @@ void RobovizLogger::drawPoint(float x, float y, float z, float size,
 
     int bufSize = -1;
     unsigned char* buf = newPoint(center, size, color, setName, &bufSize);
-    sendto(sockfd, buf, bufSize, 0, p->ai_addr, p->ai_addrlen);
+    queueCommand(buf, bufSize, setName);
     delete[] buf;
 }
 
@@ -114,7 +219,7 @@ void RobovizLogger::drawPolygon(const float* v, int numVerts, float r, float g,
 
     int bufSize = -1;
     unsigned char* buf = newPolygon(v, numVerts, color, setName, &bufSize);
-    sendto(sockfd, buf, bufSize, 0, p->ai_addr, p->ai_addrlen);
+    queueCommand(buf, bufSize, setName);
     delete[] buf;
 }
 
@@ -125,7 +230,7 @@ void RobovizLogger::drawAnnotation(const string* text, float x, float y, float z
 
     int bufSize = -1;
     unsigned char* buf = newAnnotation(text, pos, color, setName, &bufSize);
-    sendto(sockfd, buf, bufSize, 0, p->ai_addr, p->ai_addrlen);
+    queueCommand(buf, bufSize, setName);
     delete[] buf;
 }
 
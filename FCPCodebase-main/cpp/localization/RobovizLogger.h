@@ -20,6 +20,13 @@
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <math.h>
+#include <map>
+#include <vector>
+#include <chrono>
+
+// the largest datagram sent to RoboViz. RoboViz reads draw commands
+// into a 512 byte buffer and drops the rest of longer datagrams
+#define ROBOVIZ_MAX_DATAGRAM 512
 
 class RobovizLogger {
 private:
@@ -34,8 +41,24 @@ public:
 
     int init();
     void destroy();
+
+    /*
+     * Shapes are kept per drawing set until the set is swapped, and
+     * swapBuffers sends them packed into as few datagrams as possible.
+     * The sets swapped between beginFrame() and endFrame() are sent at
+     * once.
+     */
+    void beginFrame();
+    void endFrame();
     void swapBuffers(const std::string* setName);
 
+    /*
+     * Limits how often per second the drawing set setName (or every
+     * set, if setName is NULL) is swapped. The shapes of swaps that
+     * come faster are dropped. 0 (the default) means no limit.
+     */
+    void setMaxSwapRate(float swapsPerSecond, const std::string* setName = NULL);
+
     void drawLine(float x1, float y1, float z1, float x2, float y2, float z2,
             float thickness, float r, float g, float b, const std::string* setName);
     void drawCircle(float x, float y, float radius, float thickness,
@@ -50,9 +73,31 @@ public:
             float g, float b, const std::string* setName);
 
 private:
+    void queueCommand(unsigned char* buf, int bufSize, const std::string* setName);
+    void appendCommand(const char* buf, int bufSize);
+    bool acceptSwap(const std::string& setName);
+    void flush();
+
     int sockfd;
     struct addrinfo* p;
     struct addrinfo* servinfo;
+
+    // the shape commands of a drawing set since its last swapBuffers
+    struct PendingSet {
+        std::string commands;
+        std::vector<int> sizes;
+    };
+    std::map<std::string, PendingSet> pendingSets;
+
+    // the commands to send, packed into datagrams
+    std::vector<std::string> datagrams;
+    size_t numDatagrams = 0;
+    int frameDepth = 0;
+
+    // swap rate limits, see setMaxSwapRate
+    float defaultMaxSwapRate = 0;
+    std::map<std::string, float> maxSwapRates;
+    std::map<std::string, std::chrono::steady_clock::time_point> lastSwapTimes;
 };
 
 #endif // _ROBOVIZLOGGER_H_
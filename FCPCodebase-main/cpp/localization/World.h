@@ -7,7 +7,6 @@
 
 #pragma once
 #include "Vector3f.h"
-#include "Singleton.h"
 #include "Matrix4D.h"
 #include "Line6f.h"
 #include <vector>
@@ -17,14 +16,11 @@ using namespace std;
 
 
 class World {
-    friend class Singleton<World>;
 
-private:
+public:
 
     World(){};
 
-public:
-
     //Feet variables: (0) left,  (1) right
     bool foot_touch[2]; // is foot touching ground
     Vector3f foot_contact_rel_pos[2]; // foot_transform * translation(foot_contact_pt)
@@ -51,6 +47,4 @@ public:
     vector<sLine> lines_polar;
     
 
-};
-
-typedef Singleton<World> SWorld;
\ No newline at end of file
+};
\ No newline at end of file
@@ -1,20 +1,20 @@
 #include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
 #include "Geometry.h"
 #include "Vector3f.h"
 #include "Matrix4D.h"
 #include "FieldNoise.h"
 #include "Line6f.h"
-#include "World.h"
-#include "Field.h"
-#include "LocalizerV2.h"
+#include "LocalizationContext.h"
 
 using namespace std;
 
-static LocalizerV2& loc = SLocalizerV2::getInstance();
+static LocalizationContext ctx;
+static LocalizerV2& loc = ctx.loc;
 
-void print_python_data(){
-
-    static World &world = SWorld::getInstance();
+void print_python_data(const World& world){
 
     cout << "Foot touch: " << world.foot_touch[0] << " " << world.foot_touch[1] << endl;
     cout << "LFoot contact rpos: " << world.foot_contact_rel_pos[0].x << " " << world.foot_contact_rel_pos[0].y << " " << world.foot_contact_rel_pos[0].z << endl;
@@ -47,7 +47,8 @@ void print_python_data(){
     }
 }
 
-float *compute(bool lfoot_touch, bool rfoot_touch, 
+float *compute(World& world,
+            bool lfoot_touch, bool rfoot_touch, 
             double feet_contact[],
             bool ball_seen, double ball_pos[],
             double me_pos[],
@@ -57,7 +58,6 @@ float *compute(bool lfoot_touch, bool rfoot_touch,
 
     // ================================================= 1. Parse data
     
-    static World &world = SWorld::getInstance();
     world.foot_touch[0] = lfoot_touch;
     world.foot_touch[1] = rfoot_touch;
 
@@ -107,7 +107,7 @@ float *compute(bool lfoot_touch, bool rfoot_touch,
         lines += 6;
     }
 
-    print_python_data();
+    print_python_data(world);
     
     // ================================================= 2. Compute 6D pose
 
@@ -140,8 +140,7 @@ void print_report(){
 }
 
 void draw_visible_elements(bool is_right_side){
-    Field& fd = SField::getInstance();
-    fd.draw_visible(loc.headTofieldTransform, is_right_side);
+    ctx.field.draw_visible(loc.headTofieldTransform, is_right_side);
 }
 
 int main(){
@@ -181,7 +180,8 @@ int main(){
 
     int lines_no = sizeof(lines)/sizeof(lines[0])/6;
 
-    compute(true, // lfoot_touch
+    compute(ctx.world,
+            true, // lfoot_touch
             true, // rfoot_touch
             feet_contact,
             true, // ball_seen
@@ -191,6 +191,45 @@ int main(){
             lines,
             lines_no);
 
+    // ================================================= Benchmark: same frame, full search vs warm start
+
+    const int repetitions = 1000;
+
+    for(int warm=0; warm<2; warm++){
+        loc.set_warm_start(warm);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for(int i=0; i<repetitions; i++) loc.run();
+        auto t2 = std::chrono::high_resolution_clock::now();
+        cout << (warm ? "Warm start:  " : "Full search: ") <<
+            std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() / (double)repetitions << "us per run\n";
+    }
+
+    // ================================================= Independent contexts localizing in parallel must match the shared one
+
+    const int contexts_no = 4;
+    vector<LocalizationContext*> contexts;
+    for(int i=0; i<contexts_no; i++){
+        contexts.push_back(new LocalizationContext());
+        contexts[i]->world = ctx.world;
+    }
+
+    vector<thread> threads;
+    for(int i=0; i<contexts_no; i++){
+        threads.emplace_back([&contexts, i](){ for(int j=0; j<repetitions; j++) contexts[i]->loc.run(); });
+    }
+    for(auto& t : threads) t.join();
+
+    for(int i=0; i<contexts_no; i++){
+        float max_diff = 0;
+        for(int j=0; j<16; j++){
+            max_diff = max(max_diff, fabsf(contexts[i]->loc.headTofieldTransform.content[j] - loc.headTofieldTransform.content[j]));
+        }
+        cout << "Context " << i << ": max difference to the shared context " << max_diff << "\n";
+        delete contexts[i];
+    }
+
+    loc.print_report();
+
 }
 
 
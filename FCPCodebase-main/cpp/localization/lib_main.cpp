@@ -1,23 +1,26 @@
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
 #include "Geometry.h"
 #include "Vector3f.h"
 #include "Matrix4D.h"
 #include "FieldNoise.h"
 #include "Line6f.h"
-#include "World.h"
-#include "Field.h"
-#include "LocalizerV2.h"
+#include "LocalizationContext.h"
 #include <pybind11/pybind11.h>
 #include <pybind11/numpy.h>
+#include <pybind11/stl.h>
 
 namespace py = pybind11;
 using namespace std;
 
-static LocalizerV2& loc = SLocalizerV2::getInstance();
 
-void print_python_data(){
+void print_python_data(const LocalizationContext& ctx){
 
-    static World &world = SWorld::getInstance();
+    const World &world = ctx.world;
 
     cout << "Foot touch: " << world.foot_touch[0] << " " << world.foot_touch[1] << endl;
     cout << "LFoot contact rpos: " << world.foot_contact_rel_pos[0].x << " " << world.foot_contact_rel_pos[0].y << " " << world.foot_contact_rel_pos[0].z << endl;
@@ -26,7 +29,7 @@ void print_python_data(){
     cout << "Ball rpos cart: " << world.ball_rel_pos_cart.x << " " << world.ball_rel_pos_cart.y << " " << world.ball_rel_pos_cart.z << endl;
     cout << "Ball cheat: " << world.ball_cheat_abs_cart_pos.x << " " << world.ball_cheat_abs_cart_pos.y << " " << world.ball_cheat_abs_cart_pos.z << endl;
     cout << "Me cheat: " << world.my_cheat_abs_cart_pos.x << " " << world.my_cheat_abs_cart_pos.y << " " << world.my_cheat_abs_cart_pos.z << endl;
-    
+
     for(int i=0; i<8; i++){
         cout << "Landmark " << i << ": " <<
         world.landmark[i].seen << " " <<
@@ -41,26 +44,26 @@ void print_python_data(){
 
     for(int i=0; i<world.lines_polar.size(); i++){
         cout << "Line " << i << ": " <<
-        world.lines_polar[i].start.x << " " << 
-        world.lines_polar[i].start.y << " " << 
-        world.lines_polar[i].start.z << " " << 
-        world.lines_polar[i].end.x << " " << 
-        world.lines_polar[i].end.y << " " << 
+        world.lines_polar[i].start.x << " " <<
+        world.lines_polar[i].start.y << " " <<
+        world.lines_polar[i].start.z << " " <<
+        world.lines_polar[i].end.x << " " <<
+        world.lines_polar[i].end.y << " " <<
         world.lines_polar[i].end.z << endl;
     }
 }
 
-py::array_t<float> compute(
-            bool lfoot_touch, bool rfoot_touch, 
+/**
+ * @brief Copy the data received from Python into the world of a context (requires the GIL)
+ */
+void set_world_data(World& world,
+            bool lfoot_touch, bool rfoot_touch,
             py::array_t<double> feet_contact,
             bool ball_seen, py::array_t<double> ball_pos,
             py::array_t<double> me_pos,
             py::array_t<double> landmarks,
             py::array_t<double> lines){
 
-    // ================================================= 1. Parse data
-    
-    static World &world = SWorld::getInstance();
     world.foot_touch[0] = lfoot_touch;
     world.foot_touch[1] = rfoot_touch;
 
@@ -87,7 +90,7 @@ py::array_t<float> compute(
     world.ball_cheat_abs_cart_pos.x = ball_pos_ptr[3];
     world.ball_cheat_abs_cart_pos.y = ball_pos_ptr[4];
     world.ball_cheat_abs_cart_pos.z = ball_pos_ptr[5];
-    
+
     py::buffer_info me_pos_buf = me_pos.request();
     double *me_pos_ptr = (double *) me_pos_buf.ptr;
     world.my_cheat_abs_cart_pos.x = me_pos_ptr[0];
@@ -117,16 +120,16 @@ py::array_t<float> compute(
     for(int i=0; i<lines_len; i++){
         Vector3f s(lines_ptr[0],lines_ptr[1],lines_ptr[2]);
         Vector3f e(lines_ptr[3],lines_ptr[4],lines_ptr[5]);
-        world.lines_polar.emplace_back(s, e); 
+        world.lines_polar.emplace_back(s, e);
         lines_ptr += 6;
     }
-    
-    // ================================================= 2. Compute 6D pose
+}
+
+/**
+ * @brief Pack the result of the last run (requires the GIL)
+ */
+py::array_t<float> get_result(const LocalizerV2& loc){
 
-    loc.run(); 
-    
-    // ================================================= 3. Prepare data to return
-    
     py::array_t<float> retval = py::array_t<float>(35); //allocate
     py::buffer_info buff = retval.request();
     float *ptr = (float *) buff.ptr;
@@ -144,17 +147,99 @@ py::array_t<float> compute(
     ptr[1] = loc.head_z;
     ptr[2] = (float) loc.is_head_z_uptodate;
 
-
     return retval;
 }
 
-void print_report(){
-    loc.print_report();
+py::array_t<float> compute(LocalizationContext& ctx,
+            bool lfoot_touch, bool rfoot_touch,
+            py::array_t<double> feet_contact,
+            bool ball_seen, py::array_t<double> ball_pos,
+            py::array_t<double> me_pos,
+            py::array_t<double> landmarks,
+            py::array_t<double> lines){
+
+    // ================================================= 1. Parse data
+
+    set_world_data(ctx.world, lfoot_touch, rfoot_touch, feet_contact, ball_seen, ball_pos, me_pos, landmarks, lines);
+
+    // ================================================= 2. Compute 6D pose (other Python threads may run meanwhile)
+
+    {
+        py::gil_scoped_release release;
+        ctx.loc.run();
+    }
+
+    // ================================================= 3. Prepare data to return
+
+    return get_result(ctx.loc);
+}
+
+/**
+ * @brief Localize several robots in parallel
+ * @param contexts one context per robot (each context may appear only once)
+ * @param inputs one tuple of compute() arguments per context
+ * @param threads maximum number of threads (0: one per hardware thread)
+ * @return list with the compute() result of each context
+ */
+py::list compute_batch(const vector<LocalizationContext*>& contexts, py::sequence inputs, unsigned int threads){
+
+    const size_t n = contexts.size();
+
+    if (inputs.size() != n){
+        throw py::value_error("compute_batch: the number of inputs must match the number of localizers");
+    }
+    if (set<LocalizationContext*>(contexts.begin(), contexts.end()).size() != n){
+        throw py::value_error("compute_batch: each localizer may appear only once");
+    }
+
+    // ================================================= 1. Parse data
+
+    for(size_t i=0; i<n; i++){
+        py::tuple a = inputs[i].cast<py::tuple>();
+        if (a.size() != 8){
+            throw py::value_error("compute_batch: each input must have the 8 arguments of compute()");
+        }
+        set_world_data(contexts[i]->world, a[0].cast<bool>(), a[1].cast<bool>(), a[2].cast<py::array_t<double>>(),
+                       a[3].cast<bool>(), a[4].cast<py::array_t<double>>(), a[5].cast<py::array_t<double>>(),
+                       a[6].cast<py::array_t<double>>(), a[7].cast<py::array_t<double>>());
+    }
+
+    // ================================================= 2. Compute 6D poses in parallel, without the GIL
+
+    {
+        py::gil_scoped_release release;
+
+        if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+        threads = (unsigned int) min<size_t>(threads, n);
+
+        atomic<size_t> next(0);
+        auto worker = [&](){
+            for(size_t i = next++; i < n; i = next++){
+                contexts[i]->loc.run();
+            }
+        };
+
+        vector<thread> pool;
+        for(unsigned int t=1; t<threads; t++){
+            pool.emplace_back(worker);
+        }
+        worker(); // the calling thread works too
+        for(auto& t : pool){
+            t.join();
+        }
+    }
+
+    // ================================================= 3. Prepare data to return
+
+    py::list retval;
+    for(size_t i=0; i<n; i++){
+        retval.append(get_result(contexts[i]->loc));
+    }
+    return retval;
 }
 
-void draw_visible_elements(bool is_right_side){
-    Field& fd = SField::getInstance();
-    fd.draw_visible(loc.headTofieldTransform, is_right_side);
+void draw_visible_elements(const LocalizationContext& ctx, bool is_right_side){
+    ctx.field.draw_visible(ctx.loc.headTofieldTransform, is_right_side);
 }
 
 
@@ -163,20 +248,28 @@ using namespace pybind11::literals; //to add informative argument names as -> "a
 PYBIND11_MODULE(localization, m) { //the python module name, m is the interface to create bindings
     m.doc() = "Probabilistic 6D localization algorithm"; // optional module docstring
 
-    //optional arguments names
-    m.def("compute", &compute, "Compute the 6D pose based on visual information and return transformation matrices and other relevant data",
-        "lfoot_touch"_a,
-        "rfoot_touch"_a,
-        "feet_contact"_a,
-        "ball_seen"_a,
-        "ball_pos"_a,
-        "me_pos"_a,
-        "landmarks"_a,
-        "lines"_a);
-
-    m.def("print_python_data", &print_python_data, "Print data received from Python");
-    m.def("print_report", &print_report, "Print localization report");
-    m.def("draw_visible_elements", &draw_visible_elements, "Draw all visible elements in RoboViz", "is_right_side"_a);
-    
-}
+    py::class_<LocalizationContext>(m, "Localizer")
+        .def(py::init<>(), "Localization state of one robot (independent localizers may be used from different threads)")
+
+        //optional arguments names
+        .def("compute", &compute, "Compute the 6D pose based on visual information and return transformation matrices and other relevant data",
+            "lfoot_touch"_a,
+            "rfoot_touch"_a,
+            "feet_contact"_a,
+            "ball_seen"_a,
+            "ball_pos"_a,
+            "me_pos"_a,
+            "landmarks"_a,
+            "lines"_a)
 
+        .def("print_python_data", &print_python_data, "Print data received from Python")
+        .def("print_report", [](const LocalizationContext& ctx){ ctx.loc.print_report(); }, "Print localization report")
+        .def("draw_visible_elements", &draw_visible_elements, "Draw all visible elements in RoboViz", "is_right_side"_a)
+        .def("set_warm_start", [](LocalizationContext& ctx, bool enable){ ctx.loc.set_warm_start(enable); },
+            "Enable/disable warm start from the last pose (enabled by default)", "enable"_a);
+
+    m.def("compute_batch", &compute_batch, "Localize several robots in parallel, returns the compute() result of each localizer",
+        "localizers"_a,
+        "inputs"_a,
+        "threads"_a = 0);
+}
@@ -20,6 +20,7 @@
 #include <string>
 #include <cstdio>
 #include <cstring>
+#include <cmath>
 
 using namespace std;
 
@@ -28,10 +29,43 @@ inline int writeCharToBuf(unsigned char* buf, unsigned char value) {
     return 1;
 }
 
+// writes value as 6 ASCII characters with as many decimals as fit,
+// i.e. the first 6 characters of "%6f" with the last digit rounded
 inline int writeFloatToBuf(unsigned char* buf, float value) {
-    char temp[20];
-    sprintf(temp, "%6f", value);
-    memcpy(buf, temp, 6);
+    double a = fabs(value);
+
+    // large values and NaN take the slow path
+    if (!(a < 9999.5)) {
+        char temp[20];
+        snprintf(temp, sizeof(temp), "%6f", value);
+        memcpy(buf, temp, 6);
+        return 6;
+    }
+
+    static const double scale[] = {1, 10, 100, 1000, 10000};
+    static const unsigned limit[] = {1, 10, 100, 1000, 10000, 100000};
+
+    int sign = (value < 0) ? 1 : 0;
+    int intDigits = (a < 10) ? 1 : (a < 100) ? 2 : (a < 1000) ? 3 : 4;
+    int decimals = 6 - sign - intDigits - 1;
+
+    unsigned n = (unsigned) (a * scale[decimals] + 0.5);
+    if (n >= limit[intDigits + decimals]) {
+        // rounding carried into another integer digit, e.g. 9.99996
+        ++intDigits;
+        --decimals;
+        n /= 10;
+    }
+
+    int i = 5;
+    for (int d = 0; d < decimals; ++d, n /= 10)
+        buf[i--] = '0' + n % 10;
+    buf[i--] = '.';
+    for (int d = 0; d < intDigits; ++d, n /= 10)
+        buf[i--] = '0' + n % 10;
+    if (sign)
+        buf[0] = '-';
+
     return 6;
 }
 
@@ -0,0 +1,118 @@
+#include "socket_reader.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using std::cout;
+using std::chrono::high_resolution_clock;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+
+std::chrono::_V2::system_clock::time_point t1,t2;
+
+/**
+ * Send length-prefixed messages through one end of a socket pair, to emulate the server.
+ * Messages are sent in bursts, so that the reader sees several queued frames and split frames.
+ */
+void server(int fd, int msgs, int burst, const std::string& body){
+    std::string frame(4, 0);
+    frame[0] = (char)(body.size() >> 24); frame[1] = (char)(body.size() >> 16);
+    frame[2] = (char)(body.size() >> 8);  frame[3] = (char)body.size();
+    frame += body;
+
+    std::string out;
+    for(int i=0; i<msgs; i+=burst){
+        out.clear();
+        for(int j=i; j<i+burst && j<msgs; j++) out += frame;
+        for(size_t sent=0; sent<out.size(); ){
+            ssize_t n = send(fd, out.data()+sent, out.size()-sent, 0);
+            if(n <= 0) return;
+            sent += n;
+        }
+    }
+    close(fd);
+}
+
+/**
+ * A corrupt size header (>= 2^31) must close the reader after the valid frames before it
+ */
+bool corrupt_stream_is_rejected(){
+    int sv[2];
+    socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+
+    const char data[] = {0,0,0,2,'o','k', (char)0x80,0,0,0, 'x','x','x','x'};
+    send(sv[1], data, sizeof(data), 0);
+
+    Socket_Reader reader(sv[0]);
+    int first = reader.receive(false);
+    bool ok = first == 1 && reader.frame_size(0) == 2 && reader.frame_data(0)[0] == 'o';
+    ok = ok && reader.receive(false) == -1;
+
+    close(sv[0]);
+    close(sv[1]);
+    return ok;
+}
+
+/**
+ * Bytes that receive() already took from the socket must count as pending, though the socket itself is empty
+ */
+bool buffered_bytes_are_pending(){
+    int sv[2];
+    socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+
+    const char data[] = {0,0,0,2,'o','k', 0,0,0,2,'o'};
+    send(sv[1], data, sizeof(data), 0);
+
+    Socket_Reader reader(sv[0]);
+    bool ok = reader.receive(false) == 1 && reader.pending();
+
+    const char rest[] = {'k'};
+    send(sv[1], rest, sizeof(rest), 0);
+    ok = ok && reader.receive(false) == 1 && !reader.pending();
+
+    close(sv[0]);
+    close(sv[1]);
+    return ok;
+}
+
+int main(){
+
+    cout << "Corrupt stream rejected: " << (corrupt_stream_is_rejected() ? "yes" : "NO") << "\n";
+    cout << "Buffered bytes pending: " << (buffered_bytes_are_pending() ? "yes" : "NO") << "\n\n";
+
+    const int msgs = 200000;
+    std::string body(1300, 'x'); // typical sense message size
+
+    for(int burst : {1, 3}){
+        int sv[2];
+        socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+
+        Socket_Reader reader(sv[0]);
+        std::thread t(server, sv[1], msgs, burst, body);
+
+        int frames = 0, calls = 0, bad = 0;
+
+        t1 = high_resolution_clock::now();
+        while(true){
+            int n = reader.receive(true);
+            if(n < 0) break;
+            calls++;
+            for(int i=0; i<n; i++){
+                if(reader.frame_size(i) != (int)body.size() || reader.frame_data(i)[0] != 'x') bad++;
+            }
+            frames += n;
+        }
+        t2 = high_resolution_clock::now();
+        t.join();
+        close(sv[0]);
+
+        double us = duration_cast<microseconds>(t2 - t1).count();
+        cout << "Burst " << burst << ": " << frames << " frames (" << bad << " bad), " << calls << " receive calls, "
+             << reader.recv_calls() << " recv calls\n";
+        cout << us / frames << "us per frame\n\n";
+    }
+}
@@ -0,0 +1,38 @@
+#include "socket_reader.h"
+#include <pybind11/pybind11.h>
+
+namespace py = pybind11;
+using namespace std;
+
+
+/**
+ * @brief Receive all complete frames, the GIL is released while waiting, so that other Python threads can run
+ * @return number of frames, or -1 if the socket was closed
+ */
+int receive(Socket_Reader& r, bool block){
+    py::gil_scoped_release release;
+    return r.receive(block);
+}
+
+/**
+ * @brief Zero-copy view of frame i (read-only), valid until the next receive()
+ */
+py::memoryview frame(const Socket_Reader& r, int i){
+    if(i < 0 || i >= r.frame_count()) throw py::index_error("frame index out of range");
+    return py::memoryview::from_memory(r.frame_data(i), r.frame_size(i));
+}
+
+
+using namespace pybind11::literals; // to add informative argument names as -> "argname"_a
+
+PYBIND11_MODULE(socket_reader, m) {  // the python module name, m is the interface to create bindings
+    m.doc() = "Reader for the server's length-prefixed frames"; // optional module docstring
+
+    py::class_<Socket_Reader>(m, "Reader")
+        .def(py::init<int>(), "Socket file descriptor (the socket is still owned by Python)", "fd"_a)
+        .def("receive", &receive, "Receive all complete frames, if block is True wait for at least one", "block"_a = true)
+        .def("frame", &frame, "Zero-copy view of frame i, valid until the next receive()", "i"_a)
+        .def("pending", &Socket_Reader::pending, "True if the socket has unread data")
+        .def_property_readonly("frame_count", &Socket_Reader::frame_count)
+        .def_property_readonly("recv_calls", &Socket_Reader::recv_calls);
+}
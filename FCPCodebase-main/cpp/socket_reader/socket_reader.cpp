@@ -0,0 +1,95 @@
+#include "socket_reader.h"
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+
+
+Socket_Reader::Socket_Reader(int fd, int initial_capacity) : fd(fd), buf(initial_capacity) {
+    frames.reserve(16);
+}
+
+
+/**
+ * @brief Read everything the kernel has queued for this socket, without blocking
+ *        A short read means the queue was emptied, so usually a single recv call is needed
+ * @return false if the socket was closed or failed
+ */
+bool Socket_Reader::drain(){
+    while(true){
+        if(filled == (int)buf.size()) buf.resize(buf.size() * 2); // a frame larger than the buffer, or many frames queued
+
+        int space = (int)buf.size() - filled;
+        ssize_t n = recv(fd, buf.data() + filled, space, MSG_DONTWAIT);
+        recv_call_count++;
+
+        if(n > 0){
+            filled += (int)n;
+            if(n < space) return true;
+        }else if(n == 0){
+            return false; // closed by peer
+        }else if(errno == EAGAIN || errno == EWOULDBLOCK){
+            return true;
+        }else if(errno != EINTR){
+            return false;
+        }
+    }
+}
+
+
+/**
+ * @brief Split the received bytes into complete frames, a partial frame stays in the buffer
+ *        A size above MAX_FRAME_SIZE means the stream is corrupt: the reader is closed after the frames before it
+ */
+void Socket_Reader::split_frames(){
+    frames.clear();
+    int pos = 0;
+    while(filled - pos >= 4){
+        const unsigned char* h = (const unsigned char*)buf.data() + pos;
+        unsigned size = ((unsigned)h[0] << 24) | ((unsigned)h[1] << 16) | ((unsigned)h[2] << 8) | (unsigned)h[3];
+        if(size > MAX_FRAME_SIZE){ closed = true; break; }
+        if((unsigned)(filled - pos - 4) < size) break;
+        frames.push_back({pos + 4, (int)size});
+        pos += 4 + (int)size;
+    }
+    consumed = pos;
+}
+
+
+int Socket_Reader::receive(bool block){
+
+    // ================================================= 1. Discard the frames returned by the previous call
+
+    if(consumed > 0){
+        memmove(buf.data(), buf.data() + consumed, filled - consumed);
+        filled -= consumed;
+        consumed = 0;
+    }
+    frames.clear();
+
+    // ================================================= 2. Drain the socket until there is at least one complete frame
+
+    while(true){
+        if(closed) return -1;
+        if(!drain()) closed = true;
+
+        split_frames();
+        if(!frames.empty()) return (int)frames.size(); // if the socket was closed, these are returned first
+        if(closed) return -1;
+        if(!block) return 0;
+
+        pollfd p = {fd, POLLIN, 0};
+        while(poll(&p, 1, -1) < 0){
+            if(errno != EINTR){ closed = true; break; }
+        }
+    }
+}
+
+
+bool Socket_Reader::pending() const {
+    // bytes after the returned frames were already taken from the kernel, the old select() on the socket saw them
+    if(filled > consumed) return true;
+
+    pollfd p = {fd, POLLIN, 0};
+    return poll(&p, 1, 0) > 0;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+
+/**
+ * Reader for the server's length-prefixed TCP frames (4-byte big-endian size + message).
+ *
+ * The socket is created and connected in Python, which keeps using it to send commands and to close it.
+ * The reader only receives: each receive() drains every byte the kernel has queued with non-blocking recv
+ * calls (usually a single one) into an internal buffer, and splits it into complete frames.
+ * Frames are returned as pointers into that buffer, so they are only valid until the next receive().
+ */
+class Socket_Reader {
+public:
+
+    /**
+     * Largest accepted frame, a larger size header can only come from a corrupt stream
+     */
+    static const unsigned MAX_FRAME_SIZE = 64 * 1024 * 1024;
+
+    Socket_Reader(int fd, int initial_capacity = 65536);
+
+    /**
+     * @brief Receive all complete frames that are available
+     * @param block if true, wait (poll) until at least one complete frame is available
+     * @return number of complete frames (0 if block==false and there are none), or -1 if the socket was closed or failed
+     *         or a frame larger than MAX_FRAME_SIZE was announced
+     */
+    int receive(bool block);
+
+    /**
+     * @brief True if there is unread data (non-blocking check, like select with zero timeout)
+     *        Bytes already buffered after the frames of the last receive() count as unread, the socket is only
+     *        polled if there are none
+     */
+    bool pending() const;
+
+    int frame_count() const { return (int)frames.size(); }
+    const char* frame_data(int i) const { return buf.data() + frames[i].offset; }
+    int frame_size(int i) const { return frames[i].size; }
+
+    /**
+     * @brief Number of recv system calls since the reader was created (for profiling)
+     */
+    long recv_calls() const { return recv_call_count; }
+
+private:
+
+    struct Frame { int offset; int size; };
+
+    int fd;
+    std::vector<char> buf;
+    int filled = 0;         // bytes received into buf
+    int consumed = 0;       // bytes of buf that belong to frames returned by the last receive()
+    bool closed = false;
+    long recv_call_count = 0;
+    std::vector<Frame> frames;
+
+    bool drain();
+    void split_frames();
+};
@@ -0,0 +1,80 @@
+#include "world_parser.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+using std::cout;
+using std::chrono::high_resolution_clock;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+
+std::chrono::_V2::system_clock::time_point t1,t2;
+
+int main(int argc, char* argv[]){
+
+    // ================================================= 1. Load message samples (one message per line)
+
+    const char* samples_path = argc > 1 ? argv[1] : "sense_samples.txt";
+    std::ifstream f(samples_path);
+    std::vector<std::string> samples;
+    std::string line;
+    while(std::getline(f, line)){
+        if(!line.empty()) samples.push_back(line);
+    }
+    if(samples.empty()){
+        cout << "No samples found in " << samples_path << "\n";
+        return 1;
+    }
+
+    World_Parser parser("FCPortugal");
+
+    // ================================================= 2. Parse first sample and print it
+
+    parser.parse(samples[0].data(), samples[0].size());
+
+    cout << std::fixed << std::setprecision(4);
+    cout << "Time: " << parser.time_server << " game: " << parser.time_game << " pm: " << parser.play_mode << " side: " << parser.team_side << "\n";
+    cout << "Gyro: " << parser.gyro[0] << "," << parser.gyro[1] << "," << parser.gyro[2] << "\n";
+    cout << "Acc:  " << parser.acc[0] << "," << parser.acc[1] << "," << parser.acc[2] << "\n";
+    for(int i=0; i<World_Parser::MAX_JOINTS; i++){
+        cout << "Joint " << i << ": " << parser.joints_position[i] << "\n";
+    }
+    cout << "Ball: " << parser.ball_is_visible << " " << parser.ball_sph[0] << "," << parser.ball_sph[1] << "," << parser.ball_sph[2] << "\n";
+    for(int i=0; i<World_Parser::LANDMARK_COUNT; i++){
+        cout << "Landmark " << i << ": " << parser.landmark_seen[i] << " " <<
+            parser.landmark_sph[i][0] << "," << parser.landmark_sph[i][1] << "," << parser.landmark_sph[i][2] << "\n";
+    }
+    cout << "Lines: " << parser.line_count << "\n";
+    for(int t=0; t<2; t++){
+        for(int i=0; i<World_Parser::MAX_PLAYERS; i++){
+            if(parser.player_visible[t][i]) cout << (t ? "Opponent " : "Teammate ") << i+1 << " parts: " << parser.player_parts_seen[t][i] << "\n";
+        }
+    }
+    cout << "Errors: " << parser.error_count << " " << parser.first_error << "\n";
+
+    // ================================================= 3. Benchmark
+
+    const int repetitions = 20000;
+    size_t bytes = 0;
+    int hear = 0;
+
+    t1 = high_resolution_clock::now();
+    for(int r=0; r<repetitions; r++){
+        for(const std::string& s : samples){
+            parser.parse(s.data(), s.size());
+            bytes += s.size();
+            hear += parser.hear_count;
+        }
+    }
+    t2 = high_resolution_clock::now();
+
+    double ns = duration_cast<nanoseconds>(t2 - t1).count();
+    int msgs = repetitions * samples.size();
+
+    cout << "\n\n" << msgs << " messages (" << bytes/msgs << " bytes avg, " << hear << " heard)\n";
+    cout << ns / msgs / 1000 << "us per message\n";
+    cout << bytes / ns * 1000 << "MB/s\n\n";
+}
@@ -0,0 +1,98 @@
+#include "world_parser.h"
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include <vector>
+
+namespace py = pybind11;
+using namespace std;
+
+
+/**
+ * @brief Numpy view of a fixed size array that lives inside the parser (no copy)
+ * The parser object is kept alive as the base of the returned array
+ */
+template<typename T>
+py::array_t<T> view(py::object self, T* data, std::vector<py::ssize_t> shape){
+    return py::array_t<T>(shape, data, self);
+}
+
+/**
+ * @brief Parse a sense message (bytes, bytearray or memoryview)
+ * @return false if the message was truncated
+ */
+bool parse(World_Parser& p, py::buffer msg){
+    py::buffer_info msg_buf = msg.request();
+    return p.parse((const char*)msg_buf.ptr, (int)msg_buf.size);
+}
+
+/**
+ * @brief Get messages heard from our team in the last parsed message
+ * @return list of (offset, length, timestamp, direction), direction is "self" if the message was sent by oneself
+ */
+py::list get_hear(const World_Parser& p){
+    py::list retval;
+    for(int i=0; i<p.hear_count; i++){
+        const World_Parser::Hear_Msg& h = p.hear[i];
+        py::object direction;
+        if(h.is_self) direction = py::str("self");
+        else          direction = py::float_(h.direction);
+        retval.append(py::make_tuple(h.offset, h.len, h.timestamp, direction));
+    }
+    return retval;
+}
+
+
+using namespace pybind11::literals; // to add informative argument names as -> "argname"_a
+
+PYBIND11_MODULE(world_parser, m) {  // the python module name, m is the interface to create bindings
+    m.doc() = "Sense message parser"; // optional module docstring
+
+    std::vector<std::string> play_modes(World_Parser::PLAY_MODE_NAMES, World_Parser::PLAY_MODE_NAMES + World_Parser::PLAY_MODE_COUNT);
+    m.attr("PLAY_MODE_NAMES") = play_modes;
+
+    typedef World_Parser P;
+
+    py::class_<P>(m, "Parser")
+        .def(py::init<const std::string&>(), "team_name"_a)
+        .def("parse", &parse, "Parse sense message", "msg"_a)
+        .def("get_hear", &get_hear, "Get messages heard from our team")
+
+        // scalars (copied on access)
+        .def_readonly("time_server", &P::time_server)
+        .def_readonly("time_game", &P::time_game)
+        .def_readonly("team_side", &P::team_side)
+        .def_readonly("goals_left", &P::goals_left)
+        .def_readonly("goals_right", &P::goals_right)
+        .def_readonly("play_mode", &P::play_mode)
+        .def_readonly("vision_is_up_to_date", &P::vision_is_up_to_date)
+        .def_readonly("ball_is_visible", &P::ball_is_visible)
+        .def_readonly("line_count", &P::line_count)
+        .def_readonly("opponent_team_name", &P::opponent_team_name)
+        .def_readonly("cheat_pos_seen", &P::cheat_pos_seen)
+        .def_readonly("cheat_ori_seen", &P::cheat_ori_seen)
+        .def_readonly("ball_cheat_seen", &P::ball_cheat_seen)
+        .def_readonly("cheat_ori", &P::cheat_ori)
+        .def_readonly("error_count", &P::error_count)
+        .def_readonly("first_error", &P::first_error)
+
+        // arrays (views of the parser's memory, get them once and keep them)
+        .def_property_readonly("gyro",              [](py::object s){ return view(s, s.cast<P&>().gyro, {3}); })
+        .def_property_readonly("acc",               [](py::object s){ return view(s, s.cast<P&>().acc, {3}); })
+        .def_property_readonly("joints_position",   [](py::object s){ return view(s, s.cast<P&>().joints_position, {P::MAX_JOINTS}); })
+        .def_property_readonly("joints_speed",      [](py::object s){ return view(s, s.cast<P&>().joints_speed, {P::MAX_JOINTS}); })
+        .def_property_readonly("frp",               [](py::object s){ return view(s, &s.cast<P&>().frp[0][0], {P::FOOT_COUNT, 6}); })
+        .def_property_readonly("frp_seen",          [](py::object s){ return view(s, s.cast<P&>().frp_seen, {P::FOOT_COUNT}); })
+        .def_property_readonly("ball_sph",          [](py::object s){ return view(s, s.cast<P&>().ball_sph, {3}); })
+        .def_property_readonly("ball_cart",         [](py::object s){ return view(s, s.cast<P&>().ball_cart, {3}); })
+        .def_property_readonly("landmark_seen",     [](py::object s){ return view(s, s.cast<P&>().landmark_seen, {P::LANDMARK_COUNT}); })
+        .def_property_readonly("landmark_sph",      [](py::object s){ return view(s, &s.cast<P&>().landmark_sph[0][0], {P::LANDMARK_COUNT, 3}); })
+        .def_property_readonly("lines",             [](py::object s){ return view(s, &s.cast<P&>().lines[0][0], {P::MAX_LINES, 6}); })
+        .def_property_readonly("player_visible",    [](py::object s){ return view(s, &s.cast<P&>().player_visible[0][0], {2, P::MAX_PLAYERS}); })
+        .def_property_readonly("player_parts_seen", [](py::object s){ return view(s, &s.cast<P&>().player_parts_seen[0][0], {2, P::MAX_PLAYERS}); })
+        .def_property_readonly("player_parts_sph",  [](py::object s){ return view(s, &s.cast<P&>().player_parts_sph[0][0][0][0], {2, P::MAX_PLAYERS, P::PART_COUNT, 3}); })
+        .def_property_readonly("player_parts_cart", [](py::object s){ return view(s, &s.cast<P&>().player_parts_cart[0][0][0][0], {2, P::MAX_PLAYERS, P::PART_COUNT, 3}); })
+        .def_property_readonly("cheat_abs_pos",     [](py::object s){ return view(s, s.cast<P&>().cheat_abs_pos, {3}); })
+        .def_property_readonly("ball_cheat_abs_pos",[](py::object s){ return view(s, s.cast<P&>().ball_cheat_abs_pos, {3}); })
+        .def_property_readonly("ball_cheat_abs_vel",[](py::object s){ return view(s, s.cast<P&>().ball_cheat_abs_vel, {3}); });
+}
@@ -0,0 +1,475 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "world_parser.h"
+
+const char* const World_Parser::PLAY_MODE_NAMES[] = {
+    "KickOff_Left", "KickIn_Left", "corner_kick_left", "goal_kick_left", "free_kick_left", "pass_left",
+    "direct_free_kick_left", "Goal_Left", "offside_left",
+    "KickOff_Right", "KickIn_Right", "corner_kick_right", "goal_kick_right", "free_kick_right", "pass_right",
+    "direct_free_kick_right", "Goal_Right", "offside_right",
+    "BeforeKickOff", "GameOver", "PlayOn" };
+
+const int World_Parser::PLAY_MODE_COUNT = sizeof(PLAY_MODE_NAMES) / sizeof(PLAY_MODE_NAMES[0]);
+
+// Joint perceptor names, ordered by joint index (see Robot.MAP_PERCEPTOR_TO_INDEX)
+static const char* const JOINT_NAMES[World_Parser::MAX_JOINTS] = {
+    "hj1",  "hj2",  "llj1", "rlj1", "llj2", "rlj2", "llj3", "rlj3",
+    "llj4", "rlj4", "llj5", "rlj5", "llj6", "rlj6", "laj1", "raj1",
+    "laj2", "raj2", "laj3", "raj3", "laj4", "raj4", "llj7", "rlj7" };
+
+// Fix symmetry issues 2/4 (perceptors), see Robot.FIX_PERCEPTOR_SET
+static const bool JOINT_IS_INVERTED[World_Parser::MAX_JOINTS] = {
+    0,0,0,0,0,1,0,0, 0,0,0,0,0,1,0,0, 0,1,1,0,1,0,0,0 };
+
+static const char* const LANDMARK_NAMES[World_Parser::LANDMARK_COUNT] = {
+    "F1L", "F2L", "F1R", "F2R", "G1L", "G2L", "G1R", "G2R" };
+
+static const char* const FOOT_NAMES[World_Parser::FOOT_COUNT] = { "lf", "rf", "lf1", "rf1" };
+
+static const char* const PART_NAMES[World_Parser::PART_COUNT] = {
+    "head", "llowerarm", "rlowerarm", "lfoot", "rfoot" };
+
+static const double STEPTIME = 0.02;
+static const double VISUALSTEP = 0.04;
+static const double DEG_TO_RAD = M_PI / 180;
+
+static const double POW10[] = { 1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,1e12,1e13,1e14,1e15 };
+
+static inline bool tag_is(const char* tag, int tag_len, const char* name){
+    return (int)strlen(name) == tag_len && memcmp(tag, name, tag_len) == 0;
+}
+
+template<int N>
+static inline int find_name(const char* const (&names)[N], const char* s, int len){
+    for(int i=0; i<N; i++){
+        if(tag_is(s, len, names[i])) return i;
+    }
+    return -1;
+}
+
+static inline void sph2cart(const double sph[3], double cart[3]){
+    double h = sph[1] * DEG_TO_RAD;
+    double v = sph[2] * DEG_TO_RAD;
+    cart[0] = sph[0] * cos(v) * cos(h);
+    cart[1] = sph[0] * cos(v) * sin(h);
+    cart[2] = sph[0] * sin(v);
+}
+
+
+World_Parser::World_Parser(const std::string& team_name) : team_name(team_name) {}
+
+
+/**
+ * @brief Find next tag, while keeping track of the s-expression depth
+ * @param pos current position, returned after the tag name
+ * @param min_depth lowest depth reached before the tag (0 if the message ended)
+ * @return false if the message ended before a complete tag was found
+ */
+bool World_Parser::get_next_tag(int& pos, const char*& tag, int& tag_len, int& min_depth){
+
+    min_depth = depth;
+
+    while(1){
+        if(pos >= exp_len){
+            min_depth = 0;
+            tag_len = 0;
+            return false;
+        }
+        if(exp[pos] == ')'){
+            depth--;
+            if(min_depth > depth) min_depth = depth;
+        }else if(exp[pos] == '('){
+            break;
+        }
+        pos++;
+    }
+
+    depth++;
+    int start = ++pos;
+    while(pos < exp_len && exp[pos] != ' ') pos++;
+
+    tag = exp + start;
+    tag_len = pos - start;
+    if(pos >= exp_len){
+        min_depth = 0;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Read float at pos (digits, '.', sign or nan), pos is returned after the number
+ * Numbers with up to 15 significant digits are rounded exactly like Python's float()
+ */
+double World_Parser::read_float(int& pos){
+
+    int i = pos;
+    bool negative = false;
+    if(i < exp_len && exp[i] == '-'){ negative = true; i++; }
+
+    if(i+3 <= exp_len && exp[i]=='n' && exp[i+1]=='a' && exp[i+2]=='n'){ // handle nan values (they exist)
+        pos = i+3;
+        return NAN;
+    }
+
+    long long mantissa = 0;
+    int digits = 0, frac_digits = 0;
+    bool dot = false;
+    int start = i;
+
+    for(; i < exp_len; i++){
+        char c = exp[i];
+        if(c >= '0' && c <= '9'){
+            mantissa = mantissa*10 + (c-'0');
+            digits++;
+            if(dot) frac_digits++;
+        }else if(c == '.' && !dot){
+            dot = true;
+        }else{
+            break;
+        }
+        if(digits > 15) break;
+    }
+
+    if(digits > 15){ // too long for the exact fast path
+        while(i < exp_len && ((exp[i] >= '0' && exp[i] <= '9') || exp[i] == '.')) i++;
+        char buf[64];
+        int len = i - pos < 63 ? i - pos : 63;
+        memcpy(buf, exp + pos, len);
+        buf[len] = 0;
+        pos = i;
+        return strtod(buf, nullptr);
+    }
+
+    pos = i;
+    if(digits == 0){
+        error("String to float conversion failed", exp + start, i < exp_len ? 1 : 0, start);
+        return 0;
+    }
+
+    double retval = (double)mantissa / POW10[frac_digits];
+    return negative ? -retval : retval;
+}
+
+int World_Parser::read_int(int& pos){
+    int i = pos;
+    bool negative = false;
+    if(i < exp_len && exp[i] == '-'){ negative = true; i++; }
+
+    int value = 0;
+    while(i < exp_len && exp[i] >= '0' && exp[i] <= '9'){
+        value = value*10 + (exp[i++]-'0');
+    }
+    pos = i;
+    return negative ? -value : value;
+}
+
+/**
+ * @brief Read bytes until ' ' or ')'
+ * @return number of bytes, b points to the first byte
+ */
+int World_Parser::read_bytes(int& pos, const char*& b){
+    int start = pos;
+    while(pos < exp_len && exp[pos] != ' ' && exp[pos] != ')') pos++;
+    b = exp + start;
+    return pos - start;
+}
+
+bool World_Parser::read_vec3(int& pos, double v[3]){
+    v[0] = read_float(++pos);
+    v[1] = read_float(++pos);
+    v[2] = read_float(++pos);
+    return pos < exp_len;
+}
+
+void World_Parser::error(const char* what, const char* tag, int tag_len, int pos){
+    if(error_count++ == 0){
+        char buf[128];
+        snprintf(buf, sizeof(buf), "%s: %.*s at %d", what, tag_len < 32 ? tag_len : 32, tag, pos);
+        first_error = buf;
+    }
+}
+
+/**
+ * @brief Parse 'P' (other player), which is the only variable particle inside 'See'
+ */
+void World_Parser::parse_player(int& pos){
+
+    const char* tag;
+    int tag_len, min_depth;
+    int team = TEAMMATE;
+    int id = -1;
+
+    while(1){
+        int previous_depth = depth;
+        int previous_pos = pos;
+        get_next_tag(pos, tag, tag_len, min_depth);
+        if(min_depth < 2){  // if =1 we are still inside 'See', if =0 we are already outside 'See'
+            pos = previous_pos; // we restore the previous tag, and let 'See' handle it
+            depth = previous_depth;
+            return;
+        }
+
+        if(tag_is(tag, tag_len, "team")){
+            const char* b;
+            int len = read_bytes(++pos, b);
+            bool is_teammate = (len == (int)team_name.size() && memcmp(b, team_name.data(), len) == 0);
+            team = is_teammate ? TEAMMATE : OPPONENT;
+            if(!is_teammate && opponent_team_name.empty()) opponent_team_name.assign(b, len); // register opponent team name
+        }else if(tag_is(tag, tag_len, "id")){
+            id = read_int(++pos) - 1;
+            if(id < 0 || id >= MAX_PLAYERS){ id = -1; continue; }
+            player_visible[team][id] = true;
+            player_parts_seen[team][id] = 0; // reset seen body parts
+        }else{
+            int part = find_name(PART_NAMES, tag, tag_len);
+            if(part < 0){
+                error("Unknown tag inside 'P'", tag, tag_len, pos);
+                continue;
+            }
+            get_next_tag(pos, tag, tag_len, min_depth);
+            double sph[3];
+            read_vec3(pos, sph);
+            if(id < 0) continue;
+            double* p_sph = player_parts_sph[team][id][part];
+            p_sph[0] = sph[0]; p_sph[1] = sph[1]; p_sph[2] = sph[2];
+            sph2cart(sph, player_parts_cart[team][id][part]);
+            player_parts_seen[team][id] |= 1 << part;
+        }
+    }
+}
+
+
+bool World_Parser::parse(const char* msg, int msg_len){
+
+    exp = msg;
+    exp_len = msg_len;
+    depth = 0;
+
+    // reset per message state
+    vision_is_up_to_date = false;
+    ball_is_visible = false;
+    cheat_pos_seen = cheat_ori_seen = ball_cheat_seen = false;
+    line_count = 0;
+    hear_count = 0;
+    error_count = 0;
+    first_error.clear();
+    memset(frp_seen, 0, sizeof(frp_seen));
+    memset(landmark_seen, 0, sizeof(landmark_seen));
+    memset(player_visible, 0, sizeof(player_visible));
+
+    const char* tag;
+    int tag_len, min_depth;
+    int pos = 0;
+
+    get_next_tag(pos, tag, tag_len, min_depth);
+
+    while(pos < exp_len){
+
+        if(tag_is(tag, tag_len, "time")){
+            while(1){
+                get_next_tag(pos, tag, tag_len, min_depth);
+                if(min_depth == 0) break;
+
+                if(tag_is(tag, tag_len, "now")) time_server = read_float(++pos);
+                else error("Unknown tag inside 'time'", tag, tag_len, pos);
+            }
+
+        }else if(tag_is(tag, tag_len, "GS")){
+            while(1){
+                get_next_tag(pos, tag, tag_len, min_depth);
+                if(min_depth == 0) break;
+
+                if(tag_is(tag, tag_len, "unum")){
+                    read_int(++pos); // We already know our unum
+                }else if(tag_is(tag, tag_len, "team")){
+                    const char* b;
+                    int len = read_bytes(++pos, b);
+                    team_side = tag_is(b, len, "left") ? SIDE_LEFT : SIDE_RIGHT;
+                }else if(tag_is(tag, tag_len, "sl")){
+                    goals_left = read_int(++pos);
+                }else if(tag_is(tag, tag_len, "sr")){
+                    goals_right = read_int(++pos);
+                }else if(tag_is(tag, tag_len, "t")){
+                    time_game = read_float(++pos);
+                }else if(tag_is(tag, tag_len, "pm")){
+                    const char* b;
+                    int len = read_bytes(++pos, b);
+                    int pm = find_name(PLAY_MODE_NAMES, b, len);
+                    if(pm >= 0) play_mode = pm;
+                    else error("Unknown tag inside 'GS'", b, len, pos);
+                }else{
+                    error("Unknown tag inside 'GS'", tag, tag_len, pos);
+                }
+            }
+
+        }else if(tag_is(tag, tag_len, "GYR")){
+            while(1){
+                get_next_tag(pos, tag, tag_len, min_depth);
+                if(min_depth == 0) break;
+
+                if(tag_is(tag, tag_len, "n")){
+                    // torso
+                }else if(tag_is(tag, tag_len, "rt")){
+                    gyro[1] = -read_float(++pos);
+                    gyro[0] =  read_float(++pos);
+                    gyro[2] =  read_float(++pos);
+                }else{
+                    error("Unknown tag inside 'GYR'", tag, tag_len, pos);
+                }
+            }
+
+        }else if(tag_is(tag, tag_len, "ACC")){
+            while(1){
+                get_next_tag(pos, tag, tag_len, min_depth);
+                if(min_depth == 0) break;
+
+                if(tag_is(tag, tag_len, "n")){
+                    // torso
+                }else if(tag_is(tag, tag_len, "a")){
+                    acc[1] = -read_float(++pos);
+                    acc[0] =  read_float(++pos);
+                    acc[2] =  read_float(++pos);
+                }else{
+                    error("Unknown tag inside 'ACC'", tag, tag_len, pos);
+                }
+            }
+
+        }else if(tag_is(tag, tag_len, "HJ")){
+            int joint = -1;
+            while(1){
+                get_next_tag(pos, tag, tag_len, min_depth);
+                if(min_depth == 0) break;
+
+                if(tag_is(tag, tag_len, "n")){
+                    const char* b;
+                    int len = read_bytes(++pos, b);
+                    joint = find_name(JOINT_NAMES, b, len);
+                    if(joint < 0) error("Unknown tag inside 'HJ'", b, len, pos);
+                }else if(tag_is(tag, tag_len, "ax")){
+                    double angle = read_float(++pos);
+                    if(joint < 0) continue;
+                    if(JOINT_IS_INVERTED[joint]) angle = -angle;
+                    joints_speed[joint] = (angle - joints_position[joint]) / STEPTIME * DEG_TO_RAD;
+                    joints_position[joint] = angle;
+                }else{
+                    error("Unknown tag inside 'HJ'", tag, tag_len, pos);
+                }
+            }
+
+        }else if(tag_is(tag, tag_len, "FRP")){
+            int foot = -1;
+            while(1){
+                get_next_tag(pos, tag, tag_len, min_depth);
+                if(min_depth == 0) break;
+
+                if(tag_is(tag, tag_len, "n")){
+                    const char* b;
+                    int len = read_bytes(++pos, b);
+                    foot = find_name(FOOT_NAMES, b, len);
+                    if(foot >= 0) frp_seen[foot] = true;
+                    else error("Unknown tag inside 'FRP'", b, len, pos);
+                }else if(tag_is(tag, tag_len, "c") && foot >= 0){
+                    frp[foot][1] = -read_float(++pos);
+                    frp[foot][0] =  read_float(++pos);
+                    frp[foot][2] =  read_float(++pos);
+                }else if(tag_is(tag, tag_len, "f") && foot >= 0){
+                    frp[foot][4] = -read_float(++pos);
+                    frp[foot][3] =  read_float(++pos);
+                    frp[foot][5] =  read_float(++pos);
+                }else{
+                    error("Unknown tag inside 'FRP'", tag, tag_len, pos);
+                }
+            }
+
+        }else if(tag_is(tag, tag_len, "See")){
+            vision_is_up_to_date = true;
+
+            while(1){
+                get_next_tag(pos, tag, tag_len, min_depth);
+                if(min_depth == 0) break;
+
+                if(tag_len == 3 && (tag[0] == 'G' || tag[0] == 'F')){
+                    int landmark = find_name(LANDMARK_NAMES, tag, tag_len);
+                    if(landmark < 0){
+                        error("Unknown tag inside 'See'", tag, tag_len, pos);
+                        continue;
+                    }
+                    get_next_tag(pos, tag, tag_len, min_depth);
+                    read_vec3(pos, landmark_sph[landmark]);
+                    landmark_seen[landmark] = true;
+
+                }else if(tag_is(tag, tag_len, "B")){
+                    get_next_tag(pos, tag, tag_len, min_depth);
+                    read_vec3(pos, ball_sph);
+                    sph2cart(ball_sph, ball_cart);
+                    ball_is_visible = true;
+
+                }else if(tag_is(tag, tag_len, "mypos")){
+                    read_vec3(pos, cheat_abs_pos);
+                    cheat_pos_seen = true;
+
+                }else if(tag_is(tag, tag_len, "myorien")){
+                    cheat_ori = read_float(++pos);
+                    cheat_ori_seen = true;
+
+                }else if(tag_is(tag, tag_len, "ballpos")){
+                    double c[3];
+                    read_vec3(pos, c);
+                    for(int i=0; i<3; i++){
+                        ball_cheat_abs_vel[i] = (c[i] - ball_cheat_abs_pos[i]) / VISUALSTEP;
+                        ball_cheat_abs_pos[i] = c[i];
+                    }
+                    ball_cheat_seen = true;
+
+                }else if(tag_is(tag, tag_len, "P")){
+                    parse_player(pos);
+
+                }else if(tag_is(tag, tag_len, "L")){
+                    double* l = lines[line_count < MAX_LINES ? line_count : MAX_LINES-1];
+                    get_next_tag(pos, tag, tag_len, min_depth);
+                    read_vec3(pos, l);
+                    get_next_tag(pos, tag, tag_len, min_depth);
+                    read_vec3(pos, l+3);
+
+                    bool has_nan = false;
+                    for(int i=0; i<6; i++) has_nan |= std::isnan(l[i]);
+                    if(has_nan) error("Received field line with NaNs", "", 0, pos);
+                    else if(line_count < MAX_LINES) line_count++; // accept field line if there are no NaNs
+
+                }else{
+                    error("Unknown tag inside 'See'", tag, tag_len, pos);
+                }
+            }
+
+        }else if(tag_is(tag, tag_len, "hear")){
+            const char* b;
+            int len = read_bytes(++pos, b);
+
+            if(len == (int)team_name.size() && memcmp(b, team_name.data(), len) == 0){ // discard message if it's not from our team
+                Hear_Msg h;
+                h.timestamp = read_float(++pos);
+                h.is_self = (pos+1 < exp_len && exp[pos+1] == 's'); // this message was sent by oneself
+                if(h.is_self){
+                    h.direction = 0;
+                    pos += 5;
+                }else{
+                    h.direction = read_float(++pos);
+                }
+                h.len = read_bytes(++pos, b);
+                h.offset = b - exp;
+                if(hear_count < MAX_HEAR) hear[hear_count++] = h;
+            }
+
+            get_next_tag(pos, tag, tag_len, min_depth);
+
+        }else{
+            error("Unknown root tag", tag, tag_len, pos);
+            get_next_tag(pos, tag, tag_len, min_depth);
+        }
+    }
+
+    return depth == 0;
+}
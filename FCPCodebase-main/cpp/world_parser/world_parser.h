@@ -0,0 +1,107 @@
+#pragma once
+#include <string>
+
+/**
+ * Single pass parser for the server's sense messages.
+ *
+ * All results are kept in fixed size arrays, so that the Python side can wrap them
+ * once as numpy arrays and only copy out the fields it needs after each parse().
+ * Vectors are converted to the agent's reference frame, like the former Python parser:
+ *      Original: X:left(-)/right(+)      Y:back(-)/front(+)      Z:down(-)/up(+)
+ *      New:      X:back(-)/front(+)      Y:right(-)/left(+)      Z:down(-)/up(+)
+ */
+class World_Parser {
+public:
+
+    enum { MAX_JOINTS = 24, MAX_LINES = 30, MAX_HEAR = 8, MAX_PLAYERS = 11 };
+    enum { LANDMARK_F1L, LANDMARK_F2L, LANDMARK_F1R, LANDMARK_F2R,
+           LANDMARK_G1L, LANDMARK_G2L, LANDMARK_G1R, LANDMARK_G2R, LANDMARK_COUNT };
+    enum { FOOT_LF, FOOT_RF, FOOT_LF1, FOOT_RF1, FOOT_COUNT };
+    enum { PART_HEAD, PART_LLOWERARM, PART_RLOWERARM, PART_LFOOT, PART_RFOOT, PART_COUNT };
+    enum { SIDE_UNKNOWN, SIDE_LEFT, SIDE_RIGHT };
+    enum { TEAMMATE, OPPONENT };
+
+    static const char* const PLAY_MODE_NAMES[];  // index of play_mode
+    static const int PLAY_MODE_COUNT;
+
+    World_Parser(const std::string& team_name);
+
+    /**
+     * @brief Parse one sense message, values that are not part of the message keep their previous state,
+     *        per message flags (seen/visible/counters) are reset
+     * @return false if the message was truncated
+     */
+    bool parse(const char* msg, int msg_len);
+
+    // ================================================= time & game state (persistent)
+
+    double time_server = 0;
+    double time_game = 0;
+    int team_side = SIDE_UNKNOWN;
+    int goals_left = 0;
+    int goals_right = 0;
+    int play_mode = -1;                       // index in PLAY_MODE_NAMES, -1 if unknown
+
+    // ================================================= proprioception (persistent)
+
+    double gyro[3] = {0};                     // deg/s
+    double acc[3] = {0};                      // m/s^2
+    double joints_position[MAX_JOINTS] = {0}; // deg (symmetry fix applied)
+    double joints_speed[MAX_JOINTS] = {0};    // rad/s
+    double frp[FOOT_COUNT][6] = {{0}};        // contact point + force vector
+    bool frp_seen[FOOT_COUNT] = {0};
+
+    // ================================================= vision
+
+    bool vision_is_up_to_date = false;
+    bool ball_is_visible = false;
+    double ball_sph[3] = {0};                 // ball relative to head (m, deg, deg)
+    double ball_cart[3] = {0};                // ball relative to head (m)
+    bool landmark_seen[LANDMARK_COUNT] = {0};
+    double landmark_sph[LANDMARK_COUNT][3] = {{0}};
+    int line_count = 0;
+    double lines[MAX_LINES][6] = {{0}};       // start_pos+end_pos (m, deg, deg, m, deg, deg)
+
+    bool player_visible[2][MAX_PLAYERS] = {{0}};
+    int player_parts_seen[2][MAX_PLAYERS] = {{0}};  // bitmask of PART_*
+    double player_parts_sph[2][MAX_PLAYERS][PART_COUNT][3] = {{{{0}}}};
+    double player_parts_cart[2][MAX_PLAYERS][PART_COUNT][3] = {{{{0}}}};
+    std::string opponent_team_name;           // empty until an opponent is seen
+
+    // ================================================= cheats (persistent values)
+
+    bool cheat_pos_seen = false;
+    bool cheat_ori_seen = false;
+    bool ball_cheat_seen = false;
+    double cheat_abs_pos[3] = {0};
+    double cheat_ori = 0;
+    double ball_cheat_abs_pos[3] = {0};
+    double ball_cheat_abs_vel[3] = {0};
+
+    // ================================================= hear (references into the parsed message)
+
+    struct Hear_Msg { int offset; int len; double timestamp; double direction; bool is_self; };
+    int hear_count = 0;
+    Hear_Msg hear[MAX_HEAR];
+
+    // ================================================= problems found in the last message
+
+    int error_count = 0;
+    std::string first_error;
+
+private:
+
+    std::string team_name;
+    const char* exp = nullptr;
+    int exp_len = 0;
+    int depth = 0;
+
+    bool get_next_tag(int& pos, const char*& tag, int& tag_len, int& min_depth);
+    double read_float(int& pos);
+    int read_int(int& pos);
+    int read_bytes(int& pos, const char*& b);
+    bool read_vec3(int& pos, double v[3]);
+
+    void parse_player(int& pos);
+    void error(const char* what, const char* tag, int tag_len, int pos);
+};
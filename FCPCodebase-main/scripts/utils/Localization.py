@@ -1,5 +1,4 @@
 from agent.Agent import Agent as Agent
-from cpp.localization import localization
 from math_ops.Math_Ops import Math_Ops as M
 from scripts.commons.Script import Script
 from world.commons.Draw import Draw
@@ -36,10 +35,10 @@ class Localization():
             self.script.batch_receive(slice(1,None))       # receive & update world state
             
             if p.world.vision_is_up_to_date:
-                if p.world.robot.loc_is_up_to_date:     # localization will draw the world of the last agent to be executed
-                    localization.print_python_data()    # print data received by the localization module
-                    localization.draw_visible_elements(not p.world.team_side_is_left) # draw visible elements
-                    localization.print_report()         # print report with stats
+                if p.world.robot.loc_is_up_to_date:     # each agent has its own localizer, this one belongs to agent p
+                    p.world.localizer.print_python_data()    # print data received by the localization module
+                    p.world.localizer.draw_visible_elements(not p.world.team_side_is_left) # draw visible elements
+                    p.world.localizer.print_report()         # print report with stats
                     print("\nPress ctrl+c to return.")
                     d.circle( p.world.ball_abs_pos, 0.1,6,Draw.Color.purple_magenta,"world", False)
                 else:
@@ -15,6 +15,7 @@ class World():
     STEPTIME_MS = 20   # Fixed step time in milliseconds
     VISUALSTEP = 0.04  # Fixed visual step time
     VISUALSTEP_MS = 40 # Fixed visual step time in milliseconds
+    BALL_VZ_NOISE = 1.5 # Vertical ball speeds below this are treated as vision noise by the ball predictor (m/s)
 
     # play modes in our favor
     M_OUR_KICKOFF = 0
@@ -88,6 +89,8 @@ class World():
         self.ball_2d_pred_vel = np.zeros((1,2))  # prediction of current and future 2D ball velocities*
         self.ball_2d_pred_spd = np.zeros(1)      # prediction of current and future 2D ball linear speeds*
         # *at intervals of 0.02 s until ball comes to a stop or gets out of bounds (according to prediction)
+        self.ball_predictor = ball_predictor.Predictor() # ball predictor (its arrays are overwritten by every prediction, ball_2d_pred_* are copies)
+        self.localizer = localization.Localizer()       # localization state of this robot (independent of other agents in the same process)
         self.lines = np.zeros((30,6))            # Position of visible lines, relative to head, start_pos+end_pos (spherical coordinates) (m, deg, deg, m, deg, deg)
         self.line_count = 0                      # Number of visible lines
         self.vision_last_update = 0                                   # World.time_local_ms when last vision update was received
@@ -195,9 +198,29 @@ class World():
             distance between current robot position and intersection point
         '''
         
-        params = np.array([*self.robot.loc_head_position[:2], player_speed*0.02, *self.ball_2d_pred_pos.flat], np.float32)
-        pred_ret  = ball_predictor.get_intersection(params)
-        return pred_ret[:2], pred_ret[2]
+        xyd, _ = self.get_intersection_points_with_ball(self.robot.loc_head_position[None,:2], (player_speed,))
+        return xyd[0,:2], xyd[0,2]
+
+    def get_intersection_points_with_ball(self, positions, player_speeds):
+        '''
+        Get 2D intersection points with moving ball for many robots at once, based on `self.ball_2d_pred_pos`
+
+        Parameters
+        ----------
+        positions : array_like
+            2D positions of the robots, shape (n,2)
+        player_speeds : array_like
+            average speed at which each robot will chase the ball, shape (n,)
+
+        Returns
+        -------
+        intersection points and distances : ndarray
+            shape (n,3), 2D intersection point and distance between robot and intersection point, for each robot
+        intersection steps : ndarray
+            shape (n,), index of the intersection point in `self.ball_2d_pred_pos` (multiply by 0.02 to get the time in seconds)
+        '''
+
+        return ball_predictor.intersect_batch(self.ball_2d_pred_pos, positions, np.asarray(player_speeds, np.float32) * ball_predictor.STEP)
     
     def update(self):
         r = self.robot
@@ -251,7 +274,7 @@ class World():
 
             # Compute localization
 
-            loc = localization.compute(
+            loc = self.localizer.compute(
                 r.feet_toes_are_touching['lf'],
                 r.feet_toes_are_touching['rf'],
                 feet_contact,
@@ -342,12 +365,18 @@ class World():
 
         elif self.ball_abs_pos_last_update == self.time_local_ms: # make new prediction for new ball position (from vision or radio)
 
-            params = np.array([*self.ball_abs_pos[:2], *np.copy(self.get_ball_abs_vel(6)[:2])], np.float32)
-            pred_ret  = ball_predictor.predict_rolling_ball(params)
-            sample_no = len(pred_ret) // 5 * 2
-            self.ball_2d_pred_pos = pred_ret[:sample_no].reshape(-1, 2)
-            self.ball_2d_pred_vel = pred_ret[sample_no:sample_no*2].reshape(-1, 2)
-            self.ball_2d_pred_spd = pred_ret[sample_no*2:]
+            # the vertical velocity is noisy (especially if the ball is distant), a small vz would turn a rolling ball into a bouncing one
+            ball_vel = np.copy(self.get_ball_abs_vel(6))
+            if abs(ball_vel[2]) < W.BALL_VZ_NOISE:
+                ball_vel[2] = 0
+
+            bp = self.ball_predictor
+            bp.predict(self.ball_abs_pos, ball_vel) # includes the airborne phase of lofted balls
+
+            # bp.pos/vel/spd are views of the predictor's memory, which the next prediction overwrites: copy them
+            self.ball_2d_pred_pos = bp.pos.copy()
+            self.ball_2d_pred_vel = bp.vel.copy()
+            self.ball_2d_pred_spd = bp.spd.copy()
 
         elif len(self.ball_2d_pred_pos) > 1: # otherwise, advance to next predicted step, if available 
             self.ball_2d_pred_pos = self.ball_2d_pred_pos[1:]
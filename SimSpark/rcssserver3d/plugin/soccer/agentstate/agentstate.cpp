@@ -136,7 +136,9 @@ AgentState::ReduceBattery(float consumption)
 }
 
 void
-AgentState::AddMessage(const string& msg, const string& team, float direction, bool teamMate)
+AgentState::AddMessage(const std::shared_ptr<const string>& msg,
+                       const std::shared_ptr<const string>& team,
+                       float direction, bool teamMate)
 {
     if (teamMate)
     {
@@ -190,10 +192,12 @@ AgentState::GetMessage(string& msg, string& team, float& direction, bool teamMat
             return false;
         }
 
-        msg = mMateMsg;
-        team = mMateTeam;
+        msg = *mMateMsg;
+        team = *mMateTeam;
         direction = mMateMsgDir;
         mIfMateMsg = false;
+        mMateMsg.reset();
+        mMateTeam.reset();
         return true;
     }
     else
@@ -208,10 +212,12 @@ AgentState::GetMessage(string& msg, string& team, float& direction, bool teamMat
             return false;
         }
 
-        msg = mOppMsg;
-        team = mOppTeam;
+        msg = *mOppMsg;
+        team = *mOppTeam;
         direction = mOppMsgDir;
         mIfOppMsg = false;
+        mOppMsg.reset();
+        mOppTeam.reset();
         return true;
     }
 }
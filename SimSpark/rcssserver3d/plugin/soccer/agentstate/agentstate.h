@@ -101,8 +101,11 @@ public:
      */
     bool ReduceBattery(float consumption);
 
-    /** Add a new message to the list */
-    void AddMessage(const std::string& msg, const std::string& team, float direction, bool teamMate);
+    /** Add a new message to the list; the message and the team name
+        are shared with the other players that hear the message */
+    void AddMessage(const std::shared_ptr<const std::string>& msg,
+                    const std::shared_ptr<const std::string>& team,
+                    float direction, bool teamMate);
     void AddSelfMessage(const std::string& msg);
 
     /** Get the first message from the list */
@@ -154,13 +157,13 @@ protected:
     std::string mSelfMsg;
 
     /** team-mate's message */
-    std::string mMateMsg;
-    std::string mMateTeam;
+    std::shared_ptr<const std::string> mMateMsg;
+    std::shared_ptr<const std::string> mMateTeam;
     float mMateMsgDir;
 
     /** opponent's message */
-    std::string mOppMsg;
-    std::string mOppTeam;
+    std::shared_ptr<const std::string> mOppMsg;
+    std::shared_ptr<const std::string> mOppTeam;
     float mOppMsgDir;
 
     /** max hear capacity units */
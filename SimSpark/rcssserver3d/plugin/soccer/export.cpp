@@ -48,6 +48,7 @@
 #include "ball/ball.h"
 #include "visionperceptor/visionperceptor.h"
 #include "restrictedvisionperceptor/restrictedvisionperceptor.h"
+#include "visionoccluderaspect/visionoccluderaspect.h"
 #include "gamestateperceptor/gamestateperceptor.h"
 #include "soccernode/soccernode.h"
 #include "agentstateperceptor/agentstateperceptor.h"
@@ -68,6 +69,7 @@ ZEITGEIST_EXPORT_BEGIN()
         ZEITGEIST_EXPORT(BallStateAspect);
         ZEITGEIST_EXPORT(SoccerRuleAspect);
         ZEITGEIST_EXPORT(SoccerRuleItem);
+        ZEITGEIST_EXPORT(VisionOccluderAspect);
         ZEITGEIST_EXPORT(BeamEffector);
         ZEITGEIST_EXPORT(CatchEffector);
         ZEITGEIST_EXPORT(CreateEffector);
@@ -30,6 +30,7 @@
 #include <salt/linesegment2.h>
 #include <limits>
 #include <iostream>
+#include <visionoccluderaspect/visionoccluderaspect.h>
 
 using namespace zeitgeist;
 using namespace oxygen;
@@ -41,7 +42,8 @@ RestrictedVisionPerceptor::RestrictedVisionPerceptor() : Perceptor(),
                                      mSenseBallPos(false),
                                      mAddNoise(true),
                                      mStaticSenseAxis(true),
-                                     mSenseLine(false)
+                                     mSenseLine(false),
+                                     mOcclusion(false)
 {
     // set predicate name
     SetPredicateName("See");
@@ -197,6 +199,7 @@ RestrictedVisionPerceptor::OnUnlink()
     mAgentAspect.reset();
     mAgentState.reset();
     mActiveScene.reset();
+    mOccluderAspect.reset();
 }
 
 void
@@ -211,21 +214,6 @@ RestrictedVisionPerceptor::SetStaticSenseAxis(bool static_axis)
     mStaticSenseAxis = static_axis;
 }
 
-bool
-RestrictedVisionPerceptor::ConstructInternal()
-{
-    mRay = std::static_pointer_cast<RayCollider>
-        (GetCore()->New("oxygen/RayCollider"));
-
-    if (mRay.get() == 0)
-    {
-        GetLog()->Error() << "Error: (RestrictedVisionPerceptor) cannot create Raycollider. "
-                          << "occlusion check disabled\n";
-    }
-
-    return true;
-}
-
 void
 RestrictedVisionPerceptor::SetupVisibleNodes(TNodeObjectsMap& visibleNodes)
 {
@@ -395,13 +383,14 @@ RestrictedVisionPerceptor::StaticAxisPercept(std::shared_ptr<PredicateList> pred
     TTeamIndex  ti       = mAgentState->GetTeamIndex();
     salt::Vector3f myPos = mTransformParent->GetWorldTransform().Pos();
 
+    const VisionOccluders* occluders = mOcclusion ? GetOccluders() : 0;
+
     TNodeObjectsMap visibleNodes;
     SetupVisibleNodes(visibleNodes);
 
     for (TNodeObjectsMap::iterator i = visibleNodes.begin();
         i != visibleNodes.end(); ++i)
     {
-        std::shared_ptr<BaseNode> node   = (*i).first;
         TObjectList& visibleObjects = (*i).second;
 
         for (TObjectList::iterator j = visibleObjects.begin();
@@ -414,9 +403,7 @@ RestrictedVisionPerceptor::StaticAxisPercept(std::shared_ptr<PredicateList> pred
                 od.mRelPos += mError;
             }
 
-            if (od.mRelPos.Length() <= 0.1 ||
-                (CheckOcclusion(myPos,od))
-               )
+            if (od.mRelPos.Length() <= 0.1)
             {
                 // object is too close
                 j = visibleObjects.erase(j);
@@ -445,9 +432,18 @@ RestrictedVisionPerceptor::StaticAxisPercept(std::shared_ptr<PredicateList> pred
 
             ++j;
         }
+    }
 
+    if (occluders != 0)
+    {
+        RemoveOccludedObjects(*occluders, myPos, visibleNodes);
+    }
+
+    for (TNodeObjectsMap::iterator i = visibleNodes.begin();
+        i != visibleNodes.end(); ++i)
+    {
         // generate a sense entry
-        AddSense(predicate, node, visibleObjects);
+        AddSense(predicate, (*i).first, (*i).second);
     }
 
     if (mSenseMyPos)
@@ -508,13 +504,14 @@ RestrictedVisionPerceptor::DynamicAxisPercept(std::shared_ptr<PredicateList> pre
     // get the transformation matrix describing the current orientation
     const Matrix& mat = mTransformParent->GetWorldTransform();
 
+    const VisionOccluders* occluders = mOcclusion ? GetOccluders() : 0;
+
     TNodeObjectsMap visibleNodes;
     SetupVisibleNodes(visibleNodes);
 
     for (TNodeObjectsMap::iterator i = visibleNodes.begin();
         i != visibleNodes.end(); ++i)
     {
-        std::shared_ptr<BaseNode> node   = (*i).first;
         TObjectList& visibleObjects = (*i).second;
 
         for (TObjectList::iterator j = visibleObjects.begin();
@@ -573,9 +570,18 @@ RestrictedVisionPerceptor::DynamicAxisPercept(std::shared_ptr<PredicateList> pre
 
             ++j;
         }
+    }
+
+    if (occluders != 0)
+    {
+        RemoveOccludedObjects(*occluders, mat.Pos(), visibleNodes);
+    }
 
+    for (TNodeObjectsMap::iterator i = visibleNodes.begin();
+        i != visibleNodes.end(); ++i)
+    {
         // generate a sense entry
-        AddSense(predicate, node, visibleObjects);
+        AddSense(predicate, (*i).first, (*i).second);
     }
 
     if (mSenseMyPos)
@@ -643,43 +649,71 @@ RestrictedVisionPerceptor::Percept(std::shared_ptr<PredicateList> predList)
         DynamicAxisPercept(predList);
 }
 
-bool RestrictedVisionPerceptor::CheckOcclusion(const Vector3f& my_pos, const ObjectData& od) const
+const VisionOccluders*
+RestrictedVisionPerceptor::GetOccluders()
 {
-    // (occlusion test disabled for now, every object is visible)
-    return false;
+    if (mOccluderAspect.get() == 0)
+    {
+        mOccluderAspect = std::dynamic_pointer_cast<VisionOccluderAspect>
+            (SoccerBase::GetControlAspect(*this, "VisionOccluderAspect"));
+        if (mOccluderAspect.get() == 0)
+        {
+            GetLog()->Error()
+                << "Error: (RestrictedVisionPerceptor) cannot find "
+                << "VisionOccluderAspect, occlusion check disabled\n";
+            mOcclusion = false;
+            return 0;
+        }
+    }
 
-//     if (mRay.get() == 0) return;
+    return mOccluderAspect->GetOccluders();
+}
 
-//     // sort objects wrt their distance
-//     visible_objects.sort();
-//     // check visibility
-//     std::list<ObjectData>::iterator start = visible_objects.begin();
-//     ++start;
+void
+RestrictedVisionPerceptor::RemoveOccludedObjects(const VisionOccluders& occluders,
+                                                 const Vector3f& my_pos,
+                                                 TNodeObjectsMap& visibleNodes)
+{
+    // the body of a robot does not hide its own parts
+    mOcclusionTargets.Clear();
+    for (TNodeObjectsMap::const_iterator i = visibleNodes.begin();
+        i != visibleNodes.end(); ++i)
+    {
+        const int owner = occluders.GetAgentIndex
+            (dynamic_cast<const AgentAspect*>((*i).first.get()));
 
-//     // this is going to be expensive now: to check occlusion of an object,
-//     // we have to check all closer objects. For n objects, we have to
-//     // check at most n*(n-1)/2 objects.
-//     for (std::list<ObjectData>::iterator i = start;
-//          i != visible_objects.end(); ++i)
-//     {
-//         for (std::list<ObjectData>::iterator j = visible_objects.begin();
-//              j != i; ++j)
-//         {
-//             // cast ray from camera to object (j)
-//             mRay->SetParams(j->mRelPos,my_pos,j->mDist);
+        for (TObjectList::const_iterator j = (*i).second.begin();
+            j != (*i).second.end(); ++j)
+        {
+            mOcclusionTargets.Add((*j).mRelPos, owner);
+        }
+    }
 
-//             dContactGeom contact;
+    if (mOcclusionTargets.Size() == 0)
+    {
+        return;
+    }
 
-//             std::shared_ptr<Collider> collider = std::static_pointer_cast<Collider>
-//                 (i->mObj->GetChildSupportingClass("Collider"));
+    occluders.TestVisibility
+        (my_pos, occluders.GetAgentIndex(mAgentAspect.get()), mOcclusionTargets);
 
-//             if (mRay->Intersects(collider))
-//                 {
-//                     j->mVisible = false;
-//                     j = i;
-//                 }
-//         }
-//     }
+    size_t k = 0;
+    for (TNodeObjectsMap::iterator i = visibleNodes.begin();
+        i != visibleNodes.end(); ++i)
+    {
+        TObjectList& objectList = (*i).second;
+        for (TObjectList::iterator j = objectList.begin();
+            j != objectList.end(); ++k)
+        {
+            if (mOcclusionTargets.occluded[k])
+            {
+                j = objectList.erase(j);
+            } else
+            {
+                ++j;
+            }
+        }
+    }
 }
 
 void
@@ -931,3 +965,8 @@ void RestrictedVisionPerceptor::SetSenseLine(bool sense)
 {
   mSenseLine = sense;
 }
+
+void RestrictedVisionPerceptor::SetOcclusion(bool occlusion)
+{
+  mOcclusion = occlusion;
+}
@@ -24,13 +24,15 @@
 
 #include <salt/random.h>
 #include <oxygen/agentaspect/perceptor.h>
-#include <oxygen/physicsserver/raycollider.h>
 #include <oxygen/sceneserver/sceneserver.h>
 #include <oxygen/sceneserver/transform.h>
 #include <oxygen/agentaspect/agentaspect.h>
 #include <agentstate/agentstate.h>
 #include "../line/line.h"
 #include "../ball/ball.h"
+#include "visionoccluders.h"
+
+class VisionOccluderAspect;
 
 class RestrictedVisionPerceptor : public oxygen::Perceptor
 {
@@ -110,6 +112,11 @@ public:
     // turn sensing of lines on/off
     void SetSenseLine(bool sense);
 
+    /** Turn the occlusion of objects by the bodies of robots on/off.
+        Lines are never occluded.
+    */
+    void SetOcclusion(bool occlusion);
+
     /** Turn noise off/on.
         \param add_noise flag if noise should be used at all.
     */
@@ -164,9 +171,6 @@ public:
     float GetTilt() const;
 
 protected:
-    /** constructs the internal ray collider */
-    virtual bool ConstructInternal();
-
     /** prepares a list of visible nodes */
     void SetupVisibleNodes(TNodeObjectsMap& visibleNodes);
 
@@ -185,8 +189,17 @@ protected:
 
     bool CheckVisuable(ObjectData& od) const;
 
-    /** Checks if the given object is occluded, seen from from my_pos */
-    bool CheckOcclusion(const salt::Vector3f& my_pos, const ObjectData& od) const;
+    /** returns the robot proxies of the current cycle, built by the
+        VisionOccluderAspect; returns 0 if they are not available
+    */
+    const VisionOccluders* GetOccluders();
+
+    /** removes the objects that are hidden behind another robot,
+        seen from my_pos, in one batch
+    */
+    void RemoveOccludedObjects(const VisionOccluders& occluders,
+                               const salt::Vector3f& my_pos,
+                               TNodeObjectsMap& visibleNodes);
 
     /** constructs a sense entry for the given node with objects
         in the given predicate
@@ -253,8 +266,10 @@ protected:
     //! the upper bound for the vertical view direction in degrees
     int mTiltUpper;
 
-    //! ray collider to check occlusion
-    std::shared_ptr<oxygen::RayCollider> mRay;
+    //! flag if objects can be hidden behind robots
+    bool mOcclusion;
+    //! the lines of sight of the occlusion test
+    VisionOccluders::Targets mOcclusionTargets;
 
     //! random number generator for distance errors
     NormalRngPtr mDistRng;
@@ -272,6 +287,8 @@ protected:
     std::shared_ptr<oxygen::AgentAspect> mAgentAspect;
     //! a reference to the agent state
     std::shared_ptr<AgentState> mAgentState;
+    //! a reference to the aspect that holds the robot proxies
+    std::shared_ptr<VisionOccluderAspect> mOccluderAspect;
 };
 
 DECLARE_CLASS(RestrictedVisionPerceptor)
@@ -197,6 +197,22 @@ FUNCTION(RestrictedVisionPerceptor,setSenseLine)
     return true;
 }
 
+FUNCTION(RestrictedVisionPerceptor,setOcclusion)
+{
+    bool inOcclusion;
+
+    if (
+        (in.GetSize() != 1) ||
+        (! in.GetValue(in.begin(),inOcclusion))
+        )
+        {
+            return false;
+        }
+
+    obj->SetOcclusion(inOcclusion);
+    return true;
+}
+
 void CLASS(RestrictedVisionPerceptor)::DefineClass()
 {
     DEFINE_BASECLASS(oxygen/Perceptor)
@@ -210,4 +226,5 @@ void CLASS(RestrictedVisionPerceptor)::DefineClass()
     DEFINE_FUNCTION(setPanRange)
     DEFINE_FUNCTION(setTiltRange)
     DEFINE_FUNCTION(setSenseLine)
+    DEFINE_FUNCTION(setOcclusion)
 }
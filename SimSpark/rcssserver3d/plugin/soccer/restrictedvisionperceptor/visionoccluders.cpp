@@ -0,0 +1,379 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+   this file is part of rcssserver3D
+   Copyright (C) 2004-2025 RoboCup Soccer Server 3D Maintenance Group
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#include "visionoccluders.h"
+#include <oxygen/agentaspect/agentaspect.h>
+#include <oxygen/physicsserver/boxcollider.h>
+#include <oxygen/physicsserver/capsulecollider.h>
+#include <oxygen/physicsserver/ccylindercollider.h>
+#include <oxygen/physicsserver/spherecollider.h>
+#include <salt/gmath.h>
+#include <algorithm>
+
+using namespace zeitgeist;
+using namespace oxygen;
+using namespace salt;
+
+namespace
+{
+    const float EPSILON = 1e-8f;
+
+    inline float Clamp01(float v)
+    {
+        return (v < 0.0f) ? 0.0f : ((v > 1.0f) ? 1.0f : v);
+    }
+}
+
+VisionOccluders::VisionOccluders()
+{
+}
+
+void
+VisionOccluders::Clear()
+{
+    mAgents.clear();
+    mPx.clear(); mPy.clear(); mPz.clear();
+    mDx.clear(); mDy.clear(); mDz.clear();
+    mRadius.clear();
+    mBound2.clear();
+}
+
+void
+VisionOccluders::Build(const GameControlServer::TAgentAspectList& agents)
+{
+    Clear();
+
+    for (
+         GameControlServer::TAgentAspectList::const_iterator iter = agents.begin();
+         iter != agents.end();
+         ++iter
+         )
+    {
+        const std::shared_ptr<AgentAspect>& agent = (*iter);
+
+        Leaf::TLeafList colliders;
+        agent->ListChildrenSupportingClass<Collider>(colliders, true);
+
+        BeginAgent(agent.get());
+
+        for (
+             Leaf::TLeafList::const_iterator i = colliders.begin();
+             i != colliders.end();
+             ++i
+             )
+        {
+            const Matrix& mat =
+                std::static_pointer_cast<Collider>(*i)->GetWorldTransform();
+            const Vector3f& pos = mat.Pos();
+
+            std::shared_ptr<SphereCollider> sphere =
+                std::dynamic_pointer_cast<SphereCollider>(*i);
+            if (sphere.get() != 0)
+            {
+                AddCapsule(pos, pos, sphere->GetRadius());
+                continue;
+            }
+
+            // capsules are aligned to the local z axis
+            float radius = 0.0f;
+            float length = -1.0f;
+
+            std::shared_ptr<CapsuleCollider> capsule =
+                std::dynamic_pointer_cast<CapsuleCollider>(*i);
+            if (capsule.get() != 0)
+            {
+                capsule->GetParams(radius, length);
+            } else
+            {
+                std::shared_ptr<CCylinderCollider> ccylinder =
+                    std::dynamic_pointer_cast<CCylinderCollider>(*i);
+                if (ccylinder.get() != 0)
+                {
+                    ccylinder->GetParams(radius, length);
+                }
+            }
+
+            if (length >= 0.0f)
+            {
+                const Vector3f half = mat.Forward() * (0.5f * length);
+                AddCapsule(pos - half, pos + half, radius);
+                continue;
+            }
+
+            std::shared_ptr<BoxCollider> box =
+                std::dynamic_pointer_cast<BoxCollider>(*i);
+            if (box.get() != 0)
+            {
+                Vector3f lengths;
+                box->GetBoxLengths(lengths);
+
+                // a capsule along the longest axis, as thick as the
+                // mean of the other two half extents
+                int axis = 0;
+                if (lengths[1] > lengths[axis]) axis = 1;
+                if (lengths[2] > lengths[axis]) axis = 2;
+
+                const float radius = 0.25f *
+                    (lengths[(axis + 1) % 3] + lengths[(axis + 2) % 3]);
+                const float halfLength =
+                    std::max(0.0f, 0.5f * lengths[axis] - radius);
+
+                const Vector3f& dir = (axis == 0) ? mat.Right() :
+                    ((axis == 1) ? mat.Up() : mat.Forward());
+                const Vector3f half = dir * halfLength;
+                AddCapsule(pos - half, pos + half, radius);
+            }
+        }
+
+        EndAgent();
+    }
+}
+
+void
+VisionOccluders::BeginAgent(const AgentAspect* agent)
+{
+    mCurrent.agent = agent;
+    mCurrent.begin = mRadius.size();
+}
+
+void
+VisionOccluders::EndAgent()
+{
+    AgentProxy& proxy = mCurrent;
+    proxy.end = mRadius.size();
+    if (proxy.begin == proxy.end)
+    {
+        return;
+    }
+
+    // a sphere around the bounding box of the capsules
+    Vector3f minVec(mPx[proxy.begin], mPy[proxy.begin], mPz[proxy.begin]);
+    Vector3f maxVec(minVec);
+    for (size_t i = proxy.begin; i < proxy.end; ++i)
+    {
+        const Vector3f p(mPx[i], mPy[i], mPz[i]);
+        const Vector3f q(p + Vector3f(mDx[i], mDy[i], mDz[i]));
+        for (int k = 0; k < 3; ++k)
+        {
+            minVec[k] = std::min(minVec[k], std::min(p[k], q[k]));
+            maxVec[k] = std::max(maxVec[k], std::max(p[k], q[k]));
+        }
+    }
+
+    proxy.center = (minVec + maxVec) * 0.5f;
+    proxy.radius = 0.0f;
+    for (size_t i = proxy.begin; i < proxy.end; ++i)
+    {
+        const Vector3f p(mPx[i], mPy[i], mPz[i]);
+        const Vector3f q(p + Vector3f(mDx[i], mDy[i], mDz[i]));
+        const float reach = std::max((p - proxy.center).Length(),
+                                     (q - proxy.center).Length()) + mRadius[i];
+        proxy.radius = std::max(proxy.radius, reach);
+    }
+
+    mAgents.push_back(proxy);
+}
+
+void
+VisionOccluders::AddCapsule(const Vector3f& p, const Vector3f& q, float radius)
+{
+    mPx.push_back(p.x());
+    mPy.push_back(p.y());
+    mPz.push_back(p.z());
+    mDx.push_back(q.x() - p.x());
+    mDy.push_back(q.y() - p.y());
+    mDz.push_back(q.z() - p.z());
+    mRadius.push_back(radius);
+
+    const float bound = 0.5f * (q - p).Length() + radius;
+    mBound2.push_back(bound * bound);
+}
+
+int
+VisionOccluders::GetAgentIndex(const AgentAspect* agent) const
+{
+    for (size_t i = 0; i < mAgents.size(); ++i)
+    {
+        if (mAgents[i].agent == agent)
+        {
+            return static_cast<int>(i);
+        }
+    }
+
+    return -1;
+}
+
+bool
+VisionOccluders::Intersects(const Vector3f& a, const Vector3f& d,
+                            float invLength2, size_t i) const
+{
+    const Vector3f e(mDx[i], mDy[i], mDz[i]);
+    const Vector3f r(a.x() - mPx[i], a.y() - mPy[i], a.z() - mPz[i]);
+
+    // the segment has to pass the bounding sphere of the capsule
+    const Vector3f m = e * 0.5f - r;
+    const float sm = Clamp01(m.Dot(d) * invLength2);
+    if ((d * sm - m).SquareLength() >= mBound2[i])
+    {
+        return false;
+    }
+
+    // closest points of the two segments, see Ericson, Real-Time
+    // Collision Detection, 5.1.9
+    const float dd = d.Dot(d);
+    const float ee = e.Dot(e);
+    const float er = e.Dot(r);
+    const float dr = d.Dot(r);
+
+    float s;
+    float t;
+
+    if (ee <= EPSILON)
+    {
+        // a sphere
+        t = 0.0f;
+        s = Clamp01(-dr / dd);
+    } else
+    {
+        const float de = d.Dot(e);
+        const float denom = dd * ee - de * de;
+
+        s = (denom > EPSILON) ? Clamp01((de * er - dr * ee) / denom) : 0.0f;
+        t = (de * s + er) / ee;
+
+        if (t < 0.0f)
+        {
+            t = 0.0f;
+            s = Clamp01(-dr / dd);
+        } else if (t > 1.0f)
+        {
+            t = 1.0f;
+            s = Clamp01((de - dr) / dd);
+        }
+    }
+
+    const Vector3f diff = r + d * s - e * t;
+    return diff.SquareLength() < mRadius[i] * mRadius[i];
+}
+
+void
+VisionOccluders::Targets::Clear()
+{
+    x.clear();
+    y.clear();
+    z.clear();
+    invLength2.clear();
+    owner.clear();
+}
+
+void
+VisionOccluders::Targets::Add(const Vector3f& pos, int ownerIndex)
+{
+    const float length2 = pos.SquareLength();
+
+    x.push_back(pos.x());
+    y.push_back(pos.y());
+    z.push_back(pos.z());
+    invLength2.push_back((length2 > EPSILON) ? 1.0f / length2 : 0.0f);
+    owner.push_back(ownerIndex);
+}
+
+void
+VisionOccluders::TestVisibility(const Vector3f& eye, int observer,
+                                Targets& targets) const
+{
+    const size_t count = targets.Size();
+    targets.occluded.assign(count, 0);
+    targets.margin.resize(count);
+
+    const float* tx = count ? &targets.x[0] : 0;
+    const float* ty = count ? &targets.y[0] : 0;
+    const float* tz = count ? &targets.z[0] : 0;
+    const float* inv = count ? &targets.invLength2[0] : 0;
+    const int* owner = count ? &targets.owner[0] : 0;
+    unsigned char* occluded = count ? &targets.occluded[0] : 0;
+    float* margin = count ? &targets.margin[0] : 0;
+
+    float maxDist2 = 0.0f;
+    for (size_t j = 0; j < count; ++j)
+    {
+        maxDist2 = std::max(maxDist2, tx[j] * tx[j] + ty[j] * ty[j] + tz[j] * tz[j]);
+    }
+    const float maxDist = gSqrt(maxDist2);
+
+    for (size_t i = 0; i < mAgents.size(); ++i)
+    {
+        if (static_cast<int>(i) == observer)
+        {
+            continue;
+        }
+
+        const AgentProxy& proxy = mAgents[i];
+        const float cx = proxy.center.x() - eye.x();
+        const float cy = proxy.center.y() - eye.y();
+        const float cz = proxy.center.z() - eye.z();
+        const float c2 = cx * cx + cy * cy + cz * cz;
+
+        // the agent is behind all targets
+        const float reach = maxDist + proxy.radius;
+        if (c2 > reach * reach)
+        {
+            continue;
+        }
+
+        // the distance of the bounding sphere to the lines of sight,
+        // as lines, not segments: without branches the loop is
+        // vectorized, the exact test below rejects the extra hits
+        const float base = proxy.radius * proxy.radius - c2;
+        for (size_t j = 0; j < count; ++j)
+        {
+            const float cd = cx * tx[j] + cy * ty[j] + cz * tz[j];
+            margin[j] = base + cd * cd * inv[j];
+        }
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            if (
+                (margin[j] <= 0.0f) ||
+                (occluded[j] != 0) ||
+                (owner[j] == static_cast<int>(i)) ||
+                (inv[j] == 0.0f)
+                )
+            {
+                continue;
+            }
+
+            // the segment has to pass the sphere, too
+            const Vector3f d(tx[j], ty[j], tz[j]);
+            const float s = Clamp01((cx * d.x() + cy * d.y() + cz * d.z()) * inv[j]);
+            const Vector3f dist(d.x() * s - cx, d.y() * s - cy, d.z() * s - cz);
+            if (dist.SquareLength() >= proxy.radius * proxy.radius)
+            {
+                continue;
+            }
+
+            for (size_t k = proxy.begin; k < proxy.end; ++k)
+            {
+                if (Intersects(eye, d, inv[j], k))
+                {
+                    occluded[j] = 1;
+                    break;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,131 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+   this file is part of rcssserver3D
+   Copyright (C) 2004-2025 RoboCup Soccer Server 3D Maintenance Group
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#ifndef VISIONOCCLUDERS_H
+#define VISIONOCCLUDERS_H
+
+#include <salt/vector.h>
+#include <oxygen/gamecontrolserver/gamecontrolserver.h>
+#include <vector>
+
+/** \class VisionOccluders holds capsule proxies of the colliders of
+    all agents, to test which lines of sight are blocked by a robot.
+
+    The proxies form a two level hierarchy: a bounding sphere per
+    agent over the capsules of its body parts. Sphere colliders become
+    capsules of length zero, boxes a capsule along their longest
+    axis. Other collider types are ignored.
+
+    The VisionOccluderAspect builds the proxies once per cycle; they
+    are read only while the senses are generated, so the vision
+    perceptors of all agents can share them.
+*/
+class VisionOccluders
+{
+public:
+    /** the line of sight targets of one observer, one array per
+        component */
+    struct Targets
+    {
+        std::vector<float> x, y, z;
+        /** the inverse square length of the target vector */
+        std::vector<float> invLength2;
+        /** the agent index of the owner of the target, or -1 */
+        std::vector<int> owner;
+        /** the result, 1 for every blocked target, 0 otherwise */
+        std::vector<unsigned char> occluded;
+        /** scratch for the bounding sphere pass */
+        std::vector<float> margin;
+
+        void Clear();
+
+        /** adds the target at pos relative to the eye */
+        void Add(const salt::Vector3f& pos, int ownerIndex);
+
+        size_t Size() const { return x.size(); }
+    };
+
+public:
+    VisionOccluders();
+
+    /** rebuilds the proxies from the current pose of the agents */
+    void Build(const oxygen::GameControlServer::TAgentAspectList& agents);
+
+    /** removes all proxies */
+    void Clear();
+
+    /** starts the proxies of an agent; the capsules added until the
+        next EndAgent() belong to it */
+    void BeginAgent(const oxygen::AgentAspect* agent);
+
+    /** adds a capsule from p to q to the current agent */
+    void AddCapsule(const salt::Vector3f& p, const salt::Vector3f& q,
+                    float radius);
+
+    /** computes the bounding sphere of the current agent; an agent
+        without capsules is dropped */
+    void EndAgent();
+
+    /** returns the index of the given agent, or -1 if the agent has no
+        proxies */
+    int GetAgentIndex(const oxygen::AgentAspect* agent) const;
+
+    /** tests the lines of sight from eye to all targets and sets
+        their occluded flags. Neither the body of the observer nor the
+        body of the owner of a target block it.
+
+        \param observer the agent index of the observer, or -1
+    */
+    void TestVisibility(const salt::Vector3f& eye, int observer,
+                        Targets& targets) const;
+
+    /** returns the number of capsules */
+    size_t GetCapsuleCount() const { return mRadius.size(); }
+
+protected:
+    /** returns true if the segment from a to a + d passes the
+        capsule i; invLength2 is the inverse square length of d */
+    bool Intersects(const salt::Vector3f& a, const salt::Vector3f& d,
+                    float invLength2, size_t i) const;
+
+protected:
+    struct AgentProxy
+    {
+        const oxygen::AgentAspect* agent;
+        salt::Vector3f center;
+        float radius;
+
+        /** the range of the capsules of the agent */
+        size_t begin;
+        size_t end;
+    };
+
+    std::vector<AgentProxy> mAgents;
+
+    /** the agent between BeginAgent() and EndAgent() */
+    AgentProxy mCurrent;
+
+    /** the capsules as segments from P to P + D with a radius, one
+        array per component */
+    std::vector<float> mPx, mPy, mPz;
+    std::vector<float> mDx, mDy, mDz;
+    std::vector<float> mRadius;
+    /** the square radius of the bounding sphere of each capsule */
+    std::vector<float> mBound2;
+};
+
+#endif // VISIONOCCLUDERS_H
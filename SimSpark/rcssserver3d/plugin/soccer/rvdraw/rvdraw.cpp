@@ -29,6 +29,7 @@ long RVSender::uniqueIdNum;
  */
 RVSender::RVSender()
 {
+    init();
     socketCreated = false;
     sockfd = -1;
 
@@ -80,6 +81,7 @@ RVSender::RVSender()
  */
 RVSender::RVSender(int sockfd_, struct addrinfo p_)
 {
+    init();
     socketCreated = false;
     p = p_;
     sockfd = sockfd_;
@@ -87,6 +89,7 @@ RVSender::RVSender(int sockfd_, struct addrinfo p_)
 
 RVSender::~RVSender()
 {
+    flush();
     if (socketCreated)
         close(sockfd);
 }
@@ -212,9 +215,111 @@ void RVSender::updateDrawings(string id, string buf) {
     drawings[id] = buf;
 }
 
+void RVSender::init() {
+    numDatagrams = 0;
+    frameDepth = 0;
+    defaultMaxSwapRate = 0;
+}
+
+void RVSender::queueCommand(unsigned char* buf, int bufSize, const string* setName) {
+    if (setName == NULL) {
+        // not part of a drawing set, send it with the next flush
+        appendCommand((const char*)buf, bufSize);
+        if (frameDepth == 0)
+            flush();
+        return;
+    }
+
+    PendingSet& set = pendingSets[*setName];
+    set.commands.append((const char*)buf, bufSize);
+    set.sizes.push_back(bufSize);
+}
+
+void RVSender::appendCommand(const char* buf, int bufSize) {
+    // RoboViz parses any number of commands from one datagram; a
+    // command larger than a datagram is sent alone
+    if (numDatagrams == 0 ||
+            datagrams[numDatagrams-1].size() + bufSize > RVDRAW_MAX_DATAGRAM) {
+        if (numDatagrams == datagrams.size())
+            datagrams.push_back(string());
+        datagrams[numDatagrams++].clear();
+    }
+
+    datagrams[numDatagrams-1].append(buf, bufSize);
+}
+
+bool RVSender::acceptSwap(const string& setName) {
+    map<string, float>::const_iterator rate = maxSwapRates.find(setName);
+    float maxRate = (rate != maxSwapRates.end()) ? rate->second : defaultMaxSwapRate;
+    if (maxRate <= 0)
+        return true;
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    map<string, std::chrono::steady_clock::time_point>::iterator last =
+        lastSwapTimes.find(setName);
+
+    // allow 10% jitter, so that a set swapped every cycle at the
+    // limit is not throttled by timer noise
+    if (last != lastSwapTimes.end() &&
+            std::chrono::duration<float>(now - last->second).count() < 0.9f / maxRate)
+        return false;
+
+    lastSwapTimes[setName] = now;
+    return true;
+}
+
+void RVSender::flush() {
+    if (numDatagrams == 0)
+        return;
+
+#ifdef __linux__
+    vector<struct mmsghdr> msgs(numDatagrams);
+    vector<struct iovec> iovs(numDatagrams);
+    memset(&msgs[0], 0, numDatagrams * sizeof(struct mmsghdr));
+
+    for (size_t i = 0; i < numDatagrams; i++) {
+        iovs[i].iov_base = (void*)datagrams[i].data();
+        iovs[i].iov_len = datagrams[i].size();
+        msgs[i].msg_hdr.msg_name = p.ai_addr;
+        msgs[i].msg_hdr.msg_namelen = p.ai_addrlen;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    size_t sent = 0;
+    while (sent < numDatagrams) {
+        int n = sendmmsg(sockfd, &msgs[sent], numDatagrams - sent, 0);
+        if (n <= 0)
+            break;
+        sent += n;
+    }
+#else
+    for (size_t i = 0; i < numDatagrams; i++)
+        sendto(sockfd, datagrams[i].data(), datagrams[i].size(), 0, p.ai_addr, p.ai_addrlen);
+#endif
+
+    numDatagrams = 0;
+}
+
 
 // === Public Methods ===
 
+void RVSender::beginFrame() {
+    ++frameDepth;
+}
+
+void RVSender::endFrame() {
+    if (frameDepth > 0 && --frameDepth == 0)
+        flush();
+}
+
+void RVSender::setMaxSwapRate(float swapsPerSecond, const string* setName) {
+    if (setName == NULL)
+        defaultMaxSwapRate = swapsPerSecond;
+    else
+        maxSwapRates[*setName] = swapsPerSecond;
+}
+
 void RVSender::clear() {
     for (map<string,string>::iterator it = drawings.begin();
             it != drawings.end(); ++it) {
@@ -432,10 +537,32 @@ void RVSender::selectAgent(int u, int s) {
 }
 
 void RVSender::swapBuffers(const string* setName) {
-    int bufSize = -1;
-    unsigned char* buf = newBufferSwap(setName, &bufSize);
-    sendto(sockfd, buf, bufSize, 0, p.ai_addr, p.ai_addrlen);
-    delete[] buf;
+    string name = (setName != NULL) ? *setName : string();
+    bool accept = acceptSwap(name);
+
+    // RoboViz swaps every set whose name starts with setName
+    map<string, PendingSet>::iterator it = pendingSets.lower_bound(name);
+    while (it != pendingSets.end() && it->first.compare(0, name.length(), name) == 0) {
+        if (accept) {
+            const PendingSet& set = it->second;
+            size_t offset = 0;
+            for (size_t i = 0; i < set.sizes.size(); i++) {
+                appendCommand(set.commands.data() + offset, set.sizes[i]);
+                offset += set.sizes[i];
+            }
+        }
+        pendingSets.erase(it++);
+    }
+
+    if (accept) {
+        int bufSize = -1;
+        unsigned char* buf = newBufferSwap(setName, &bufSize);
+        appendCommand((const char*)buf, bufSize);
+        delete[] buf;
+    }
+
+    if (frameDepth == 0)
+        flush();
 }
 
 void RVSender::drawLine(float x1, float y1, float z1, float x2, float y2, float z2, float thickness, float r, float g, float b,
@@ -446,7 +573,7 @@ void RVSender::drawLine(float x1, float y1, float z1, float x2, float y2, float
 
     int bufSize = -1;
     unsigned char* buf = newLine(pa, pb, thickness, color, setName, &bufSize);
-    sendto(sockfd, buf, bufSize, 0, p.ai_addr, p.ai_addrlen);
+    queueCommand(buf, bufSize, setName);
     delete[] buf;
 }
 
@@ -456,7 +583,7 @@ void RVSender::drawCircle(float x, float y, float radius, float thickness, float
 
     int bufSize = -1;
     unsigned char* buf = newCircle(center, radius, thickness, color, setName, &bufSize);
-    sendto(sockfd, buf, bufSize, 0, p.ai_addr, p.ai_addrlen);
+    queueCommand(buf, bufSize, setName);
     delete[] buf;
 }
 
@@ -466,7 +593,7 @@ void RVSender::drawSphere(float x, float y, float z, float radius, float r, floa
 
     int bufSize = -1;
     unsigned char* buf = newSphere(center, radius, color, setName, &bufSize);
-    sendto(sockfd, buf, bufSize, 0, p.ai_addr, p.ai_addrlen);
+    queueCommand(buf, bufSize, setName);
     delete[] buf;
 }
 
@@ -478,7 +605,7 @@ void RVSender::drawPoint(float x, float y, float z, float size, float r, float g
 
     int bufSize = -1;
     unsigned char* buf = newPoint(center, size, color, setName, &bufSize);
-    sendto(sockfd, buf, bufSize, 0, p.ai_addr, p.ai_addrlen);
+    queueCommand(buf, bufSize, setName);
     delete[] buf;
 }
 
@@ -488,7 +615,7 @@ void RVSender::drawPolygon(const float* v, int numVerts, float r, float g, float
 
     int bufSize = -1;
     unsigned char* buf = newPolygon(v, numVerts, color, setName, &bufSize);
-    sendto(sockfd, buf, bufSize, 0, p.ai_addr, p.ai_addrlen);
+    queueCommand(buf, bufSize, setName);
     delete[] buf;
 }
 
@@ -499,7 +626,7 @@ void RVSender::drawAnnotation(const string *txt, float x, float y, float z,
     float point[3] = {x,y,z};
     int bufSize = -1;
     unsigned char *buf = newAnnotation(txt, point, color, setName, &bufSize);
-    sendto(sockfd, buf, bufSize, 0, p.ai_addr, p.ai_addrlen);
+    queueCommand(buf, bufSize, setName);
     delete[] buf;
 }
 
@@ -509,7 +636,7 @@ void RVSender::drawAgentAnnotation(const string *txt, char teamAgent,
     float color[3] = {r,g,b};
     int bufSize = -1;
     unsigned char *buf = newAgentAnnotation(txt, teamAgent, color, &bufSize);
-    sendto(sockfd, buf, bufSize, 0, p.ai_addr, p.ai_addrlen);
+    queueCommand(buf, bufSize, NULL);
     delete[] buf;
 }
 
@@ -517,7 +644,7 @@ void RVSender::removeAgentAnnotation(char teamAgent)
 {
     int bufSize = -1;
     unsigned char *buf = newRemoveAgentAnnotation(teamAgent, &bufSize);
-    sendto(sockfd, buf, bufSize, 0, p.ai_addr, p.ai_addrlen);
+    queueCommand(buf, bufSize, NULL);
     delete[] buf;
 }
 
@@ -525,7 +652,7 @@ void RVSender::selectAgent(char teamAgent)
 {
     int bufSize = -1;
     unsigned char *buf = newSelectAgent(teamAgent, &bufSize);
-    sendto(sockfd, buf, bufSize, 0, p.ai_addr, p.ai_addrlen);
+    queueCommand(buf, bufSize, NULL);
     delete[] buf;
 }
 
@@ -33,11 +33,18 @@
 #include <string>
 #include <math.h>
 #include <map>
+#include <vector>
+#include <chrono>
 #include <sstream>
 #include <iomanip>
 
 #define ROBOVIS_PORT "32769"
 
+// the largest datagram sent to RoboViz. RoboViz reads draw commands
+// into a 512 byte buffer and drops the rest of longer datagrams, so
+// commands are packed into datagrams of at most this size
+#define RVDRAW_MAX_DATAGRAM 512
+
 //class RVSender;
 
 //RVSender* pRVSender;
@@ -51,10 +58,43 @@ inline int writeCharToBuf(unsigned char* buf, unsigned char value) {
     return 1;
 }
 
+// writes value as 6 ASCII characters with as many decimals as fit,
+// i.e. the first 6 characters of "%6f" with the last digit rounded
 inline int writeFloatToBuf(unsigned char* buf, float value) {
-    char temp[20];
-    snprintf(temp, sizeof(temp), "%6f", value);
-    memcpy(buf, temp, 6);
+    double a = fabs(value);
+
+    // large values and NaN take the slow path
+    if (!(a < 9999.5)) {
+        char temp[20];
+        snprintf(temp, sizeof(temp), "%6f", value);
+        memcpy(buf, temp, 6);
+        return 6;
+    }
+
+    static const double scale[] = {1, 10, 100, 1000, 10000};
+    static const unsigned limit[] = {1, 10, 100, 1000, 10000, 100000};
+
+    int sign = (value < 0) ? 1 : 0;
+    int intDigits = (a < 10) ? 1 : (a < 100) ? 2 : (a < 1000) ? 3 : 4;
+    int decimals = 6 - sign - intDigits - 1;
+
+    unsigned n = (unsigned)(a * scale[decimals] + 0.5);
+    if (n >= limit[intDigits + decimals]) {
+        // rounding carried into another integer digit, e.g. 9.99996
+        ++intDigits;
+        --decimals;
+        n /= 10;
+    }
+
+    int i = 5;
+    for (int d = 0; d < decimals; ++d, n /= 10)
+        buf[i--] = '0' + n % 10;
+    buf[i--] = '.';
+    for (int d = 0; d < intDigits; ++d, n /= 10)
+        buf[i--] = '0' + n % 10;
+    if (sign)
+        buf[0] = '-';
+
     return 6;
 }
 
@@ -97,6 +137,29 @@ private:
     struct addrinfo p;
     bool socketCreated;
 
+    //the shape commands of a drawing set since its last swapBuffers
+    struct PendingSet {
+        string commands;
+        vector<int> sizes;
+    };
+    map<string, PendingSet> pendingSets;
+
+    //the commands to send, packed into datagrams
+    vector<string> datagrams;
+    size_t numDatagrams;
+    int frameDepth;
+
+    //swap rate limits, see setMaxSwapRate
+    float defaultMaxSwapRate;
+    map<string, float> maxSwapRates;
+    map<string, std::chrono::steady_clock::time_point> lastSwapTimes;
+
+    void init();
+    void queueCommand(unsigned char* buf, int bufSize, const string* setName);
+    void appendCommand(const char* buf, int bufSize);
+    bool acceptSwap(const string& setName);
+    void flush();
+
     unsigned char* newBufferSwap(const string* name, int* bufSize);
     unsigned char* newCircle(const float* center,
                              float radius, float thickness,
@@ -177,6 +240,23 @@ public:
      *  You can use the RVSender::Color enum to specify colors, or specify your own r,g,b values.
      */
 
+    /*
+     *  The commands are not sent one datagram each. Shapes are kept
+     *  per drawing set until the set is swapped, and swapBuffers sends
+     *  them packed into as few datagrams as possible. Wrap the drawing
+     *  of a cycle in beginFrame() and endFrame() to send all sets
+     *  swapped in between at once.
+     */
+    void beginFrame();
+    void endFrame();
+
+    /*
+     *  Limits how often per second the drawing set setName (or every
+     *  set, if setName is NULL) is swapped. The shapes of swaps that
+     *  come faster are dropped. 0 (the default) means no limit.
+     */
+    void setMaxSwapRate(float swapsPerSecond, const string* setName = NULL);
+
     /* draws all elements of drawings map to the screen */
     void refresh();
 
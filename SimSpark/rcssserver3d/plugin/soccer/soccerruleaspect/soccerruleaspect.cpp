@@ -132,8 +132,7 @@ SoccerRuleAspect::SoccerRuleAspect() :
     mBallHoldResetTime(0.5),
     mBallHoldMaxDistance(1.0),
     mBallHoldOppDistance(0.75),
-    mBallHoldBeamPenalty(false),
-    mRng(random_device()())
+    mBallHoldBeamPenalty(false)
 {
     mFreeKickPos = Vector3f(0.0,0.0,mBallRadius);
     ResetFoulCounter(TI_LEFT);
@@ -251,7 +250,7 @@ SoccerRuleAspect::AutomaticSimpleReferee()
         AnalyseFouls(TI_LEFT);   		// Analyzes simple fouls for the left team
         AnalyseFouls(TI_RIGHT);   		// Analyzes simple fouls for the right team
 
-        if (rand()%2 == 0) {
+        if (salt::RandomEngine::instance()() % 2 == 0) {
             AnalyseTouchGroups(TI_LEFT);            // Analyzes whether too many players are touching for the left team
             AnalyseTouchGroups(TI_RIGHT);           // Analyzes whether too many players are touching for the right team
         } else {
@@ -259,7 +258,7 @@ SoccerRuleAspect::AutomaticSimpleReferee()
             AnalyseTouchGroups(TI_LEFT);            // Analyzes whether too many players are touching for the left team
         }
 
-        if (rand()%2 == 0) {
+        if (salt::RandomEngine::instance()() % 2 == 0) {
             ClearPlayersAutomatic(TI_LEFT);   	// enforce standing and not overcrowding rules for left team
             ClearPlayersAutomatic(TI_RIGHT);  	// enforce standing and not overcrowding rules for right team
         } else {
@@ -852,6 +851,7 @@ void SoccerRuleAspect::AnalyseChargingFouls()
 
 #ifdef RVDRAW
             if (mRVSender) {
+                mRVSender->beginFrame();
                 mRVSender->clearStaticDrawings();
                 for (auto& cInfo : (*asIt)->GetOppCollisionPosInfoVec())
                 {
@@ -872,6 +872,7 @@ void SoccerRuleAspect::AnalyseChargingFouls()
                 if (agentCollisionSpeed[1] > 0) {
                     mRVSender->drawLine(agentPos[1].x(), agentPos[1].y(), agentPos[1].x()+(agentCollisionSpeed[1]*agentToCollisionVec[1].x()), agentPos[1].y()+(agentCollisionSpeed[1]*agentToCollisionVec[1].y()), RVSender::YELLOW, !isCharging[1]);
                 }
+                mRVSender->endFrame();
             }
 #endif // RVDRAW
             
@@ -941,7 +942,7 @@ void SoccerRuleAspect::AnalyseTouchGroups(TTeamIndex idx, bool fOnlyProcessNewly
     if (! SoccerBase::GetAgentStates(*mBallState.get(), agent_states, idx))
         return;
 
-    shuffle(agent_states.begin(), agent_states.end(), mRng);
+    shuffle(agent_states.begin(), agent_states.end(), salt::RandomEngine::instance());
 
     SoccerBase::TAgentStateList::iterator i = agent_states.begin();
     for (; i != agent_states.end(); ++i)
@@ -974,7 +975,7 @@ void SoccerRuleAspect::AnalyseTouchGroups(TTeamIndex idx, bool fOnlyProcessNewly
 
             // Randomize order of agent states in touch group to remove any bias in order before processing
             SoccerBase::TAgentStateList touchGroupList(touchGroup->begin(), touchGroup->end());
-            shuffle(touchGroupList.begin(), touchGroupList.end(), mRng);
+            shuffle(touchGroupList.begin(), touchGroupList.end(), salt::RandomEngine::instance());
 
             for (SoccerBase::TAgentStateList::iterator agentIt = touchGroupList.begin();
                     agentIt != touchGroupList.end(); ++agentIt)
@@ -1277,7 +1278,7 @@ void SoccerRuleAspect::AnalyseFouls(TTeamIndex idx)
     // Randomize order of agents evaluated
     std::vector<unsigned int> unums(11);
     for (unsigned int i = 0; i < unums.size(); i++) {unums[i] = i+1;}
-    shuffle(unums.begin(), unums.end(), mRng);
+    shuffle(unums.begin(), unums.end(), salt::RandomEngine::instance());
 
     for(std::vector<unsigned int>::const_iterator it = unums.begin(); it != unums.end(); ++it)
     {
@@ -1732,7 +1733,7 @@ SoccerRuleAspect::ClearPlayersAutomatic(TTeamIndex idx)
     if (! SoccerBase::GetAgentStates(*mBallState.get(), agent_states, idx))
         return;
 
-    shuffle(agent_states.begin(), agent_states.end(), mRng);
+    shuffle(agent_states.begin(), agent_states.end(), salt::RandomEngine::instance());
 
     salt::Vector3f ballPos = mBallBody->GetPosition();
 
@@ -1791,7 +1792,7 @@ SoccerRuleAspect::ClearPlayers(const salt::Vector3f& pos, float radius,
     if (! SoccerBase::GetAgentStates(*mBallState.get(), agent_states, idx))
         return;
 
-    shuffle(agent_states.begin(), agent_states.end(), mRng);
+    shuffle(agent_states.begin(), agent_states.end(), salt::RandomEngine::instance());
 
     salt::BoundingSphere sphere(pos, radius);
     std::shared_ptr<oxygen::Transform> agent_aspect;
@@ -1841,7 +1842,7 @@ SoccerRuleAspect::ClearPlayers(const salt::AABB2& box,
     if (! SoccerBase::GetAgentStates(*mBallState.get(), agent_states, idx))
         return;
 
-    shuffle(agent_states.begin(), agent_states.end(), mRng);
+    shuffle(agent_states.begin(), agent_states.end(), salt::RandomEngine::instance());
 
     SoccerBase::TAgentStateList::const_iterator i;
     for (i = agent_states.begin(); i != agent_states.end(); ++i)
@@ -1897,7 +1898,7 @@ void SoccerRuleAspect::ClearPlayersBeforeKickOff(TTeamIndex idx)
     if (! SoccerBase::GetAgentStates(*mBallState.get(), agent_states, idx))
         return;
 
-    shuffle(agent_states.begin(), agent_states.end(), mRng);
+    shuffle(agent_states.begin(), agent_states.end(), salt::RandomEngine::instance());
 
     salt::AABB2 box;
     if ( TI_RIGHT == idx ){
@@ -2002,7 +2003,7 @@ SoccerRuleAspect::RepelPlayers(const salt::Vector3f& pos, float radius,
     if (! SoccerBase::GetAgentStates(*mBallState.get(), agent_states, idx))
         return;
 
-    shuffle(agent_states.begin(), agent_states.end(), mRng);
+    shuffle(agent_states.begin(), agent_states.end(), salt::RandomEngine::instance());
 
     std::shared_ptr<oxygen::Transform> agent_aspect;
     SoccerBase::TAgentStateList::const_iterator i;
@@ -2306,7 +2307,7 @@ SoccerRuleAspect::ClearSelectedPlayers()
     if (! SoccerBase::GetAgentStates(*mBallState.get(), agent_states, TI_NONE))
         return;
 
-    shuffle(agent_states.begin(), agent_states.end(), mRng);
+    shuffle(agent_states.begin(), agent_states.end(), salt::RandomEngine::instance());
 
     std::shared_ptr<oxygen::Transform> agent_aspect;
     SoccerBase::TAgentStateList::const_iterator i;
@@ -2393,7 +2394,7 @@ SoccerRuleAspect::DropBall(Vector3f pos)
 
     MoveBall(pos);
 
-    if (rand()%2 == 0) 
+    if (salt::RandomEngine::instance()() % 2 == 0) 
     {
         ClearPlayers(pos, mFreeKickDist, mFreeKickMoveDist, TI_LEFT);
         ClearPlayers(pos, mFreeKickDist, mFreeKickMoveDist, TI_RIGHT);
@@ -2434,7 +2435,7 @@ SoccerRuleAspect::UpdateBeforeKickOff()
     
     if (!mStartAnyFieldPosition && !mPenaltyShootout)
     {
-        if (rand()%2 == 0) 
+        if (salt::RandomEngine::instance()() % 2 == 0) 
         {
             ClearPlayers(mRightHalf, mFreeKickMoveDist, TI_LEFT);
             ClearPlayers(mLeftHalf, mFreeKickMoveDist, TI_RIGHT);
@@ -3444,6 +3445,10 @@ void
 SoccerRuleAspect::Update(float deltaTime)
 {
     mDeltaTime = deltaTime;
+
+    // all agents acted, the perceptors run after this update
+    DeliverSaidMessages();
+
     if (
         (mGameState.get() == 0) ||
         (mBallState.get() == 0) ||
@@ -3674,6 +3679,12 @@ SoccerRuleAspect::OnUnlink()
     mGameState.reset();
     mBallState.reset();
     mBallBody.reset();
+
+    mSaidMessages.clear();
+    for (int i = 0; i < 2; ++i)
+    {
+        mSayListeners[i].states.clear();
+    }
 }
 
 void
@@ -3809,81 +3820,156 @@ void
 SoccerRuleAspect::Broadcast(const string& message, const Vector3f& pos,
                             int number, TTeamIndex idx)
 {
-    SoccerBase::TAgentStateList agent_states;
-    if (! SoccerBase::GetAgentStates(*mBallState.get(), agent_states, idx))
+    if (
+        (static_cast<int>(message.size()) > mSayMsgSize) ||
+        ((idx != TI_LEFT) && (idx != TI_RIGHT))
+        )
     {
         return;
     }
 
-    SoccerBase::TAgentStateList opponent_agent_states;
-    if (! SoccerBase::GetAgentStates(*mBallState.get(), opponent_agent_states,
-                                     SoccerBase::OpponentTeam(idx)))
+    // the players don't move while the agents act, so their positions
+    // are looked up once for all messages of the cycle
+    if (mSaidMessages.empty() && ! CollectSayListeners())
     {
         return;
     }
 
-    if (static_cast<int>(message.size()) > mSayMsgSize)
+    const SayListeners& team = mSayListeners[idx - TI_LEFT];
+    if (team.states.empty())
     {
         return;
     }
 
-    salt::BoundingSphere sphere(pos, mAudioCutDist);
+    SaidMessage said;
+    said.text = std::make_shared<const string>(message);
+    said.team = std::make_shared<const string>
+        (team.states.front()->GetPerceptName(ObjectState::PT_Player));
+    said.pos = pos;
+    said.number = number;
+    said.idx = idx;
 
-    std::shared_ptr<Transform> transform_parent;
-    std::shared_ptr<RigidBody> agent_body;
+    mSaidMessages.push_back(said);
+}
 
-    std::string team = "";
+bool
+SoccerRuleAspect::CollectSayListeners()
+{
+    if (mBallState.get() == 0)
+    {
+        return false;
+    }
 
-    for (
-        SoccerBase::TAgentStateList::const_iterator it = agent_states.begin();
-        it != agent_states.end();
-        it++
-        )
+    for (int i = 0; i < 2; ++i)
     {
-        // Get name of team to label all messages with
-        team = (*it)->GetPerceptName(ObjectState::PT_Player);
-        if ( (*it)->GetUniformNumber() == number)
+        SayListeners& listeners = mSayListeners[i];
+        listeners.states.clear();
+        listeners.numbers.clear();
+        listeners.x.clear();
+        listeners.y.clear();
+        listeners.z.clear();
+
+        SoccerBase::TAgentStateList agent_states;
+        if (! SoccerBase::GetAgentStates(*mBallState.get(), agent_states,
+                                         static_cast<TTeamIndex>(TI_LEFT + i)))
         {
-            (*it)->AddSelfMessage(message);
-            continue;
+            return false;
         }
-        SoccerBase::GetTransformParent(*(*it), transform_parent);
 
-        // call GetAgentBody with matching AgentAspect
-        SoccerBase::GetAgentBody(transform_parent, agent_body);
+        std::shared_ptr<Transform> transform_parent;
+        std::shared_ptr<RigidBody> agent_body;
 
-        // if the player is in the range, send the message
-        Vector3f new_pos = agent_body->GetPosition();
-        if (sphere.Contains(new_pos))
+        for (
+            SoccerBase::TAgentStateList::const_iterator it = agent_states.begin();
+            it != agent_states.end();
+            it++
+            )
         {
-            Vector3f relPos = pos - new_pos;
-            relPos = SoccerBase::FlipView(relPos, idx);
-            float direction = salt::gRadToDeg(salt::gArcTan2(relPos[1], relPos[0]));
-            (*it)->AddMessage(message, team, direction, true);
+            // call GetAgentBody with matching AgentAspect
+            if (
+                (! SoccerBase::GetTransformParent(*(*it), transform_parent)) ||
+                (! SoccerBase::GetAgentBody(transform_parent, agent_body))
+                )
+            {
+                continue;
+            }
+
+            Vector3f agent_pos = agent_body->GetPosition();
+            listeners.states.push_back(*it);
+            listeners.numbers.push_back((*it)->GetUniformNumber());
+            listeners.x.push_back(agent_pos.x());
+            listeners.y.push_back(agent_pos.y());
+            listeners.z.push_back(agent_pos.z());
         }
+
+        listeners.inRange.resize(listeners.states.size());
     }
 
-    for (
-        SoccerBase::TAgentStateList::const_iterator it = opponent_agent_states.begin();
-        it != opponent_agent_states.end();
-        it++
-        )
+    return true;
+}
+
+template<bool teamMate>
+void
+SoccerRuleAspect::DeliverSaidMessage(const SaidMessage& said,
+                                     SayListeners& listeners)
+{
+    const int count = static_cast<int>(listeners.states.size());
+    const float* x = listeners.x.data();
+    const float* y = listeners.y.data();
+    const float* z = listeners.z.data();
+    unsigned char* inRange = listeners.inRange.data();
+
+    const float cx = said.pos.x();
+    const float cy = said.pos.y();
+    const float cz = said.pos.z();
+    const float radiusSq = mAudioCutDist * mAudioCutDist;
+
+    // branch free, so the compiler can vectorize it
+    for (int i = 0; i < count; ++i)
     {
-        SoccerBase::GetTransformParent(*(*it), transform_parent);
+        const float dx = cx - x[i];
+        const float dy = cy - y[i];
+        const float dz = cz - z[i];
+        inRange[i] = (dx * dx + dy * dy + dz * dz < radiusSq);
+    }
 
-        // call GetAgentBody with matching AgentAspect
-        SoccerBase::GetAgentBody(transform_parent, agent_body);
+    for (int i = 0; i < count; ++i)
+    {
+        AgentState& state = *listeners.states[i];
 
-        // if the player is in the range, send the message
-        Vector3f new_pos = agent_body->GetPosition();
-        if (sphere.Contains(new_pos))
+        if (teamMate && listeners.numbers[i] == said.number)
+        {
+            state.AddSelfMessage(*said.text);
+            continue;
+        }
+
+        if (! inRange[i])
         {
-            Vector3f relPos = pos - new_pos;
-            relPos = SoccerBase::FlipView(relPos, SoccerBase::OpponentTeam(idx));
-            float direction = salt::gRadToDeg(salt::gArcTan2(relPos[1], relPos[0]));
-            (*it)->AddMessage(message, team, direction, false);
+            continue;
         }
+
+        Vector3f relPos(cx - x[i], cy - y[i], cz - z[i]);
+        relPos = SoccerBase::FlipView(relPos, state.GetTeamIndex());
+        float direction = salt::gRadToDeg(salt::gArcTan2(relPos[1], relPos[0]));
+        state.AddMessage(said.text, said.team, direction, teamMate);
+    }
+}
+
+void
+SoccerRuleAspect::DeliverSaidMessages()
+{
+    for (
+        std::vector<SaidMessage>::const_iterator it = mSaidMessages.begin();
+        it != mSaidMessages.end();
+        ++it
+        )
+    {
+        const int team = it->idx - TI_LEFT;
+        DeliverSaidMessage<true>(*it, mSayListeners[team]);
+        DeliverSaidMessage<false>(*it, mSayListeners[1 - team]);
     }
+
+    mSaidMessages.clear();
 }
 
 bool
@@ -4191,7 +4277,7 @@ SoccerRuleAspect::ClearPlayersWithException(const salt::Vector3f& pos,
     if (! SoccerBase::GetAgentStates(*mBallState.get(), agent_states, idx))
         return;
 
-    shuffle(agent_states.begin(), agent_states.end(), mRng);
+    shuffle(agent_states.begin(), agent_states.end(), salt::RandomEngine::instance());
 
     salt::BoundingSphere sphere(pos, radius);
     std::shared_ptr<oxygen::Transform> agent_aspect;
@@ -212,7 +212,9 @@ public:
     */
     void AutomaticSimpleReferee();
 
-    /** broadcast a said message to all players
+    /** broadcast a said message to all players. The message is
+        stored once and handed to the players in range on the next
+        Update(), see DeliverSaidMessages()
         \param message said message-
         \param pos positon of the player-
         \param num uniform number-
@@ -298,6 +300,45 @@ protected:
     /** checks if the penalty shootout is over */
     void CheckPenaltyShootoutEnd();
 
+    /** a message said in the current cycle; the text is shared by all
+        players that hear it
+    */
+    struct SaidMessage
+    {
+        std::shared_ptr<const std::string> text;
+        std::shared_ptr<const std::string> team;
+        salt::Vector3f pos;
+        int number;
+        TTeamIndex idx;
+    };
+
+    /** the players of one team that can hear the said messages, with
+        their positions at the time of the first message of the cycle
+    */
+    struct SayListeners
+    {
+        std::vector<std::shared_ptr<AgentState> > states;
+        std::vector<int> numbers;
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+        std::vector<unsigned char> inRange;
+    };
+
+    /** collects the players of both teams and their positions;
+        returns false if the players can't be looked up
+    */
+    bool CollectSayListeners();
+
+    /** hands all messages said in this cycle to the players in range,
+        with one distance pass over the players of each team per message
+    */
+    void DeliverSaidMessages();
+
+    /** hands a said message to the listeners of one team */
+    template<bool teamMate>
+    void DeliverSaidMessage(const SaidMessage& said, SayListeners& listeners);
+
     /** updates the RuleAspect during BeforeKickOff mode */
     void UpdateBeforeKickOff();
 
@@ -551,6 +592,11 @@ protected:
     /** max distance that player can hear a message */
     float mAudioCutDist;
 
+    /** the messages said in the current cycle, in order */
+    std::vector<SaidMessage> mSaidMessages;
+    /** the listeners of the left and the right team */
+    SayListeners mSayListeners[2];
+
     //FCP 2010 - New Parameters (added by FCPortugal for Singapure 2010)
     /** max time player may be sitted or laying down before being repositioned */
     int mNotStandingMaxTime;
@@ -791,9 +837,6 @@ protected:
     /** Output file stream for writing self collision information */
     std::ofstream selfCollisionsFile;
 
-    /** Random number generator for use with the shuffle function */
-    std::mt19937 mRng;
-
     /** the team that is currently kicking in a penalty shootout */
     TTeamIndex mPenaltyShootoutCurrentKickerTeam;
     /** the current penalty shootout kicker */
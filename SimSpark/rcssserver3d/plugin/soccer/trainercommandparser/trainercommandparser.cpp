@@ -31,12 +31,123 @@
 #include <gamestateaspect/gamestateaspect.h>
 #include <oxygen/agentaspect/agentaspect.h>
 #include "trainercommandparser.h"
+#include <cstring>
+#include <set>
 
 using namespace std;
 using namespace salt;
 using namespace zeitgeist;
 using namespace oxygen;
 
+const char* TrainerCommandParser::BINARY_SCENARIO_MAGIC = "SSCN1";
+
+namespace
+{
+    /** reads the little endian values of a binary scenario */
+    class BinaryReader
+    {
+    public:
+        BinaryReader(const string& data)
+            : mPos(data.data()), mEnd(data.data() + data.size()) {}
+
+        bool Skip(size_t n)
+        {
+            if ((size_t)(mEnd - mPos) < n)
+            {
+                return false;
+            }
+
+            mPos += n;
+            return true;
+        }
+
+        bool Read(unsigned char& value)
+        {
+            if (mPos >= mEnd)
+            {
+                return false;
+            }
+
+            value = (unsigned char)*mPos++;
+            return true;
+        }
+
+        bool Read(float& value)
+        {
+            unsigned char b[4];
+            if (! Read(b[0]) || ! Read(b[1]) || ! Read(b[2]) || ! Read(b[3]))
+            {
+                return false;
+            }
+
+            const uint32_t bits =
+                (uint32_t)b[0] | ((uint32_t)b[1] << 8) |
+                ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+
+            memcpy(&value, &bits, sizeof(value));
+            return true;
+        }
+
+        bool Read(Vector3f& value)
+        {
+            return Read(value[0]) && Read(value[1]) && Read(value[2]);
+        }
+
+        bool Read(string& value, size_t length)
+        {
+            const char* start = mPos;
+            if (! Skip(length))
+            {
+                return false;
+            }
+
+            value.assign(start, length);
+            return true;
+        }
+
+        /** returns true if all data was read, except for the '\0'
+            NetMessage::Extract() appends to a received message */
+        bool AtMessageEnd() const
+        {
+            return (mPos == mEnd) || ((mPos + 1 == mEnd) && (*mPos == '\0'));
+        }
+
+    protected:
+        const char* mPos;
+        const char* mEnd;
+    };
+
+    /** rotates the bodies by angle degrees around the axis through
+        anchor and stops them */
+    void RotateBodies(const vector<std::shared_ptr<RigidBody> >& bodies,
+                      const Vector3f& anchor, Vector3f axis, float angle)
+    {
+        axis.Normalize();
+
+        const float c = gCos(gDegToRad(angle));
+        const float s = gSin(gDegToRad(angle));
+        const float t = 1.0f - c;
+        const float x = axis[0];
+        const float y = axis[1];
+        const float z = axis[2];
+
+        const Matrix rot(t*x*x + c,   t*x*y - s*z, t*x*z + s*y, 0,
+                         t*x*y + s*z, t*y*y + c,   t*y*z - s*x, 0,
+                         t*x*z - s*y, t*y*z + s*x, t*z*z + c,   0,
+                         0,           0,           0,           1);
+
+        for (size_t i = 0; i < bodies.size(); ++i)
+        {
+            const std::shared_ptr<RigidBody>& body = bodies[i];
+
+            body->SetPosition(anchor + rot.Rotate(body->GetPosition() - anchor));
+            body->SetRotation(rot * body->GetRotation());
+            body->SetVelocity(Vector3f(0,0,0));
+            body->SetAngularVelocity(Vector3f(0,0,0));
+        }
+    }
+}
+
 TrainerCommandParser::TrainerCommandParser() : MonitorCmdParser()
 {
     // setup command map
@@ -53,6 +164,7 @@ TrainerCommandParser::TrainerCommandParser() : MonitorCmdParser()
     mCommandMap["reqfullstate"] = CT_REQFULLSTATE;
     mCommandMap["time"] = CT_TIME;
     mCommandMap["score"] = CT_SCORE;
+    mCommandMap["scenario"] = CT_SCENARIO;
 
     // setup team index map
     // Originally  team sides were "L","R" and "N"
@@ -157,6 +269,13 @@ void TrainerCommandParser::ParseMonitorMessage(const std::string& data)
         return;
     }
 
+    if (data.compare(0, strlen(BINARY_SCENARIO_MAGIC), BINARY_SCENARIO_MAGIC) == 0)
+    {
+        SoccerBase::GetGameState(*this,mGameState);
+        ParseBinaryScenario(data);
+        return;
+    }
+
     std::shared_ptr<PredicateList> predList = mSexpParser->Parse(data);
     ParsePredicates(*predList);
 }
@@ -246,6 +365,9 @@ TrainerCommandParser::ParsePredicate(const oxygen::Predicate & predicate)
     case CT_SCORE:
         ParseScoreCommand(predicate);
         break;
+    case CT_SCENARIO:
+        ParseScenarioCommand(predicate);
+        break;
 
     default:
         return false;
@@ -826,3 +948,565 @@ void TrainerCommandParser::ParseScoreCommand(const oxygen::Predicate & predicate
 
     mGameState->SetScores(scoreLeft, scoreRight);
 }
+
+void TrainerCommandParser::ParseScenarioCommand(const oxygen::Predicate & predicate)
+{
+    Scenario scenario;
+
+    for (
+         ParameterList::TVector::const_iterator iter = predicate.parameter.begin();
+         iter != predicate.parameter.end();
+         ++iter
+         )
+    {
+        const ParameterList* list = any_cast<ParameterList>(&(*iter));
+        string name;
+
+        if (
+            (list == 0) ||
+            (list->IsEmpty()) ||
+            (! list->GetValue(list->begin(), name))
+            )
+        {
+            GetLog()->Error()
+                << "(TrainerCommandParser) ERROR: invalid scenario element\n";
+            return;
+        }
+
+        ParameterList::TVector::const_iterator value = list->begin();
+        ++value;
+
+        if (name == "playMode")
+        {
+            string mode;
+            TPlayModeMap::const_iterator playmode;
+
+            if (
+                (! list->GetValue(value, mode)) ||
+                ((playmode = mPlayModeMap.find(mode)) == mPlayModeMap.end())
+                )
+            {
+                GetLog()->Error()
+                    << "(TrainerCommandParser) ERROR: unknown scenario playmode "
+                    << mode << "\n";
+                return;
+            }
+
+            scenario.hasPlayMode = true;
+            scenario.playMode = playmode->second;
+        }
+        else if (name == "time")
+        {
+            if (
+                (! list->GetValue(value, scenario.time)) ||
+                (scenario.time < 0)
+                )
+            {
+                GetLog()->Error()
+                    << "(TrainerCommandParser) ERROR: invalid scenario time\n";
+                return;
+            }
+
+            scenario.hasTime = true;
+        }
+        else if (name == "ball")
+        {
+            Predicate::Iterator posParam(list);
+            if (predicate.FindParameter(posParam, "pos"))
+            {
+                if (! predicate.GetValue(posParam, scenario.ballPos))
+                {
+                    GetLog()->Error()
+                        << "(TrainerCommandParser) ERROR: can't get scenario ball pos\n";
+                    return;
+                }
+
+                scenario.hasBallPos = true;
+            }
+
+            Predicate::Iterator velParam(list);
+            if (predicate.FindParameter(velParam, "vel"))
+            {
+                if (! predicate.GetValue(velParam, scenario.ballVel))
+                {
+                    GetLog()->Error()
+                        << "(TrainerCommandParser) ERROR: can't get scenario ball vel\n";
+                    return;
+                }
+
+                scenario.hasBallVel = true;
+            }
+        }
+        else if (name == "agent")
+        {
+            scenario.agents.push_back(ScenarioAgent());
+            if (! ParseScenarioAgent(*list, scenario.agents.back()))
+            {
+                return;
+            }
+        }
+        else
+        {
+            GetLog()->Error()
+                << "(TrainerCommandParser) ERROR: unknown scenario element "
+                << name << "\n";
+            return;
+        }
+    }
+
+    ApplyScenario(scenario);
+}
+
+bool TrainerCommandParser::ParseScenarioAgent(const ParameterList& list,
+                                              ScenarioAgent& agent)
+{
+    // the agent list is parsed with the helpers of an empty predicate
+    Predicate predicate;
+
+    string team;
+    Predicate::Iterator teamParam(&list);
+    Predicate::Iterator unumParam(&list);
+
+    TTeamIndexMap::const_iterator teamIndex;
+
+    if (
+        (! predicate.FindParameter(teamParam, "team")) ||
+        (! predicate.GetValue(teamParam, team)) ||
+        ((teamIndex = mTeamIndexMap.find(team)) == mTeamIndexMap.end()) ||
+        (! predicate.FindParameter(unumParam, "unum")) ||
+        (! predicate.GetValue(unumParam, agent.unum))
+        )
+    {
+        GetLog()->Error()
+            << "(TrainerCommandParser) ERROR: scenario agent needs team and unum\n";
+        return false;
+    }
+
+    agent.team = teamIndex->second;
+
+    Predicate::Iterator posParam(&list);
+    if (predicate.FindParameter(posParam, "pos"))
+    {
+        if (! predicate.GetValue(posParam, agent.pos))
+        {
+            GetLog()->Error()
+                << "(TrainerCommandParser) ERROR: can't get scenario agent pos\n";
+            return false;
+        }
+
+        agent.hasPos = true;
+    }
+
+    Predicate::Iterator rotParam(&list);
+    if (predicate.FindParameter(rotParam, "rot"))
+    {
+        if (! predicate.GetValue(rotParam, agent.rot))
+        {
+            GetLog()->Error()
+                << "(TrainerCommandParser) ERROR: can't get scenario agent rot\n";
+            return false;
+        }
+
+        agent.hasRot = true;
+    }
+
+    // (joints (<name> <angle>) ...)
+    Predicate::Iterator jointParam(&list);
+    if (predicate.FindParameter(jointParam, "joints"))
+    {
+        for (; jointParam != jointParam.end(); ++jointParam)
+        {
+            const ParameterList* joint = any_cast<ParameterList>(&(*jointParam));
+
+            string name;
+            float angle;
+
+            if (
+                (joint == 0) ||
+                (joint->GetSize() != 2) ||
+                (! joint->GetValue(joint->begin(), name)) ||
+                (! joint->GetValue(++joint->begin(), angle))
+                )
+            {
+                GetLog()->Error()
+                    << "(TrainerCommandParser) ERROR: invalid scenario joint\n";
+                return false;
+            }
+
+            agent.joints.push_back(make_pair(name, angle));
+        }
+    }
+
+    return true;
+}
+
+void TrainerCommandParser::ParseBinaryScenario(const std::string& data)
+{
+    BinaryReader reader(data);
+    Scenario scenario;
+
+    unsigned char flags = 0;
+    unsigned char numAgents = 0;
+    bool ok = reader.Skip(strlen(BINARY_SCENARIO_MAGIC)) && reader.Read(flags);
+
+    if (ok && (flags & 1))
+    {
+        unsigned char playMode = 0;
+        ok = reader.Read(playMode) && (playMode < PM_NONE);
+        scenario.hasPlayMode = true;
+        scenario.playMode = (TPlayMode)playMode;
+    }
+
+    if (ok && (flags & 2))
+    {
+        ok = reader.Read(scenario.time) && (scenario.time >= 0);
+        scenario.hasTime = true;
+    }
+
+    if (ok && (flags & 4))
+    {
+        ok = reader.Read(scenario.ballPos);
+        scenario.hasBallPos = true;
+    }
+
+    if (ok && (flags & 8))
+    {
+        ok = reader.Read(scenario.ballVel);
+        scenario.hasBallVel = true;
+    }
+
+    ok = ok && reader.Read(numAgents);
+    scenario.agents.resize(ok ? numAgents : 0);
+
+    for (size_t i = 0; ok && i < scenario.agents.size(); ++i)
+    {
+        ScenarioAgent& agent = scenario.agents[i];
+
+        unsigned char team = 0;
+        unsigned char unum = 0;
+        unsigned char agentFlags = 0;
+        unsigned char numJoints = 0;
+
+        ok = reader.Read(team) && reader.Read(unum) && reader.Read(agentFlags) &&
+            (team == TI_LEFT || team == TI_RIGHT);
+
+        agent.team = (TTeamIndex)team;
+        agent.unum = unum;
+
+        if (ok && (agentFlags & 1))
+        {
+            ok = reader.Read(agent.pos);
+            agent.hasPos = true;
+        }
+
+        if (ok && (agentFlags & 2))
+        {
+            ok = reader.Read(agent.rot);
+            agent.hasRot = true;
+        }
+
+        ok = ok && reader.Read(numJoints);
+        agent.joints.resize(ok ? numJoints : 0);
+
+        for (size_t j = 0; ok && j < agent.joints.size(); ++j)
+        {
+            unsigned char length = 0;
+            ok = reader.Read(length) &&
+                reader.Read(agent.joints[j].first, length) &&
+                reader.Read(agent.joints[j].second);
+        }
+    }
+
+    if (! ok || ! reader.AtMessageEnd())
+    {
+        GetLog()->Error()
+            << "(TrainerCommandParser) ERROR: invalid binary scenario\n";
+        return;
+    }
+
+    ApplyScenario(scenario);
+}
+
+void TrainerCommandParser::ApplyScenario(const Scenario& scenario)
+{
+    if (scenario.hasPlayMode || scenario.hasTime)
+    {
+        if (mGameState.get() == 0)
+        {
+            GetLog()->Error()
+                << "(TrainerCommandParser) ERROR: no GameStateAspect found, "
+                << "can't apply scenario\n";
+            return;
+        }
+    }
+
+    std::shared_ptr<RigidBody> ballBody;
+    if (scenario.hasBallPos || scenario.hasBallVel)
+    {
+        if (! SoccerBase::GetBallBody(*this, ballBody))
+        {
+            GetLog()->Error()
+                << "(TrainerCommandParser) ERROR: can't get ball body, "
+                << "can't apply scenario\n";
+            return;
+        }
+    }
+
+    // index the agents by team and uniform number once, instead of
+    // searching all agents for every agent of the scenario
+    typedef std::map<std::pair<int, int>, std::shared_ptr<AgentState> > TAgentIndex;
+    TAgentIndex agentIndex;
+
+    if (! scenario.agents.empty())
+    {
+        SoccerBase::TAgentStateList agentStates;
+        SoccerBase::GetAgentStates(*this, agentStates, TI_NONE);
+
+        for (
+             SoccerBase::TAgentStateList::const_iterator iter = agentStates.begin();
+             iter != agentStates.end();
+             ++iter
+             )
+        {
+            agentIndex[make_pair((int)(*iter)->GetTeamIndex(),
+                                 (*iter)->GetUniformNumber())] = (*iter);
+        }
+    }
+
+    // look up everything before the first change
+    std::vector<std::shared_ptr<Transform> > agentAspects(scenario.agents.size());
+    std::vector<std::vector<JointPose> > jointPoses(scenario.agents.size());
+    std::vector<Vector3f> agentPos(scenario.agents.size());
+
+    for (size_t i = 0; i < scenario.agents.size(); ++i)
+    {
+        const ScenarioAgent& agent = scenario.agents[i];
+
+        TAgentIndex::const_iterator iter =
+            agentIndex.find(make_pair((int)agent.team, agent.unum));
+
+        if (
+            (iter == agentIndex.end()) ||
+            (! SoccerBase::GetTransformParent(*(iter->second), agentAspects[i]))
+            )
+        {
+            GetLog()->Error()
+                << "(TrainerCommandParser) ERROR: can't get agent "
+                << agent.unum << " of team " << (int)agent.team
+                << ", can't apply scenario\n";
+            return;
+        }
+
+        if (! GetJointPoses(agentAspects[i], agent, jointPoses[i]))
+        {
+            return;
+        }
+
+        // a rotation without a position keeps the agent where it is
+        agentPos[i] = agent.pos;
+        if (agent.hasRot && (! agent.hasPos))
+        {
+            std::shared_ptr<RigidBody> body;
+            if (! SoccerBase::GetAgentBody(agentAspects[i], body))
+            {
+                GetLog()->Error()
+                    << "(TrainerCommandParser) ERROR: can't get body of agent "
+                    << agent.unum << " of team " << (int)agent.team
+                    << ", can't apply scenario\n";
+                return;
+            }
+
+            agentPos[i] = body->GetPosition();
+        }
+    }
+
+    // apply the whole scenario
+    if (scenario.hasPlayMode)
+    {
+        mGameState->SetPlayMode(scenario.playMode);
+    }
+
+    if (scenario.hasTime)
+    {
+        mGameState->SetTime(scenario.time);
+    }
+
+    if (scenario.hasBallPos)
+    {
+        ballBody->SetPosition(scenario.ballPos);
+    }
+
+    if (scenario.hasBallPos || scenario.hasBallVel)
+    {
+        ballBody->SetVelocity(scenario.hasBallVel ? scenario.ballVel : Vector3f(0,0,0));
+        ballBody->SetAngularVelocity(salt::Vector3f(0.0f,0.0f,0.0f));
+        ballBody->Enable();
+    }
+
+    for (size_t i = 0; i < scenario.agents.size(); ++i)
+    {
+        const ScenarioAgent& agent = scenario.agents[i];
+
+        if (agent.hasRot)
+        {
+            SoccerBase::MoveAndRotateAgent(agentAspects[i], agentPos[i], agent.rot);
+        }
+        else if (agent.hasPos)
+        {
+            SoccerBase::MoveAgent(agentAspects[i], agent.pos);
+        }
+
+        const std::vector<JointPose>& poses = jointPoses[i];
+        for (size_t j = 0; j < poses.size(); ++j)
+        {
+            SetJointPose(poses[j]);
+        }
+    }
+}
+
+bool TrainerCommandParser::GetJointPoses(std::shared_ptr<Transform> agent_aspect,
+                                         const ScenarioAgent& agent,
+                                         std::vector<JointPose>& poses)
+{
+    if (agent.joints.empty())
+    {
+        return true;
+    }
+
+    std::shared_ptr<Transform> parent = std::dynamic_pointer_cast<Transform>
+        (agent_aspect->FindParentSupportingClass<Transform>().lock());
+
+    std::shared_ptr<RigidBody> root;
+
+    if (
+        (parent.get() == 0) ||
+        (! SoccerBase::GetAgentBody(agent_aspect, root))
+        )
+    {
+        GetLog()->Error()
+            << "(TrainerCommandParser) ERROR: can't get body of agent "
+            << agent.unum << "\n";
+        return false;
+    }
+
+    // the joints by the names of their perceptors and effectors, and
+    // the joints of each body
+    typedef std::map<std::string, std::shared_ptr<HingeJoint> > TJointMap;
+    typedef std::map<RigidBody*, std::vector<std::shared_ptr<HingeJoint> > > TBodyJoints;
+
+    TJointMap jointMap;
+    TBodyJoints bodyJoints;
+
+    Leaf::TLeafList joints;
+    parent->ListChildrenSupportingClass<HingeJoint>(joints, true);
+
+    for (
+         Leaf::TLeafList::const_iterator iter = joints.begin();
+         iter != joints.end();
+         ++iter
+         )
+    {
+        std::shared_ptr<HingeJoint> joint = std::static_pointer_cast<HingeJoint>(*iter);
+
+        for (Leaf::TLeafList::const_iterator child = joint->begin(); child != joint->end(); ++child)
+        {
+            jointMap[(*child)->GetName()] = joint;
+        }
+
+        for (int b = 0; b < 2; ++b)
+        {
+            std::shared_ptr<RigidBody> body = joint->GetBody((Joint::EBodyIndex)b);
+            if (body.get() != 0)
+            {
+                bodyJoints[body.get()].push_back(joint);
+            }
+        }
+    }
+
+    // the joint tree, walked from the root body
+    std::map<HingeJoint*, std::shared_ptr<RigidBody> > childBody;
+    std::map<RigidBody*, std::vector<std::shared_ptr<RigidBody> > > children;
+
+    std::vector<std::shared_ptr<RigidBody> > open(1, root);
+    std::set<RigidBody*> visited;
+    visited.insert(root.get());
+
+    while (! open.empty())
+    {
+        std::shared_ptr<RigidBody> body = open.back();
+        open.pop_back();
+
+        const std::vector<std::shared_ptr<HingeJoint> >& adjacent = bodyJoints[body.get()];
+        for (size_t i = 0; i < adjacent.size(); ++i)
+        {
+            std::shared_ptr<RigidBody> other = adjacent[i]->GetBody(Joint::BI_FIRST);
+            if (other == body)
+            {
+                other = adjacent[i]->GetBody(Joint::BI_SECOND);
+            }
+
+            if (other.get() == 0 || ! visited.insert(other.get()).second)
+            {
+                continue;
+            }
+
+            childBody[adjacent[i].get()] = other;
+            children[body.get()].push_back(other);
+            open.push_back(other);
+        }
+    }
+
+    for (size_t i = 0; i < agent.joints.size(); ++i)
+    {
+        TJointMap::const_iterator iter = jointMap.find(agent.joints[i].first);
+
+        if (
+            (iter == jointMap.end()) ||
+            (childBody.find(iter->second.get()) == childBody.end())
+            )
+        {
+            GetLog()->Error()
+                << "(TrainerCommandParser) ERROR: can't get joint "
+                << agent.joints[i].first << " of agent " << agent.unum << "\n";
+            return false;
+        }
+
+        JointPose pose;
+        pose.joint = iter->second;
+        pose.angle = agent.joints[i].second;
+
+        // the bodies behind the joint move with it
+        pose.bodies.push_back(childBody[pose.joint.get()]);
+        for (size_t b = 0; b < pose.bodies.size(); ++b)
+        {
+            const std::vector<std::shared_ptr<RigidBody> >& next =
+                children[pose.bodies[b].get()];
+            pose.bodies.insert(pose.bodies.end(), next.begin(), next.end());
+        }
+
+        poses.push_back(pose);
+    }
+
+    return true;
+}
+
+void TrainerCommandParser::SetJointPose(const JointPose& pose)
+{
+    const float delta = pose.angle - pose.joint->GetAngle();
+    if (gAbs(delta) < 1e-3f)
+    {
+        return;
+    }
+
+    const Vector3f anchor = pose.joint->GetAnchor(Joint::BI_FIRST);
+    const Vector3f axis = pose.joint->GetAxis();
+
+    RotateBodies(pose.bodies, anchor, axis, delta);
+
+    // the sign of the joint angle depends on which of the bodies is
+    // the first body of the joint
+    if (gAbs(pose.angle - pose.joint->GetAngle()) > gAbs(delta) * 0.5f)
+    {
+        RotateBodies(pose.bodies, anchor, axis, -2.0f * delta);
+    }
+}
@@ -34,6 +34,7 @@
 #include <soccerruleaspect/soccerruleaspect.h>
 #include <oxygen/simulationserver/simulationserver.h>
 #include <oxygen/simulationserver/monitorcontrol.h>
+#include <oxygen/physicsserver/hingejoint.h>
 
 namespace oxygen
 {
@@ -58,7 +59,8 @@ public:
         CT_KILLSIM,
         CT_REQFULLSTATE,
         CT_TIME,
-        CT_SCORE
+        CT_SCORE,
+        CT_SCENARIO
     };
 
     typedef std::map<std::string, ECommandType>  TCommandMap;
@@ -67,6 +69,54 @@ public:
     // mapping from string to TPlayMode
     typedef std::map<std::string, TPlayMode> TPlayModeMap;
 
+    /** the state of one agent set by a scenario command */
+    struct ScenarioAgent
+    {
+        TTeamIndex team;
+        int unum;
+
+        bool hasPos;
+        salt::Vector3f pos;
+
+        /** the orientation around the z-axis in degrees, like the
+            angle of the move parameter of the agent command */
+        bool hasRot;
+        float rot;
+
+        /** the joint angles in degrees; joints are named like their
+            perceptor or effector, e.g. hj1 or he1 */
+        std::vector<std::pair<std::string, float> > joints;
+
+        ScenarioAgent()
+            : team(TI_NONE), unum(0), hasPos(false), hasRot(false), rot(0) {}
+    };
+
+    /** the state set by a scenario command; members without the has
+        flag set are left unchanged */
+    struct Scenario
+    {
+        bool hasPlayMode;
+        TPlayMode playMode;
+
+        bool hasTime;
+        float time;
+
+        bool hasBallPos;
+        salt::Vector3f ballPos;
+
+        bool hasBallVel;
+        salt::Vector3f ballVel;
+
+        std::vector<ScenarioAgent> agents;
+
+        Scenario()
+            : hasPlayMode(false), playMode(PM_NONE), hasTime(false), time(0),
+              hasBallPos(false), hasBallVel(false) {}
+    };
+
+    /** the first bytes of a binary scenario message */
+    static const char* BINARY_SCENARIO_MAGIC;
+
 public:
     TrainerCommandParser();
 
@@ -76,7 +126,8 @@ public:
 
     /** This function will be called be called from the monitor server
         implementation to parse any command strings received from the
-        monitor client process
+        monitor client process. Messages that start with
+        BINARY_SCENARIO_MAGIC are binary scenario commands.
      */
     virtual void ParseMonitorMessage(const std::string& data);
 
@@ -144,8 +195,69 @@ protected:
         predicate
     */
     void ParseScoreCommand(const oxygen::Predicate & predicate);
-    
-    
+
+    /** parses and executes the scenario command contained in the
+        given predicate
+    */
+    void ParseScenarioCommand(const oxygen::Predicate & predicate);
+
+    /** parses the state of one agent of a scenario command */
+    bool ParseScenarioAgent(const zeitgeist::ParameterList& list,
+                            ScenarioAgent& agent);
+
+    /** parses and executes a binary scenario message. It carries the
+        same state as the scenario command for resets at a high rate;
+        numbers are little endian, floats are 32 bit IEEE:
+
+        magic     "SSCN1"
+        flags     uint8: 1 play mode, 2 time, 4 ball pos, 8 ball vel
+        playMode  uint8 TPlayMode, if flag 1
+        time      float, if flag 2
+        ballPos   3 floats, if flag 4
+        ballVel   3 floats, if flag 8
+        numAgents uint8, followed per agent by
+          team      uint8 TTeamIndex
+          unum      uint8
+          flags     uint8: 1 pos, 2 rot
+          pos       3 floats, if flag 1
+          rot       float, if flag 2
+          numJoints uint8, followed per joint by
+            length    uint8
+            name      length chars
+            angle     float
+
+        One '\0' after the last field is accepted, as NetMessage
+        terminates every received message with it.
+    */
+    void ParseBinaryScenario(const std::string& data);
+
+    /** sets the state of a scenario. All agents and joints are looked
+        up first; if one of them is missing, nothing is changed.
+        Otherwise the whole state is set at once, before the next
+        physics step, so that no rule can interfere.
+    */
+    void ApplyScenario(const Scenario& scenario);
+
+protected:
+    /** a joint angle to set, together with the bodies that move with
+        the joint */
+    struct JointPose
+    {
+        std::shared_ptr<oxygen::HingeJoint> joint;
+        std::vector<std::shared_ptr<oxygen::RigidBody> > bodies;
+        float angle;
+    };
+
+    /** looks up the joints of an agent for the given joint angles */
+    bool GetJointPoses(std::shared_ptr<oxygen::Transform> agent_aspect,
+                       const ScenarioAgent& agent,
+                       std::vector<JointPose>& poses);
+
+    /** sets the angle of a joint by rotating the bodies of its
+        subtree around the joint axis */
+    void SetJointPose(const JointPose& pose);
+
+
 protected:
     TCommandMap    mCommandMap;
 
@@ -0,0 +1,81 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+   this file is part of rcssserver3D
+   Copyright (C) 2004-2025 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#include "visionoccluderaspect.h"
+#include <oxygen/gamecontrolserver/gamecontrolserver.h>
+#include <soccerbase/soccerbase.h>
+
+using namespace oxygen;
+
+VisionOccluderAspect::VisionOccluderAspect() : SoccerControlAspect(),
+                                               mEnabled(true)
+{
+}
+
+VisionOccluderAspect::~VisionOccluderAspect()
+{
+}
+
+void
+VisionOccluderAspect::OnLink()
+{
+    SoccerControlAspect::OnLink();
+
+    SoccerBase::GetGameControlServer(*this, mGameControlServer);
+}
+
+void
+VisionOccluderAspect::OnUnlink()
+{
+    SoccerControlAspect::OnUnlink();
+
+    mGameControlServer.reset();
+    mOccluders.Clear();
+}
+
+void
+VisionOccluderAspect::Update(float /*deltaTime*/)
+{
+    if (
+        (! mEnabled) ||
+        (mGameControlServer.get() == 0)
+        )
+    {
+        return;
+    }
+
+    GameControlServer::TAgentAspectList agents;
+    mGameControlServer->GetAgentAspectList(agents);
+    mOccluders.Build(agents);
+}
+
+void
+VisionOccluderAspect::SetEnabled(bool enabled)
+{
+    mEnabled = enabled;
+    if (! mEnabled)
+    {
+        mOccluders.Clear();
+    }
+}
+
+const VisionOccluders*
+VisionOccluderAspect::GetOccluders() const
+{
+    return mEnabled ? &mOccluders : 0;
+}
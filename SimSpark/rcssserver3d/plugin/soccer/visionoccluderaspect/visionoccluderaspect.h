@@ -0,0 +1,75 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+   this file is part of rcssserver3D
+   Copyright (C) 2004-2025 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#ifndef VISIONOCCLUDERASPECT_H
+#define VISIONOCCLUDERASPECT_H
+
+#include <soccercontrolaspect/soccercontrolaspect.h>
+#include <restrictedvisionperceptor/visionoccluders.h>
+
+namespace oxygen
+{
+    class GameControlServer;
+}
+
+/** VisionOccluderAspect is a ControlAspect that holds the robot
+    proxies the RestrictedVisionPerceptors test their lines of sight
+    against.
+
+    The proxies are rebuilt in Update(), after the physics step of a
+    cycle and before the senses are generated. They stay unchanged
+    until the next Update(), so all perceptors read them without
+    locking.
+ */
+class VisionOccluderAspect : public SoccerControlAspect
+{
+public:
+    VisionOccluderAspect();
+    virtual ~VisionOccluderAspect();
+
+    /** called during the update of the GameControlServer to rebuild
+        the proxies from the current pose of the agents
+    */
+    virtual void Update(float deltaTime);
+
+    /** turns the occlusion test of all vision perceptors on/off */
+    void SetEnabled(bool enabled);
+
+    /** returns the proxies of the current cycle, or 0 if the
+        occlusion test is disabled
+    */
+    const VisionOccluders* GetOccluders() const;
+
+protected:
+    virtual void OnLink();
+    virtual void OnUnlink();
+
+protected:
+    /** the robot proxies */
+    VisionOccluders mOccluders;
+
+    /** flag if the proxies are built and used */
+    bool mEnabled;
+
+    /** reference to the GameControlServer, to find all agents */
+    std::shared_ptr<oxygen::GameControlServer> mGameControlServer;
+};
+
+DECLARE_CLASS(VisionOccluderAspect)
+
+#endif // VISIONOCCLUDERASPECT_H
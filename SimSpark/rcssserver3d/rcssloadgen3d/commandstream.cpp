@@ -0,0 +1,115 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+   this file is part of rcssserver3D
+   Copyright (C) 2004-2025 RoboCup Soccer Server 3D Maintenance Group
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#include "commandstream.h"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+using namespace std;
+
+namespace
+{
+    const char* JOINTS[] =
+    {
+        "he1", "he2",
+        "lae1", "lae2", "lae3", "lae4",
+        "rae1", "rae2", "rae3", "rae4",
+        "lle1", "lle2", "lle3", "lle4", "lle5", "lle6",
+        "rle1", "rle2", "rle3", "rle4", "rle5", "rle6"
+    };
+
+    /** the simulation step the joint periods are based on */
+    const double SIM_STEP = 0.02;
+}
+
+GeneratedStream::GeneratedStream(int index, int unum, int sayInterval)
+    : mIndex(index), mUnum(unum), mSayInterval(sayInterval)
+{
+}
+
+std::string GeneratedStream::GetMessage(int cycle)
+{
+    char buffer[64];
+
+    if (cycle == 0)
+    {
+        // a grid in the own half, the server mirrors the right team
+        snprintf(buffer, sizeof(buffer), "(beam %.1f %.1f 0)",
+                 -1.0 - 1.5 * ((mUnum - 1) / 4),
+                 -3.0 + 2.0 * ((mUnum - 1) % 4));
+        return buffer;
+    }
+
+    string message;
+    const double t = cycle * SIM_STEP;
+    const size_t numJoints = sizeof(JOINTS) / sizeof(JOINTS[0]);
+
+    for (size_t joint = 0; joint < numJoints; ++joint)
+    {
+        const double phase = 0.7 * joint + 0.3 * mIndex;
+        snprintf(buffer, sizeof(buffer), "(%s %.3f)", JOINTS[joint],
+                 2.0 * sin(2.0 * M_PI * t + phase));
+        message += buffer;
+    }
+
+    if (mSayInterval > 0 && cycle % mSayInterval == 0)
+    {
+        snprintf(buffer, sizeof(buffer), "(say a%dc%d)", mIndex, cycle);
+        message += buffer;
+    }
+
+    return message;
+}
+
+std::shared_ptr<RecordedStream> RecordedStream::Load(const std::string& fileName)
+{
+    ifstream in(fileName.c_str());
+    if (! in)
+    {
+        return std::shared_ptr<RecordedStream>();
+    }
+
+    std::shared_ptr<RecordedStream> stream(new RecordedStream());
+    string line;
+    while (getline(in, line))
+    {
+        if (! line.empty() && line[line.size() - 1] == '\r')
+        {
+            line.erase(line.size() - 1);
+        }
+
+        if (! line.empty() && line[0] == '#')
+        {
+            continue;
+        }
+
+        stream->mMessages.push_back(line);
+    }
+
+    if (stream->mMessages.empty())
+    {
+        return std::shared_ptr<RecordedStream>();
+    }
+
+    return stream;
+}
+
+std::string RecordedStream::GetMessage(int cycle)
+{
+    return mMessages[cycle % mMessages.size()];
+}
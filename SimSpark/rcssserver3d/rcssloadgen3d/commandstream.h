@@ -0,0 +1,77 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+   this file is part of rcssserver3D
+   Copyright (C) 2004-2025 RoboCup Soccer Server 3D Maintenance Group
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#ifndef COMMANDSTREAM_H
+#define COMMANDSTREAM_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/** \class CommandStream provides the message a synthetic agent sends in
+    each cycle after its bring up, i.e. after the scene and the init
+    message
+*/
+class CommandStream
+{
+public:
+    virtual ~CommandStream() {}
+
+    /** returns the message of the given cycle, counted from the first
+        cycle after the init message; may be empty */
+    virtual std::string GetMessage(int cycle) = 0;
+};
+
+/** \class GeneratedStream beams the agent into its half in the first
+    cycle and then swings every hinge joint of the Nao with its own
+    phase. Every sayInterval cycles the agent says a short message.
+*/
+class GeneratedStream : public CommandStream
+{
+public:
+    /** \param index is the index of the agent, used for the joint
+        phases; \param unum the uniform number that determines the
+        beam position; \param sayInterval the cycles between two say
+        messages, 0 to never say anything */
+    GeneratedStream(int index, int unum, int sayInterval);
+
+    virtual std::string GetMessage(int cycle);
+
+protected:
+    int mIndex;
+    int mUnum;
+    int mSayInterval;
+};
+
+/** \class RecordedStream replays a text file with the message of one
+    cycle per line in a loop. Empty lines send nothing, lines starting
+    with '#' are skipped.
+*/
+class RecordedStream : public CommandStream
+{
+public:
+    /** reads the given file, returns 0 if it can't be read or has no
+        messages */
+    static std::shared_ptr<RecordedStream> Load(const std::string& fileName);
+
+    virtual std::string GetMessage(int cycle);
+
+protected:
+    std::vector<std::string> mMessages;
+};
+
+#endif // COMMANDSTREAM_H
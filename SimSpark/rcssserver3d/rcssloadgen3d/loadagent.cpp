@@ -0,0 +1,316 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+   this file is part of rcssserver3D
+   Copyright (C) 2004-2025 RoboCup Soccer Server 3D Maintenance Group
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#include "loadagent.h"
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef HAVE_CONFIG_H
+#include <rcssserver3d_config.h>
+#endif
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#ifdef HAVE_NETINET_IN_H
+#include <netinet/in.h>
+#endif
+#ifdef HAVE_ARPA_INET_H
+#include <arpa/inet.h>
+#endif
+
+using namespace rcss::net;
+using namespace std;
+
+namespace
+{
+    /** the largest accepted sense message */
+    const unsigned int MAX_MESSAGE_SIZE = 1024 * 1024;
+
+    /** the simulation step of the server */
+    const double SIM_STEP = 0.02;
+
+#ifdef MSG_NOSIGNAL
+    const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+    const int SEND_FLAGS = 0;
+#endif
+}
+
+LoadAgent::LoadAgent(int index, const std::string& teamName, int unum,
+                     const std::string& scene,
+                     std::shared_ptr<CommandStream> stream, bool sync)
+    : mIndex(index),
+      mTeamName(teamName),
+      mUnum(unum),
+      mScene(scene),
+      mStream(stream),
+      mSync(sync),
+      mState(S_CLOSED),
+      mCycle(0),
+      mRecvOffset(0),
+      mSendOffset(0),
+      mWaiting(false),
+      mLastSimTime(-1.0),
+      mSenses(0),
+      mMissedCycles(0),
+      mBytesSent(0),
+      mBytesReceived(0)
+{
+}
+
+bool LoadAgent::Connect(const Addr& server)
+{
+    if (! mSocket.isOpen() && ! mSocket.open())
+    {
+        cerr << "(LoadAgent) agent " << mIndex << " can't open socket: "
+             << strerror(errno) << "\n";
+        return false;
+    }
+
+    mSocket.setNonBlocking(true);
+
+    if (! mSocket.connect(server) && errno != EINPROGRESS)
+    {
+        cerr << "(LoadAgent) agent " << mIndex << " can't connect: "
+             << strerror(errno) << "\n";
+        mSocket.close();
+        return false;
+    }
+
+    mState = S_CONNECTING;
+    return true;
+}
+
+void LoadAgent::Close()
+{
+    mSocket.close();
+    mState = S_CLOSED;
+}
+
+bool LoadAgent::OnWritable()
+{
+    if (mState == S_CONNECTING)
+    {
+        int error = 0;
+        socklen_t size = sizeof(error);
+        if (
+            getsockopt(mSocket.getFD(), SOL_SOCKET, SO_ERROR, &error, &size) != 0 ||
+            error != 0
+            )
+        {
+            cerr << "(LoadAgent) agent " << mIndex << " failed to connect: "
+                 << strerror(error) << "\n";
+            Close();
+            return false;
+        }
+
+        // in sync mode the server waits for a (syn) of every connection
+        mState = S_SCENE;
+        return Send(mSync ? mScene + "(syn)" : mScene);
+    }
+
+    return Flush();
+}
+
+bool LoadAgent::OnReadable(TTimePoint now)
+{
+    char buffer[16 * 1024];
+
+    for (;;)
+    {
+        int received = mSocket.recv(buffer, sizeof(buffer));
+        if (received > 0)
+        {
+            mRecvBuffer.append(buffer, received);
+            mBytesReceived += received;
+            continue;
+        }
+
+        if (received == 0)
+        {
+            Close();
+            return false;
+        }
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            break;
+        }
+
+        cerr << "(LoadAgent) agent " << mIndex << " recv failed: "
+             << strerror(errno) << "\n";
+        Close();
+        return false;
+    }
+
+    // answer every complete frame
+    while (mRecvBuffer.size() - mRecvOffset >= sizeof(unsigned int))
+    {
+        unsigned int length;
+        memcpy(&length, mRecvBuffer.data() + mRecvOffset, sizeof(length));
+        length = ntohl(length);
+
+        if (length > MAX_MESSAGE_SIZE)
+        {
+            cerr << "(LoadAgent) agent " << mIndex << " received a message of "
+                 << length << " bytes, closing\n";
+            Close();
+            return false;
+        }
+
+        if (mRecvBuffer.size() - mRecvOffset < sizeof(unsigned int) + length)
+        {
+            break;
+        }
+
+        OnSense(mRecvBuffer.data() + mRecvOffset + sizeof(unsigned int),
+                length, now);
+        mRecvOffset += sizeof(unsigned int) + length;
+
+        if (mState == S_CLOSED)
+        {
+            return false;
+        }
+    }
+
+    if (mRecvOffset == mRecvBuffer.size())
+    {
+        mRecvBuffer.clear();
+        mRecvOffset = 0;
+    } else if (mRecvOffset > mRecvBuffer.size() / 2)
+    {
+        mRecvBuffer.erase(0, mRecvOffset);
+        mRecvOffset = 0;
+    }
+
+    return true;
+}
+
+void LoadAgent::OnSense(const char* data, size_t size, TTimePoint now)
+{
+    switch (mState)
+    {
+    case S_SCENE:
+        {
+            char init[128];
+            snprintf(init, sizeof(init), "(init (unum %d)(teamname %s))%s",
+                     mUnum, mTeamName.c_str(), mSync ? "(syn)" : "");
+            mState = S_INIT;
+            Send(init);
+            return;
+        }
+
+    case S_INIT:
+        mState = S_RUNNING;
+        break;
+
+    case S_RUNNING:
+        break;
+
+    default:
+        return;
+    }
+
+    ++mSenses;
+
+    if (mWaiting)
+    {
+        mLatencies.push_back
+            (std::chrono::duration<float, std::milli>(now - mSentTime).count());
+        mWaiting = false;
+    }
+
+    // count the cycles that passed without a sense
+    const string sense(data, size);
+    const size_t pos = sense.find("(time (now ");
+    if (pos != string::npos)
+    {
+        const double simTime = strtod(sense.c_str() + pos + 11, 0);
+        if (mLastSimTime >= 0.0)
+        {
+            const int cycles = static_cast<int>
+                (floor((simTime - mLastSimTime) / SIM_STEP + 0.5));
+            if (cycles > 1)
+            {
+                mMissedCycles += cycles - 1;
+            }
+        }
+        mLastSimTime = simTime;
+    }
+
+    string message = mStream->GetMessage(mCycle++);
+    if (mSync)
+    {
+        message += "(syn)";
+    }
+
+    if (! message.empty())
+    {
+        mSentTime = now;
+        mWaiting = true;
+        Send(message);
+    }
+}
+
+bool LoadAgent::Send(const std::string& message)
+{
+    const unsigned int length = htonl(message.size());
+    mSendBuffer.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    mSendBuffer.append(message);
+
+    return Flush();
+}
+
+bool LoadAgent::Flush()
+{
+    while (mSendOffset < mSendBuffer.size())
+    {
+        int sent = mSocket.send(mSendBuffer.data() + mSendOffset,
+                                mSendBuffer.size() - mSendOffset,
+                                SEND_FLAGS, Socket::DONT_CHECK);
+        if (sent > 0)
+        {
+            mSendOffset += sent;
+            mBytesSent += sent;
+            continue;
+        }
+
+        if (sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            // the event loop waits until the socket is writable
+            return true;
+        }
+
+        cerr << "(LoadAgent) agent " << mIndex << " send failed: "
+             << strerror(errno) << "\n";
+        Close();
+        return false;
+    }
+
+    mSendBuffer.clear();
+    mSendOffset = 0;
+    return true;
+}
@@ -0,0 +1,146 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+   this file is part of rcssserver3D
+   Copyright (C) 2004-2025 RoboCup Soccer Server 3D Maintenance Group
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#ifndef LOADAGENT_H
+#define LOADAGENT_H
+
+#include "commandstream.h"
+#include <rcssnet/tcpsocket.hpp>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+/** \class LoadAgent is a synthetic agent on a non-blocking connection,
+    driven by the event loop of the LoadGenerator. After connecting it
+    sends the scene message, answers the first sense with the init
+    message and every further sense with the next message of its
+    CommandStream, followed by a (syn) in sync mode.
+
+    The agent measures the round trip from sending its answer to the
+    arrival of the next sense and counts the simulation cycles it did
+    not get a sense for.
+*/
+class LoadAgent
+{
+public:
+    typedef std::chrono::steady_clock TClock;
+    typedef TClock::time_point TTimePoint;
+
+    enum EState
+    {
+        S_CONNECTING,
+        S_SCENE,
+        S_INIT,
+        S_RUNNING,
+        S_CLOSED
+    };
+
+public:
+    LoadAgent(int index, const std::string& teamName, int unum,
+              const std::string& scene,
+              std::shared_ptr<CommandStream> stream, bool sync);
+
+    /** starts the non-blocking connect to the server */
+    bool Connect(const rcss::net::Addr& server);
+
+    /** closes the connection */
+    void Close();
+
+    /** returns the socket descriptor */
+    int GetFD() const { return mSocket.getFD(); }
+
+    EState GetState() const { return mState; }
+
+    /** returns true if the agent waits for its socket to become
+        writable, i.e. while connecting or with pending output */
+    bool WantsToWrite() const
+    { return mState == S_CONNECTING || mSendOffset < mSendBuffer.size(); }
+
+    /** finishes the connect or sends pending output; returns false if
+        the connection failed */
+    bool OnWritable();
+
+    /** reads the available input and answers every complete sense;
+        returns false if the connection was closed */
+    bool OnReadable(TTimePoint now);
+
+    int GetIndex() const { return mIndex; }
+    const std::string& GetTeamName() const { return mTeamName; }
+    int GetUnum() const { return mUnum; }
+
+    /** returns the number of senses received after the bring up */
+    int GetSenses() const { return mSenses; }
+
+    /** returns the sense round trips in milliseconds */
+    const std::vector<float>& GetLatencies() const { return mLatencies; }
+
+    /** returns the number of simulation cycles without a sense */
+    int GetMissedCycles() const { return mMissedCycles; }
+
+    unsigned long long GetBytesSent() const { return mBytesSent; }
+    unsigned long long GetBytesReceived() const { return mBytesReceived; }
+
+protected:
+    /** handles a complete sense message */
+    void OnSense(const char* data, size_t size, TTimePoint now);
+
+    /** frames the message and sends as much of it as the socket takes */
+    bool Send(const std::string& message);
+
+    /** sends the pending output, returns false on errors */
+    bool Flush();
+
+protected:
+    int mIndex;
+    std::string mTeamName;
+    int mUnum;
+    std::string mScene;
+    std::shared_ptr<CommandStream> mStream;
+    bool mSync;
+
+    rcss::net::TCPSocket mSocket;
+    EState mState;
+
+    /** the cycle of the command stream */
+    int mCycle;
+
+    /** the framed input; mRecvOffset is the start of the unprocessed
+        part */
+    std::string mRecvBuffer;
+    size_t mRecvOffset;
+
+    /** the framed output; mSendOffset is the start of the unsent part */
+    std::string mSendBuffer;
+    size_t mSendOffset;
+
+    /** the time the last answer was sent, valid if mWaiting */
+    TTimePoint mSentTime;
+    bool mWaiting;
+
+    /** the simulation time of the last sense, negative before the
+        first one */
+    double mLastSimTime;
+
+    int mSenses;
+    int mMissedCycles;
+    std::vector<float> mLatencies;
+    unsigned long long mBytesSent;
+    unsigned long long mBytesReceived;
+};
+
+#endif // LOADAGENT_H
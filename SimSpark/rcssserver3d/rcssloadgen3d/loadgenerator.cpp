@@ -0,0 +1,280 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+   this file is part of rcssserver3D
+   Copyright (C) 2004-2025 RoboCup Soccer Server 3D Maintenance Group
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#include "loadgenerator.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <poll.h>
+
+using namespace rcss::net;
+using namespace std;
+
+volatile bool LoadGenerator::mStop = false;
+
+namespace
+{
+    /** the longest poll() timeout, to notice Stop() and the end */
+    const int MAX_POLL_MILLISECS = 100;
+
+    /** the nearest rank percentile of sorted values */
+    float Percentile(const vector<float>& sorted, double p)
+    {
+        if (sorted.empty())
+        {
+            return 0.0f;
+        }
+
+        size_t rank = static_cast<size_t>(ceil(p * sorted.size()));
+        return sorted[std::max<size_t>(rank, 1) - 1];
+    }
+
+    float Mean(const vector<float>& values)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            sum += values[i];
+        }
+        return values.empty() ? 0.0f : static_cast<float>(sum / values.size());
+    }
+}
+
+LoadGenerator::LoadGenerator()
+    : mConnectInterval(0), mSeconds(0.0)
+{
+}
+
+void LoadGenerator::AddAgent(std::shared_ptr<LoadAgent> agent, const Addr& server)
+{
+    Entry entry;
+    entry.agent = agent;
+    entry.server = server;
+    mAgents.push_back(entry);
+}
+
+void LoadGenerator::SetConnectInterval(int millisecs)
+{
+    mConnectInterval = std::max(millisecs, 0);
+}
+
+void LoadGenerator::Stop()
+{
+    mStop = true;
+}
+
+bool LoadGenerator::IsDone(int cycles) const
+{
+    if (cycles <= 0)
+    {
+        return false;
+    }
+
+    bool running = false;
+    for (size_t i = 0; i < mAgents.size(); ++i)
+    {
+        const LoadAgent& agent = *mAgents[i].agent;
+        if (agent.GetState() == LoadAgent::S_CLOSED)
+        {
+            continue;
+        }
+
+        if (agent.GetSenses() < cycles)
+        {
+            return false;
+        }
+        running = true;
+    }
+
+    return running;
+}
+
+bool LoadGenerator::Run(int cycles, double seconds)
+{
+    typedef LoadAgent::TClock TClock;
+
+    const TClock::time_point start = TClock::now();
+    const std::chrono::milliseconds interval(mConnectInterval);
+    TClock::time_point nextConnect = start;
+    size_t connected = 0;
+
+    vector<pollfd> fds;
+    vector<size_t> polled;
+    fds.reserve(mAgents.size());
+    polled.reserve(mAgents.size());
+
+    mStop = false;
+
+    while (! mStop)
+    {
+        TClock::time_point now = TClock::now();
+
+        while (connected < mAgents.size() && now >= nextConnect)
+        {
+            const Entry& entry = mAgents[connected];
+            entry.agent->Connect(entry.server);
+            ++connected;
+            nextConnect += interval;
+        }
+
+        if (IsDone(cycles) ||
+            (seconds > 0.0 &&
+             std::chrono::duration<double>(now - start).count() >= seconds))
+        {
+            break;
+        }
+
+        fds.clear();
+        polled.clear();
+        for (size_t i = 0; i < connected; ++i)
+        {
+            const LoadAgent& agent = *mAgents[i].agent;
+            if (agent.GetState() == LoadAgent::S_CLOSED)
+            {
+                continue;
+            }
+
+            pollfd fd;
+            fd.fd = agent.GetFD();
+            fd.events = agent.WantsToWrite() ? POLLOUT : POLLIN;
+            if (agent.GetState() != LoadAgent::S_CONNECTING)
+            {
+                fd.events |= POLLIN;
+            }
+            fd.revents = 0;
+            fds.push_back(fd);
+            polled.push_back(i);
+        }
+
+        if (fds.empty() && connected == mAgents.size())
+        {
+            cerr << "(LoadGenerator) all connections are closed\n";
+            break;
+        }
+
+        int timeout = MAX_POLL_MILLISECS;
+        if (connected < mAgents.size())
+        {
+            const long long untilConnect =
+                std::chrono::duration_cast<std::chrono::milliseconds>
+                (nextConnect - now).count();
+            timeout = static_cast<int>
+                (std::max<long long>(0, std::min<long long>(timeout, untilConnect)));
+        }
+
+        const int ready = poll(fds.empty() ? 0 : &fds[0], fds.size(), timeout);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            cerr << "(LoadGenerator) poll failed: " << strerror(errno) << "\n";
+            return false;
+        }
+
+        now = TClock::now();
+
+        for (size_t i = 0; i < fds.size() && ready > 0; ++i)
+        {
+            if (fds[i].revents == 0)
+            {
+                continue;
+            }
+
+            LoadAgent& agent = *mAgents[polled[i]].agent;
+
+            // a failed connect reports POLLERR, which OnWritable() reads
+            if (
+                (fds[i].revents & (POLLOUT | POLLERR | POLLHUP)) &&
+                agent.WantsToWrite() &&
+                ! agent.OnWritable()
+                )
+            {
+                continue;
+            }
+
+            if (fds[i].revents & (POLLIN | POLLERR | POLLHUP))
+            {
+                agent.OnReadable(now);
+            }
+        }
+    }
+
+    mSeconds = std::chrono::duration<double>(TClock::now() - start).count();
+
+    for (size_t i = 0; i < mAgents.size(); ++i)
+    {
+        mAgents[i].agent->Close();
+    }
+
+    return true;
+}
+
+void LoadGenerator::PrintReport(std::ostream& out) const
+{
+    vector<float> all;
+    unsigned long long senses = 0;
+    unsigned long long missed = 0;
+    unsigned long long sent = 0;
+    unsigned long long received = 0;
+
+    out << "agent team         unum   senses missed  rtt mean   rtt p50   "
+        << "rtt p99   rtt max (ms)\n";
+    out << fixed << setprecision(2);
+
+    for (size_t i = 0; i < mAgents.size(); ++i)
+    {
+        const LoadAgent& agent = *mAgents[i].agent;
+        vector<float> latencies = agent.GetLatencies();
+        std::sort(latencies.begin(), latencies.end());
+
+        out << setw(5) << agent.GetIndex() << " "
+            << left << setw(12) << agent.GetTeamName() << right
+            << setw(5) << agent.GetUnum()
+            << setw(9) << agent.GetSenses()
+            << setw(7) << agent.GetMissedCycles()
+            << setw(10) << Mean(latencies)
+            << setw(10) << Percentile(latencies, 0.5)
+            << setw(10) << Percentile(latencies, 0.99)
+            << setw(10) << (latencies.empty() ? 0.0f : latencies.back())
+            << "\n";
+
+        all.insert(all.end(), latencies.begin(), latencies.end());
+        senses += agent.GetSenses();
+        missed += agent.GetMissedCycles();
+        sent += agent.GetBytesSent();
+        received += agent.GetBytesReceived();
+    }
+
+    std::sort(all.begin(), all.end());
+
+    out << "\n" << mAgents.size() << " agents, " << mSeconds << " s, "
+        << senses << " senses ("
+        << (mSeconds > 0.0 ? senses / mSeconds : 0.0) << "/s), "
+        << missed << " missed cycles\n"
+        << "round trip mean " << Mean(all)
+        << " ms, p50 " << Percentile(all, 0.5)
+        << " ms, p90 " << Percentile(all, 0.9)
+        << " ms, p99 " << Percentile(all, 0.99)
+        << " ms, max " << (all.empty() ? 0.0f : all.back()) << " ms\n"
+        << "sent " << sent << " bytes, received " << received << " bytes\n";
+}
@@ -0,0 +1,77 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+   this file is part of rcssserver3D
+   Copyright (C) 2004-2025 RoboCup Soccer Server 3D Maintenance Group
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+#include "loadagent.h"
+#include <rcssnet/addr.hpp>
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+/** \class LoadGenerator drives many LoadAgents from a single thread
+    with one poll() loop. The agents connect one after another, like
+    the players of a team started by a script, and then answer each
+    sense as soon as it arrives.
+*/
+class LoadGenerator
+{
+public:
+    LoadGenerator();
+
+    /** adds an agent that connects to the given server */
+    void AddAgent(std::shared_ptr<LoadAgent> agent, const rcss::net::Addr& server);
+
+    /** sets the delay between two connects in milliseconds */
+    void SetConnectInterval(int millisecs);
+
+    /** runs the agents until each of them received the given number
+        of senses (0 for no limit), the given number of seconds passed
+        (0 for no limit), all connections are closed or Stop() is
+        called */
+    bool Run(int cycles, double seconds);
+
+    /** stops Run(); may be called from a signal handler */
+    static void Stop();
+
+    /** prints the statistics of every agent and of all agents */
+    void PrintReport(std::ostream& out) const;
+
+protected:
+    struct Entry
+    {
+        std::shared_ptr<LoadAgent> agent;
+        rcss::net::Addr server;
+    };
+
+protected:
+    /** returns true if every running agent received the given number
+        of senses */
+    bool IsDone(int cycles) const;
+
+protected:
+    static volatile bool mStop;
+
+    std::vector<Entry> mAgents;
+    int mConnectInterval;
+
+    /** the wall time of the run, from the first connect on */
+    double mSeconds;
+};
+
+#endif // LOADGENERATOR_H
@@ -0,0 +1,263 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+   this file is part of rcssserver3D
+   Copyright (C) 2004-2025 RoboCup Soccer Server 3D Maintenance Group
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+/* rcssloadgen3d connects many synthetic agents from a single process to
+   one or more servers, to measure how a server copes with full teams
+   without starting an agent process per player. */
+
+#include <signal.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "loadgenerator.h"
+
+#ifdef HAVE_CONFIG_H
+#include <rcssserver3d_config.h>
+#endif
+
+using namespace rcss::net;
+using namespace std;
+
+namespace
+{
+    string gHost = "127.0.0.1";
+    int gPort = 3100;
+    int gServers = 1;
+    int gAgents = 22;
+    int gTeamSize = 11;
+    bool gSync = false;
+    int gCycles = 0;
+    double gDuration = 0.0;
+    string gScene = "rsg/agent/nao/nao.rsg";
+    string gStream;
+    int gSayInterval = 10;
+    int gConnectInterval = 50;
+}
+
+// SIGINT handler prototype
+extern "C" void handler(int sig)
+{
+    if (sig == SIGINT)
+        LoadGenerator::Stop();
+}
+
+void PrintGreeting()
+{
+    cout << "rcssloadgen3d, a synthetic agent load generator\n"
+         << "Copyright (C) 2004-2025 RoboCup Soccer Server 3D Maintenance Group.\n\n";
+}
+
+void PrintHelp()
+{
+    cout << "\nusage: rcssloadgen3d [options]" << endl;
+    cout << "\noptions:" << endl;
+    cout << " --help                 prints this message." << endl;
+    cout << " --host=IP              IP of the server(s)." << endl;
+    cout << " --port=PORT            agent port of the first server (3100)." << endl;
+    cout << " --servers=N            number of servers, on consecutive ports (1)." << endl;
+    cout << " --agents=N             number of agents (22)." << endl;
+    cout << " --team-size=N          players per team (11); two teams per server." << endl;
+    cout << " --sync                 send a (syn) with every message, for servers in sync mode." << endl;
+    cout << " --cycles=N             stop after N senses per agent." << endl;
+    cout << " --duration=SECONDS     stop after the given time." << endl;
+    cout << " --scene=RSG            the agent scene (rsg/agent/nao/nao.rsg)." << endl;
+    cout << " --stream=FILE          replay one message per line and cycle from FILE;" << endl;
+    cout << "                        a %d in FILE is replaced by the agent index." << endl;
+    cout << " --say-interval=N       cycles between two say messages of the generated" << endl;
+    cout << "                        stream, 0 for none (10)." << endl;
+    cout << " --connect-interval=MS  delay between two connects (50)." << endl;
+    cout << "\nWithout --stream the agents beam into their half and swing all joints." << endl;
+    cout << "\n";
+}
+
+bool ReadOptions(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; i++)
+        {
+            const string arg = argv[i];
+            const size_t eq = arg.find('=');
+            const string name = arg.substr(0, eq);
+            const string value = (eq == string::npos) ? string() : arg.substr(eq + 1);
+
+            if (name == "--help")
+                {
+                    PrintHelp();
+                    exit(0);
+                }
+            else if (name == "--sync")
+                {
+                    gSync = true;
+                }
+            else if (value.empty())
+                {
+                    cerr << "missing or unknown option '" << arg << "'\n";
+                    return false;
+                }
+            else if (name == "--host")
+                {
+                    gHost = value;
+                }
+            else if (name == "--port")
+                {
+                    gPort = atoi(value.c_str());
+                }
+            else if (name == "--servers")
+                {
+                    gServers = atoi(value.c_str());
+                }
+            else if (name == "--agents")
+                {
+                    gAgents = atoi(value.c_str());
+                }
+            else if (name == "--team-size")
+                {
+                    gTeamSize = atoi(value.c_str());
+                }
+            else if (name == "--cycles")
+                {
+                    gCycles = atoi(value.c_str());
+                }
+            else if (name == "--duration")
+                {
+                    gDuration = atof(value.c_str());
+                }
+            else if (name == "--scene")
+                {
+                    gScene = value;
+                }
+            else if (name == "--stream")
+                {
+                    gStream = value;
+                }
+            else if (name == "--say-interval")
+                {
+                    gSayInterval = atoi(value.c_str());
+                }
+            else if (name == "--connect-interval")
+                {
+                    gConnectInterval = atoi(value.c_str());
+                }
+            else
+                {
+                    cerr << "unknown option '" << arg << "'\n";
+                    return false;
+                }
+        }
+
+    if (gServers < 1 || gTeamSize < 1 || gAgents < 1)
+        {
+            cerr << "the number of servers, agents and the team size must be positive\n";
+            return false;
+        }
+
+    if (gAgents > gServers * 2 * gTeamSize)
+        {
+            cerr << gServers << " server(s) take at most " << gServers * 2 * gTeamSize
+                 << " agents, use --servers\n";
+            return false;
+        }
+
+    return true;
+}
+
+/** returns the command stream of the given agent */
+std::shared_ptr<CommandStream> CreateStream(int index, int unum)
+{
+    if (gStream.empty())
+        {
+            return std::shared_ptr<CommandStream>
+                (new GeneratedStream(index, unum, gSayInterval));
+        }
+
+    string fileName = gStream;
+    const size_t pos = fileName.find("%d");
+    if (pos != string::npos)
+        {
+            char number[16];
+            snprintf(number, sizeof(number), "%d", index);
+            fileName.replace(pos, 2, number);
+        }
+
+    std::shared_ptr<RecordedStream> stream = RecordedStream::Load(fileName);
+    if (stream.get() == 0)
+        {
+            cerr << "can't read a command stream from '" << fileName << "'\n";
+        }
+
+    return stream;
+}
+
+int
+main(int argc, char* argv[])
+{
+    // registering the handler, catching SIGINT signals
+    signal(SIGINT, handler);
+#ifdef SIGPIPE
+    signal(SIGPIPE, SIG_IGN);
+#endif
+
+    PrintGreeting();
+    if (! ReadOptions(argc, argv))
+        {
+            PrintHelp();
+            return 1;
+        }
+
+    LoadGenerator generator;
+    generator.SetConnectInterval(gConnectInterval);
+
+    for (int i = 0; i < gAgents; ++i)
+        {
+            // fill the teams of the first server before the next one
+            const int server = i / (2 * gTeamSize);
+            const int team = (i / gTeamSize) % 2;
+            const int unum = i % gTeamSize + 1;
+
+            std::shared_ptr<CommandStream> stream = CreateStream(i, unum);
+            if (stream.get() == 0)
+                {
+                    return 1;
+                }
+
+            char teamName[32];
+            snprintf(teamName, sizeof(teamName), "Load%d%c", server, team == 0 ? 'A' : 'B');
+
+            generator.AddAgent
+                (std::shared_ptr<LoadAgent>
+                 (new LoadAgent(i, teamName, unum, "(scene " + gScene + ")", stream, gSync)),
+                 Addr(gPort + server, gHost));
+        }
+
+    cout << "connecting " << gAgents << " agents to " << gHost << ":" << gPort;
+    if (gServers > 1)
+        {
+            cout << "-" << (gPort + gServers - 1);
+        }
+    cout << (gSync ? " in sync mode" : " in real time mode") << "\n";
+
+    if (! generator.Run(gCycles, gDuration))
+        {
+            return 1;
+        }
+
+    generator.PrintReport(cout);
+    return 0;
+}
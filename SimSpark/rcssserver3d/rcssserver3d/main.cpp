@@ -87,6 +87,10 @@ void SimSpark::PrintHelp()
         << " --init-script-prefix PATH\t path prefix for init scripts (spark.rb, oxygen.rb, etc.).\n"
         << " --agent-port PORTNUM\t\t port for agents to connect to.\n"
         << " --server-port PORTNUM\t\t port for monitors to connect to.\n"
+        << " --turbo\t\t\t run headless as fast as the agents respond.\n"
+        << " --seed SEED\t\t\t random seed, used to reproduce turbo runs.\n"
+        << " --journal-record FILE\t\t record the agent and trainer input.\n"
+        << " --journal-replay FILE\t\t replay a recorded input headless and quit.\n"
 #ifdef RVDRAW
         << " --rvdraw-host HOST\t\t host to connect to for drawing in roboviz.\n"
 #endif // RVDRAW
@@ -135,6 +139,46 @@ bool SimSpark::ProcessCmdLine(int argc, char* argv[])
                return false;
             }
         }
+        else if (strcmp(argv[i], "--turbo") == 0)
+        {
+          GetScriptServer()->Eval("$enableTurboMode = true");
+        }
+        else if (strcmp(argv[i], "--seed") == 0)
+        {
+          i++;
+          if (i < argc)
+            GetScriptServer()->Eval(string("$randomSeed = ") + argv[i]);
+          else
+            {
+               PrintHelp();
+               return false;
+            }
+        }
+        else if (strcmp(argv[i], "--journal-record") == 0)
+        {
+          i++;
+          if (i < argc)
+            GetScriptServer()->SetGlobalVariable("$journalRecord", argv[i]);
+          else
+            {
+               PrintHelp();
+               return false;
+            }
+        }
+        else if (strcmp(argv[i], "--journal-replay") == 0)
+        {
+          i++;
+          if (i < argc)
+            {
+              GetScriptServer()->SetGlobalVariable("$journalReplay", argv[i]);
+              GetScriptServer()->Eval("$enableTurboMode = true");
+            }
+          else
+            {
+               PrintHelp();
+               return false;
+            }
+        }
 #ifdef RVDRAW
         else if (strcmp(argv[i], "--rvdraw-host") == 0)
         {
@@ -192,7 +236,7 @@ int main(int argc, char** argv)
     spark.GetSimulationServer()->Run(argc,argv);
 
     std::shared_ptr<RenderControl> renderCtr = spark.GetRenderControl();
-    if (renderCtr.get() != 0)
+    if (renderCtr.get() != 0 && !spark.GetSimulationServer()->GetTurboMode())
     {
         spark.GetLog()->Normal()
             << "Average FPS: "
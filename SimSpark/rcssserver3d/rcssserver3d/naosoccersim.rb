@@ -33,7 +33,7 @@ end
 # set a random seed (a seed of 0 means: use a random random seed)
 randomServer = get($serverPath+'random')
 if (randomServer != nil)
-  randomServer.seed(0)
+  randomServer.seed($randomSeed)
 end
 
 # the soccer field dimensions in meters
@@ -201,6 +201,7 @@ if (gameControlServer != nil)
   gameControlServer.initControlAspect('GameStateAspect')
   gameControlServer.initControlAspect('BallStateAspect')
   gameControlServer.initControlAspect('SoccerRuleAspect')
+  gameControlServer.initControlAspect('VisionOccluderAspect')
   obj = get('/sys/server/gamecontrol/GameStateAspect')
   if (obj != nil)
 	  obj.setTime(0)
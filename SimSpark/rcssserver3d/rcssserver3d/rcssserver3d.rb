@@ -11,6 +11,16 @@ $enableInternalMonitor = false
 # toggle the real time mode
 $enableRealTimeMode = true
 
+# the headless turbo mode neither renders nor waits for a timer, and
+# needs a fixed seed to be reproducible
+if ($enableTurboMode)
+  $enableInternalMonitor = false
+  $enableRealTimeMode = false
+  if ($randomSeed == 0)
+    $randomSeed = 1
+  end
+end
+
 sparkSetupServer()
 if ($enableInternalMonitor)
   sparkSetupRendering()
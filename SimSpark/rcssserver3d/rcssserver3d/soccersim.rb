@@ -26,7 +26,7 @@ end
 # set a random seed (a seed of 0 means: use a random random seed)
 randomServer = get($serverPath+'random')
 if (randomServer != nil)
-  randomServer.seed(0)
+  randomServer.seed($randomSeed)
 end
 
 # the soccer field dimensions in meters
@@ -88,6 +88,7 @@ if (gameControlServer != nil)
   gameControlServer.initControlAspect('GameStateAspect')
   gameControlServer.initControlAspect('BallStateAspect')
   gameControlServer.initControlAspect('SoccerRuleAspect')
+  gameControlServer.initControlAspect('VisionOccluderAspect')
 end
   
 # init monitorItems to transmit game state information
@@ -111,6 +111,7 @@ if (gameControlServer != nil)
   gameControlServer.initControlAspect('GameStateAspect')
   gameControlServer.initControlAspect('BallStateAspect')
   gameControlServer.initControlAspect('SoccerRuleAspect')
+  gameControlServer.initControlAspect('VisionOccluderAspect')
   obj = get('/sys/server/gamecontrol/GameStateAspect')
   if (obj != nil)
 	  obj.setTime(0)
@@ -88,6 +88,7 @@ if (gameControlServer != nil)
   gameControlServer.initControlAspect('GameStateAspect')
   gameControlServer.initControlAspect('BallStateAspect')
   gameControlServer.initControlAspect('SoccerRuleAspect')
+  gameControlServer.initControlAspect('VisionOccluderAspect')
 end
   
 # init monitorItems to transmit game state information
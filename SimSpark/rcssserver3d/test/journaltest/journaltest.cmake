@@ -0,0 +1,56 @@
+# runs journaltest to record a journal and to replay it twice, then
+# compares the ball traces and the agent senses of the three runs
+
+set(JOURNAL ${WORKDIR}/journaltest.journal)
+
+foreach(RUN record replay1 replay2)
+  if (RUN STREQUAL "record")
+    set(MODE record)
+  else ()
+    set(MODE replay)
+  endif ()
+
+  execute_process(
+    COMMAND ${JOURNALTEST} ${MODE} ${JOURNAL} ${WORKDIR}/${RUN}.trace
+            ${WORKDIR}/${RUN}.senses
+    WORKING_DIRECTORY ${WORKDIR}
+    RESULT_VARIABLE RESULT)
+
+  if (NOT RESULT EQUAL 0)
+    message(FATAL_ERROR "journaltest ${MODE} failed: ${RESULT}")
+  endif ()
+endforeach ()
+
+file(READ ${WORKDIR}/record.trace RECORD_TRACE)
+string(LENGTH "${RECORD_TRACE}" TRACE_LENGTH)
+if (TRACE_LENGTH EQUAL 0)
+  message(FATAL_ERROR "the recording traced no cycles")
+endif ()
+
+foreach(RUN replay1 replay2)
+  execute_process(
+    COMMAND ${CMAKE_COMMAND} -E compare_files
+            ${WORKDIR}/record.trace ${WORKDIR}/${RUN}.trace
+    RESULT_VARIABLE RESULT)
+
+  if (NOT RESULT EQUAL 0)
+    message(FATAL_ERROR "the ball trajectory of ${RUN} differs from the recording")
+  endif ()
+endforeach ()
+
+file(READ ${WORKDIR}/record.senses RECORD_SENSES)
+string(LENGTH "${RECORD_SENSES}" SENSES_LENGTH)
+if (SENSES_LENGTH EQUAL 0)
+  message(FATAL_ERROR "the recording sensed no agents")
+endif ()
+
+foreach(RUN replay1 replay2)
+  execute_process(
+    COMMAND ${CMAKE_COMMAND} -E compare_files
+            ${WORKDIR}/record.senses ${WORKDIR}/${RUN}.senses
+    RESULT_VARIABLE RESULT)
+
+  if (NOT RESULT EQUAL 0)
+    message(FATAL_ERROR "the agent senses of ${RUN} differ from the recording")
+  endif ()
+endforeach ()
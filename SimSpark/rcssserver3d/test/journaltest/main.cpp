@@ -0,0 +1,373 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+   this file is part of rcssserver3D
+   Copyright (C) 2004-2025 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+/* journaltest boots the soccer simulation headless and either records
+   a game into a command journal, or replays such a journal. The game
+   is driven by a few trainer commands and by simulated agents, which
+   are connected to the GameControlServer like the agents of
+   simspark-bench; while recording, their input is passed to the
+   journal as the AgentControl does.
+
+   Both write the ball position after every cycle into a trace file
+   and the senses of the agents into a sense file; the recording
+   generates the senses itself, a replay through $journalSenseLog.
+   The files of a recording and of its replays must be identical (see
+   journaltest.cmake).
+
+   usage: journaltest record|replay JOURNAL TRACE SENSES
+*/
+
+#include <spark/spark.h>
+#include <zeitgeist/zeitgeist.h>
+#include <zeitgeist/fileserver/fileserver.h>
+#include <oxygen/simulationserver/simulationserver.h>
+#include <oxygen/simulationserver/commandjournal.h>
+#include <oxygen/simulationserver/cyclearena.h>
+#include <oxygen/gamecontrolserver/gamecontrolserver.h>
+#include <oxygen/gamecontrolserver/baseparser.h>
+#include <oxygen/agentaspect/agentaspect.h>
+#include <oxygen/monitorserver/monitorserver.h>
+#include <oxygen/physicsserver/rigidbody.h>
+#include <oxygen/sceneserver/scene.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#ifdef HAVE_CONFIG_H
+#undef PACKAGE_NAME
+#include <rcssserver3d_config.h>
+#endif
+
+using namespace spark;
+using namespace oxygen;
+using namespace zeitgeist;
+using namespace salt;
+using namespace std;
+
+namespace
+{
+    /** the number of recorded cycles */
+    const int RECORD_CYCLES = 300;
+
+    /** the trainer input of the recording, sent after the given cycle */
+    struct TrainerCommand
+    {
+        int cycle;
+        const char* message;
+    };
+
+    const TrainerCommand TRAINER_COMMANDS[] =
+    {
+        { 5, "(playMode PlayOn)" },
+        { 10, "(ball (pos 0 0 0.5) (vel 4 1.5 3))" },
+        { 120, "(scenario (ball (pos -3 2 0.3) (vel -5 -3 1)))" },
+        { 200, "(ball (pos 1 -1 0.1) (vel 0 6 0))" }
+    };
+
+    /** the number of simulated agents, alternating between the teams */
+    const int NUM_AGENTS = 4;
+
+    /** the client ids of the simulated agents, clear of the socket
+        descriptors the AgentControl uses as ids */
+    const int FIRST_AGENT_ID = 10000;
+
+    const char* JOINTS[] =
+    {
+        "he1", "he2", "lae1", "rae1", "lle3", "rle3", "lle4", "rle4"
+    };
+
+    /** returns the message the agent sends after the given cycle: the
+        scene, init and beam messages, then swinging joints and a say
+        message now and then */
+    string GetAgentMessage(int agent, int cycle)
+    {
+        const int team = agent % 2;
+        const int unum = agent / 2 + 1;
+        char buffer[128];
+
+        switch (cycle)
+        {
+        case 1:
+            return "(scene rsg/agent/nao/nao.rsg)";
+
+        case 2:
+            snprintf(buffer, sizeof(buffer), "(init (unum %d)(teamname %s))",
+                     unum, team == 0 ? "JournalLeft" : "JournalRight");
+            return buffer;
+
+        case 3:
+            snprintf(buffer, sizeof(buffer), "(beam %.2f %.2f 0)",
+                     -1.0 - unum, 0.5 * (2 * team - 1));
+            return buffer;
+
+        default:
+            break;
+        }
+
+        string message;
+        const size_t numJoints = sizeof(JOINTS) / sizeof(JOINTS[0]);
+        for (size_t joint = 0; joint < numJoints; ++joint)
+        {
+            snprintf(buffer, sizeof(buffer), "(%s %.3f)", JOINTS[joint],
+                     1.5 * sin(0.1 * cycle + 0.7 * joint + agent));
+            message += buffer;
+        }
+
+        if (cycle % 25 == agent)
+        {
+            snprintf(buffer, sizeof(buffer), "(say a%dc%d)", agent, cycle);
+            message += buffer;
+        }
+
+        return message;
+    }
+}
+
+class JournalTest : public Spark
+{
+public:
+    JournalTest(bool record, const string& journal, const string& senses)
+        : Spark(), mRecord(record), mJournal(journal), mSenses(senses) {}
+
+    virtual bool InitApp(int argc, char** argv);
+
+    /** connects the simulated agents and records their connects */
+    bool ConnectAgents();
+
+    /** passes the messages of the simulated agents to the
+        GameControlServer and records them */
+    void SendAgentMessages(int cycle);
+
+    /** writes the senses of the agents in the order of their ids, in
+        the format of the sense log of a replay */
+    void SenseAgents(FILE* senses);
+
+    /** writes the ball position of the current cycle */
+    bool TraceBall(FILE* trace);
+
+protected:
+    bool mRecord;
+    string mJournal;
+    string mSenses;
+
+    std::shared_ptr<GameControlServer> mGameControlServer;
+};
+
+bool JournalTest::InitApp(int /*argc*/, char** /*argv*/)
+{
+    GetCore()->AddLibraryLocation(RCSS_LIBRARY_PATH);
+    GetCore()->GetFileServer()->AddResourceLocation(RCSS_BUNDLE_PATH);
+    GetSimulationServer()->SetSimStep(0.02f);
+
+    // stay off the ports of a running server
+    GetScriptServer()->Eval("$agentPort = 3179");
+    GetScriptServer()->Eval("$serverPort = 3279");
+    GetScriptServer()->Eval("$enableTurboMode = true");
+    GetScriptServer()->SetGlobalVariable
+        (mRecord ? "$journalRecord" : "$journalReplay", mJournal);
+
+    if (! mRecord)
+    {
+        GetScriptServer()->SetGlobalVariable("$journalSenseLog", mSenses);
+    }
+
+    GetScriptServer()->Run("rcssserver3d.rb");
+    return true;
+}
+
+bool JournalTest::ConnectAgents()
+{
+    mGameControlServer = GetSimulationServer()->GetGameControlServer();
+    CommandJournal* journal = CommandJournal::GetRecording();
+
+    if (
+        (mGameControlServer.get() == 0) ||
+        (journal == 0)
+        )
+    {
+        GetLog()->Error()
+            << "(JournalTest) ERROR: no GameControlServer or recording journal\n";
+        return false;
+    }
+
+    for (int i = 0; i < NUM_AGENTS; ++i)
+    {
+        journal->RecordConnect(FIRST_AGENT_ID + i);
+        mGameControlServer->AgentConnect(FIRST_AGENT_ID + i);
+    }
+
+    return true;
+}
+
+void JournalTest::SendAgentMessages(int cycle)
+{
+    CommandJournal* journal = CommandJournal::GetRecording();
+
+    for (int i = 0; i < NUM_AGENTS; ++i)
+    {
+        const int id = FIRST_AGENT_ID + i;
+        std::shared_ptr<AgentAspect> agent = mGameControlServer->GetAgentAspect(id);
+        if (agent.get() == 0)
+        {
+            continue;
+        }
+
+        const string message = GetAgentMessage(i, cycle);
+        if (journal != 0)
+        {
+            journal->RecordAgentMessage(id, message);
+        }
+
+        CycleArena::Scope arena;
+        agent->RealizeActions(mGameControlServer->Parse(id, message));
+    }
+}
+
+void JournalTest::SenseAgents(FILE* senses)
+{
+    std::shared_ptr<BaseParser> parser = mGameControlServer->GetParser();
+    if (parser.get() == 0)
+    {
+        return;
+    }
+
+    const int cycle = GetSimulationServer()->GetCycle();
+
+    for (int i = 0; i < NUM_AGENTS; ++i)
+    {
+        const int id = FIRST_AGENT_ID + i;
+        std::shared_ptr<AgentAspect> agent = mGameControlServer->GetAgentAspect(id);
+        if (agent.get() == 0)
+        {
+            continue;
+        }
+
+        CycleArena::Scope arena;
+        std::shared_ptr<PredicateList> senseList = agent->QueryPerceptors();
+        const string sense = parser->Generate(senseList);
+        fprintf(senses, "%d %d %s\n", cycle, id, sense.c_str());
+    }
+}
+
+bool JournalTest::TraceBall(FILE* trace)
+{
+    std::shared_ptr<Scene> scene = GetActiveScene();
+    if (scene.get() == 0)
+    {
+        return false;
+    }
+
+    std::shared_ptr<RigidBody> ball = std::dynamic_pointer_cast<RigidBody>
+        (GetCore()->Get(scene->GetFullPath() + "Ball/physics"));
+    if (ball.get() == 0)
+    {
+        GetLog()->Error() << "(JournalTest) ERROR: ball not found\n";
+        return false;
+    }
+
+    const Vector3f pos = ball->GetPosition();
+    fprintf(trace, "%d %.9g %.9g %.9g\n",
+            GetSimulationServer()->GetCycle(), pos[0], pos[1], pos[2]);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (
+        (argc != 5) ||
+        (strcmp(argv[1], "record") != 0 && strcmp(argv[1], "replay") != 0)
+        )
+    {
+        printf("usage: journaltest record|replay JOURNAL TRACE SENSES\n");
+        return 1;
+    }
+
+    const bool record = (strcmp(argv[1], "record") == 0);
+    JournalTest spark(record, argv[2], argv[4]);
+
+    if (! spark.Init(1, argv))
+    {
+        return 1;
+    }
+
+    FILE* trace = fopen(argv[3], "w");
+    if (trace == 0)
+    {
+        printf("journaltest: can't create '%s'\n", argv[3]);
+        return 1;
+    }
+
+    std::shared_ptr<SimulationServer> sim = spark.GetSimulationServer();
+    std::shared_ptr<MonitorServer> monitor = sim->GetMonitorServer();
+    const size_t numCommands = sizeof(TRAINER_COMMANDS) / sizeof(TRAINER_COMMANDS[0]);
+
+    // a replay writes the senses through its sense log
+    FILE* senses = 0;
+    if (record)
+    {
+        senses = fopen(argv[4], "w");
+        if (senses == 0)
+        {
+            printf("journaltest: can't create '%s'\n", argv[4]);
+            fclose(trace);
+            return 1;
+        }
+    }
+
+    sim->Init(1, argv);
+
+    bool ok = (! record) || spark.ConnectAgents();
+    size_t command = 0;
+
+    // a recording sends the trainer commands and the agent messages
+    // after the cycle and then generates the senses; a replay feeds
+    // the input in at the same point and senses the agents right
+    // after it, so the ball is traced after both
+    while (ok && (record ? sim->GetCycle() < RECORD_CYCLES : ! SimulationServer::WantsToQuit()))
+    {
+        sim->Cycle();
+
+        if (record)
+        {
+            while (
+                   command < numCommands &&
+                   TRAINER_COMMANDS[command].cycle == sim->GetCycle()
+                   )
+            {
+                monitor->ParseMonitorMessage(TRAINER_COMMANDS[command].message);
+                ++command;
+            }
+
+            spark.SendAgentMessages(sim->GetCycle());
+            spark.SenseAgents(senses);
+        }
+
+        ok = spark.TraceBall(trace);
+    }
+
+    sim->Done();
+    fclose(trace);
+
+    if (senses != 0)
+    {
+        fclose(senses);
+    }
+
+    return ok ? 0 : 1;
+}
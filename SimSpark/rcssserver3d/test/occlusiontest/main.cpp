@@ -0,0 +1,222 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+   this file is part of rcssserver3D
+   Copyright (C) 2004-2025 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+/* occlusiontest builds the robot proxies of the
+   RestrictedVisionPerceptor for Nao sized robots by hand and checks
+   the lines of sight to targets that are known to be hidden or
+   visible. It then times the test of a full 11 vs 11 field; the time
+   is printed, not checked.
+*/
+
+#include <restrictedvisionperceptor/visionoccluders.h>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace salt;
+using namespace std;
+
+namespace
+{
+    int gFailures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (! condition)
+        {
+            printf("FAILED: %s\n", what);
+            ++gFailures;
+        }
+    }
+
+    /** the height of the eyes of a robot */
+    const float EYE_HEIGHT = 0.53f;
+
+    /** adds the capsules of a standing Nao sized robot at x,y: the
+        torso, the head, two legs and two arms
+    */
+    void AddRobot(VisionOccluders& occluders, float x, float y)
+    {
+        occluders.BeginAgent(0);
+
+        occluders.AddCapsule(Vector3f(x, y, 0.35f),
+                             Vector3f(x, y, 0.45f), 0.05f);
+        occluders.AddCapsule(Vector3f(x, y, EYE_HEIGHT),
+                             Vector3f(x, y, EYE_HEIGHT), 0.065f);
+
+        for (int side = -1; side <= 1; side += 2)
+        {
+            for (int k = 0; k < 6; ++k)
+            {
+                occluders.AddCapsule
+                    (Vector3f(x, y + side * 0.055f, 0.3f - 0.05f * k),
+                     Vector3f(x, y + side * 0.055f, 0.25f - 0.05f * k),
+                     0.03f);
+            }
+
+            for (int k = 0; k < 3; ++k)
+            {
+                occluders.AddCapsule
+                    (Vector3f(x, y + side * 0.1f, 0.45f - 0.07f * k),
+                     Vector3f(x, y + side * 0.1f, 0.40f - 0.07f * k),
+                     0.025f);
+            }
+        }
+
+        occluders.EndAgent();
+    }
+
+    void TestKnownCases()
+    {
+        // robot 0 stands between robot 1 and the targets at x = 3
+        VisionOccluders occluders;
+        AddRobot(occluders, 1.0f, 0.0f);
+        AddRobot(occluders, -5.0f, 0.0f);
+
+        const Vector3f eye(-5.0f, 0.0f, EYE_HEIGHT);
+        const int observer = 1;
+
+        VisionOccluders::Targets targets;
+        targets.Add(Vector3f(3.0f, 0.055f, 0.04f) - eye, -1);
+        targets.Add(Vector3f(3.0f, 1.0f, 0.04f) - eye, -1);
+        targets.Add(Vector3f(0.0f, 0.0f, 0.04f) - eye, -1);
+        targets.Add(Vector3f(3.0f, 0.0f, 2.0f) - eye, -1);
+        targets.Add(Vector3f(3.0f, 0.055f, 0.04f) - eye, 0);
+        targets.Add(Vector3f(0.0f, 0.0f, 0.0f), -1);
+        targets.Add(Vector3f(-7.0f, 0.0f, 0.2f) - eye, -1);
+        targets.Add(Vector3f(3.0f, 0.0f, EYE_HEIGHT) - eye, -1);
+
+        occluders.TestVisibility(eye, observer, targets);
+
+        Check(targets.Size() == 8, "all targets are tested");
+        if (targets.Size() != 8)
+        {
+            return;
+        }
+
+        Check(targets.occluded[0] == 1,
+              "a ball behind the leg of a robot is occluded");
+        Check(targets.occluded[1] == 0,
+              "a ball beside a robot is visible");
+        Check(targets.occluded[2] == 0,
+              "a ball in front of a robot is visible");
+        Check(targets.occluded[3] == 0,
+              "a target above a robot is visible");
+        Check(targets.occluded[4] == 0,
+              "a robot does not occlude its own body parts");
+        Check(targets.occluded[5] == 0,
+              "a target at the eye is visible");
+        Check(targets.occluded[6] == 0,
+              "the body of the observer does not occlude");
+        Check(targets.occluded[7] == 1,
+              "a target behind the head of a robot is occluded");
+    }
+
+    void TimeField()
+    {
+        const int numRobots = 22;
+        const int cycles = 1000;
+
+        mt19937 rng(1);
+        uniform_real_distribution<float> ux(-15.0f, 15.0f);
+        uniform_real_distribution<float> uy(-10.0f, 10.0f);
+
+        VisionOccluders occluders;
+        vector<Vector3f> pos;
+        for (int i = 0; i < numRobots; ++i)
+        {
+            pos.push_back(Vector3f(ux(rng), uy(rng), 0.0f));
+            AddRobot(occluders, pos[i].x(), pos[i].y());
+        }
+
+        // the corner flags, the goal posts and the ball
+        vector<Vector3f> fixed;
+        for (int i = 0; i < 4; ++i)
+        {
+            fixed.push_back(Vector3f((i < 2) ? -15.0f : 15.0f,
+                                     (i % 2) ? 10.0f : -10.0f, 0.0f));
+            fixed.push_back(Vector3f((i < 2) ? -15.0f : 15.0f,
+                                     (i % 2) ? 1.05f : -1.05f, 0.8f));
+        }
+        fixed.push_back(Vector3f(0.0f, 0.0f, 0.04f));
+
+        VisionOccluders::Targets targets;
+        size_t hidden = 0;
+        size_t total = 0;
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (int c = 0; c < cycles; ++c)
+        {
+            for (int o = 0; o < numRobots; ++o)
+            {
+                const Vector3f eye = pos[o] + Vector3f(0.0f, 0.0f, EYE_HEIGHT);
+
+                targets.Clear();
+                for (size_t f = 0; f < fixed.size(); ++f)
+                {
+                    targets.Add(fixed[f] - eye, -1);
+                }
+
+                // the head, the arms and a foot of the other robots
+                for (int p = 0; p < numRobots; ++p)
+                {
+                    if (p == o)
+                    {
+                        continue;
+                    }
+
+                    targets.Add(pos[p] + Vector3f(0.0f, 0.0f, EYE_HEIGHT) - eye, p);
+                    targets.Add(pos[p] + Vector3f(0.0f, 0.1f, 0.45f) - eye, p);
+                    targets.Add(pos[p] + Vector3f(0.0f, -0.1f, 0.45f) - eye, p);
+                    targets.Add(pos[p] + Vector3f(0.0f, 0.055f, 0.02f) - eye, p);
+                }
+
+                occluders.TestVisibility(eye, o, targets);
+
+                for (size_t t = 0; t < targets.Size(); ++t)
+                {
+                    hidden += targets.occluded[t];
+                }
+                total += targets.Size();
+            }
+        }
+        chrono::steady_clock::time_point end = chrono::steady_clock::now();
+
+        printf("%d robots: %.1f us per cycle for all observers, "
+               "%zu of %zu targets hidden\n",
+               numRobots,
+               chrono::duration<double, micro>(end - start).count() / cycles,
+               hidden / cycles, total / cycles);
+    }
+}
+
+int main()
+{
+    TestKnownCases();
+    TimeField();
+
+    if (gFailures > 0)
+    {
+        printf("%d check(s) failed\n", gFailures);
+        return 1;
+    }
+
+    printf("all checks passed\n");
+    return 0;
+}
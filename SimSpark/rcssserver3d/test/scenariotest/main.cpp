@@ -0,0 +1,218 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+   this file is part of rcssserver3D
+   Copyright (C) 2004-2025 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+/* scenariotest boots the soccer simulation headless and sends binary
+   scenario messages to the trainer command parser. The messages take
+   the path of a monitor client: they are length prefixed into a
+   receive buffer and cut out of it by NetMessage::Extract(), which
+   terminates them with a '\0'.
+*/
+
+#include <spark/spark.h>
+#include <zeitgeist/zeitgeist.h>
+#include <zeitgeist/fileserver/fileserver.h>
+#include <oxygen/simulationserver/simulationserver.h>
+#include <oxygen/simulationserver/netmessage.h>
+#include <oxygen/simulationserver/netbuffer.h>
+#include <oxygen/monitorserver/monitorserver.h>
+#include <oxygen/physicsserver/rigidbody.h>
+#include <oxygen/sceneserver/scene.h>
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+
+#ifdef HAVE_CONFIG_H
+#undef PACKAGE_NAME
+#include <rcssserver3d_config.h>
+#endif
+
+using namespace spark;
+using namespace oxygen;
+using namespace zeitgeist;
+using namespace salt;
+using namespace std;
+
+namespace
+{
+    int gFailures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (! condition)
+        {
+            printf("FAILED: %s\n", what);
+            ++gFailures;
+        }
+    }
+
+    void AppendFloat(string& msg, float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        for (int i = 0; i < 4; ++i)
+        {
+            msg += (char)((bits >> (8 * i)) & 0xff);
+        }
+    }
+
+    /** returns a binary scenario that moves the ball to pos; it ends
+        with the agent count 0, i.e. with a '\0' of its own */
+    string BallScenario(const Vector3f& pos)
+    {
+        string msg("SSCN1");
+        msg += (char)4;
+        AppendFloat(msg, pos[0]);
+        AppendFloat(msg, pos[1]);
+        AppendFloat(msg, pos[2]);
+        msg += (char)0;
+
+        return msg;
+    }
+}
+
+class ScenarioTest : public Spark
+{
+public:
+    ScenarioTest() : Spark() {}
+
+    virtual bool InitApp(int argc, char** argv);
+
+    /** returns the ball position */
+    bool GetBallPos(Vector3f& pos);
+
+    /** sends a message like a monitor client does and returns true if
+        NetMessage extracted exactly one message */
+    bool SendMonitorMessage(const string& msg);
+};
+
+bool ScenarioTest::InitApp(int /*argc*/, char** /*argv*/)
+{
+    GetCore()->AddLibraryLocation(RCSS_LIBRARY_PATH);
+    GetCore()->GetFileServer()->AddResourceLocation(RCSS_BUNDLE_PATH);
+    GetSimulationServer()->SetSimStep(0.02f);
+
+    // stay off the ports of a running server
+    GetScriptServer()->Eval("$agentPort = 3189");
+    GetScriptServer()->Eval("$serverPort = 3289");
+    GetScriptServer()->Eval("$enableTurboMode = true");
+
+    GetScriptServer()->Run("rcssserver3d.rb");
+    return true;
+}
+
+bool ScenarioTest::GetBallPos(Vector3f& pos)
+{
+    std::shared_ptr<Scene> scene = GetActiveScene();
+    if (scene.get() == 0)
+    {
+        return false;
+    }
+
+    std::shared_ptr<RigidBody> ball = std::dynamic_pointer_cast<RigidBody>
+        (GetCore()->Get(scene->GetFullPath() + "Ball/physics"));
+    if (ball.get() == 0)
+    {
+        GetLog()->Error() << "(ScenarioTest) ERROR: ball not found\n";
+        return false;
+    }
+
+    pos = ball->GetPosition();
+    return true;
+}
+
+bool ScenarioTest::SendMonitorMessage(const string& msg)
+{
+    std::shared_ptr<NetMessage> netMessage(new NetMessage());
+    std::shared_ptr<NetBuffer> buffer(new NetBuffer());
+
+    // frame the message as NetMessage::PrepareToSend() does
+    string framed(msg);
+    netMessage->PrepareToSend(framed);
+    buffer->AddFragment(framed);
+
+    std::shared_ptr<MonitorServer> monitor =
+        GetSimulationServer()->GetMonitorServer();
+
+    int count = 0;
+    string received;
+    while (netMessage->Extract(buffer, received))
+    {
+        monitor->ParseMonitorMessage(received);
+        ++count;
+    }
+
+    return (count == 1);
+}
+
+int main(int /*argc*/, char** argv)
+{
+    ScenarioTest spark;
+
+    if (! spark.Init(1, argv))
+    {
+        return 1;
+    }
+
+    std::shared_ptr<SimulationServer> sim = spark.GetSimulationServer();
+    sim->Init(1, argv);
+
+    // let the scene settle
+    for (int i = 0; i < 5; ++i)
+    {
+        sim->Cycle();
+    }
+
+    Vector3f pos;
+    if (! spark.GetBallPos(pos))
+    {
+        sim->Done();
+        return 1;
+    }
+
+    // a scenario received from a monitor client
+    const Vector3f received(1.0f, 2.0f, 0.5f);
+    Check(spark.SendMonitorMessage(BallScenario(received)),
+          "the binary scenario is extracted as one message");
+    Check(spark.GetBallPos(pos) && (pos - received).Length() < 1e-5f,
+          "a received binary scenario moves the ball");
+
+    // the same scenario passed on without the '\0' of NetMessage
+    const Vector3f direct(-2.0f, 1.0f, 0.3f);
+    sim->GetMonitorServer()->ParseMonitorMessage(BallScenario(direct));
+    Check(spark.GetBallPos(pos) && (pos - direct).Length() < 1e-5f,
+          "an unterminated binary scenario moves the ball");
+
+    // trailing data after the scenario is rejected
+    Check(spark.SendMonitorMessage(BallScenario(received) + "x"),
+          "the long binary scenario is extracted as one message");
+    Check(spark.GetBallPos(pos) && (pos - direct).Length() < 1e-5f,
+          "a binary scenario with trailing data is rejected");
+
+    sim->Done();
+
+    if (gFailures > 0)
+    {
+        printf("%d check(s) failed\n", gFailures);
+        return 1;
+    }
+
+    printf("all checks passed\n");
+    return 0;
+}
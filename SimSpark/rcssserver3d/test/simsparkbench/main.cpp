@@ -0,0 +1,786 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+   this file is part of rcssserver3D
+   Copyright (C) 2004-2025 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+/* simspark-bench boots the soccer simulation headless in turbo mode,
+   i.e. without timer sleeps, and runs it through a set of scripted
+   scenes. The agents are simulated in process: their messages are
+   passed to the GameControlServer and their perceptors are queried
+   directly, so the numbers do not depend on the network or on the
+   agent processes. Every scene runs in its own process, as the
+   simulation can only be booted once per process.
+
+   For every scene the benchmark reports the wall time of a cycle
+   (including the agent input and the sense generation), the cycle
+   profiler breakdown of the server phases, the operator new calls per
+   cycle and the resident set size, as JSON on stdout or into a file.
+
+   usage: simspark-bench [--scene NAME]... [--warmup N] [--cycles N]
+                         [--contact-cache] [--cycle-arena]
+                         [--no-occlusion] [--label TEXT] [--output FILE]
+
+   The scenes are empty (no agents), standing (22 idle Naos), scrum
+   (22 Naos moving their joints around the kick off spot) and traffic
+   (the scrum, with every agent saying something every cycle). The
+   label, e.g. the commit id, is copied into the output.
+
+   --contact-cache enables the contact cache of the physics space
+   ($enableContactCache) and adds its hit rates to every scene. Run
+   the benchmark with and without it to compare the step times.
+
+   --cycle-arena allocates the predicates from the per thread cycle
+   arenas ($enableCycleArena) and adds their allocation counts to
+   every scene. Compare allocationsPerCycle and cycleTime of runs with
+   and without it.
+
+   --no-occlusion disables the VisionOccluderAspect, i.e. the test of
+   the vision perceptors for objects hidden behind robots. Compare the
+   senseTime of runs with and without it; the proxies are built in the
+   VisionOccluderAspect::Update section of the step.
+*/
+
+#include <spark/spark.h>
+#include <zeitgeist/zeitgeist.h>
+#include <zeitgeist/fileserver/fileserver.h>
+#include <oxygen/simulationserver/simulationserver.h>
+#include <oxygen/simulationserver/cycleprofiler.h>
+#include <oxygen/simulationserver/cyclearena.h>
+#include <oxygen/gamecontrolserver/gamecontrolserver.h>
+#include <oxygen/gamecontrolserver/baseparser.h>
+#include <oxygen/agentaspect/agentaspect.h>
+#include <oxygen/monitorserver/monitorserver.h>
+#include <oxygen/physicsserver/space.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sstream>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifdef HAVE_CONFIG_H
+#undef PACKAGE_NAME
+#include <rcssserver3d_config.h>
+#endif
+
+using namespace spark;
+using namespace oxygen;
+using namespace zeitgeist;
+using namespace std;
+
+namespace
+{
+    /** counts the calls of operator new, see below */
+    std::atomic<unsigned long long> gAllocations(0);
+
+    /** a scripted scene */
+    struct BenchScene
+    {
+        const char* name;
+        int agentsPerTeam;
+        bool moveJoints;
+        bool say;
+    };
+
+    const BenchScene SCENES[] =
+    {
+        { "empty", 0, false, false },
+        { "standing", 11, false, false },
+        { "scrum", 11, true, false },
+        { "traffic", 11, true, true }
+    };
+
+    const char* JOINTS[] =
+    {
+        "he1", "he2",
+        "lae1", "lae2", "lae3", "lae4",
+        "rae1", "rae2", "rae3", "rae4",
+        "lle1", "lle2", "lle3", "lle4", "lle5", "lle6",
+        "rle1", "rle2", "rle3", "rle4", "rle5", "rle6"
+    };
+
+    /** the client ids of the simulated agents, clear of the socket
+        descriptors the AgentControl uses as ids */
+    const int FIRST_AGENT_ID = 10000;
+
+    /** the cycles of the agent bring up: the scene message, the init
+        message and the beam, after which the game is started */
+    const int BRING_UP_CYCLES = 4;
+
+    typedef std::chrono::steady_clock TClock;
+
+    double ElapsedMicroseconds(TClock::time_point start, TClock::time_point end)
+    {
+        return std::chrono::duration<double, std::micro>(end - start).count();
+    }
+
+    /** the nearest rank percentile of sorted values */
+    double Percentile(const vector<double>& sorted, double p)
+    {
+        if (sorted.empty())
+        {
+            return 0.0;
+        }
+
+        size_t rank = static_cast<size_t>(ceil(p * sorted.size()));
+        return sorted[std::max<size_t>(rank, 1) - 1];
+    }
+
+    /** writes count, mean, percentiles and max of the given values */
+    void WriteDistribution(ostream& out, vector<double> values)
+    {
+        std::sort(values.begin(), values.end());
+
+        double sum = 0.0;
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            sum += values[i];
+        }
+
+        out << "{\"count\": " << values.size()
+            << ", \"mean\": " << (values.empty() ? 0.0 : sum / values.size())
+            << ", \"p50\": " << Percentile(values, 0.5)
+            << ", \"p90\": " << Percentile(values, 0.9)
+            << ", \"p99\": " << Percentile(values, 0.99)
+            << ", \"max\": " << (values.empty() ? 0.0 : values.back())
+            << "}";
+    }
+
+    /** returns the string as a JSON string literal */
+    string Quote(const string& str)
+    {
+        string quoted = "\"";
+        for (size_t i = 0; i < str.size(); ++i)
+        {
+            const char c = str[i];
+            if (c == '"' || c == '\\')
+            {
+                quoted += '\\';
+                quoted += c;
+            } else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char escape[8];
+                snprintf(escape, sizeof(escape), "\\u%04x", c);
+                quoted += escape;
+            } else
+            {
+                quoted += c;
+            }
+        }
+
+        return quoted + "\"";
+    }
+
+    /** returns the current and the peak resident set size in bytes */
+    void GetMemoryUsage(unsigned long long& rss, unsigned long long& peakRss)
+    {
+        rss = 0;
+        FILE* statm = fopen("/proc/self/statm", "r");
+        if (statm != 0)
+        {
+            unsigned long long size = 0;
+            unsigned long long resident = 0;
+            if (fscanf(statm, "%llu %llu", &size, &resident) == 2)
+            {
+                rss = resident * sysconf(_SC_PAGESIZE);
+            }
+            fclose(statm);
+        }
+
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        peakRss = usage.ru_maxrss;
+#else
+        peakRss = static_cast<unsigned long long>(usage.ru_maxrss) * 1024;
+#endif
+    }
+}
+
+/* all allocations of the process, including those of the libraries,
+   go through these replacements */
+void* operator new(std::size_t size)
+{
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = malloc(size == 0 ? 1 : size);
+    if (ptr == 0)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    free(ptr);
+}
+
+class SimsparkBench : public Spark
+{
+public:
+    SimsparkBench(const BenchScene& scene, int warmup, int cycles,
+                  bool contactCache, bool cycleArena, bool occlusion)
+        : Spark(), mScene(scene), mWarmup(warmup), mCycles(cycles),
+          mContactCache(contactCache), mCycleArena(cycleArena),
+          mOcclusion(occlusion) {}
+
+    virtual bool InitApp(int argc, char** argv);
+
+    /** runs the scene and writes its results as a JSON object */
+    bool Run(ostream& out);
+
+protected:
+    /** passes the messages of the agents to the GameControlServer */
+    void SendMessages(const vector<string>& messages);
+
+    /** queries the perceptors of all agents and generates their sense
+        messages, returns their total length */
+    size_t GenerateSenses();
+
+    /** returns the message of the given agent in the current cycle */
+    string GetMessage(int agent, int cycle) const;
+
+protected:
+    BenchScene mScene;
+    int mWarmup;
+    int mCycles;
+    bool mContactCache;
+    bool mCycleArena;
+    bool mOcclusion;
+
+    std::shared_ptr<SimulationServer> mSimulationServer;
+    std::shared_ptr<GameControlServer> mGameControlServer;
+    std::shared_ptr<BaseParser> mParser;
+};
+
+bool SimsparkBench::InitApp(int /*argc*/, char** /*argv*/)
+{
+    GetCore()->AddLibraryLocation(RCSS_LIBRARY_PATH);
+    GetCore()->GetFileServer()->AddResourceLocation(RCSS_BUNDLE_PATH);
+    GetSimulationServer()->SetSimStep(0.02f);
+
+    // stay off the ports of a running server
+    GetScriptServer()->Eval("$agentPort = 3189");
+    GetScriptServer()->Eval("$serverPort = 3289");
+    GetScriptServer()->Eval("$enableTurboMode = true");
+    GetScriptServer()->Eval("$enableCycleProfiler = true");
+    if (mContactCache)
+    {
+        GetScriptServer()->Eval("$enableContactCache = true");
+    }
+    if (mCycleArena)
+    {
+        GetScriptServer()->Eval("$enableCycleArena = true");
+    }
+
+    // keep the profile of all measured cycles
+    std::ostringstream window;
+    window << "$cycleProfilerWindow = " << mCycles;
+    GetScriptServer()->Eval(window.str());
+
+    GetScriptServer()->Run("rcssserver3d.rb");
+
+    if (! mOcclusion)
+    {
+        GetScriptServer()->Eval
+            (
+             "aspect = get('/sys/server/gamecontrol/VisionOccluderAspect')\n"
+             "if (aspect != nil)\n"
+             "  aspect.setEnabled(false)\n"
+             "end"
+             );
+    }
+
+    return true;
+}
+
+string SimsparkBench::GetMessage(int agent, int cycle) const
+{
+    const int team = agent / mScene.agentsPerTeam;
+    const int unum = agent % mScene.agentsPerTeam + 1;
+    char buffer[128];
+
+    if (cycle == 0)
+    {
+        return "(scene rsg/agent/nao/nao.rsg)";
+    }
+
+    if (cycle == 1)
+    {
+        snprintf(buffer, sizeof(buffer), "(init (unum %d)(teamname %s))",
+                 unum, team == 0 ? "BenchLeft" : "BenchRight");
+        return buffer;
+    }
+
+    if (cycle == 2)
+    {
+        // both teams beam into their own half, two rings around the
+        // kick off spot
+        const double angle = 2.0 * M_PI * unum / mScene.agentsPerTeam;
+        const double radius = (unum % 2 == 0) ? 1.0 : 2.0;
+        snprintf(buffer, sizeof(buffer), "(beam %.2f %.2f 0)",
+                 -0.3 - radius * (1.0 + cos(angle)) / 2.0,
+                 radius * sin(angle));
+        return buffer;
+    }
+
+    string message;
+    if (mScene.moveJoints)
+    {
+        // every joint swings with its own phase and a period of 1s
+        const double t = cycle * mSimulationServer->GetSimStep();
+        const size_t numJoints = sizeof(JOINTS) / sizeof(JOINTS[0]);
+        for (size_t joint = 0; joint < numJoints; ++joint)
+        {
+            const double phase = 0.7 * joint + 0.3 * agent;
+            snprintf(buffer, sizeof(buffer), "(%s %.3f)", JOINTS[joint],
+                     2.0 * sin(2.0 * M_PI * t + phase));
+            message += buffer;
+        }
+    }
+
+    if (mScene.say)
+    {
+        snprintf(buffer, sizeof(buffer), "(say t%du%dc%d)",
+                 team, unum, cycle);
+        message += buffer;
+    }
+
+    return message;
+}
+
+void SimsparkBench::SendMessages(const vector<string>& messages)
+{
+    for (size_t i = 0; i < messages.size(); ++i)
+    {
+        if (messages[i].empty())
+        {
+            continue;
+        }
+
+        const int id = FIRST_AGENT_ID + static_cast<int>(i);
+        std::shared_ptr<AgentAspect> agent = mGameControlServer->GetAgentAspect(id);
+        if (agent.get() == 0)
+        {
+            continue;
+        }
+
+        CycleArena::Scope arena;
+        agent->RealizeActions(mGameControlServer->Parse(id, messages[i]));
+    }
+}
+
+size_t SimsparkBench::GenerateSenses()
+{
+    size_t bytes = 0;
+    const int numAgents = 2 * mScene.agentsPerTeam;
+    for (int i = 0; i < numAgents; ++i)
+    {
+        std::shared_ptr<AgentAspect> agent =
+            mGameControlServer->GetAgentAspect(FIRST_AGENT_ID + i);
+        if (agent.get() == 0)
+        {
+            continue;
+        }
+
+        CycleArena::Scope arena;
+        std::shared_ptr<PredicateList> senseList = agent->QueryPerceptors();
+        if (mParser.get() != 0)
+        {
+            bytes += mParser->Generate(senseList).size();
+        }
+    }
+
+    return bytes;
+}
+
+bool SimsparkBench::Run(ostream& out)
+{
+    mSimulationServer = GetSimulationServer();
+    mGameControlServer = mSimulationServer->GetGameControlServer();
+    if (mGameControlServer.get() == 0)
+    {
+        GetLog()->Error() << "(SimsparkBench) ERROR: no GameControlServer\n";
+        return false;
+    }
+
+    mParser = mGameControlServer->GetParser();
+
+    std::shared_ptr<MonitorServer> monitor = mSimulationServer->GetMonitorServer();
+    const int numAgents = 2 * mScene.agentsPerTeam;
+    char* argv[] = { const_cast<char*>("simspark-bench"), 0 };
+
+    mSimulationServer->Init(1, argv);
+
+    for (int i = 0; i < numAgents; ++i)
+    {
+        mGameControlServer->AgentConnect(FIRST_AGENT_ID + i);
+    }
+
+    vector<string> messages(numAgents);
+    vector<double> cycleTimes;
+    vector<double> inputTimes;
+    vector<double> stepTimes;
+    vector<double> senseTimes;
+    vector<double> allocations;
+    vector<double> senseBytes;
+    cycleTimes.reserve(mCycles);
+    inputTimes.reserve(mCycles);
+    stepTimes.reserve(mCycles);
+    senseTimes.reserve(mCycles);
+    allocations.reserve(mCycles);
+    senseBytes.reserve(mCycles);
+
+    const int totalCycles = BRING_UP_CYCLES + mWarmup + mCycles;
+    TClock::time_point measureStart = TClock::now();
+
+    for (int cycle = 0; cycle < totalCycles; ++cycle)
+    {
+        if (cycle == BRING_UP_CYCLES && monitor.get() != 0)
+        {
+            monitor->ParseMonitorMessage("(playMode PlayOn)");
+        }
+
+        const bool measured = (cycle >= BRING_UP_CYCLES + mWarmup);
+        if (cycle == BRING_UP_CYCLES + mWarmup)
+        {
+            CycleProfiler* profiler = CycleProfiler::GetActive();
+            if (profiler != 0)
+            {
+                profiler->Reset();
+            }
+            measureStart = TClock::now();
+        }
+
+        // the agents' side is not measured
+        for (int i = 0; i < numAgents; ++i)
+        {
+            messages[i] = GetMessage(i, cycle);
+        }
+
+        const unsigned long long allocStart =
+            gAllocations.load(std::memory_order_relaxed);
+        const TClock::time_point start = TClock::now();
+
+        SendMessages(messages);
+        const TClock::time_point sent = TClock::now();
+
+        mSimulationServer->Cycle();
+        const TClock::time_point stepped = TClock::now();
+
+        const size_t bytes = GenerateSenses();
+        const TClock::time_point end = TClock::now();
+
+        if (measured)
+        {
+            cycleTimes.push_back(ElapsedMicroseconds(start, end));
+            inputTimes.push_back(ElapsedMicroseconds(start, sent));
+            stepTimes.push_back(ElapsedMicroseconds(sent, stepped));
+            senseTimes.push_back(ElapsedMicroseconds(stepped, end));
+            allocations.push_back(static_cast<double>
+                                  (gAllocations.load(std::memory_order_relaxed)
+                                   - allocStart));
+            senseBytes.push_back(static_cast<double>(bytes));
+        }
+    }
+
+    const double wallSeconds =
+        ElapsedMicroseconds(measureStart, TClock::now()) / 1e6;
+
+    unsigned long long rss = 0;
+    unsigned long long peakRss = 0;
+    GetMemoryUsage(rss, peakRss);
+
+    vector<CycleProfiler::SectionStats> sections;
+    CycleProfiler* profiler = CycleProfiler::GetActive();
+    if (profiler != 0)
+    {
+        profiler->GetStats(sections);
+    }
+
+    std::shared_ptr<Space> space =
+        std::dynamic_pointer_cast<Space>(GetCore()->Get("/usr/scene/space"));
+    const string contactCache =
+        (space.get() != 0) ? space->GetContactCacheReport() : string();
+    const string cycleArena = mSimulationServer->GetCycleArenaReport();
+
+    mSimulationServer->Done();
+
+    // times in microseconds
+    out << "{\"name\": " << Quote(mScene.name)
+        << ", \"agents\": " << numAgents
+        << ", \"cycles\": " << mCycles
+        << ", \"contactCache\": " << Quote(contactCache)
+        << ", \"cycleArena\": " << Quote(cycleArena)
+        << ", \"wallSeconds\": " << wallSeconds
+        << ", \"cyclesPerSecond\": "
+        << (wallSeconds > 0.0 ? mCycles / wallSeconds : 0.0)
+        << ",\n   \"cycleTime\": ";
+    WriteDistribution(out, cycleTimes);
+    out << ",\n   \"phases\": {\n    \"agentInput\": ";
+    WriteDistribution(out, inputTimes);
+    out << ",\n    \"cycle\": ";
+    WriteDistribution(out, stepTimes);
+    out << ",\n    \"senses\": ";
+    WriteDistribution(out, senseTimes);
+    out << "},\n   \"profiler\": [";
+
+    for (size_t i = 0; i < sections.size(); ++i)
+    {
+        const CycleProfiler::SectionStats& section = sections[i];
+        out << (i == 0 ? "\n    " : ",\n    ")
+            << "{\"section\": " << Quote(section.name)
+            << ", \"count\": " << section.count
+            << ", \"mean\": " << section.mean
+            << ", \"p50\": " << section.p50
+            << ", \"p99\": " << section.p99
+            << ", \"max\": " << section.max << "}";
+    }
+
+    out << "],\n   \"allocationsPerCycle\": ";
+    WriteDistribution(out, allocations);
+    out << ",\n   \"senseBytesPerCycle\": ";
+    WriteDistribution(out, senseBytes);
+    out << ",\n   \"rssBytes\": " << rss
+        << ", \"peakRssBytes\": " << peakRss << "}";
+
+    return true;
+}
+
+namespace
+{
+    void PrintUsage()
+    {
+        printf("usage: simspark-bench [--scene NAME]... [--warmup N] [--cycles N]\n"
+               "                      [--contact-cache] [--cycle-arena]\n"
+               "                      [--no-occlusion] [--label TEXT] [--output FILE]\n"
+               "scenes:");
+        for (size_t i = 0; i < sizeof(SCENES) / sizeof(SCENES[0]); ++i)
+        {
+            printf(" %s", SCENES[i].name);
+        }
+        printf("\n");
+    }
+
+    /** runs a scene in a child process and returns its JSON object */
+    bool RunScene(const BenchScene& scene, int warmup, int cycles,
+                  bool contactCache, bool cycleArena, bool occlusion,
+                  string& result)
+    {
+        int fds[2];
+        if (pipe(fds) != 0)
+        {
+            return false;
+        }
+
+        fflush(stdout);
+        const pid_t pid = fork();
+        if (pid < 0)
+        {
+            close(fds[0]);
+            close(fds[1]);
+            return false;
+        }
+
+        if (pid == 0)
+        {
+            close(fds[0]);
+
+            // keep the log output of the simulation out of the results
+            FILE* devNull = freopen("/dev/null", "w", stdout);
+            (void)devNull;
+
+            char* argv[] = { const_cast<char*>("simspark-bench"), 0 };
+            SimsparkBench spark(scene, warmup, cycles, contactCache,
+                                cycleArena, occlusion);
+            std::ostringstream out;
+
+            bool ok = spark.Init(1, argv) && spark.Run(out);
+
+            const string json = out.str();
+            size_t written = 0;
+            while (ok && written < json.size())
+            {
+                const ssize_t n = write(fds[1], json.data() + written,
+                                        json.size() - written);
+                ok = (n > 0);
+                written += (n > 0) ? n : 0;
+            }
+
+            close(fds[1]);
+            _exit(ok ? 0 : 1);
+        }
+
+        close(fds[1]);
+
+        char buffer[4096];
+        ssize_t n;
+        while ((n = read(fds[0], buffer, sizeof(buffer))) > 0)
+        {
+            result.append(buffer, n);
+        }
+        close(fds[0]);
+
+        int status = 0;
+        waitpid(pid, &status, 0);
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0 && ! result.empty();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    vector<const BenchScene*> scenes;
+    int warmup = 100;
+    int cycles = 1000;
+    bool contactCache = false;
+    bool cycleArena = false;
+    bool occlusion = true;
+    string label;
+    string output;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = (i + 1 < argc);
+
+        if (strcmp(argv[i], "--scene") == 0 && hasValue)
+        {
+            const char* name = argv[++i];
+            const BenchScene* found = 0;
+            for (size_t s = 0; s < sizeof(SCENES) / sizeof(SCENES[0]); ++s)
+            {
+                if (strcmp(SCENES[s].name, name) == 0)
+                {
+                    found = &SCENES[s];
+                }
+            }
+
+            if (found == 0)
+            {
+                printf("simspark-bench: unknown scene '%s'\n", name);
+                PrintUsage();
+                return 1;
+            }
+            scenes.push_back(found);
+        } else if (strcmp(argv[i], "--warmup") == 0 && hasValue)
+        {
+            warmup = std::max(atoi(argv[++i]), 0);
+        } else if (strcmp(argv[i], "--cycles") == 0 && hasValue)
+        {
+            cycles = std::max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--contact-cache") == 0)
+        {
+            contactCache = true;
+        } else if (strcmp(argv[i], "--cycle-arena") == 0)
+        {
+            cycleArena = true;
+        } else if (strcmp(argv[i], "--no-occlusion") == 0)
+        {
+            occlusion = false;
+        } else if (strcmp(argv[i], "--label") == 0 && hasValue)
+        {
+            label = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0 && hasValue)
+        {
+            output = argv[++i];
+        } else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (scenes.empty())
+    {
+        for (size_t s = 0; s < sizeof(SCENES) / sizeof(SCENES[0]); ++s)
+        {
+            scenes.push_back(&SCENES[s]);
+        }
+    }
+
+    std::ostringstream json;
+    json << "{\"benchmark\": \"simspark-bench\""
+         << ", \"version\": " << Quote(RCSS_VERSION)
+         << ", \"label\": " << Quote(label)
+         << ", \"warmupCycles\": " << warmup
+         << ", \"cycles\": " << cycles
+         << ", \"contactCache\": " << (contactCache ? "true" : "false")
+         << ", \"cycleArena\": " << (cycleArena ? "true" : "false")
+         << ", \"occlusion\": " << (occlusion ? "true" : "false")
+         << ",\n \"scenes\": [";
+
+    bool ok = true;
+    bool first = true;
+    for (size_t i = 0; i < scenes.size(); ++i)
+    {
+        string result;
+        if (! RunScene(*scenes[i], warmup, cycles, contactCache, cycleArena,
+                       occlusion, result))
+        {
+            fprintf(stderr, "simspark-bench: scene '%s' failed\n", scenes[i]->name);
+            ok = false;
+            continue;
+        }
+
+        json << (first ? "\n  " : ",\n  ") << result;
+        first = false;
+    }
+
+    json << "]}\n";
+
+    if (output.empty())
+    {
+        fputs(json.str().c_str(), stdout);
+    } else
+    {
+        FILE* file = fopen(output.c_str(), "w");
+        if (file == 0)
+        {
+            printf("simspark-bench: can't create '%s'\n", output.c_str());
+            return 1;
+        }
+        fputs(json.str().c_str(), file);
+        fclose(file);
+    }
+
+    return ok ? 0 : 1;
+}
@@ -50,7 +50,7 @@ SoundServer::~SoundServer()
 
 bool SoundServer::Init(const std::string &sndSysName)
 {
-        GetLog()->Normal().Printf("SoundServer::Init -> '%s'\n", sndSysName.c_str());
+        GetLog()->Normal() << "SoundServer::Init -> '" << sndSysName << "'\n";
         Reset();
 
         // create the soundsystem
@@ -59,7 +59,7 @@ bool SoundServer::Init(const std::string &sndSysName)
         if(!mSoundSystem)
         {
                 // could not create SoundSystem
-                GetLog()->Error().Printf("ERROR: Unable to create '%s'\n", sndSysName.c_str());
+                GetLog()->Error() << "ERROR: Unable to create '" << sndSysName << "'\n";
                 return false;
         }
 
@@ -67,7 +67,7 @@ bool SoundServer::Init(const std::string &sndSysName)
         if(mSoundSystem->Init(mQuality) == false)
         {
                 // something happened when we wanted to initialize the soundsystem
-                GetLog()->Error().Printf("ERROR: Could not init '%s'\n", sndSysName.c_str());
+                GetLog()->Error() << "ERROR: Could not init '" << sndSysName << "'\n";
                 return false;
         }
 
@@ -27,7 +27,8 @@ using namespace oxygen;
 using namespace salt;
 using namespace std;
 
-AgentAspect::AgentAspect() : Transform(), mSyncEnabled(false), mIsSynced(true)
+AgentAspect::AgentAspect() : Transform(), mSyncEnabled(false), mIsSynced(true),
+                               mSyncCount(0)
 {
     SetName("agentAspect");
     mID = -1;
@@ -89,7 +90,7 @@ AgentAspect::QueryPerceptors()
     mPerceptorCycle++;
     // build list of perceptors, searching recursively
 
-    std::shared_ptr<PredicateList> predList(new PredicateList());
+    std::shared_ptr<PredicateList> predList = PredicateList::Create();
 
     // query the perceptors for new data
     for (
@@ -98,9 +99,17 @@ AgentAspect::QueryPerceptors()
          ++iter
          )
         {
-            std::shared_ptr<Perceptor> pct = std::static_pointer_cast<Perceptor>(*iter);
-            if ( mPerceptorCycle % pct->GetInterval() == 0 )
-                pct->Percept(predList);
+            Perceptor* pct = static_cast<Perceptor*>(iter->get());
+            if (pct->IsBatched())
+                {
+                    continue;
+                }
+
+            const unsigned int interval = pct->GetInterval();
+            if (interval <= 1 || mPerceptorCycle % interval == 0)
+                {
+                    pct->Percept(predList);
+                }
         }
 
     return predList;
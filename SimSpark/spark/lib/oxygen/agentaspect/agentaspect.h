@@ -76,6 +76,14 @@ public:
     /** sets the synchronization status of the agent */
     void SetSynced(bool synced) { mIsSynced = synced; }
 
+    /** marks the agent as synced and counts the received sync command.
+        Called by the AgentSyncEffector when it realizes a (syn) action.
+    */
+    void NotifySync() { mIsSynced = true; ++mSyncCount; }
+
+    /** @return the number of sync commands received from this agent */
+    unsigned int GetSyncCount() const { return mSyncCount; }
+
 protected:
     typedef std::map<std::string, std::shared_ptr<Effector> > TEffectorMap;
 
@@ -96,6 +104,9 @@ private:
 
     /** show if the agent is in sync with the server (in Sync mode) */
     bool mIsSynced;
+
+    /** the number of sync commands received from the agent */
+    unsigned int mSyncCount;
 };
 
 DECLARE_CLASS(AgentAspect)
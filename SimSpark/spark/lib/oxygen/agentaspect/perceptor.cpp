@@ -24,7 +24,7 @@
 using namespace oxygen;
 
 Perceptor::Perceptor()
-    : BaseNode(), mInterval(1)
+    : BaseNode(), mInterval(1), mBatched(false)
 {
 }
 
@@ -43,3 +43,8 @@ void Perceptor::SetInterval(unsigned int i)
 {
     mInterval = i;
 }
+
+void Perceptor::SetBatched(bool batched)
+{
+    mBatched = batched;
+}
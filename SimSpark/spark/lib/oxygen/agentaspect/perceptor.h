@@ -93,12 +93,32 @@ public:
      */
     void SetInterval(unsigned int i);
 
+    /** @brief Mark the perceptor as batched.
+     *
+     * The output of a batched perceptor is generated by another
+     * perceptor that reads several perceptors in one pass, e.g. all
+     * joint perceptors of a robot. The AgentAspect does not query
+     * batched perceptors.
+     *
+     * @param[in] batched true if another perceptor takes over
+     */
+    void SetBatched(bool batched);
+
+    /** @brief Returns true if the perceptor is batched.
+     *
+     * @see @ref SetBatched()
+     */
+    bool IsBatched() const { return mBatched; }
+
 protected:
     /** @brief The predicate name of the perceptor. */
     std::string mPredicateName;
 
     /** @brief The interval cycle of the perceptor. */
     unsigned int mInterval;
+
+    /** @brief true if another perceptor generates the output. */
+    bool mBatched;
 };
 
 DECLARE_ABSTRACTCLASS(Perceptor)
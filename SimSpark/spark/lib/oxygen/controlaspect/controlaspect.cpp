@@ -29,7 +29,7 @@ using namespace oxygen;
 using namespace zeitgeist;
 
 ControlAspect::ControlAspect()
-  : BaseNode()
+  : BaseNode(), mProfileSection(-1)
 {
 }
 
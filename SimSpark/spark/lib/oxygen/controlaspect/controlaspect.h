@@ -49,6 +49,17 @@ public:
     /** returns a reference to a ControlAspect registered to the
         GameControlServer */
     void GetControlAspect(zeitgeist::Core::CachedLeafPath& aspect, const std::string& name);
+
+    /** sets the CycleProfiler section of the Update() of this aspect */
+    void SetProfileSection(int section) { mProfileSection = section; }
+
+    /** returns the CycleProfiler section of the Update() of this
+        aspect, or -1 */
+    int GetProfileSection() const { return mProfileSection; }
+
+protected:
+    /** the CycleProfiler section of Update() */
+    int mProfileSection;
 };
 
 DECLARE_ABSTRACTCLASS(ControlAspect)
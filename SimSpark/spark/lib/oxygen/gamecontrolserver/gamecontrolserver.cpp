@@ -26,6 +26,7 @@
 #include <oxygen/sceneserver/sceneserver.h>
 #include <oxygen/sceneserver/scene.h>
 #include <oxygen/controlaspect/controlaspect.h>
+#include <oxygen/simulationserver/cycleprofiler.h>
 #include <zeitgeist/logserver/logserver.h>
 #include <zeitgeist/corecontext.h>
 
@@ -77,6 +78,10 @@ GameControlServer::InitControlAspect(const string& aspectName)
     }
 
     aspect->SetName(aspectName);
+#ifdef ENABLE_CYCLE_PROFILER
+    aspect->SetProfileSection
+        (CycleProfiler::RegisterSection(aspectName + "::Update"));
+#endif
     AddChildReference(aspect);
 
     return true;
@@ -327,6 +332,8 @@ GameControlServer::GetAgentAspectList(TAgentAspectList & list)
 void
 GameControlServer::Update(float deltaTime)
 {
+    OXYGEN_PROFILE_SCOPE("GameControlServer::Update");
+
     // remove disappeared agent
     for(
         vector<int>::iterator iter = mDisappearedAgent.begin();
@@ -353,6 +360,7 @@ GameControlServer::Update(float deltaTime)
         std::shared_ptr<ControlAspect> aspect =
             std::static_pointer_cast<ControlAspect>(*iter);
 
+        OXYGEN_PROFILE_SECTION(aspect->GetProfileSection());
         aspect->Update(deltaTime);
     }
 }
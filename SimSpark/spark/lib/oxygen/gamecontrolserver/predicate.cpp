@@ -21,6 +21,7 @@
 */
 #include "predicate.h"
 #include <algorithm>
+#include <oxygen/simulationserver/cyclearena.h>
 
 using namespace zeitgeist;
 using namespace oxygen;
@@ -125,6 +126,15 @@ ParameterName::operator()(const std::any& param, const string& pred) const
     }
 }
 
+Predicate::Predicate()
+{
+}
+
+Predicate::Predicate(std::pmr::memory_resource* resource)
+    : parameter(resource)
+{
+}
+
 bool
 Predicate::FindParameter(Iterator& iter, const string& name) const
 {
@@ -181,10 +191,17 @@ bool Predicate::DescentList(Iterator& iter) const
 }
 
 /** implementation of class PredicateList */
-PredicateList::PredicateList()
+PredicateList::PredicateList() : mList(CycleArena::GetResource())
 {
 }
 
+std::shared_ptr<PredicateList> PredicateList::Create()
+{
+    return std::allocate_shared<PredicateList>
+        (std::pmr::polymorphic_allocator<PredicateList>
+         (CycleArena::GetResource()));
+}
+
 PredicateList::~PredicateList()
 {
 }
@@ -201,8 +218,16 @@ PredicateList::TList::const_iterator PredicateList::end() const
 
 Predicate& PredicateList::AddPredicate()
 {
-    mList.push_back(Predicate());
-    return mList.back();
+    return mList.emplace_back(mList.get_allocator().resource());
+}
+
+void PredicateList::AddPreformatted(std::string& text)
+{
+    Predicate& predicate = AddPredicate();
+
+    PreformattedText preformatted;
+    preformatted.text.swap(text);
+    predicate.parameter.AddValue(std::any(std::move(preformatted)));
 }
 
 int PredicateList::GetSize() const
@@ -23,6 +23,8 @@
 #define OXYGEN_PREDICATE_H
 
 #include <list>
+#include <memory>
+#include <memory_resource>
 #include <string>
 #include <functional>
 #include <any>
@@ -124,6 +126,11 @@ class OXYGEN_API Predicate
     };
 
 public:
+    Predicate();
+
+    /** constructs a Predicate whose parameters allocate from resource */
+    explicit Predicate(std::pmr::memory_resource* resource);
+
     const Iterator begin() const
     {
         return Iterator(&parameter,parameter.begin());
@@ -244,14 +251,36 @@ public:
     bool operator()(const std::any& param, const std::string& pred) const;
 };
 
+/** \class PreformattedText holds a part of a message that a
+    perceptor already formatted in the format of the parser, e.g. from
+    a template where only the numbers change. An unnamed Predicate
+    with a PreformattedText as its only parameter is written to the
+    agent as is.
+*/
+struct PreformattedText
+{
+    std::string text;
+};
+
+/** \class PredicateList is a list of Predicates. A PredicateList and
+    its Predicates allocate from CycleArena::GetResource(), i.e. from
+    the cycle arena of the thread if the list is created inside a
+    CycleArena::Scope. Such a list must be released before the end of
+    the cycle.
+*/
 class OXYGEN_API PredicateList
 {
 public:
-    typedef std::list<Predicate> TList;
+    typedef std::pmr::list<Predicate> TList;
 public:
     PredicateList();
     virtual ~PredicateList();
 
+    /** creates a new PredicateList; the list object itself is
+        allocated from CycleArena::GetResource() as well
+    */
+    static std::shared_ptr<PredicateList> Create();
+
     /** returns an iterator pointing at the first contained Predicate
      */
     TList::const_iterator begin() const;
@@ -269,6 +298,11 @@ public:
 
     Predicate& AddPredicate();
 
+    /** adds an unnamed Predicate that carries preformatted output,
+        see PreformattedText. The contents of text are moved.
+    */
+    void AddPreformatted(std::string& text);
+
 protected:
     TList mList;
 };
@@ -23,13 +23,15 @@
 #include "meshimporter.h"
 #include "meshexporter.h"
 #include <zeitgeist/logserver/logserver.h>
+#include <zeitgeist/scriptserver/scriptserver.h>
+#include <salt/fileclasses.h>
 
 using namespace oxygen;
 using namespace zeitgeist;
 using namespace salt;
 using namespace std;
 
-GeometryServer::GeometryServer() : Node()
+GeometryServer::GeometryServer() : Node(), mMeshCacheDirSet(false)
 {
 }
 
@@ -44,6 +46,12 @@ GeometryServer::OnLink()
     {
         InitMeshImporter("oxygen/StdMeshImporter");
     }
+
+    string dotDir;
+    if ((! mMeshCacheDirSet) && GetScript()->GetDotDirName(dotDir))
+    {
+        mMeshCacheDir = dotDir + salt::RFile::Sep() + "meshcache";
+    }
 }
 
 bool
@@ -216,3 +224,25 @@ GeometryServer::InitMeshExporter(const string& name)
 
     return true;
 }
+
+void
+GeometryServer::SetMeshCacheDir(const string& dir)
+{
+    mMeshCacheDir = dir;
+    mMeshCacheDirSet = true;
+
+    if (dir.empty())
+    {
+        GetLog()->Debug() << "(GeometryServer) mesh cache disabled\n";
+    } else
+    {
+        GetLog()->Debug() << "(GeometryServer) mesh cache directory is '"
+                          << dir << "'\n";
+    }
+}
+
+const string&
+GeometryServer::GetMeshCacheDir() const
+{
+    return mMeshCacheDir;
+}
@@ -71,6 +71,16 @@ public:
     */
     bool InitMeshExporter(const std::string& name);
 
+    /** sets the directory MeshImporters store binary copies of
+        imported meshes in, see MeshCache. An empty name disables the
+        cache. The default is the directory 'meshcache' in the users
+        dot directory
+    */
+    void SetMeshCacheDir(const std::string& dir);
+
+    /** returns the mesh cache directory; empty if disabled */
+    const std::string& GetMeshCacheDir() const;
+
 protected:
     /** registers the standard mesh importer */
     virtual void OnLink();
@@ -78,6 +88,12 @@ protected:
 protected:
     /** the registry of cached trimeshes */
     TMeshMap mMeshMap;
+
+    /** the directory of the binary mesh cache */
+    std::string mMeshCacheDir;
+
+    /** true if mMeshCacheDir was set explicitly */
+    bool mMeshCacheDirSet;
 };
 
 DECLARE_CLASS(GeometryServer)
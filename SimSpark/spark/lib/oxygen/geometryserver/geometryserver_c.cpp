@@ -55,10 +55,27 @@ FUNCTION(GeometryServer,initMeshExporter)
     return obj->InitMeshExporter(inExporterName);
 }
 
+FUNCTION(GeometryServer,setMeshCacheDir)
+{
+    string inDir;
+
+    if (
+        (in.GetSize() != 1) ||
+        (! in.GetValue(in.begin(),inDir))
+        )
+    {
+        return false;
+    }
+
+    obj->SetMeshCacheDir(inDir);
+    return true;
+}
+
 void
 CLASS(GeometryServer)::DefineClass()
 {
     DEFINE_BASECLASS(zeitgeist/Node)
     DEFINE_FUNCTION(initMeshImporter)
     DEFINE_FUNCTION(initMeshExporter)
+    DEFINE_FUNCTION(setMeshCacheDir)
 }
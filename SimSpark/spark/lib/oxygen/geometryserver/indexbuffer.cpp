@@ -46,6 +46,15 @@ void IndexBuffer::Cache(unsigned int newIndex)
     Cache(1, &newIndex);
 }
 
+void IndexBuffer::Attach(std::shared_ptr<unsigned int[]> index,
+                         unsigned int numIndex)
+{
+    // EnsureFit() grows the buffer by doubling its size
+    mIndex    = (numIndex > 0) ? index : std::shared_ptr<unsigned int[]>();
+    mMaxIndex = numIndex;
+    mNumIndex = numIndex;
+}
+
 void IndexBuffer::EnsureFit(unsigned int count)
 {
     if(mIndex.get() == 0)
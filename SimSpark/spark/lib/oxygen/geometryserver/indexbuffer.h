@@ -49,6 +49,12 @@ public:
     /** appends a single index */
     void Cache(unsigned int newIndex);
 
+    /** uses the given memory, that holds numIndex indices, without
+        copying it. It is copied when further indices are cached, but
+        overwritten after a Flush()
+    */
+    void Attach(std::shared_ptr<unsigned int[]> index, unsigned int numIndex);
+
     /** empties the index buffer */
     void Flush();
 
@@ -0,0 +1,585 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2002,2003 Koblenz University
+   Copyright (C) 2004-2009 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#include "meshcache.h"
+#include <salt/fileclasses.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <sys/stat.h>
+
+#ifdef WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace oxygen;
+using namespace std;
+
+namespace
+{
+    const char MAGIC[8] = { 'S', 'P', 'K', 'M', 'E', 'S', 'H', 0 };
+
+    /** arrays in the cache file start at multiples of this */
+    const uint64_t ALIGNMENT = 16;
+
+    enum EFlags
+    {
+        F_NORMALS   = 1,
+        F_TEXCOORDS = 2
+    };
+
+    /** the file header; all offsets are relative to the file start */
+    struct Header
+    {
+        char     magic[8];
+        uint32_t version;
+        uint32_t headerSize;
+        uint64_t fileSize;
+        uint64_t sourceHash;
+        uint64_t sourceSize;
+        uint32_t vertexCount;
+        uint32_t flags;
+        uint32_t faceCount;
+        uint32_t tagSize;
+        uint64_t tagOffset;
+        uint64_t faceOffset;
+        uint64_t posOffset;
+        uint64_t normalOffset;
+        uint64_t texCoordOffset;
+    };
+
+    /** describes one index buffer of the mesh */
+    struct FaceRecord
+    {
+        uint64_t indexOffset;
+        uint64_t materialOffset;
+        uint32_t indexCount;
+        uint32_t materialSize;
+    };
+
+    uint64_t Align(uint64_t offset)
+    {
+        return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    /** hashes 8 bytes at a time; not cryptographic, it only has to
+        notice edited source files */
+    class Hasher
+    {
+    public:
+        Hasher() : mHash(0xcbf29ce484222325ULL) {}
+
+        void Add(const char* data, size_t size)
+        {
+            while (size >= 8)
+                {
+                    uint64_t word;
+                    memcpy(&word, data, 8);
+                    Mix(word);
+                    data += 8;
+                    size -= 8;
+                }
+
+            if (size > 0)
+                {
+                    uint64_t word = 0;
+                    memcpy(&word, data, size);
+                    Mix(word);
+                }
+        }
+
+        uint64_t Get(uint64_t size) const
+        {
+            uint64_t h = mHash ^ size;
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+            return h;
+        }
+
+    protected:
+        void Mix(uint64_t word)
+        {
+            mHash = (mHash ^ word) * 0x100000001b3ULL;
+            mHash ^= mHash >> 29;
+        }
+
+    protected:
+        uint64_t mHash;
+    };
+
+    /** a read only view of a whole file; memory mapped where
+        available, read into memory otherwise */
+    class MappedFile
+    {
+    public:
+        MappedFile() : mData(0), mSize(0), mMapped(false) {}
+
+        ~MappedFile()
+        {
+#ifndef WIN32
+            if (mMapped)
+                {
+                    munmap(mData, mSize);
+                    return;
+                }
+#endif
+            delete[] mData;
+        }
+
+        bool Open(const string& fileName)
+        {
+#ifdef WIN32
+            ifstream ifs(fileName.c_str(), ios::binary);
+            if (! ifs)
+                {
+                    return false;
+                }
+
+            ifs.seekg(0, ios::end);
+            mSize = static_cast<size_t>(ifs.tellg());
+            ifs.seekg(0, ios::beg);
+            mData = new char[mSize > 0 ? mSize : 1];
+            ifs.read(mData, mSize);
+            return ifs.good();
+#else
+            int fd = open(fileName.c_str(), O_RDONLY);
+            if (fd < 0)
+                {
+                    return false;
+                }
+
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size <= 0)
+                {
+                    close(fd);
+                    return false;
+                }
+
+            mSize = static_cast<size_t>(st.st_size);
+
+            // private and writable: TriMesh users may modify their
+            // arrays, the pages are copied on write
+            void* data = mmap(0, mSize, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE, fd, 0);
+            close(fd);
+
+            if (data == MAP_FAILED)
+                {
+                    mSize = 0;
+                    return false;
+                }
+
+            mData = static_cast<char*>(data);
+            mMapped = true;
+            return true;
+#endif
+        }
+
+        char* GetData() const { return mData; }
+        size_t GetSize() const { return mSize; }
+
+    private:
+        MappedFile(const MappedFile&);
+        MappedFile& operator=(const MappedFile&);
+
+    protected:
+        char* mData;
+        size_t mSize;
+        bool mMapped;
+    };
+
+    bool InFile(uint64_t offset, uint64_t bytes, uint64_t fileSize)
+    {
+        return (
+                (offset <= fileSize) &&
+                (bytes <= fileSize - offset)
+                );
+    }
+
+    bool CreateDir(const string& dir)
+    {
+        struct stat st;
+        if (stat(dir.c_str(), &st) == 0)
+            {
+                return true;
+            }
+
+#ifdef WIN32
+        return (CreateDirectory(dir.c_str(), 0) != 0);
+#else
+        return (mkdir(dir.c_str(), 0777) == 0);
+#endif
+    }
+
+    /** writes bytes at the file offset at, padding the gap after the
+        bytes written before */
+    void WriteAt(ofstream& ofs, uint64_t& written, uint64_t at,
+                 const void* data, uint64_t bytes)
+    {
+        static const char padding[ALIGNMENT] = { 0 };
+
+        ofs.write(padding, at - written);
+        ofs.write(static_cast<const char*>(data), bytes);
+        written = at + bytes;
+    }
+
+    int GetProcessId()
+    {
+#ifdef WIN32
+        return _getpid();
+#else
+        return getpid();
+#endif
+    }
+}
+
+bool MeshCache::HashFile(const string& fileName,
+                         unsigned long long& hash,
+                         unsigned long long& size)
+{
+    FILE* file = fopen(fileName.c_str(), "rb");
+    if (file == 0)
+        {
+            return false;
+        }
+
+    Hasher hasher;
+    vector<char> buffer(256 * 1024);
+    size = 0;
+
+    for (;;)
+        {
+            size_t n = fread(&buffer[0], 1, buffer.size(), file);
+            if (n == 0)
+                {
+                    break;
+                }
+
+            // n is a multiple of 8 except at the end of the file
+            hasher.Add(&buffer[0], n);
+            size += n;
+        }
+
+    bool ok = (ferror(file) == 0);
+    fclose(file);
+
+    hash = hasher.Get(size);
+    return ok;
+}
+
+string MeshCache::GetCacheFileName(const string& cacheDir,
+                                   const string& fileName)
+{
+    // the base name keeps the cache directory readable, the hash of
+    // the full path tells apart files with the same name
+    string::size_type sep = fileName.find_last_of("/\\");
+    string baseName =
+        (sep == string::npos) ? fileName : fileName.substr(sep + 1);
+
+    Hasher hasher;
+    hasher.Add(fileName.data(), fileName.size());
+
+    char pathHash[17];
+    snprintf(pathHash, sizeof(pathHash), "%016llx",
+             static_cast<unsigned long long>(hasher.Get(fileName.size())));
+
+    return cacheDir + salt::RFile::Sep() + baseName + "-" + pathHash + ".mesh";
+}
+
+std::shared_ptr<TriMesh> MeshCache::Load(const string& cacheFile,
+                                         unsigned long long hash,
+                                         unsigned long long size,
+                                         string& tag)
+{
+    std::shared_ptr<MappedFile> file(new MappedFile());
+    if (! file->Open(cacheFile))
+        {
+            return std::shared_ptr<TriMesh>();
+        }
+
+    const char* data = file->GetData();
+    const uint64_t fileSize = file->GetSize();
+
+    if (fileSize < sizeof(Header))
+        {
+            return std::shared_ptr<TriMesh>();
+        }
+
+    Header header;
+    memcpy(&header, data, sizeof(Header));
+
+    if (
+        (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) ||
+        (header.version != VERSION) ||
+        (header.headerSize != sizeof(Header)) ||
+        (header.fileSize != fileSize) ||
+        (header.sourceHash != hash) ||
+        (header.sourceSize != size) ||
+        (header.vertexCount == 0)
+        )
+        {
+            return std::shared_ptr<TriMesh>();
+        }
+
+    const uint64_t arrayBytes =
+        uint64_t(header.vertexCount) * 3 * sizeof(float);
+
+    if (
+        (! InFile(header.tagOffset, header.tagSize, fileSize)) ||
+        (! InFile(header.faceOffset,
+                  uint64_t(header.faceCount) * sizeof(FaceRecord), fileSize)) ||
+        (! InFile(header.posOffset, arrayBytes, fileSize)) ||
+        ((header.flags & F_NORMALS) &&
+         (! InFile(header.normalOffset, arrayBytes, fileSize))) ||
+        ((header.flags & F_TEXCOORDS) &&
+         (! InFile(header.texCoordOffset, arrayBytes, fileSize)))
+        )
+        {
+            return std::shared_ptr<TriMesh>();
+        }
+
+    // the arrays alias the mapping, which lives as long as any of them
+    std::shared_ptr<TriMesh> mesh(new TriMesh());
+
+    mesh->SetPos(std::shared_ptr<float[]>
+                 (file, (float*)(file->GetData() + header.posOffset)),
+                 header.vertexCount);
+
+    if (header.flags & F_NORMALS)
+        {
+            mesh->SetNormals(std::shared_ptr<float[]>
+                             (file, (float*)(file->GetData() + header.normalOffset)));
+        }
+
+    if (header.flags & F_TEXCOORDS)
+        {
+            mesh->SetTexCoords(std::shared_ptr<float[]>
+                               (file, (float*)(file->GetData() + header.texCoordOffset)));
+        }
+
+    for (uint32_t i = 0; i < header.faceCount; ++i)
+        {
+            FaceRecord record;
+            memcpy(&record, data + header.faceOffset + i * sizeof(FaceRecord),
+                   sizeof(FaceRecord));
+
+            if (
+                (! InFile(record.materialOffset, record.materialSize, fileSize)) ||
+                (! InFile(record.indexOffset,
+                          uint64_t(record.indexCount) * sizeof(unsigned int),
+                          fileSize)) ||
+                (record.indexOffset % sizeof(unsigned int) != 0)
+                )
+                {
+                    return std::shared_ptr<TriMesh>();
+                }
+
+            unsigned int* index =
+                (unsigned int*)(file->GetData() + record.indexOffset);
+
+            // a corrupt index would crash the collider or renderer later
+            for (uint32_t j = 0; j < record.indexCount; ++j)
+                {
+                    if (index[j] >= header.vertexCount)
+                        {
+                            return std::shared_ptr<TriMesh>();
+                        }
+                }
+
+            std::shared_ptr<IndexBuffer> indeces(new IndexBuffer());
+            indeces->Attach(std::shared_ptr<unsigned int[]>(file, index),
+                            record.indexCount);
+
+            mesh->AddFace(indeces,
+                          string(data + record.materialOffset,
+                                 record.materialSize));
+        }
+
+    tag.assign(data + header.tagOffset, header.tagSize);
+
+    return mesh;
+}
+
+bool MeshCache::Save(const string& cacheFile, const TriMesh& mesh,
+                     unsigned long long hash, unsigned long long size,
+                     const string& tag)
+{
+    if (mesh.GetVertexCount() <= 0 || mesh.GetPos().get() == 0)
+        {
+            return false;
+        }
+
+    string::size_type sep = cacheFile.find_last_of("/\\");
+    if (sep != string::npos && ! CreateDir(cacheFile.substr(0, sep)))
+        {
+            return false;
+        }
+
+    const TriMesh::TFaces& faces = mesh.GetFaces();
+    const uint64_t arrayBytes =
+        uint64_t(mesh.GetVertexCount()) * 3 * sizeof(float);
+
+    // lay out the file
+    Header header;
+    memset(&header, 0, sizeof(Header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.headerSize = sizeof(Header);
+    header.sourceHash = hash;
+    header.sourceSize = size;
+    header.vertexCount = mesh.GetVertexCount();
+    header.faceCount = faces.size();
+    header.tagSize = tag.size();
+
+    uint64_t offset = sizeof(Header);
+
+    header.tagOffset = offset;
+    offset += tag.size();
+
+    header.faceOffset = Align(offset);
+    offset = header.faceOffset + faces.size() * sizeof(FaceRecord);
+
+    vector<FaceRecord> records;
+    records.reserve(faces.size());
+
+    for (
+         TriMesh::TFaces::const_iterator iter = faces.begin();
+         iter != faces.end();
+         ++iter
+         )
+        {
+            FaceRecord record;
+            record.materialOffset = offset;
+            record.materialSize = iter->material.size();
+            record.indexCount = iter->indeces->GetNumIndex();
+            offset += record.materialSize;
+            records.push_back(record);
+        }
+
+    header.posOffset = Align(offset);
+    offset = header.posOffset + arrayBytes;
+
+    if (mesh.GetNormals().get() != 0)
+        {
+            header.flags |= F_NORMALS;
+            header.normalOffset = Align(offset);
+            offset = header.normalOffset + arrayBytes;
+        }
+
+    if (mesh.GetTexCoords().get() != 0)
+        {
+            header.flags |= F_TEXCOORDS;
+            header.texCoordOffset = Align(offset);
+            offset = header.texCoordOffset + arrayBytes;
+        }
+
+    for (size_t i = 0; i < records.size(); ++i)
+        {
+            records[i].indexOffset = Align(offset);
+            offset = records[i].indexOffset
+                + uint64_t(records[i].indexCount) * sizeof(unsigned int);
+        }
+
+    header.fileSize = offset;
+
+    // write to a private temporary file and rename it, so readers
+    // either see the complete file or none
+    stringstream tmpName;
+    tmpName << cacheFile << "." << GetProcessId() << ".tmp";
+
+    {
+        ofstream ofs(tmpName.str().c_str(), ios::binary | ios::trunc);
+        if (! ofs)
+            {
+                return false;
+            }
+
+        uint64_t written = 0;
+
+        WriteAt(ofs, written, 0, &header, sizeof(Header));
+        WriteAt(ofs, written, header.tagOffset, tag.data(), tag.size());
+
+        if (! records.empty())
+            {
+                WriteAt(ofs, written, header.faceOffset, &records[0],
+                         records.size() * sizeof(FaceRecord));
+            }
+
+        TriMesh::TFaces::const_iterator face = faces.begin();
+        for (size_t i = 0; i < records.size(); ++i, ++face)
+            {
+                WriteAt(ofs, written, records[i].materialOffset, face->material.data(),
+                         records[i].materialSize);
+            }
+
+        WriteAt(ofs, written, header.posOffset, mesh.GetPos().get(), arrayBytes);
+
+        if (header.flags & F_NORMALS)
+            {
+                WriteAt(ofs, written, header.normalOffset, mesh.GetNormals().get(),
+                         arrayBytes);
+            }
+
+        if (header.flags & F_TEXCOORDS)
+            {
+                WriteAt(ofs, written, header.texCoordOffset, mesh.GetTexCoords().get(),
+                         arrayBytes);
+            }
+
+        face = faces.begin();
+        for (size_t i = 0; i < records.size(); ++i, ++face)
+            {
+                WriteAt(ofs, written, records[i].indexOffset,
+                         face->indeces->GetIndex().get(),
+                         uint64_t(records[i].indexCount) * sizeof(unsigned int));
+            }
+
+        ofs.close();
+        if (! ofs)
+            {
+                remove(tmpName.str().c_str());
+                return false;
+            }
+    }
+
+#ifdef WIN32
+    // rename does not replace existing files on windows
+    remove(cacheFile.c_str());
+#endif
+
+    if (rename(tmpName.str().c_str(), cacheFile.c_str()) != 0)
+        {
+            remove(tmpName.str().c_str());
+            return false;
+        }
+
+    return true;
+}
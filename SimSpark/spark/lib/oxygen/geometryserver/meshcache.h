@@ -0,0 +1,99 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2002,2003 Koblenz University
+   Copyright (C) 2004-2009 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#ifndef OXYGEN_MESHCACHE_H
+#define OXYGEN_MESHCACHE_H
+
+#include <memory>
+#include <string>
+#include <oxygen/oxygen_defines.h>
+#include "trimesh.h"
+
+namespace oxygen
+{
+
+/** \class MeshCache stores imported TriMeshes in a binary file, so
+    that MeshImporters that parse text formats only do so once per
+    source file.
+
+    A cache file holds the vertex positions, normals, texture
+    coordinates and the index buffer of each material of one mesh,
+    each aligned to 16 bytes, together with a 64 bit hash and the size
+    of the source file it was created from. A cache file is only used
+    if both still match the source file, i.e. cache files never have
+    to be deleted by hand.
+
+    Cache files are memory mapped on load. The arrays of the returned
+    TriMesh point into the mapping, which is released with the last
+    array that references it. The mapping is private, so writes to the
+    arrays never reach the file.
+
+    Cache files are written to a temporary file first and then renamed,
+    so that several servers that start at the same time never read a
+    partially written file.
+*/
+class OXYGEN_API MeshCache
+{
+public:
+    enum
+    {
+        /** the version of the file format; files with another
+            version are ignored */
+        VERSION = 1
+    };
+
+public:
+    /** computes the 64 bit content hash and the size of a source
+        file, returns false if the file cannot be read
+    */
+    static bool HashFile(const std::string& fileName,
+                         unsigned long long& hash,
+                         unsigned long long& size);
+
+    /** returns the name of the cache file in the directory \param
+        cacheDir for the source file \param fileName
+    */
+    static std::string GetCacheFileName(const std::string& cacheDir,
+                                        const std::string& fileName);
+
+    /** loads the mesh from \param cacheFile if it was created from a
+        source file with the given hash and size. \param tag receives
+        the importer specific data that was stored with the mesh.
+        Returns an empty pointer if the cache file is missing, outdated
+        or invalid
+    */
+    static std::shared_ptr<TriMesh> Load(const std::string& cacheFile,
+                                         unsigned long long hash,
+                                         unsigned long long size,
+                                         std::string& tag);
+
+    /** stores \param mesh in \param cacheFile, together with the hash
+        and size of its source file and the importer specific \param
+        tag. The directory of the cache file is created if necessary.
+        Returns true on success
+    */
+    static bool Save(const std::string& cacheFile, const TriMesh& mesh,
+                     unsigned long long hash, unsigned long long size,
+                     const std::string& tag);
+};
+
+} // namespace oxygen
+
+#endif // OXYGEN_MESHCACHE_H
@@ -22,6 +22,8 @@
 
 #include <zeitgeist/logserver/logserver.h>
 #include <oxygen/simulationserver/simulationserver.h>
+#include <oxygen/simulationserver/cyclearena.h>
+#include <oxygen/simulationserver/commandjournal.h>
 #include "monitorserver.h"
 #include "monitoritem.h"
 
@@ -167,6 +169,7 @@ string MonitorServer::GetMonitorHeaderInfo()
         return string();
     }
 
+    CycleArena::Scope arena;
     PredicateList pList;
     std::lock_guard dataLock(mMonitorMutex);
     CollectItemPredicates(true,pList);
@@ -189,6 +192,7 @@ string MonitorServer::GetMonitorData()
             return string();
         }
 
+    CycleArena::Scope arena;
     PredicateList pList;
     CollectItemPredicates(false,pList);
     mData = monitorSystem->GetMonitorInformation(pList);
@@ -200,6 +204,12 @@ void MonitorServer::ParseMonitorMessage(const string& data)
 {
     std::shared_ptr<MonitorSystem> monitorSystem = GetMonitorSystem();
 
+    CommandJournal* journal = CommandJournal::GetRecording();
+    if (journal != 0)
+        {
+            journal->RecordMonitorMessage(data);
+        }
+
     if (monitorSystem.get() != 0)
         {
             std::lock_guard dataLock(mMonitorMutex);
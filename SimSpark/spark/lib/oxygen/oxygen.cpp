@@ -45,6 +45,8 @@ Oxygen::Oxygen(zeitgeist::Zeitgeist& zg)
     zg.GetCore()->RegisterClassObject(new CLASS(MonitorLogger), "oxygen/");
     zg.GetCore()->RegisterClassObject(new CLASS(TrainControl), "oxygen/");
     zg.GetCore()->RegisterClassObject(new CLASS(TimerSystem), "oxygen/");
+    zg.GetCore()->RegisterClassObject(new CLASS(CycleProfiler), "oxygen/");
+    zg.GetCore()->RegisterClassObject(new CLASS(CommandJournal), "oxygen/");
 
     // geometry
     zg.GetCore()->RegisterClassObject(new CLASS(GeometryServer), "oxygen/");
@@ -91,6 +91,8 @@
 #include <oxygen/simulationserver/monitorlogger.h>
 #include <oxygen/simulationserver/traincontrol.h>
 #include <oxygen/simulationserver/timersystem.h>
+#include <oxygen/simulationserver/cycleprofiler.h>
+#include <oxygen/simulationserver/commandjournal.h>
 
 #include <oxygen/geometryserver/geometryserver.h>
 #include <oxygen/geometryserver/meshexporter.h>
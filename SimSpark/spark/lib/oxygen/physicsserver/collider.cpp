@@ -28,6 +28,7 @@
 #include <oxygen/sceneserver/scene.h>
 #include <zeitgeist/leaf.h>
 #include <zeitgeist/logserver/logserver.h>
+#include <atomic>
 
 using namespace oxygen;
 using namespace salt;
@@ -35,7 +36,14 @@ using namespace std;
 
 std::shared_ptr<ColliderInt> Collider::mColliderImp;
 
-Collider::Collider() : PhysicsObject(), mGeomID(0)
+namespace
+{
+    // the serial number of the next Collider
+    std::atomic<unsigned long> nextSerial(1);
+}
+
+Collider::Collider() : PhysicsObject(), mGeomID(0),
+                       mSerial(nextSerial.fetch_add(1))
 {
 
 }
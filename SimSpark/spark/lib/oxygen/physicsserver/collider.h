@@ -103,6 +103,11 @@ public:
     /** returns the ID of managed geom */
     long GetGeomID();
 
+    /** returns a number that identifies this collider. Unlike the geom
+        ID it is never reused within a process
+    */
+    unsigned long GetSerial() const { return mSerial; }
+
     /** sets the relative position of the managed geom directly. If
         the geom is connected to a body, the position of the body will
         also be changed
@@ -164,7 +169,10 @@ protected:
 protected:
     /** the ID of the managed collision geometry */
     long mGeomID;
-    
+
+    /** see GetSerial() */
+    unsigned long mSerial;
+
 private:
     static std::shared_ptr<ColliderInt> mColliderImp;
 
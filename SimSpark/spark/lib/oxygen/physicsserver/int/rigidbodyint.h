@@ -57,6 +57,19 @@ public:
     /** returns true if this body is enabled */
     virtual bool IsEnabled(long bodyID) const = 0;
 
+    /** sets whether the body is disabled automatically when it comes
+        to rest */
+    virtual void SetAutoDisableFlag(bool flag, long bodyID) = 0;
+
+    /** sets the auto disable parameters of this body, see
+        WorldInt::SetAutoDisableParameters()
+    */
+    virtual void SetAutoDisableParameters(float linearThreshold,
+                                          float angularThreshold,
+                                          int idleSteps, float idleTime,
+                                          int averageSamples,
+                                          long bodyID) = 0;
+
     /** sets whether the body is influenced by the world's gravity or
         not. Bodies are constructed to be influenced by the world's
         gravity by default.
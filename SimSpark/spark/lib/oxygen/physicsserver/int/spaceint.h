@@ -24,6 +24,7 @@
 #define OXYGEN_SPACEINT_H
 
 #include <set>
+#include <string>
 #include <oxygen/oxygen_defines.h>
 #include <oxygen/physicsserver/genericphysicsobjects.h>
 
@@ -84,11 +85,36 @@ public:
     */
     virtual bool AreConnectedWithJoint(long bodyID1, long bodyID2) = 0;
 
+    /** Returns true if \param bodyID is an enabled body; returns
+        false for disabled bodies and for 0, i.e. static geoms
+    */
+    virtual bool IsBodyEnabled(long bodyID) = 0;
+
     /** Collides the two geoms managed by \param collider
         and \param collidee */
     virtual void CollideInternal(std::shared_ptr<Collider> collider,
                                 std::shared_ptr<Collider> collidee,
                                 long geomID1, long geomID2) = 0;
+
+    /** called once per simulation step before the collision
+        detection of the top level space starts
+    */
+    virtual void BeginCollide() = 0;
+
+    /** enables or disables the contact cache. Narrow phase collision
+        detection is skipped for a geom pair as long as both geoms
+        moved less than \param moveTolerance (meters) and turned less
+        than \param turnTolerance (radians) since the last test, for
+        at most \param maxReuse steps. Contact points that stay within
+        \param persistTolerance (meters) of a point of the last step
+        keep their position.
+    */
+    virtual void SetContactCache(bool enable, float moveTolerance,
+                                 float turnTolerance, float persistTolerance,
+                                 int maxReuse) = 0;
+
+    /** returns the statistics of the contact cache */
+    virtual std::string GetContactCacheReport() = 0;
 };
 
 } //namespace oxygen
@@ -85,6 +85,19 @@ public:
     virtual bool GetAutoDisableFlag(long worldID) const = 0;
     virtual void SetAutoDisableFlag(bool flag, long worldID) = 0;
 
+    /** sets the default auto disable parameters of bodies created
+        later in this world. A body goes to sleep when its linear and
+        angular speed, averaged over \param averageSamples steps, stayed
+        below \param linearThreshold (m/s) and \param angularThreshold
+        (rad/s) for at least \param idleSteps steps and \param idleTime
+        seconds.
+    */
+    virtual void SetAutoDisableParameters(float linearThreshold,
+                                          float angularThreshold,
+                                          int idleSteps, float idleTime,
+                                          int averageSamples,
+                                          long worldID) = 0;
+
     /** Set and get the depth of the surface layer around all geometry
         objects. Contacts are allowed to sink into the surface layer up to
         the given depth before coming to rest. The default value is
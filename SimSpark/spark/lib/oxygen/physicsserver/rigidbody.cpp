@@ -62,6 +62,29 @@ bool RigidBody::IsEnabled() const
     return mRigidBodyImp->IsEnabled(mBodyID);
 }
 
+void RigidBody::Wake()
+{
+    if (! mRigidBodyImp->IsEnabled(mBodyID))
+        {
+            mRigidBodyImp->Enable(mBodyID);
+        }
+}
+
+void RigidBody::SetAutoDisableFlag(bool flag)
+{
+    mRigidBodyImp->SetAutoDisableFlag(flag, mBodyID);
+}
+
+void RigidBody::SetAutoDisableParameters(float linearThreshold,
+                                         float angularThreshold,
+                                         int idleSteps, float idleTime,
+                                         int averageSamples)
+{
+    mRigidBodyImp->SetAutoDisableParameters(linearThreshold, angularThreshold,
+                                            idleSteps, idleTime,
+                                            averageSamples, mBodyID);
+}
+
 void RigidBody::UseGravity(bool f)
 {
     mRigidBodyImp->UseGravity(f, mBodyID);
@@ -246,11 +269,17 @@ Vector3f RigidBody::GetVelocity() const
 
 void RigidBody::SetVelocity(const Vector3f& vel)
 {
+    if (vel.SquareLength() > 0)
+        {
+            Wake();
+        }
+
     mRigidBodyImp->SetVelocity(vel, mBodyID);
 }
 
 void RigidBody::SetRotation(const Matrix& rot)
 {
+    Wake();
     mRigidBodyImp->SetRotation(rot, mBodyID);
 }
 
@@ -271,6 +300,11 @@ Vector3f RigidBody::GetAngularVelocity() const
 
 void RigidBody::SetAngularVelocity(const Vector3f& vel)
 {
+    if (vel.SquareLength() > 0)
+        {
+            Wake();
+        }
+
     mRigidBodyImp->SetAngularVelocity(vel, mBodyID);
 }
 
@@ -362,6 +396,11 @@ std::shared_ptr<RigidBody> RigidBody::GetBody(long id)
 
 void RigidBody::AddForce(const Vector3f& force)
 {
+    if (force.SquareLength() > 0)
+        {
+            Wake();
+        }
+
     mRigidBodyImp->AddForce(force, mBodyID);
 }
 
@@ -372,11 +411,17 @@ Vector3f RigidBody::GetForce() const
 
 void RigidBody::AddTorque(const Vector3f& torque)
 {
+    if (torque.SquareLength() > 0)
+        {
+            Wake();
+        }
+
     mRigidBodyImp->AddTorque(torque, mBodyID);
 }
 
 void RigidBody::SetPosition(const Vector3f& pos)
 {
+    Wake();
     mRigidBodyImp->SetPosition(pos, mBodyID);
 }
 
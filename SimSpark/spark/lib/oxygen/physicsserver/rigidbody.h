@@ -66,6 +66,25 @@ public:
     /** returns true if this body is enabled */
     bool IsEnabled() const;
 
+    /** enables this body if it was disabled, e.g. automatically by
+        the physics engine because it came to rest. Moving the body,
+        setting a velocity or applying a force wakes it up as well.
+    */
+    void Wake();
+
+    /** sets whether this body is disabled automatically when it comes
+        to rest. Bodies take the setting of the world by default.
+    */
+    void SetAutoDisableFlag(bool flag);
+
+    /** sets the auto disable parameters of this body, see
+        World::SetAutoDisableParameters()
+    */
+    void SetAutoDisableParameters(float linearThreshold,
+                                  float angularThreshold,
+                                  int idleSteps, float idleTime,
+                                  int averageSamples);
+
     /** sets whether the body is influenced by the world's gravity or
         not. Bodies are constructed to be influenced by the world's
         gravity by default.
@@ -42,6 +42,52 @@ FUNCTION(RigidBody,isEnabled)
     return obj->IsEnabled();
 }
 
+FUNCTION(RigidBody,setAutoDisableFlag)
+{
+    bool inFlag;
+
+    if (
+        (in.GetSize() != 1) ||
+        (! in.GetValue(in.begin(),inFlag))
+        )
+        {
+            return false;
+        }
+
+    obj->SetAutoDisableFlag(inFlag);
+    return true;
+}
+
+FUNCTION(RigidBody,setAutoDisableParameters)
+{
+    float inLinearThreshold;
+    float inAngularThreshold;
+    int inIdleSteps;
+    float inIdleTime;
+    int inAverageSamples;
+
+    if (in.GetSize() != 5)
+        {
+            return false;
+        }
+
+    ParameterList::TVector::const_iterator iter = in.begin();
+    if (
+        (! in.AdvanceValue(iter,inLinearThreshold)) ||
+        (! in.AdvanceValue(iter,inAngularThreshold)) ||
+        (! in.AdvanceValue(iter,inIdleSteps)) ||
+        (! in.AdvanceValue(iter,inIdleTime)) ||
+        (! in.AdvanceValue(iter,inAverageSamples))
+        )
+        {
+            return false;
+        }
+
+    obj->SetAutoDisableParameters(inLinearThreshold, inAngularThreshold,
+                                  inIdleSteps, inIdleTime, inAverageSamples);
+    return true;
+}
+
 FUNCTION(RigidBody,useGravity)
 {
     bool inB;
@@ -583,6 +629,8 @@ void CLASS(RigidBody)::DefineClass()
         DEFINE_FUNCTION(enable)
         DEFINE_FUNCTION(disable)
         DEFINE_FUNCTION(isEnabled)
+        DEFINE_FUNCTION(setAutoDisableFlag)
+        DEFINE_FUNCTION(setAutoDisableParameters)
         DEFINE_FUNCTION(useGravity)
         DEFINE_FUNCTION(setSphere)
         DEFINE_FUNCTION(addSphere)
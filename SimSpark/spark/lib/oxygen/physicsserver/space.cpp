@@ -53,6 +53,8 @@ long Space::GetODEJointGroup() const
 
 void Space::Collide()
 {
+    mSpaceImp->BeginCollide();
+
     // bind collision callback function to this object
     Collide(mSpaceID);
 }
@@ -103,6 +105,19 @@ void Space::HandleCollide(long obj1, long obj2)
             return;
         }
 
+    // reject pairs of two disabled (sleeping) bodies; the physics
+    // step ignores their contacts anyway. A static geom (body 0) is
+    // not filtered: a sleeping body can be woken by the island it
+    // joins during the step and then needs its ground contacts
+    if (
+        (body1 != 0) && (body2 != 0) &&
+        (! mSpaceImp->IsBodyEnabled(body1)) &&
+        (! mSpaceImp->IsBodyEnabled(body2))
+        )
+        {
+            return;
+        }
+
     // if obj1 and obj2 are in a space that disabled inner collision,
     // reject the collision
     const long s1 = mSpaceImp->FetchSpace(obj1);
@@ -235,3 +250,26 @@ bool Space::GetDisableInnerCollision() const
 
     return (iter != gDisabledInnerCollisionSet.end());
 }
+
+void Space::SetContactCache(bool enable, float moveTolerance,
+                            float turnTolerance, float persistTolerance,
+                            int maxReuse)
+{
+    if (mSpaceImp.get() == 0)
+        {
+            return;
+        }
+
+    mSpaceImp->SetContactCache(enable, moveTolerance, turnTolerance,
+                               persistTolerance, maxReuse);
+}
+
+std::string Space::GetContactCacheReport()
+{
+    if (mSpaceImp.get() == 0)
+        {
+            return std::string();
+        }
+
+    return mSpaceImp->GetContactCacheReport();
+}
@@ -24,6 +24,7 @@
 
 #include <oxygen/physicsserver/physicsobject.h>
 #include <set>
+#include <string>
 #include <oxygen/oxygen_defines.h>
 
 namespace oxygen
@@ -82,6 +83,17 @@ public:
     */
     void HandleCollide(long obj1, long obj2);
 
+    /** enables or disables the contact cache of the physics engine,
+        see SpaceInt::SetContactCache(). The cache is shared by all
+        spaces.
+    */
+    void SetContactCache(bool enable, float moveTolerance,
+                         float turnTolerance, float persistTolerance,
+                         int maxReuse);
+
+    /** returns the statistics of the contact cache */
+    std::string GetContactCacheReport();
+
 protected:
     /** unregisters the managed Space of the Scene. */
     virtual void OnUnlink();
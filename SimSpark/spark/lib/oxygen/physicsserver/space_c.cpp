@@ -36,8 +36,40 @@ FUNCTION(Space,disableInnerCollision)
     return true;
 }
 
+FUNCTION(Space,setContactCache)
+{
+    bool inEnable;
+    float inMoveTolerance;
+    float inTurnTolerance;
+    float inPersistTolerance;
+    int inMaxReuse;
+
+    if (
+        (in.GetSize() != 5) ||
+        (! in.GetValue(in[0],inEnable)) ||
+        (! in.GetValue(in[1],inMoveTolerance)) ||
+        (! in.GetValue(in[2],inTurnTolerance)) ||
+        (! in.GetValue(in[3],inPersistTolerance)) ||
+        (! in.GetValue(in[4],inMaxReuse))
+        )
+    {
+        return false;
+    }
+
+    obj->SetContactCache(inEnable, inMoveTolerance, inTurnTolerance,
+                         inPersistTolerance, inMaxReuse);
+    return true;
+}
+
+FUNCTION(Space,getContactCacheReport)
+{
+    return obj->GetContactCacheReport();
+}
+
 void CLASS(Space)::DefineClass()
 {
     DEFINE_BASECLASS(oxygen/PhysicsObject)
     DEFINE_FUNCTION(disableInnerCollision)
+    DEFINE_FUNCTION(setContactCache)
+    DEFINE_FUNCTION(getContactCacheReport)
 }
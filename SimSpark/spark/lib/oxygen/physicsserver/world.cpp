@@ -20,6 +20,7 @@
 */
 
 #include <oxygen/physicsserver/int/worldint.h>
+#include <oxygen/physicsserver/rigidbody.h>
 #include <oxygen/physicsserver/space.h>
 #include <oxygen/physicsserver/world.h>
 #include <oxygen/sceneserver/scene.h>
@@ -88,6 +89,48 @@ void World::SetAutoDisableFlag(bool flag)
     mWorldImp->SetAutoDisableFlag(flag, mWorldID);
 }
 
+void World::SetAutoDisableParameters(float linearThreshold,
+                                     float angularThreshold,
+                                     int idleSteps, float idleTime,
+                                     int averageSamples)
+{
+    mWorldImp->SetAutoDisableParameters(linearThreshold, angularThreshold,
+                                        idleSteps, idleTime, averageSamples,
+                                        mWorldID);
+}
+
+void World::GetSleepingBodyCount(int& total, int& sleeping)
+{
+    total = 0;
+    sleeping = 0;
+
+    std::shared_ptr<Scene> scene = GetScene();
+    if (scene.get() == 0)
+        {
+            return;
+        }
+
+    TLeafList bodies;
+    scene->ListChildrenSupportingClass<RigidBody>(bodies, true);
+
+    for (TLeafList::iterator iter = bodies.begin(); iter != bodies.end(); ++iter)
+        {
+            std::shared_ptr<RigidBody> body =
+                std::static_pointer_cast<RigidBody>(*iter);
+
+            if (body->GetBodyID() == 0)
+                {
+                    continue;
+                }
+
+            ++total;
+            if (! body->IsEnabled())
+                {
+                    ++sleeping;
+                }
+        }
+}
+
 void World::SetContactSurfaceLayer(float depth)
 {
     mWorldImp->SetContactSurfaceLayer(depth, mWorldID);
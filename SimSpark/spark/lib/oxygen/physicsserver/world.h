@@ -93,6 +93,19 @@ public:
     bool GetAutoDisableFlag() const;
     void SetAutoDisableFlag(bool flag);
 
+    /** sets the default auto disable (sleeping) parameters of bodies
+        created later, see WorldInt::SetAutoDisableParameters()
+    */
+    void SetAutoDisableParameters(float linearThreshold,
+                                  float angularThreshold,
+                                  int idleSteps, float idleTime,
+                                  int averageSamples);
+
+    /** counts the rigid bodies of the scene and how many of them are
+        currently disabled, i.e. skipped by the physics step
+    */
+    void GetSleepingBodyCount(int& total, int& sleeping);
+
     /** Set and get the depth of the surface layer around all geometry
         objects. Contacts are allowed to sink into the surface layer up to
         the given depth before coming to rest. The default value is
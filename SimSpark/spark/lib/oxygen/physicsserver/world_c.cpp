@@ -20,6 +20,7 @@ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 */
 
 #include <oxygen/physicsserver/world.h>
+#include <sstream>
 
 using namespace oxygen;
 using namespace zeitgeist;
@@ -103,6 +104,52 @@ FUNCTION(World,getAutoDisableFlag)
     return obj->GetAutoDisableFlag();
 }
 
+FUNCTION(World,setAutoDisableParameters)
+{
+    float inLinearThreshold;
+    float inAngularThreshold;
+    int inIdleSteps;
+    float inIdleTime;
+    int inAverageSamples;
+
+    if (in.GetSize() != 5)
+        {
+            return false;
+        }
+
+    ParameterList::TVector::const_iterator iter = in.begin();
+    if (
+        (! in.AdvanceValue(iter,inLinearThreshold)) ||
+        (! in.AdvanceValue(iter,inAngularThreshold)) ||
+        (! in.AdvanceValue(iter,inIdleSteps)) ||
+        (! in.AdvanceValue(iter,inIdleTime)) ||
+        (! in.AdvanceValue(iter,inAverageSamples))
+        )
+        {
+            return false;
+        }
+
+    obj->SetAutoDisableParameters(inLinearThreshold, inAngularThreshold,
+                                  inIdleSteps, inIdleTime, inAverageSamples);
+    return true;
+}
+
+FUNCTION(World,getSleepReport)
+{
+    int total;
+    int sleeping;
+    obj->GetSleepingBodyCount(total, sleeping);
+
+    std::ostringstream report;
+    report << "bodies: " << total << ", sleeping: " << sleeping;
+    if (total > 0)
+        {
+            report << " (" << (100.0 * sleeping / total) << "%)";
+        }
+
+    return report.str();
+}
+
 FUNCTION(World,setContactSurfaceLayer)
 {
     float inDepth;
@@ -134,6 +181,8 @@ void CLASS(World)::DefineClass()
     DEFINE_FUNCTION(getCFM)
     DEFINE_FUNCTION(setAutoDisableFlag)
     DEFINE_FUNCTION(getAutoDisableFlag)
+    DEFINE_FUNCTION(setAutoDisableParameters)
+    DEFINE_FUNCTION(getSleepReport)
     DEFINE_FUNCTION(setContactSurfaceLayer)
     DEFINE_FUNCTION(getContactSurfaceLayer)
 }
@@ -20,7 +20,8 @@
    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 */
 #include "agentproxy.h"
-#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <rcssnet/exception.hpp>
 #include <zeitgeist/logserver/logserver.h>
 #include <oxygen/simulationserver/netcontrol.h>
@@ -34,9 +35,22 @@ using namespace zeitgeist;
 using namespace std;
 using namespace rcss::net;
 
+#ifdef MSG_MORE
+// the agent messages and the (sync) are sent in a single segment
+static const int SEND_MORE = MSG_MORE;
+#else
+static const int SEND_MORE = 0;
+#endif
+
+// receive buffers grow by at least this many bytes
+static const size_t RECV_CHUNK = 32 * 1024;
+
 AgentProxy::AgentProxy(int cycleMillisecs) : Node(),
     mCycleMillisecs(cycleMillisecs), mFinished(false),
-    mAgentBuffer(new NetBuffer)
+    mWaitingForServer(false),
+    mAgentIn(RECV_CHUNK), mAgentInSize(0),
+    mServerIn(RECV_CHUNK), mServerInSize(0),
+    mCycleCount(0), mLatenessSum(0), mLatenessSqSum(0), mMaxLateness(0)
 {
 }
 
@@ -44,25 +58,26 @@ AgentProxy::~AgentProxy()
 {
 }
 
-void AgentProxy::Start(std::shared_ptr<rcss::net::Socket> agentSocket,
+bool AgentProxy::Start(std::shared_ptr<rcss::net::Socket> agentSocket,
            rcss::net::Addr serverAddress)
 {
+    mAgentSocket = agentSocket;
+
     try
     {
-        mAgentSocket = agentSocket;
         mServerSocket = NetControl::CreateSocket(NetControl::ST_TCP);
         if (!mServerSocket)
         {
             mFinished = true;
-            return;
+            return false;
         }
-        GetLog()->Normal() << "(AgentProxy) '" << GetName() << "'connecting to "
+        GetLog()->Normal() << "(AgentProxy) '" << GetName() << "' connecting to "
                 << serverAddress << "\n";
         mServerSocket->connect(serverAddress);
         if (mServerSocket->isConnected())
         {
-            cout << "(AgentProxy) '" << GetName() << "' connected successfully"
-                    << endl;
+            GetLog()->Normal() << "(AgentProxy) '" << GetName()
+                    << "' connected successfully\n";
         }
 
         // assure that a NetMessage object is registered
@@ -72,11 +87,15 @@ void AgentProxy::Start(std::shared_ptr<rcss::net::Socket> agentSocket,
             mNetMessage = std::shared_ptr<NetMessage>(new NetMessage());
         }
 
-        mAgentConnectionThread = std::thread(
-            &AgentProxy::AgentConnectionHandler, this);
-        mServerConnectionThread = std::thread(
-            &AgentProxy::ServerConnectionHandler, this);
-        return;
+        mSyncMsg = "(sync)";
+        mNetMessage->PrepareToSend(mSyncMsg);
+
+        mAgentSocket->setNonBlocking(true);
+        mServerSocket->setNonBlocking(true);
+
+        mCycleDeadline = TimerWheel::TClock::now()
+            + std::chrono::milliseconds(mCycleMillisecs);
+        return true;
     }
     catch (const BindErr& error)
     {
@@ -93,89 +112,323 @@ void AgentProxy::Start(std::shared_ptr<rcss::net::Socket> agentSocket,
     // executed on error
     mServerSocket->close();
     mFinished = true;
+    return false;
 }
 
 void AgentProxy::Stop()
 {
     mFinished = true;
-    mServerConnectionThread.join();
+
+    if (mServerSocket.get() != 0)
+    {
+        mServerSocket->close();
+    }
+    if (mAgentSocket.get() != 0)
+    {
+        mAgentSocket->close();
+    }
+
+    GetLog()->Normal()
+        << "(AgentProxy) '" << GetName() << "' closed after "
+        << mCycleCount << " cycles, deadline lateness avg "
+        << GetAvgLateness() << "us, jitter " << GetLatenessJitter()
+        << "us, max " << mMaxLateness << "us\n";
 }
 
-void AgentProxy::ServerConnectionHandler()
+int AgentProxy::GetAgentFD() const
 {
-    string syncMsg("(sync)");
-    string servermsg, agentmsg;
-    
-    std::chrono::time_point<std::chrono::steady_clock> cycleFinishTime = std::chrono::steady_clock::now()
-            + std::chrono::milliseconds(mCycleMillisecs);
-    std::shared_ptr<NetBuffer> netbuf(new NetBuffer);
-    TRawBuffer recvbuf;
+    return (mAgentSocket.get() != 0) ? mAgentSocket->getFD() : -1;
+}
 
-    mNetMessage->PrepareToSend(syncMsg);
-    while (!mFinished)
+int AgentProxy::GetServerFD() const
+{
+    return (mServerSocket.get() != 0) ? mServerSocket->getFD() : -1;
+}
+
+double AgentProxy::GetAvgLateness() const
+{
+    return (mCycleCount > 0) ? (mLatenessSum / mCycleCount) : 0.0;
+}
+
+double AgentProxy::GetLatenessJitter() const
+{
+    if (mCycleCount == 0)
     {
-        servermsg.clear();
-        std::this_thread::sleep_until(cycleFinishTime);
+        return 0.0;
+    }
+
+    double avg = mLatenessSum / mCycleCount;
+    double var = mLatenessSqSum / mCycleCount - avg * avg;
+    return (var > 0.0) ? sqrt(var) : 0.0;
+}
 
-        std::unique_lock agentBufLock(mAgentBufferMutex);
-        while (!mAgentBuffer->IsEmpty() &&
-                mNetMessage->Extract(mAgentBuffer, agentmsg))
+void AgentProxy::Fail(const char* connection)
+{
+    if (mFinished)
+    {
+        return;
+    }
+
+    GetLog()->Error()
+        << "(AgentProxy) ERROR: '" << GetName() << "' " << connection
+        << " connection closed or failed '" << strerror(errno) << "'\n";
+    mFinished = true;
+}
+
+bool AgentProxy::Receive(Socket& sock, vector<char>& buf, size_t& filled)
+{
+    for (;;)
+    {
+        if (buf.size() - filled < RECV_CHUNK / 2)
         {
-            mNetMessage->PrepareToSend(agentmsg);
-            mServerSocket->send(agentmsg.data(), agentmsg.size());
+            buf.resize(buf.size() + RECV_CHUNK);
         }
-        agentBufLock.unlock();
 
-        mServerSocket->send(syncMsg.data(), syncMsg.size());
-        do
+        size_t space = buf.size() - filled;
+        int retval = sock.recv(&buf[filled], space, 0, Socket::DONT_CHECK);
+        if (retval > 0)
         {
-            int retval = mServerSocket->recv(recvbuf.data(), recvbuf.size());
-            if (retval > 0)
-                netbuf->AddFragment(string(recvbuf.data(), recvbuf.size()));
-            else
+            filled += retval;
+            if (static_cast<size_t>(retval) < space)
             {
-                GetLog()->Error()
-                    << "(AgentProxy) ERROR: '" << GetName()
-                    << "' recv returned error on a client socket '"
-                    << strerror(errno) << "' " << endl;
-                mFinished = true;
-                break;
+                // a short read empties the socket
+                return true;
             }
-        } while (!mNetMessage->Extract(netbuf, servermsg));
-
-        if (!servermsg.empty())
+        }
+        else if (retval == 0)
         {
-            cycleFinishTime = std::chrono::steady_clock::now()
-                    + std::chrono::milliseconds(mCycleMillisecs);
-
-            mNetMessage->PrepareToSend(servermsg);
-            mAgentSocket->send(servermsg.data(), servermsg.size(),
-                Socket::DONT_CHECK);
+            errno = 0;
+            return false;
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            return true;
+        }
+        else if (errno != EINTR)
+        {
+            return false;
         }
     }
-    mServerSocket->close();
-    mFinished = true;
-    mAgentConnectionThread.join();
 }
 
-void AgentProxy::AgentConnectionHandler()
+bool AgentProxy::Send(Socket& sock, string& out,
+                      const char* data, size_t len, int flags)
 {
-    TRawBuffer recvbuf;
+    if (! out.empty())
+    {
+        out.append(data, len);
+        return true;
+    }
 
-    while (!mFinished)
+    size_t sent = 0;
+    while (sent < len)
     {
-        int retval = mAgentSocket->recv(recvbuf.data(), recvbuf.size());
+        int retval = sock.send(data + sent, len - sent, flags,
+                               Socket::DONT_CHECK);
         if (retval > 0)
         {
-            std::lock_guard agentBufLock(mAgentBufferMutex);
-            mAgentBuffer->AddFragment(string(recvbuf.data(), recvbuf.size()));
+            sent += retval;
         }
-        else if (retval <= 0 && errno != EAGAIN)
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
         {
-            GetLog()->Error() << "(AgentProxy) ERROR: '" << GetName()
-                    << "' recv returned error on a client socket '"
-                    << strerror(errno) << "' " << endl;
-            mFinished = true;
+            // the event loop continues when the socket is writable
+            out.append(data + sent, len - sent);
+            return true;
+        }
+        else if (errno != EINTR)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool AgentProxy::Flush(Socket& sock, string& out)
+{
+    size_t sent = 0;
+    while (sent < out.size())
+    {
+        int retval = sock.send(out.data() + sent, out.size() - sent, 0,
+                               Socket::DONT_CHECK);
+        if (retval > 0)
+        {
+            sent += retval;
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            break;
+        }
+        else if (errno != EINTR)
+        {
+            return false;
+        }
+    }
+
+    out.erase(0, sent);
+    return true;
+}
+
+size_t AgentProxy::GetFrameBytes(const vector<char>& buf, size_t filled,
+                                 int maxFrames) const
+{
+    // frames have a 4 byte length prefix in network byte order, see
+    // NetMessage::PrepareToSend()
+    size_t pos = 0;
+    while (
+           (maxFrames != 0) &&
+           (filled - pos >= sizeof(unsigned int))
+           )
+    {
+        const unsigned char* h =
+            reinterpret_cast<const unsigned char*>(&buf[pos]);
+        size_t len =
+            (static_cast<size_t>(h[0]) << 24) |
+            (static_cast<size_t>(h[1]) << 16) |
+            (static_cast<size_t>(h[2]) << 8) |
+            static_cast<size_t>(h[3]);
+
+        if (filled - pos - sizeof(unsigned int) < len)
+        {
+            break;
         }
+
+        pos += sizeof(unsigned int) + len;
+        --maxFrames;
+    }
+
+    return pos;
+}
+
+void AgentProxy::Consume(vector<char>& buf, size_t& filled, size_t len)
+{
+    if (len == 0)
+    {
+        return;
+    }
+
+    // usually all data was consumed and nothing is moved
+    if (filled > len)
+    {
+        memmove(&buf[0], &buf[len], filled - len);
+    }
+    filled -= len;
+}
+
+void AgentProxy::OnAgentReadable()
+{
+    if (mFinished)
+    {
+        return;
+    }
+
+    if (! Receive(*mAgentSocket, mAgentIn, mAgentInSize))
+    {
+        Fail("agent");
+    }
+}
+
+bool AgentProxy::OnServerReadable(TTimePoint now)
+{
+    if (mFinished)
+    {
+        return false;
+    }
+
+    if (! Receive(*mServerSocket, mServerIn, mServerInSize))
+    {
+        Fail("server");
+        return false;
+    }
+
+    return ForwardServerFrame(now);
+}
+
+bool AgentProxy::ForwardServerFrame(TTimePoint now)
+{
+    if (! mWaitingForServer)
+    {
+        return false;
+    }
+
+    // forward a single answer per cycle, further messages wait for
+    // the next (sync)
+    size_t len = GetFrameBytes(mServerIn, mServerInSize, 1);
+    if (len == 0)
+    {
+        return false;
+    }
+
+    if (! Send(*mAgentSocket, mAgentOut, &mServerIn[0], len))
+    {
+        Fail("agent");
+        return false;
+    }
+    Consume(mServerIn, mServerInSize, len);
+
+    mWaitingForServer = false;
+    mCycleDeadline = now + std::chrono::milliseconds(mCycleMillisecs);
+    return true;
+}
+
+bool AgentProxy::OnCycleDeadline(TTimePoint now)
+{
+    if (mFinished || mWaitingForServer)
+    {
+        return false;
+    }
+
+    // the deadline is handled before pending socket events, so
+    // collect what the agent sent up to now
+    if (! Receive(*mAgentSocket, mAgentIn, mAgentInSize))
+    {
+        Fail("agent");
+        return false;
+    }
+
+    double lateness = std::chrono::duration_cast<std::chrono::duration<double, std::micro> >
+        (now - mCycleDeadline).count();
+    ++mCycleCount;
+    mLatenessSum += lateness;
+    mLatenessSqSum += lateness * lateness;
+    if (lateness > mMaxLateness)
+    {
+        mMaxLateness = lateness;
+    }
+
+    // forward the complete agent messages as they were received, an
+    // incomplete message stays in the buffer for the next cycle
+    size_t len = GetFrameBytes(mAgentIn, mAgentInSize, -1);
+    if (
+        ((len > 0) &&
+         (! Send(*mServerSocket, mServerOut, &mAgentIn[0], len, SEND_MORE))) ||
+        (! Send(*mServerSocket, mServerOut, mSyncMsg.data(), mSyncMsg.size()))
+        )
+    {
+        Fail("server");
+        return false;
+    }
+    Consume(mAgentIn, mAgentInSize, len);
+
+    mWaitingForServer = true;
+
+    // a message the server sent earlier is the answer to this (sync),
+    // the server socket may not become readable again
+    return ForwardServerFrame(now);
+}
+
+void AgentProxy::OnAgentWritable()
+{
+    if ((! mFinished) && (! Flush(*mAgentSocket, mAgentOut)))
+    {
+        Fail("agent");
+    }
+}
+
+void AgentProxy::OnServerWritable()
+{
+    if ((! mFinished) && (! Flush(*mServerSocket, mServerOut)))
+    {
+        Fail("server");
     }
 }
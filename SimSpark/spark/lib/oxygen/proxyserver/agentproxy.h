@@ -22,33 +22,45 @@
 #ifndef OXYGEN_AGENTPROXY_H
 #define OXYGEN_AGENTPROXY_H
 
-#include <array>
-#include <mutex>
-#include <thread>
+#include <string>
+#include <vector>
 #include <oxygen/oxygen_defines.h>
 #include <zeitgeist/class.h>
 #include <zeitgeist/node.h>
 #include <rcssnet/addr.hpp>
 #include <rcssnet/socket.hpp>
-#include <oxygen/simulationserver/netbuffer.h>
 #include <oxygen/simulationserver/netmessage.h>
+#include "timerwheel.h"
 
 namespace oxygen
 {
 
-/** \class AgentProxy TODO: add description
- */
+/** \class AgentProxy relays the messages of a single agent to the
+    server and back, and runs the agent in sync mode on behalf of the
+    server: the messages the agent sent during a cycle are forwarded
+    together with a (sync) when the cycle deadline passes, and the
+    next cycle starts when the server answers.
+
+    The AgentProxy does not own a thread. Its sockets are non-blocking
+    and multiplexed by the ProxyServer event loop, which calls the
+    On*() handlers when a socket is ready or the cycle deadline has
+    passed. Complete frames are forwarded as they were received
+    (length prefix included), straight from the receive buffer.
+*/
 class OXYGEN_API AgentProxy: public zeitgeist::Node
 {
-private:
-    typedef std::array<char, 32 * 1024> TRawBuffer;
+public:
+    typedef TimerWheel::TTimePoint TTimePoint;
 
 public:
     AgentProxy(int cycleMillisecs = 0);
     virtual ~AgentProxy();
 
-    /** starts the proxy for a single agent */
-    void Start(std::shared_ptr<rcss::net::Socket> agentSocket,
+    /** connects to the server for a single agent and switches both
+        sockets to non-blocking mode. The first cycle deadline is one
+        cycle from now.
+    */
+    bool Start(std::shared_ptr<rcss::net::Socket> agentSocket,
                rcss::net::Addr serverAddress);
 
     /** does the agent connection terminated so not */
@@ -57,25 +69,131 @@ public:
     /** stops the current running proxy (if running!) */
     void Stop();
 
-private:
-    /** manages server connection */
-    void ServerConnectionHandler();
+    /** returns the socket descriptor of the agent connection */
+    int GetAgentFD() const;
+
+    /** returns the socket descriptor of the server connection */
+    int GetServerFD() const;
+
+    /** receives all pending data of the agent */
+    void OnAgentReadable();
+
+    /** receives all pending data of the server. If the server
+        answered the last (sync), the answer is forwarded to the agent
+        and true is returned; the next cycle deadline is then
+        available via GetCycleDeadline()
+    */
+    bool OnServerReadable(TTimePoint now);
+
+    /** forwards the complete messages the agent sent so far, followed
+        by a (sync), to the server. If a server message is already
+        buffered, it is forwarded to the agent as the answer and true
+        is returned, like OnServerReadable()
+    */
+    bool OnCycleDeadline(TTimePoint now);
+
+    /** sends data that could not be sent to the agent immediately */
+    void OnAgentWritable();
+
+    /** sends data that could not be sent to the server immediately */
+    void OnServerWritable();
+
+    /** returns true if there is data queued for the agent */
+    bool HasAgentOutput() const  { return ! mAgentOut.empty(); }
+
+    /** returns true if there is data queued for the server */
+    bool HasServerOutput() const { return ! mServerOut.empty(); }
+
+    /** returns the deadline of the current cycle */
+    TTimePoint GetCycleDeadline() const { return mCycleDeadline; }
 
-    /** manages agent connection */
-    void AgentConnectionHandler();
+    /** returns the number of cycle deadlines handled */
+    int GetCycleCount() const { return mCycleCount; }
+
+    /** returns the average time in microseconds the cycle deadlines
+        were handled after they passed
+    */
+    double GetAvgLateness() const;
+
+    /** returns the standard deviation of the deadline lateness in
+        microseconds
+    */
+    double GetLatenessJitter() const;
+
+    /** returns the maximum deadline lateness in microseconds */
+    double GetMaxLateness() const { return mMaxLateness; }
+
+private:
+    /** appends all data pending on sock to buf. Returns false if the
+        connection was closed or failed
+    */
+    bool Receive(rcss::net::Socket& sock, std::vector<char>& buf,
+                 size_t& filled);
+
+    /** sends len bytes, or queues what could not be sent to out. Data
+        is always queued if out is not empty, to keep the order.
+        Returns false if the connection failed
+    */
+    bool Send(rcss::net::Socket& sock, std::string& out,
+              const char* data, size_t len, int flags = 0);
+
+    /** sends as much of out as possible. Returns false if the
+        connection failed
+    */
+    bool Flush(rcss::net::Socket& sock, std::string& out);
+
+    /** returns the number of bytes at the start of buf that make up
+        complete frames, at most maxFrames frames (all if negative)
+    */
+    size_t GetFrameBytes(const std::vector<char>& buf, size_t filled,
+                         int maxFrames) const;
+
+    /** removes the first len bytes from buf */
+    void Consume(std::vector<char>& buf, size_t& filled, size_t len);
+
+    /** forwards the first complete server message to the agent if
+        the (sync) of the current cycle is not answered yet, and
+        starts the next cycle. Returns true if a message was forwarded
+    */
+    bool ForwardServerFrame(TTimePoint now);
+
+    /** marks the proxy as finished after a connection error */
+    void Fail(const char* connection);
 
 private:
     const int mCycleMillisecs;
 
     /** shows if the proxy execution is finished */
     bool mFinished;
+
+    /** true while the (sync) of the current cycle is not answered */
+    bool mWaitingForServer;
+
     std::shared_ptr<NetMessage> mNetMessage;
     std::shared_ptr<rcss::net::Socket> mServerSocket;
     std::shared_ptr<rcss::net::Socket> mAgentSocket;
-    std::shared_ptr<NetBuffer> mAgentBuffer;
-    std::thread mServerConnectionThread;
-    std::thread mAgentConnectionThread;
-    std::mutex mAgentBufferMutex;
+
+    /** the framed (sync) message */
+    std::string mSyncMsg;
+
+    /** data received from the agent and the server */
+    std::vector<char> mAgentIn;
+    size_t mAgentInSize;
+    std::vector<char> mServerIn;
+    size_t mServerInSize;
+
+    /** data that could not be sent yet */
+    std::string mAgentOut;
+    std::string mServerOut;
+
+    /** the deadline of the current cycle */
+    TTimePoint mCycleDeadline;
+
+    /** deadline lateness statistics, in microseconds */
+    int mCycleCount;
+    double mLatenessSum;
+    double mLatenessSqSum;
+    double mMaxLateness;
 };
 
 DECLARE_CLASS(AgentProxy)
@@ -24,6 +24,21 @@
 #include <oxygen/simulationserver/netcontrol.h>
 #include <rcssnet/exception.hpp>
 #include "agentproxy.h"
+#include <cstring>
+#include <sstream>
+#include <errno.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#if defined(HAVE_SYS_EPOLL_H)
+#include <sys/epoll.h>
+#ifdef HAVE_SYS_TIMERFD_H
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+#elif defined(HAVE_POLL_H)
+#include <poll.h>
+#endif
 
 using namespace oxygen;
 using namespace zeitgeist;
@@ -35,12 +50,15 @@ ProxyServer::ProxyServer() : Leaf(),
     mCycleMillisecs(0),
     mLocalAddr(0, Addr::ANY),
     mServerAddr(0, Addr::ANY),
-    mSocket(NetControl::CreateSocket(NetControl::ST_TCP))
+    mSocket(NetControl::CreateSocket(NetControl::ST_TCP)),
+    mEventFD(-1),
+    mTimerFD(-1)
 {
 }
 
 ProxyServer::~ProxyServer()
 {
+    DoneEvents();
 }
 
 void ProxyServer::SetProxyPort(Addr::PortType port)
@@ -65,8 +83,6 @@ void ProxyServer::SetCycleLength(int millisecs)
 
 bool ProxyServer::Run()
 {
-    bool success = false;
-
     if (mLocalAddr.getPort() == 0)
     {
         GetLog()->Error()
@@ -106,41 +122,412 @@ bool ProxyServer::Run()
     {
         mSocket->bind(mLocalAddr);
         mSocket->listen(50);
-        mRunning = true;
-
-        do
-        {
-            Addr addr;
-            std::shared_ptr<Socket> socket(mSocket->accept(addr));
-            if (socket)
-            {
-                GetLog()->Normal() << "(ProxyServer) accepted a new connection"
-                    << " from " << socket->getPeer() << '\n';
-
-                AgentProxy *agentProxy = new AgentProxy(mCycleMillisecs);
-                agentProxy->Start(socket, mServerAddr);
-                mClientProxyList.push_back(agentProxy);
-            }
-        } while (mRunning);
-        success = true;
     }
     catch (const BindErr& error)
     {
         GetLog()->Error() << "(ProxyServer) failed to bind socket with '"
                 << error.what() << "'" << endl;
+        mSocket->close();
+        return false;
     }
     catch (const ListenErr& error)
     {
         GetLog()->Error() << "(ProxyServer) failed to listen on socket with '"
                 << error.what() << "'" << endl;
+        mSocket->close();
+        return false;
     }
-    catch (const AcceptErr& error)
+
+    if (! InitEvents())
     {
-        GetLog()->Error() << "(ProxyServer) '" << GetName()
-                << "' failed to accept TCP connection with '" << error.what()
-                << endl;
+        mSocket->close();
+        return false;
     }
 
+    mSocket->setNonBlocking(true);
+    Watch(mSocket->getFD(), T_LISTEN, false);
+    mTimers.Reset(TimerWheel::TClock::now());
+    mRunning = true;
+
+    do
+    {
+        WaitEvents();
+
+        // the deadlines that passed go first, their lateness is the
+        // jitter the agents see; each proxy reads its agent socket
+        // itself before it sends the (sync)
+        HandleDeadlines();
+
+        for (vector<Event>::const_iterator iter = mEvents.begin();
+             iter != mEvents.end();
+             ++iter)
+        {
+            const Event& event = (*iter);
+            switch (event.token)
+            {
+            case T_LISTEN:
+                AcceptConnections();
+                break;
+
+            case T_TIMER:
+                break;
+
+            default:
+                Dispatch(event);
+                break;
+            }
+        }
+    } while (mRunning);
+
+    for (int id = 0; id < static_cast<int>(mProxies.size()); ++id)
+    {
+        if (mProxies[id].proxy.get() != 0)
+        {
+            RemoveProxy(id);
+        }
+    }
+
+    DoneEvents();
     mSocket->close();
-    return success;
+    return true;
+}
+
+void ProxyServer::HandleDeadlines()
+{
+    TimerWheel::TTimePoint now = TimerWheel::TClock::now();
+    mExpired.clear();
+    mTimers.Advance(now, mExpired);
+
+    for (vector<int>::const_iterator iter = mExpired.begin();
+         iter != mExpired.end();
+         ++iter)
+    {
+        std::shared_ptr<AgentProxy> proxy = mProxies[*iter].proxy;
+        if (proxy.get() == 0)
+        {
+            continue;
+        }
+
+        if (proxy->OnCycleDeadline(now))
+        {
+            mTimers.Schedule(*iter, proxy->GetCycleDeadline());
+        }
+        UpdateProxy(*iter);
+    }
+}
+
+void ProxyServer::AcceptConnections()
+{
+    for (;;)
+    {
+        Addr addr;
+        std::shared_ptr<Socket> socket(mSocket->accept(addr));
+        if (! socket)
+        {
+            // no more pending connections
+            return;
+        }
+
+        GetLog()->Normal() << "(ProxyServer) accepted a new connection"
+            << " from " << socket->getPeer() << '\n';
+
+        // reuse the id of a closed proxy
+        int id = 0;
+        while (
+               (id < static_cast<int>(mProxies.size())) &&
+               (mProxies[id].proxy.get() != 0)
+               )
+        {
+            ++id;
+        }
+        if (id == static_cast<int>(mProxies.size()))
+        {
+            mProxies.push_back(ProxyEntry());
+        }
+
+        std::shared_ptr<AgentProxy> proxy(new AgentProxy(mCycleMillisecs));
+        std::ostringstream name;
+        name << "AgentProxy" << id;
+        proxy->SetName(name.str());
+
+        if (! proxy->Start(socket, mServerAddr))
+        {
+            socket->close();
+            continue;
+        }
+
+        ProxyEntry& entry = mProxies[id];
+        entry.proxy = proxy;
+        entry.agentOut = false;
+        entry.serverOut = false;
+
+        Watch(proxy->GetAgentFD(), 2 * id, false);
+        Watch(proxy->GetServerFD(), 2 * id + 1, false);
+        mTimers.Schedule(id, proxy->GetCycleDeadline());
+    }
+}
+
+void ProxyServer::Dispatch(const Event& event)
+{
+    int id = static_cast<int>(event.token / 2);
+    bool server = ((event.token % 2) == 1);
+
+    if (
+        (id >= static_cast<int>(mProxies.size())) ||
+        (mProxies[id].proxy.get() == 0)
+        )
+    {
+        // the proxy was closed by an earlier event
+        return;
+    }
+
+    AgentProxy& proxy = *mProxies[id].proxy;
+    if (server)
+    {
+        if (event.writable)
+        {
+            proxy.OnServerWritable();
+        }
+        if (
+            (event.readable) &&
+            (proxy.OnServerReadable(TimerWheel::TClock::now()))
+            )
+        {
+            mTimers.Schedule(id, proxy.GetCycleDeadline());
+        }
+    } else
+    {
+        if (event.writable)
+        {
+            proxy.OnAgentWritable();
+        }
+        if (event.readable)
+        {
+            proxy.OnAgentReadable();
+        }
+    }
+
+    UpdateProxy(id);
+}
+
+void ProxyServer::UpdateProxy(int id)
+{
+    ProxyEntry& entry = mProxies[id];
+    AgentProxy& proxy = *entry.proxy;
+
+    if (proxy.IsFinished())
+    {
+        RemoveProxy(id);
+        return;
+    }
+
+    if (entry.agentOut != proxy.HasAgentOutput())
+    {
+        entry.agentOut = proxy.HasAgentOutput();
+        Watch(proxy.GetAgentFD(), 2 * id, entry.agentOut, true);
+    }
+    if (entry.serverOut != proxy.HasServerOutput())
+    {
+        entry.serverOut = proxy.HasServerOutput();
+        Watch(proxy.GetServerFD(), 2 * id + 1, entry.serverOut, true);
+    }
+}
+
+void ProxyServer::RemoveProxy(int id)
+{
+    ProxyEntry& entry = mProxies[id];
+
+    // unwatch before the descriptors are closed and reused
+    Unwatch(entry.proxy->GetAgentFD());
+    Unwatch(entry.proxy->GetServerFD());
+    mTimers.Cancel(id);
+
+    entry.proxy->Stop();
+    entry.proxy.reset();
+}
+
+bool ProxyServer::InitEvents()
+{
+    DoneEvents();
+
+#if defined(HAVE_SYS_EPOLL_H)
+    mEventFD = epoll_create1(EPOLL_CLOEXEC);
+    if (mEventFD < 0)
+    {
+        GetLog()->Error() << "(ProxyServer) ERROR: epoll_create1 failed with '"
+                << strerror(errno) << "'\n";
+        return false;
+    }
+
+#ifdef HAVE_SYS_TIMERFD_H
+    mTimerFD = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (mTimerFD >= 0)
+    {
+        Watch(mTimerFD, T_TIMER, false);
+    } else
+    {
+        GetLog()->Warning()
+            << "(ProxyServer) timerfd_create failed with '" << strerror(errno)
+            << "', cycle deadlines have millisecond resolution\n";
+    }
+#endif
+    return true;
+#elif defined(HAVE_POLL_H)
+    return true;
+#else
+    GetLog()->Error()
+        << "(ProxyServer) ERROR: neither epoll nor poll is available\n";
+    return false;
+#endif
+}
+
+void ProxyServer::DoneEvents()
+{
+#ifdef HAVE_UNISTD_H
+    if (mTimerFD >= 0)
+    {
+        close(mTimerFD);
+    }
+    if (mEventFD >= 0)
+    {
+        close(mEventFD);
+    }
+#endif
+
+    mTimerFD = -1;
+    mEventFD = -1;
+    mWatched.clear();
+}
+
+void ProxyServer::Watch(int fd, long token, bool writable, bool modify)
+{
+#if defined(HAVE_SYS_EPOLL_H)
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | (writable ? static_cast<uint32_t>(EPOLLOUT) : 0);
+    ev.data.u64 = static_cast<uint64_t>(token);
+
+    if (epoll_ctl(mEventFD, modify ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &ev) < 0)
+    {
+        GetLog()->Error() << "(ProxyServer) ERROR: epoll_ctl failed with '"
+                << strerror(errno) << "'\n";
+    }
+#else
+    (void)modify;
+    mWatched[fd] = make_pair(token, writable);
+#endif
+}
+
+void ProxyServer::Unwatch(int fd)
+{
+#if defined(HAVE_SYS_EPOLL_H)
+    epoll_ctl(mEventFD, EPOLL_CTL_DEL, fd, 0);
+#else
+    mWatched.erase(fd);
+#endif
+}
+
+void ProxyServer::WaitEvents()
+{
+    mEvents.clear();
+
+    TimerWheel::TTimePoint deadline;
+    bool hasDeadline = mTimers.NextDeadline(deadline);
+
+    // timeout in milliseconds, rounded up so that the deadline has
+    // passed on wake up
+    int timeout = -1;
+    if (hasDeadline)
+    {
+        long long micros = std::chrono::duration_cast<std::chrono::microseconds>
+            (deadline - TimerWheel::TClock::now()).count();
+        timeout = (micros > 0) ? static_cast<int>((micros + 999) / 1000) : 0;
+    }
+
+#if defined(HAVE_SYS_EPOLL_H)
+#ifdef HAVE_SYS_TIMERFD_H
+    if (mTimerFD >= 0)
+    {
+        // steady_clock is CLOCK_MONOTONIC, arm the timer to the exact
+        // deadline; a zero value disarms it
+        itimerspec spec;
+        memset(&spec, 0, sizeof(spec));
+        if (hasDeadline)
+        {
+            long long nanos = std::chrono::duration_cast<std::chrono::nanoseconds>
+                (deadline.time_since_epoch()).count();
+            spec.it_value.tv_sec = nanos / 1000000000LL;
+            spec.it_value.tv_nsec = nanos % 1000000000LL;
+            if (
+                (spec.it_value.tv_sec == 0) &&
+                (spec.it_value.tv_nsec == 0)
+                )
+            {
+                spec.it_value.tv_nsec = 1;
+            }
+        }
+        timerfd_settime(mTimerFD, TFD_TIMER_ABSTIME, &spec, 0);
+        timeout = -1;
+    }
+#endif
+
+    const int maxEvents = 64;
+    epoll_event events[maxEvents];
+    int n = epoll_wait(mEventFD, events, maxEvents, timeout);
+
+    for (int i = 0; i < n; ++i)
+    {
+        Event event;
+        event.token = static_cast<long>(events[i].data.u64);
+        event.readable = (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0;
+        event.writable = (events[i].events & EPOLLOUT) != 0;
+
+#ifdef HAVE_SYS_TIMERFD_H
+        if (event.token == T_TIMER)
+        {
+            // clear the expiration, the deadlines are read from the wheel
+            uint64_t expirations;
+            if (read(mTimerFD, &expirations, sizeof(expirations)) < 0)
+            {
+                expirations = 0;
+            }
+        }
+#endif
+
+        mEvents.push_back(event);
+    }
+#elif defined(HAVE_POLL_H)
+    vector<pollfd> fds;
+    vector<long> tokens;
+    fds.reserve(mWatched.size());
+    tokens.reserve(mWatched.size());
+
+    for (map<int, pair<long, bool> >::const_iterator iter = mWatched.begin();
+         iter != mWatched.end();
+         ++iter)
+    {
+        pollfd p;
+        p.fd = (*iter).first;
+        p.events = POLLIN | ((*iter).second.second ? POLLOUT : 0);
+        p.revents = 0;
+        fds.push_back(p);
+        tokens.push_back((*iter).second.first);
+    }
+
+    int n = poll(fds.empty() ? 0 : &fds[0], fds.size(), timeout);
+
+    for (int i = 0; (n > 0) && (i < static_cast<int>(fds.size())); ++i)
+    {
+        if (fds[i].revents == 0)
+        {
+            continue;
+        }
+
+        Event event;
+        event.token = tokens[i];
+        event.readable = (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+        event.writable = (fds[i].revents & POLLOUT) != 0;
+        mEvents.push_back(event);
+    }
+#endif
 }
@@ -27,13 +27,24 @@
 #include <zeitgeist/leaf.h>
 #include <rcssnet/addr.hpp>
 #include <rcssnet/socket.hpp>
+#include <map>
+#include <vector>
+#include "timerwheel.h"
 
 namespace oxygen
 {
 
 class AgentProxy;
 
-/** \class ProxyServer TODO: Add description
+/** \class ProxyServer accepts agent connections, connects each agent
+    to the server and runs it in sync mode through an AgentProxy.
+
+    All proxies are served by a single event loop: the sockets of all
+    agents and their server connections are multiplexed with epoll
+    (poll where epoll is not available), and the cycle deadlines of
+    all proxies are kept in a TimerWheel. On Linux the loop sleeps on
+    a timerfd armed to the next deadline, so deadlines are handled
+    with microsecond instead of millisecond resolution.
  */
 class OXYGEN_API ProxyServer: public zeitgeist::Leaf
 {
@@ -57,6 +68,66 @@ public:
      * requests */
     bool Run();
 
+private:
+    /** identifies the source of an event */
+    enum EToken
+    {
+        T_LISTEN = -1,
+        T_TIMER = -2
+    };
+
+    struct Event
+    {
+        long token;
+        bool readable;
+        bool writable;
+    };
+
+    struct ProxyEntry
+    {
+        std::shared_ptr<AgentProxy> proxy;
+
+        /** true if writability is watched on the agent/server socket */
+        bool agentOut;
+        bool serverOut;
+    };
+
+    /** sets up the event multiplexer */
+    bool InitEvents();
+
+    /** releases the event multiplexer */
+    void DoneEvents();
+
+    /** adds a socket to the event multiplexer, or changes whether
+        writability is watched
+    */
+    void Watch(int fd, long token, bool writable, bool modify = false);
+
+    /** removes a socket from the event multiplexer */
+    void Unwatch(int fd);
+
+    /** waits until an event occurs or the next cycle deadline has
+        passed, and collects the events in mEvents
+    */
+    void WaitEvents();
+
+    /** passes the cycle deadlines that passed to their proxies */
+    void HandleDeadlines();
+
+    /** accepts all pending connections and starts their proxies */
+    void AcceptConnections();
+
+    /** passes a socket event to its proxy */
+    void Dispatch(const Event& event);
+
+    /** updates the watched writability of the proxy sockets and
+        removes the proxy if it is finished
+    */
+    void UpdateProxy(int id);
+
+    /** closes the proxy and frees its id */
+    void RemoveProxy(int id);
+
 private:
     bool mRunning;
     int mCycleMillisecs;
@@ -70,7 +141,28 @@ private:
     /** the socket used to accept connections */
     std::shared_ptr<rcss::net::Socket> mSocket;
 
-    std::list<AgentProxy*> mClientProxyList;
+    /** the active proxies, indexed by their id (their timer id in the
+        wheel and the high bits of their event tokens)
+    */
+    std::vector<ProxyEntry> mProxies;
+
+    /** the cycle deadlines of the proxies */
+    TimerWheel mTimers;
+
+    /** the epoll descriptor, or -1 */
+    int mEventFD;
+
+    /** the timerfd armed to the next cycle deadline, or -1 */
+    int mTimerFD;
+
+    /** the watched sockets, used by the poll fallback */
+    std::map<int, std::pair<long, bool> > mWatched;
+
+    /** the events collected by WaitEvents() */
+    std::vector<Event> mEvents;
+
+    /** reusable list of expired timers */
+    std::vector<int> mExpired;
 };
 
 DECLARE_CLASS(ProxyServer)
@@ -0,0 +1,275 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2002,2003 Koblenz University
+   Copyright (C) 2004-2009 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#include "timerwheel.h"
+
+using namespace oxygen;
+using namespace std;
+
+TimerWheel::TimerWheel(int tickMicrosecs) :
+    mTick(tickMicrosecs > 0 ? tickMicrosecs : 1),
+    mOrigin(TClock::now()),
+    mCurrent(0),
+    mActiveCount(0)
+{
+}
+
+void TimerWheel::Reset(TTimePoint now)
+{
+    mOrigin = now;
+    mCurrent = 0;
+
+    for (int i = 0; i < L0_SIZE; ++i)
+    {
+        mLevel0[i].clear();
+    }
+    for (int i = 0; i < L1_SIZE; ++i)
+    {
+        mLevel1[i].clear();
+    }
+
+    for (vector<Timer>::iterator iter = mTimers.begin();
+         iter != mTimers.end();
+         ++iter)
+    {
+        (*iter).active = false;
+        ++(*iter).gen;
+    }
+
+    mActiveCount = 0;
+}
+
+long long TimerWheel::GetTick(TTimePoint t) const
+{
+    return chrono::duration_cast<chrono::microseconds>(t - mOrigin).count()
+        / mTick.count();
+}
+
+bool TimerWheel::IsLive(const Entry& e) const
+{
+    const Timer& timer = mTimers[e.id];
+    return (timer.active && timer.gen == e.gen);
+}
+
+void TimerWheel::Insert(const Entry& e)
+{
+    long long tick = GetTick(mTimers[e.id].deadline);
+    if (tick < mCurrent)
+    {
+        // already due, fire with the next Advance()
+        tick = mCurrent;
+    }
+
+    if (tick - mCurrent < L0_SIZE)
+    {
+        mLevel0[tick & (L0_SIZE - 1)].push_back(e);
+        return;
+    }
+
+    long long block = tick >> L0_BITS;
+    long long currentBlock = mCurrent >> L0_BITS;
+    if (block - currentBlock >= L1_SIZE)
+    {
+        // park in the farthest slot, it is sorted again on cascade
+        block = currentBlock + L1_SIZE - 1;
+    }
+
+    mLevel1[block % L1_SIZE].push_back(e);
+}
+
+void TimerWheel::Cascade()
+{
+    TSlot slot;
+    slot.swap(mLevel1[(mCurrent >> L0_BITS) % L1_SIZE]);
+
+    for (TSlot::const_iterator iter = slot.begin();
+         iter != slot.end();
+         ++iter)
+    {
+        if (IsLive(*iter))
+        {
+            Insert(*iter);
+        }
+    }
+}
+
+void TimerWheel::Schedule(int id, TTimePoint deadline)
+{
+    if (id < 0)
+    {
+        return;
+    }
+
+    if (id >= static_cast<int>(mTimers.size()))
+    {
+        mTimers.resize(id + 1);
+    }
+
+    Timer& timer = mTimers[id];
+    if (! timer.active)
+    {
+        timer.active = true;
+        ++mActiveCount;
+    }
+
+    ++timer.gen;
+    timer.deadline = deadline;
+
+    Entry e = { id, timer.gen };
+    Insert(e);
+}
+
+void TimerWheel::Cancel(int id)
+{
+    if (! IsScheduled(id))
+    {
+        return;
+    }
+
+    Timer& timer = mTimers[id];
+    timer.active = false;
+    ++timer.gen;
+    --mActiveCount;
+}
+
+bool TimerWheel::IsScheduled(int id) const
+{
+    return (
+            (id >= 0) &&
+            (id < static_cast<int>(mTimers.size())) &&
+            (mTimers[id].active)
+            );
+}
+
+void TimerWheel::ProcessSlot(TTimePoint now, vector<int>& expired)
+{
+    TSlot& slot = mLevel0[mCurrent & (L0_SIZE - 1)];
+
+    size_t kept = 0;
+    for (size_t i = 0; i < slot.size(); ++i)
+    {
+        const Entry& e = slot[i];
+        if (! IsLive(e))
+        {
+            continue;
+        }
+
+        Timer& timer = mTimers[e.id];
+        if (timer.deadline <= now)
+        {
+            timer.active = false;
+            --mActiveCount;
+            expired.push_back(e.id);
+        } else
+        {
+            slot[kept++] = e;
+        }
+    }
+
+    slot.resize(kept);
+}
+
+void TimerWheel::Advance(TTimePoint now, vector<int>& expired)
+{
+    long long nowTick = GetTick(now);
+
+    while (mCurrent < nowTick)
+    {
+        if (mActiveCount == 0)
+        {
+            // nothing to fire, drop the stale entries and jump ahead
+            Reset(mOrigin);
+            mCurrent = nowTick;
+            break;
+        }
+
+        ProcessSlot(now, expired);
+
+        ++mCurrent;
+        if ((mCurrent & (L0_SIZE - 1)) == 0)
+        {
+            Cascade();
+        }
+    }
+
+    ProcessSlot(now, expired);
+}
+
+bool TimerWheel::EarliestInSlot(const TSlot& slot, TTimePoint& deadline) const
+{
+    bool found = false;
+    for (TSlot::const_iterator iter = slot.begin();
+         iter != slot.end();
+         ++iter)
+    {
+        if (! IsLive(*iter))
+        {
+            continue;
+        }
+
+        const TTimePoint& t = mTimers[(*iter).id].deadline;
+        if ((! found) || (t < deadline))
+        {
+            deadline = t;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+bool TimerWheel::NextDeadline(TTimePoint& deadline) const
+{
+    if (mActiveCount == 0)
+    {
+        return false;
+    }
+
+    // the first level slots hold the next L0_SIZE ticks in order
+    bool found = false;
+    for (long long tick = mCurrent; tick < mCurrent + L0_SIZE; ++tick)
+    {
+        if (EarliestInSlot(mLevel0[tick & (L0_SIZE - 1)], deadline))
+        {
+            found = true;
+            break;
+        }
+    }
+
+    // a second level slot can still hold earlier timers that were
+    // scheduled before their block came into first level range. The
+    // slots are not in deadline order: a slot that parked timers far
+    // away can come before one with an earlier timer, so all of them
+    // are checked
+    for (int i = 0; i < L1_SIZE; ++i)
+    {
+        TTimePoint t;
+        if (
+            EarliestInSlot(mLevel1[i], t) &&
+            ((! found) || (t < deadline))
+            )
+        {
+            deadline = t;
+            found = true;
+        }
+    }
+
+    return found;
+}
@@ -0,0 +1,148 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2002,2003 Koblenz University
+   Copyright (C) 2004-2009 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#ifndef OXYGEN_TIMERWHEEL_H
+#define OXYGEN_TIMERWHEEL_H
+
+#include <chrono>
+#include <vector>
+#include <oxygen/oxygen_defines.h>
+
+namespace oxygen
+{
+
+/** \class TimerWheel is a two level hierarchical timer wheel used by
+    the ProxyServer to keep the cycle deadlines of all proxied agents.
+
+    The first level has 256 slots of one tick each, the second level
+    64 slots of 256 ticks each; timers further away are parked in the
+    last second level slot and re-sorted when it is cascaded. Timers
+    are identified by small integer ids. Scheduling, rescheduling and
+    cancelling are O(1): a rescheduled timer leaves a stale entry
+    behind that is dropped when its slot is processed.
+
+    Slots only group timers, the exact deadline of each timer is kept,
+    so that Advance() never fires a timer early and NextDeadline()
+    returns the exact time to sleep until.
+*/
+class OXYGEN_API TimerWheel
+{
+public:
+    typedef std::chrono::steady_clock TClock;
+    typedef TClock::time_point TTimePoint;
+
+public:
+    /** constructs the wheel, with a tick length in microseconds */
+    TimerWheel(int tickMicrosecs = 1000);
+
+    /** (re)starts the wheel at the given time, removing all timers */
+    void Reset(TTimePoint now);
+
+    /** schedules (or reschedules) timer id to expire at deadline */
+    void Schedule(int id, TTimePoint deadline);
+
+    /** cancels timer id, if it is scheduled */
+    void Cancel(int id);
+
+    /** returns true if timer id is scheduled */
+    bool IsScheduled(int id) const;
+
+    /** advances the wheel to now and appends the ids of all expired
+        timers to expired, in deadline slot order
+    */
+    void Advance(TTimePoint now, std::vector<int>& expired);
+
+    /** returns the earliest deadline of all scheduled timers, false
+        if no timer is scheduled
+    */
+    bool NextDeadline(TTimePoint& deadline) const;
+
+    /** returns the number of scheduled timers */
+    int GetTimerCount() const { return mActiveCount; }
+
+protected:
+    enum
+    {
+        L0_BITS = 8,
+        L0_SIZE = 1 << L0_BITS,
+        L1_SIZE = 64
+    };
+
+    struct Entry
+    {
+        int id;
+        unsigned gen;
+    };
+
+    struct Timer
+    {
+        TTimePoint deadline;
+        unsigned gen;
+        bool active;
+
+        Timer() : gen(0), active(false) {}
+    };
+
+    typedef std::vector<Entry> TSlot;
+
+    /** returns the tick that contains t */
+    long long GetTick(TTimePoint t) const;
+
+    /** returns true if the slot entry still refers to a scheduled timer */
+    bool IsLive(const Entry& e) const;
+
+    /** puts a timer entry into the slot that matches its deadline */
+    void Insert(const Entry& e);
+
+    /** moves the second level slot of the current block to the first level */
+    void Cascade();
+
+    /** fires the live entries of the current first level slot with a
+        deadline up to now, keeps the others
+    */
+    void ProcessSlot(TTimePoint now, std::vector<int>& expired);
+
+    /** returns the earliest deadline of the live entries of a slot */
+    bool EarliestInSlot(const TSlot& slot, TTimePoint& deadline) const;
+
+protected:
+    /** the tick length */
+    std::chrono::microseconds mTick;
+
+    /** the time of tick 0 */
+    TTimePoint mOrigin;
+
+    /** the tick of the current first level slot; all earlier slots are
+        processed
+    */
+    long long mCurrent;
+
+    TSlot mLevel0[L0_SIZE];
+    TSlot mLevel1[L1_SIZE];
+
+    /** the timers, indexed by id */
+    std::vector<Timer> mTimers;
+
+    int mActiveCount;
+};
+
+} // namespace oxygen
+
+#endif // OXYGEN_TIMERWHEEL_H
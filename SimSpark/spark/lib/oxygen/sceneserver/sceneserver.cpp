@@ -24,6 +24,7 @@
 #include <zeitgeist/logserver/logserver.h>
 #include <zeitgeist/corecontext.h>
 #include <zeitgeist/fileserver/fileserver.h>
+#include <zeitgeist/startuptrace.h>
 #include <salt/vector.h>
 #include <salt/frustum.h>
 #include "transform.h"
@@ -31,6 +32,7 @@
 #include "sceneimporter.h"
 #include "scenedict.h"
 #include <oxygen/physicsserver/physicsserver.h>
+#include <oxygen/simulationserver/cycleprofiler.h>
 
 using namespace oxygen;
 using namespace salt;
@@ -193,10 +195,16 @@ void SceneServer::PhysicsUpdate(float deltaTime)
 {
     std::lock_guard lock(mMutex);
     // determine collisions
-    mPhysicsServer->DoCollisions();
+    {
+        OXYGEN_PROFILE_SCOPE("PhysicsServer::DoCollisions");
+        mPhysicsServer->DoCollisions();
+    }
 
     // do physics
-    mPhysicsServer->StepSimulation(deltaTime);
+    {
+        OXYGEN_PROFILE_SCOPE("PhysicsServer::StepSimulation");
+        mPhysicsServer->StepSimulation(deltaTime);
+    }
 }
 
 void SceneServer::PostPhysicsUpdate()
@@ -228,6 +236,8 @@ bool SceneServer::ImportScene(const string& fileName, std::shared_ptr<BaseNode>
                 << "root node, fileName was " << fileName << "\n";
         }
 
+    StartupTrace::Span span("scene", fileName);
+
     GetLog()->Debug() << "(SceneServer) ImportScene fileName=" << fileName
                       << " root=" << root->GetFullPath() << "\n";
 
@@ -20,7 +20,10 @@
 #include "agentcontrol.h"
 #include "simulationserver.h"
 #include "netmessage.h"
-#include <set>
+#include "cycleprofiler.h"
+#include "cyclearena.h"
+#include "commandjournal.h"
+#include <algorithm>
 #include <zeitgeist/logserver/logserver.h>
 #include <oxygen/agentaspect/agentaspect.h>
 
@@ -29,7 +32,9 @@ using namespace zeitgeist;
 using namespace std;
 
 AgentControl::AgentControl() : NetControl(), mSyncMode(false),
-            mMultiThreads(true), mThreadBarrierNew(NULL), nThreads(0)
+            mMultiThreads(true), mConnectCount(0), mSyncConnectCount(0),
+            mSyncTimeout(0), mThreadBarrierNew(NULL),
+            nThreads(0)
 {
     mThreadBarrier = new boost::barrier(1);
     mLocalAddr.setPort(3100);
@@ -58,11 +63,19 @@ void AgentControl::ClientConnect(std::shared_ptr<Client> client)
     if (client->id >= (int) mClientSenses.size())
         mClientSenses.resize(client->id+1);
 
+    ++mConnectCount;
+
     if (mGameControlServer.get() == 0)
         {
             return;
         }
 
+    CommandJournal* journal = CommandJournal::GetRecording();
+    if (journal != 0)
+        {
+            journal->RecordConnect(client->id);
+        }
+
     mGameControlServer->AgentConnect(client->id);
 
     //Create a new thread and new barrier
@@ -83,11 +96,26 @@ void AgentControl::ClientDisconnect(std::shared_ptr<Client> client)
             return;
         }
 
+    CommandJournal* journal = CommandJournal::GetRecording();
+    if (journal != 0)
+        {
+            journal->RecordDisconnect(client->id);
+        }
+
     mGameControlServer->pushDisappearedAgent(client->id);
 }
 
 void AgentControl::StartCycle()
 {
+    const std::chrono::steady_clock::time_point syncStart =
+        std::chrono::steady_clock::now();
+
+    if (mSyncMode)
+    {
+        InitSyncBarrier();
+        UpdateSyncWait(syncStart);
+    }
+
     do
     {
         NetControl::StartCycle();
@@ -137,7 +165,25 @@ void AgentControl::StartCycle()
           WaitMaster(); //let threads start
           WaitMaster(); //wait for threads to finish
         }*/
-    } while (!AgentsAreSynced());
+    } while (!AgentsAreSynced() && UpdateSyncWait(syncStart));
+
+    if (mSyncMode)
+    {
+        std::chrono::duration<float> waitTime =
+            std::chrono::steady_clock::now() - syncStart;
+        mSyncStats.waitTime = waitTime.count();
+        mSyncStats.timedOut = !mSyncPending.empty();
+
+        if (mSyncStats.timedOut)
+        {
+            mSyncStats.waitClient = mSyncPending.front().client->id;
+            GetLog()->Warning()
+                << "(AgentControl) sync timeout, " << mSyncPending.size()
+                << " agent(s) did not sync, first id "
+                << mSyncStats.waitClient << "\n";
+            mSyncPending.clear();
+        }
+    }
 
     /* TODO Once StartCycle is run in parralel, the following block should be called after NetControl::StartCycle
        because after exactly one bunch of new threads has been created, we need to call WaitMaster once
@@ -168,10 +214,20 @@ void AgentControl::StartCycle(const std::shared_ptr<Client> &client,
   {
       return;
   }
+  OXYGEN_PROFILE_SCOPE("AgentControl::ParseActions");
+  CycleArena::Scope arena;
+
+  CommandJournal* journal = CommandJournal::GetRecording();
+
   // parse and immediately realize the action
   string message;
   while (mNetMessage->Extract(netBuff,message))
   {
+      if (journal != 0)
+      {
+          journal->RecordAgentMessage(client->id, message);
+      }
+
       agent->RealizeActions
           (mGameControlServer->Parse(client->id,message));
   }
@@ -218,15 +274,26 @@ void AgentControl::EndCycle()
 
     if(!mMultiThreads)
     {
-      // generate senses for all agents
+      // generate senses for all agents, in the order of the client
+      // ids, which a CommandJournal replay reproduces
+      std::vector<std::shared_ptr<Client> > clients;
+      clients.reserve(mClients.size());
       for (
            TAddrMap::iterator iter = mClients.begin();
            iter != mClients.end();
            ++iter
            )
           {
-              const std::shared_ptr<Client> &client = (*iter).second;
-              EndCycle(client);
+              clients.push_back((*iter).second);
+          }
+
+      sort(clients.begin(), clients.end(),
+           [](const std::shared_ptr<Client>& a, const std::shared_ptr<Client>& b)
+           { return a->id < b->id; });
+
+      for (size_t i = 0; i < clients.size(); ++i)
+          {
+              EndCycle(clients[i]);
           }
     }
     else
@@ -259,8 +326,17 @@ void AgentControl::EndCycle(const std::shared_ptr<Client> &client)
         agent->SetSynced(false);
     }
 
-    std::shared_ptr<PredicateList> senseList = agent->QueryPerceptors();
-    mClientSenses[client->id] = parser->Generate(senseList);
+    CycleArena::Scope arena;
+    std::shared_ptr<PredicateList> senseList;
+    {
+        OXYGEN_PROFILE_SCOPE("AgentControl::QueryPerceptors");
+        senseList = agent->QueryPerceptors();
+    }
+
+    {
+        OXYGEN_PROFILE_SCOPE("AgentControl::GenerateSense");
+        mClientSenses[client->id] = parser->Generate(senseList);
+    }
     if (mClientSenses[client->id].empty())
     {
         return;
@@ -272,6 +348,7 @@ void AgentControl::EndCycle(const std::shared_ptr<Client> &client)
 void AgentControl::SetSyncMode(bool syncMode)
 {
     mSyncMode = syncMode;
+    mSyncPending.clear();
     if (mSyncMode)
     {
         BlockOnReadMessages(true);
@@ -291,33 +368,134 @@ void AgentControl::SetMultiThreaded(bool multiThreaded)
     mMultiThreads = multiThreaded;
 }
 
-bool AgentControl::AgentsAreSynced()
+void AgentControl::SetSyncTimeout(long usec)
 {
-    if (mSyncMode)
+    mSyncTimeout = std::max<long>(usec, 0);
+}
+
+void AgentControl::InitSyncBarrier()
+{
+    mSyncPending.clear();
+    mSyncStats = SyncStats();
+
+    CollectSyncPending();
+}
+
+void AgentControl::CollectSyncPending()
+{
+    mSyncConnectCount = mConnectCount;
+
+    if (mGameControlServer.get() == 0)
+    {
+        return;
+    }
+
+    for (
+         TAddrMap::const_iterator iter = mClients.begin();
+         iter != mClients.end();
+         ++iter
+         )
         {
-            set<rcss::net::Addr> closedClients(mCloseClients.begin(),
-                mCloseClients.end());
-
-            for (
-                 TAddrMap::const_iterator iter = mClients.begin();
-                 iter != mClients.end();
-                 ++iter
-                 )
+            const std::shared_ptr<Client>& client = iter->second;
+            std::shared_ptr<AgentAspect> agent =
+                mGameControlServer->GetAgentAspect(client->id);
+            if (!agent || agent->IsSynced())
+            {
+                continue;
+            }
+
+            bool pending = false;
+            for (size_t i = 0; i < mSyncPending.size(); ++i)
+            {
+                if (mSyncPending[i].client == client)
                 {
-                    if (closedClients.find(iter->first) != closedClients.end())
-                        continue;
-
-                    std::shared_ptr<AgentAspect> agent =
-                        mGameControlServer->GetAgentAspect(iter->second->id);
-                    if (agent && !agent->IsSynced())
-                    {
-                        return false;
-                    }
+                    pending = true;
+                    break;
                 }
+            }
+
+            if (!pending)
+            {
+                SyncPending entry = { client, agent->GetSyncCount() };
+                mSyncPending.push_back(entry);
+            }
         }
+}
+
+bool AgentControl::UpdateSyncWait(
+    const std::chrono::steady_clock::time_point& start)
+{
+    if (mSyncPending.empty())
+    {
+        // nothing to wait for, just collect what is already there
+        SetReadTimeout(0);
+        return true;
+    }
+
+    if (mSyncTimeout == 0)
+    {
+        // wait until the next message arrives
+        BlockOnReadMessages(true);
+        return true;
+    }
+
+    long elapsed = std::chrono::duration_cast<std::chrono::microseconds>
+        (std::chrono::steady_clock::now() - start).count();
+
+    if (elapsed >= mSyncTimeout)
+    {
+        return false;
+    }
+
+    SetReadTimeout(mSyncTimeout - elapsed);
     return true;
 }
 
+bool AgentControl::AgentsAreSynced()
+{
+    if (! mSyncMode)
+    {
+        return true;
+    }
+
+    // agents that connected while the barrier waits are waited for
+    // as well
+    if (mConnectCount != mSyncConnectCount)
+    {
+        CollectSyncPending();
+    }
+
+    // only the agents that were not synced in the previous pass need to
+    // be checked again
+    std::vector<SyncPending>::iterator iter = mSyncPending.begin();
+    while (iter != mSyncPending.end())
+        {
+            const std::shared_ptr<Client>& client = (*iter).client;
+            std::shared_ptr<AgentAspect> agent =
+                mGameControlServer->GetAgentAspect(client->id);
+
+            bool closed = std::find(mCloseClients.begin(), mCloseClients.end(),
+                                    client->addr) != mCloseClients.end();
+
+            // a (syn) realized since the barrier was armed counts
+            // even if the agent was reset to unsynced in between
+            if (
+                closed || !agent || agent->IsSynced() ||
+                (agent->GetSyncCount() != (*iter).syncCount)
+                )
+            {
+                mSyncStats.waitClient = client->id;
+                iter = mSyncPending.erase(iter);
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+
+    return mSyncPending.empty();
+}
+
 
 void AgentControl::AgentThread(const std::shared_ptr<Client> &client)
 {
@@ -361,6 +539,7 @@ void AgentControl::AgentThread(const std::shared_ptr<Client> &client)
     {
 
       EndCycle(client);
+      CycleArena::EndCycle();
 
     }
 
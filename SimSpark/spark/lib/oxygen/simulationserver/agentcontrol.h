@@ -20,6 +20,7 @@
 #ifndef OXYGEN_AGENTCONTROL_H
 #define OXYGEN_AGENTCONTROL_H
 
+#include <chrono>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -37,6 +38,20 @@ namespace oxygen
 
 class OXYGEN_API AgentControl : public NetControl
 {
+public:
+    /** statistics of the sync barrier in the last cycle */
+    struct SyncStats
+    {
+        /** the id of the client the barrier waited for last, -1 if none */
+        int waitClient;
+        /** the time spent in the barrier, in seconds */
+        float waitTime;
+        /** true if the barrier gave up before all agents were synced */
+        bool timedOut;
+
+        SyncStats() : waitClient(-1), waitTime(0.0f), timedOut(false) {}
+    };
+
 public:
     AgentControl();
     virtual ~AgentControl();
@@ -63,12 +78,35 @@ public:
     /** sets the AgentControl's sync mode */
     void SetMultiThreaded(bool multiThreaded);
 
+    /** sets the maximum time in microseconds to wait for all agents to
+        sync in a cycle. 0 means wait until every agent has synced.
+    */
+    void SetSyncTimeout(long usec);
+
+    /** returns the sync barrier statistics of the last cycle */
+    const SyncStats& GetSyncStats() const { return mSyncStats; }
+
 protected:
     virtual void OnLink();
 
-    /** returns if the agents are synced with the srever */
+    /** returns if the agents are synced with the srever. Agents that
+        have synced are removed from the list of pending agents.
+    */
     bool AgentsAreSynced();
 
+    /** collects the agents the sync barrier has to wait for in this
+        cycle */
+    void InitSyncBarrier();
+
+    /** adds the connected agents that have not synced yet and are not
+        pending to the list of pending agents */
+    void CollectSyncPending();
+
+    /** sets the read timeout for the next pass of the sync barrier
+        \return false if the sync deadline has passed
+    */
+    bool UpdateSyncWait(const std::chrono::steady_clock::time_point& start);
+
     /** the thread function which does EndCycle for one agent in
      *  multi-threaded mode. */
     void AgentThread(const std::shared_ptr<Client> &client);
@@ -91,6 +129,15 @@ protected:
      */
     void WaitSlave(boost::barrier* &currentBarrier, bool newAgent);
 
+protected:
+    /** an agent the sync barrier waits for */
+    struct SyncPending
+    {
+        std::shared_ptr<Client> client;
+        /** the sync count of the agent when the barrier was armed */
+        unsigned int syncCount;
+    };
+
 protected:
     /** cached reference to the GameControlServer */
     CachedPath<GameControlServer> mGameControlServer;
@@ -108,6 +155,23 @@ protected:
     /** indicates if the AgentControl runs in multi-threads */
     bool mMultiThreads;
 
+    /** the clients the sync barrier still waits for in this cycle */
+    std::vector<SyncPending> mSyncPending;
+
+    /** the number of clients that connected so far */
+    unsigned long mConnectCount;
+
+    /** mConnectCount when the pending list was collected; the list is
+        collected again if agents connect during the barrier */
+    unsigned long mSyncConnectCount;
+
+    /** the maximum time to wait for agents to sync in microseconds,
+        0 means no limit */
+    long mSyncTimeout;
+
+    /** statistics of the sync barrier in the last cycle */
+    SyncStats mSyncStats;
+
     /** barrier object for synchronizing threads in multi-threaded mode */
     boost::barrier *mThreadBarrier;
     boost::barrier *mThreadBarrierNew;
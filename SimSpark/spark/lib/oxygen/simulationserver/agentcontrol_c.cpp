@@ -48,9 +48,35 @@ FUNCTION(AgentControl, setMultiThreaded)
     return true;
 }
 
+FUNCTION(AgentControl, setSyncTimeout)
+{
+    int inUsec;
+
+    if ((in.GetSize() != 1) || (!in.GetValue(in[0], inUsec)))
+    {
+        return false;
+    }
+
+    obj->SetSyncTimeout(inUsec);
+    return true;
+}
+
+FUNCTION(AgentControl, getSyncWaitTime)
+{
+    return obj->GetSyncStats().waitTime;
+}
+
+FUNCTION(AgentControl, getSyncWaitClient)
+{
+    return obj->GetSyncStats().waitClient;
+}
+
 void CLASS(AgentControl)::DefineClass()
 {
     DEFINE_BASECLASS(oxygen/NetControl)
     DEFINE_FUNCTION(setSyncMode)
     DEFINE_FUNCTION(setMultiThreaded)
+    DEFINE_FUNCTION(setSyncTimeout)
+    DEFINE_FUNCTION(getSyncWaitTime)
+    DEFINE_FUNCTION(getSyncWaitClient)
 }
@@ -0,0 +1,770 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2002,2003 Koblenz University
+   Copyright (C) 2004-2009 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#include "commandjournal.h"
+#include "simulationserver.h"
+#include "cyclearena.h"
+#include <salt/random.h>
+#include <zeitgeist/logserver/logserver.h>
+#include <oxygen/agentaspect/agentaspect.h>
+#include <oxygen/gamecontrolserver/gamecontrolserver.h>
+#include <oxygen/monitorserver/monitorserver.h>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+using namespace oxygen;
+using namespace zeitgeist;
+using namespace std;
+
+std::atomic<CommandJournal*> CommandJournal::mRecording(0);
+
+namespace
+{
+    const char JOURNAL_MAGIC[] = "SPKJ";
+    const unsigned char JOURNAL_VERSION = 1;
+
+    /** the size of the record buffer that is handed to the writer
+        thread before the end of the simulation */
+    const size_t FLUSH_SIZE = 64 * 1024;
+
+    void PutNumber(string& out, unsigned long long value)
+    {
+        while (value >= 0x80)
+            {
+                out += (char)((value & 0x7f) | 0x80);
+                value >>= 7;
+            }
+
+        out += (char)value;
+    }
+
+    bool GetNumber(const string& data, size_t& pos, unsigned long long& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+            {
+                if (pos >= data.size())
+                    {
+                        return false;
+                    }
+
+                const unsigned char byte = (unsigned char)data[pos++];
+                value |= (unsigned long long)(byte & 0x7f) << shift;
+
+                if ((byte & 0x80) == 0)
+                    {
+                        return true;
+                    }
+            }
+
+        return false;
+    }
+
+    bool GetString(const string& data, size_t& pos, size_t& offset,
+                   size_t& size)
+    {
+        unsigned long long length;
+        if (
+            (! GetNumber(data, pos, length)) ||
+            (length > data.size() - pos)
+            )
+            {
+                return false;
+            }
+
+        offset = pos;
+        size = length;
+        pos += length;
+        return true;
+    }
+}
+
+CommandJournal::CommandJournal() : SimControlNode(), mMode(JM_NONE),
+    mMarkCycle(-1), mMarkLate(false), mCycle(0), mActed(false),
+    mLastTime(0), mStopWriter(false), mFile(0), mNextEvent(0),
+    mEndCycle(0), mAgentStep(0), mAgentTime(0), mSenseLog(0)
+{
+    // take part in every cycle
+    mStep = 0;
+}
+
+CommandJournal::~CommandJournal()
+{
+    StopRecording();
+
+    if (mSenseLog != 0)
+        {
+            fclose(mSenseLog);
+        }
+}
+
+void CommandJournal::OnUnlink()
+{
+    StopRecording();
+    SimControlNode::OnUnlink();
+}
+
+bool CommandJournal::Record(const std::string& fileName)
+{
+    if (mMode != JM_NONE)
+        {
+            GetLog()->Error()
+                << "(CommandJournal) ERROR: journal is already in use\n";
+            return false;
+        }
+
+    CommandJournal* expected = 0;
+    if (! mRecording.compare_exchange_strong(expected, this))
+        {
+            GetLog()->Error()
+                << "(CommandJournal) ERROR: another journal is recording\n";
+            return false;
+        }
+
+    mFile = fopen(fileName.c_str(), "wb");
+    if (mFile == 0)
+        {
+            GetLog()->Error()
+                << "(CommandJournal) ERROR: can't create journal '"
+                << fileName << "'\n";
+            mRecording.store(0, std::memory_order_release);
+            return false;
+        }
+
+    mBuffer.assign(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC) - 1);
+    mBuffer += (char)JOURNAL_VERSION;
+
+    mStopWriter = false;
+    mWriter = std::thread(&CommandJournal::WriteJournal, this);
+    mMode = JM_RECORD;
+
+    GetLog()->Normal()
+        << "(CommandJournal) recording journal '" << fileName << "'\n";
+    return true;
+}
+
+bool CommandJournal::Replay(const std::string& fileName)
+{
+    if (mMode != JM_NONE)
+        {
+            GetLog()->Error()
+                << "(CommandJournal) ERROR: journal is already in use\n";
+            return false;
+        }
+
+    ifstream file(fileName.c_str(), ios::in | ios::binary);
+    if (! file)
+        {
+            GetLog()->Error()
+                << "(CommandJournal) ERROR: can't open journal '"
+                << fileName << "'\n";
+            return false;
+        }
+
+    ostringstream data;
+    data << file.rdbuf();
+    mData = data.str();
+
+    if (! ParseJournal())
+        {
+            GetLog()->Error()
+                << "(CommandJournal) ERROR: '" << fileName
+                << "' is not a valid journal\n";
+            mData.clear();
+            mEvents.clear();
+            return false;
+        }
+
+    mMode = JM_REPLAY;
+
+    GetLog()->Normal()
+        << "(CommandJournal) replaying journal '" << fileName << "', "
+        << mEndCycle << " cycles, " << mEvents.size() << " events\n";
+    return true;
+}
+
+bool CommandJournal::SetSenseLog(const std::string& fileName)
+{
+    if (mSenseLog != 0)
+        {
+            fclose(mSenseLog);
+        }
+
+    mSenseLog = fopen(fileName.c_str(), "w");
+    if (mSenseLog == 0)
+        {
+            GetLog()->Error()
+                << "(CommandJournal) ERROR: can't create sense log '"
+                << fileName << "'\n";
+            return false;
+        }
+
+    return true;
+}
+
+bool CommandJournal::ParseJournal()
+{
+    const size_t headerSize = sizeof(JOURNAL_MAGIC);
+    if (
+        (mData.size() < headerSize) ||
+        (mData.compare(0, headerSize - 1, JOURNAL_MAGIC) != 0) ||
+        ((unsigned char)mData[headerSize - 1] != JOURNAL_VERSION)
+        )
+        {
+            return false;
+        }
+
+    size_t pos = headerSize;
+    Event event;
+    event.cycle = 0;
+    event.late = false;
+
+    mEvents.clear();
+    mSteps.clear();
+    mConfig.clear();
+    mEndCycle = 0;
+
+    while (pos < mData.size())
+        {
+            event.type = (unsigned char)mData[pos++];
+            event.id = -1;
+            event.offset = 0;
+            event.size = 0;
+
+            unsigned long long value = 0;
+            unsigned long long steps = 0;
+            size_t offset = 0;
+            size_t size = 0;
+            bool ok = true;
+
+            switch (event.type)
+                {
+                case RT_CONFIG:
+                    {
+                        ok = GetString(mData, pos, offset, size);
+                        if (! ok)
+                            {
+                                break;
+                            }
+
+                        istringstream lines(mData.substr(offset, size));
+                        string key;
+                        string setting;
+                        while (lines >> key >> setting)
+                            {
+                                mConfig[key] = setting;
+                            }
+                        break;
+                    }
+
+                case RT_RANDOM:
+                    ok = GetString(mData, pos, offset, size);
+                    if (! ok)
+                        {
+                            break;
+                        }
+
+                    mRandomState = mData.substr(offset, size);
+                    break;
+
+                case RT_CYCLE:
+                    ok = GetNumber(mData, pos, value);
+                    event.cycle = (int)(value >> 1);
+                    event.late = ((value & 1) != 0);
+                    mEndCycle = max(mEndCycle, event.cycle);
+                    break;
+
+                case RT_CONNECT:
+                case RT_DISCONNECT:
+                    ok = GetNumber(mData, pos, value);
+                    event.id = (int)value;
+                    mEvents.push_back(event);
+                    break;
+
+                case RT_AGENT:
+                    ok = GetNumber(mData, pos, value) &&
+                        GetString(mData, pos, event.offset, event.size);
+                    event.id = (int)value;
+                    mEvents.push_back(event);
+                    break;
+
+                case RT_MONITOR:
+                    ok = GetString(mData, pos, event.offset, event.size);
+                    mEvents.push_back(event);
+                    break;
+
+                case RT_STEPS:
+                    ok = GetNumber(mData, pos, value) &&
+                        GetNumber(mData, pos, steps);
+                    mSteps[(int)value] = (int)steps;
+                    break;
+
+                case RT_END:
+                    ok = GetNumber(mData, pos, value);
+                    mEndCycle = max(mEndCycle, (int)value);
+                    break;
+
+                default:
+                    ok = false;
+                    break;
+                }
+
+            if (! ok)
+                {
+                    return false;
+                }
+        }
+
+    return true;
+}
+
+void CommandJournal::InitSimulation()
+{
+    mSimulationServer = GetSimulationServer();
+    if (mSimulationServer.get() == 0)
+        {
+            GetLog()->Error()
+                << "(CommandJournal) ERROR: SimulationServer not found\n";
+            return;
+        }
+
+    mGameControlServer = mSimulationServer->GetGameControlServer();
+    mMonitorServer = mSimulationServer->GetMonitorServer();
+    mLastTime = mSimulationServer->GetTime();
+
+    if (mMode == JM_RECORD)
+        {
+            // the AgentControl may query the perceptors less often
+            // than the simulation steps
+            float agentStep = mSimulationServer->GetSimStep();
+            std::shared_ptr<SimControlNode> agentControl =
+                mSimulationServer->GetControlNode("AgentControl");
+            if (agentControl.get() != 0)
+                {
+                    agentStep = agentControl->GetStep();
+                }
+
+            ostringstream config;
+            config.precision(9);
+            config << "simStep " << mSimulationServer->GetSimStep() << "\n"
+                   << "agentStep " << agentStep << "\n";
+
+            ostringstream random;
+            random << static_cast<std::mt19937&>(salt::RandomEngine::instance());
+
+            lock_guard<mutex> lock(mMutex);
+
+            mBuffer += (char)RT_CONFIG;
+            PutNumber(mBuffer, config.str().size());
+            mBuffer += config.str();
+
+            mBuffer += (char)RT_RANDOM;
+            PutNumber(mBuffer, random.str().size());
+            mBuffer += random.str();
+        }
+    else if (mMode == JM_REPLAY)
+        {
+            if (mConfig.find("simStep") != mConfig.end())
+                {
+                    mSimulationServer->SetSimStep
+                        ((float)atof(mConfig["simStep"].c_str()));
+                }
+
+            mAgentStep = mSimulationServer->GetSimStep();
+            if (mConfig.find("agentStep") != mConfig.end())
+                {
+                    mAgentStep = (float)atof(mConfig["agentStep"].c_str());
+                }
+
+            if (! mRandomState.empty())
+                {
+                    istringstream random(mRandomState);
+                    random >> static_cast<std::mt19937&>(salt::RandomEngine::instance());
+                }
+
+            mNextEvent = 0;
+            mAgents.clear();
+            mAgentTime = 0;
+        }
+}
+
+void CommandJournal::DoneSimulation()
+{
+    if (mMode == JM_RECORD)
+        {
+            {
+                lock_guard<mutex> lock(mMutex);
+                mBuffer += (char)RT_END;
+                PutNumber(mBuffer, mSimulationServer.get() != 0 ?
+                          mSimulationServer->GetCycle() : 0);
+            }
+
+            StopRecording();
+        }
+    else if (mMode == JM_REPLAY)
+        {
+            if (mNextEvent < mEvents.size())
+                {
+                    GetLog()->Warning()
+                        << "(CommandJournal) replay stopped with "
+                        << (mEvents.size() - mNextEvent)
+                        << " events left\n";
+                }
+
+            if (mSenseLog != 0)
+                {
+                    fclose(mSenseLog);
+                    mSenseLog = 0;
+                }
+        }
+
+    mSimulationServer.reset();
+    mGameControlServer.reset();
+    mMonitorServer.reset();
+}
+
+void CommandJournal::StartCycle()
+{
+    if (mSimulationServer.get() == 0)
+        {
+            return;
+        }
+
+    if (mMode == JM_RECORD)
+        {
+            lock_guard<mutex> lock(mMutex);
+            mCycle = mSimulationServer->GetCycle();
+            mActed = false;
+        }
+    else if (mMode == JM_REPLAY)
+        {
+            // take the recorded number of physics steps
+            const int cycle = mSimulationServer->GetCycle();
+            map<int, int>::const_iterator steps = mSteps.find(cycle);
+            const float simStep = mSimulationServer->GetSimStep();
+            const float time =
+                ((steps != mSteps.end()) ? steps->second : 1) * simStep;
+
+            mSimulationServer->AdvanceTime
+                (time - mSimulationServer->GetSumDeltaTime());
+
+            ReplayEvents(false);
+        }
+}
+
+void CommandJournal::ActAgent()
+{
+    if (mSimulationServer.get() == 0)
+        {
+            return;
+        }
+
+    if (mMode == JM_RECORD)
+        {
+            // everything recorded from now on in this cycle happens
+            // after the physics step
+            lock_guard<mutex> lock(mMutex);
+            mActed = true;
+        }
+    else if (mMode == JM_REPLAY)
+        {
+            // see SimulationServer::IsControlNodeActive()
+            const float now = mSimulationServer->GetTime();
+            if (mAgentTime - now <= 0.005f)
+                {
+                    mAgentTime = now + mAgentStep;
+                }
+        }
+}
+
+void CommandJournal::EndCycle()
+{
+    if (mSimulationServer.get() == 0)
+        {
+            return;
+        }
+
+    if (mMode == JM_RECORD)
+        {
+            const int cycle = mSimulationServer->GetCycle();
+            const float now = mSimulationServer->GetTime();
+            const int steps = (int)floor
+                ((now - mLastTime) / mSimulationServer->GetSimStep() + 0.5f);
+            mLastTime = now;
+
+            if (steps != 1)
+                {
+                    lock_guard<mutex> lock(mMutex);
+                    mBuffer += (char)RT_STEPS;
+                    PutNumber(mBuffer, cycle);
+                    PutNumber(mBuffer, steps);
+                }
+
+            FlushBuffer(false);
+        }
+    else if (mMode == JM_REPLAY)
+        {
+            ReplayEvents(true);
+
+            if (mAgentTime - mSimulationServer->GetTime() <= 0.005f)
+                {
+                    ReplaySenses();
+                }
+
+            if (mSimulationServer->GetCycle() >= mEndCycle)
+                {
+                    GetLog()->Normal()
+                        << "(CommandJournal) replayed " << mEndCycle
+                        << " cycles\n";
+                    SimulationServer::Quit();
+                }
+        }
+}
+
+void CommandJournal::MarkCycle()
+{
+    const int cycle = (mSimulationServer.get() != 0) ?
+        mSimulationServer->GetCycle() : 0;
+
+    // input from before the journal's StartCycle belongs to the new
+    // cycle as well
+    const bool late = (cycle == mCycle) && mActed;
+
+    if (cycle == mMarkCycle && late == mMarkLate)
+        {
+            return;
+        }
+
+    mMarkCycle = cycle;
+    mMarkLate = late;
+
+    mBuffer += (char)RT_CYCLE;
+    PutNumber(mBuffer, ((unsigned long long)cycle << 1) | (late ? 1 : 0));
+}
+
+void CommandJournal::RecordConnect(int id)
+{
+    lock_guard<mutex> lock(mMutex);
+    MarkCycle();
+    mBuffer += (char)RT_CONNECT;
+    PutNumber(mBuffer, id);
+}
+
+void CommandJournal::RecordDisconnect(int id)
+{
+    lock_guard<mutex> lock(mMutex);
+    MarkCycle();
+    mBuffer += (char)RT_DISCONNECT;
+    PutNumber(mBuffer, id);
+}
+
+void CommandJournal::RecordAgentMessage(int id, const std::string& message)
+{
+    lock_guard<mutex> lock(mMutex);
+    MarkCycle();
+    mBuffer += (char)RT_AGENT;
+    PutNumber(mBuffer, id);
+    PutNumber(mBuffer, message.size());
+    mBuffer += message;
+}
+
+void CommandJournal::RecordMonitorMessage(const std::string& message)
+{
+    lock_guard<mutex> lock(mMutex);
+    MarkCycle();
+    mBuffer += (char)RT_MONITOR;
+    PutNumber(mBuffer, message.size());
+    mBuffer += message;
+}
+
+void CommandJournal::FlushBuffer(bool force)
+{
+    lock_guard<mutex> lock(mMutex);
+
+    if (
+        (mBuffer.empty()) ||
+        (! force && mBuffer.size() < FLUSH_SIZE)
+        )
+        {
+            return;
+        }
+
+    mWriteQueue.push_back(string());
+    mWriteQueue.back().swap(mBuffer);
+    mBuffer.reserve(FLUSH_SIZE * 2);
+    mWriteCondition.notify_one();
+}
+
+void CommandJournal::StopRecording()
+{
+    if (mMode != JM_RECORD)
+        {
+            return;
+        }
+
+    FlushBuffer(true);
+
+    {
+        lock_guard<mutex> lock(mMutex);
+        mStopWriter = true;
+        mWriteCondition.notify_one();
+    }
+
+    if (mWriter.joinable())
+        {
+            mWriter.join();
+        }
+
+    if (mFile != 0)
+        {
+            fclose(mFile);
+            mFile = 0;
+        }
+
+    CommandJournal* self = this;
+    mRecording.compare_exchange_strong(self, 0);
+    mMode = JM_NONE;
+}
+
+void CommandJournal::WriteJournal()
+{
+    unique_lock<mutex> lock(mMutex);
+
+    for (;;)
+        {
+            mWriteCondition.wait
+                (lock, [this] { return mStopWriter || ! mWriteQueue.empty(); });
+
+            if (mWriteQueue.empty())
+                {
+                    break;
+                }
+
+            string chunk;
+            chunk.swap(mWriteQueue.front());
+            mWriteQueue.pop_front();
+
+            lock.unlock();
+            if (fwrite(chunk.data(), 1, chunk.size(), mFile) != chunk.size())
+                {
+                    GetLog()->Error()
+                        << "(CommandJournal) ERROR: writing the journal failed\n";
+                }
+            lock.lock();
+        }
+
+    fflush(mFile);
+}
+
+void CommandJournal::ReplayEvents(bool late)
+{
+    if (mGameControlServer.get() == 0)
+        {
+            return;
+        }
+
+    const int cycle = mSimulationServer->GetCycle();
+
+    while (mNextEvent < mEvents.size())
+        {
+            const Event& event = mEvents[mNextEvent];
+            if (
+                (event.cycle > cycle) ||
+                (event.cycle == cycle && event.late && ! late)
+                )
+                {
+                    break;
+                }
+
+            ++mNextEvent;
+
+            switch (event.type)
+                {
+                case RT_CONNECT:
+                    mGameControlServer->AgentConnect(event.id);
+                    mAgents.insert(event.id);
+                    break;
+
+                case RT_DISCONNECT:
+                    mGameControlServer->pushDisappearedAgent(event.id);
+                    mAgents.erase(event.id);
+                    break;
+
+                case RT_AGENT:
+                    {
+                        std::shared_ptr<AgentAspect> agent =
+                            mGameControlServer->GetAgentAspect(event.id);
+                        if (agent.get() == 0)
+                            {
+                                break;
+                            }
+
+                        CycleArena::Scope arena;
+                        agent->RealizeActions
+                            (mGameControlServer->Parse
+                             (event.id, mData.substr(event.offset, event.size)));
+                        break;
+                    }
+
+                case RT_MONITOR:
+                    if (mMonitorServer.get() != 0)
+                        {
+                            mMonitorServer->ParseMonitorMessage
+                                (mData.substr(event.offset, event.size));
+                        }
+                    break;
+                }
+        }
+}
+
+void CommandJournal::ReplaySenses()
+{
+    std::shared_ptr<BaseParser> parser = mGameControlServer->GetParser();
+    if (parser.get() == 0)
+        {
+            return;
+        }
+
+    const int cycle = mSimulationServer->GetCycle();
+
+    for (
+         set<int>::const_iterator iter = mAgents.begin();
+         iter != mAgents.end();
+         ++iter
+         )
+        {
+            std::shared_ptr<AgentAspect> agent =
+                mGameControlServer->GetAgentAspect(*iter);
+            if (agent.get() == 0)
+                {
+                    continue;
+                }
+
+            CycleArena::Scope arena;
+            std::shared_ptr<PredicateList> senseList = agent->QueryPerceptors();
+
+            if (mSenseLog != 0)
+                {
+                    const string sense = parser->Generate(senseList);
+                    fprintf(mSenseLog, "%d %d %s\n", cycle, *iter, sense.c_str());
+                }
+        }
+}
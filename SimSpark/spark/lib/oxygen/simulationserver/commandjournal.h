@@ -0,0 +1,253 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2002,2003 Koblenz University
+   Copyright (C) 2004-2009 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#ifndef OXYGEN_COMMANDJOURNAL_H
+#define OXYGEN_COMMANDJOURNAL_H
+
+#include "simcontrolnode.h"
+#include <oxygen/oxygen_defines.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace oxygen
+{
+class GameControlServer;
+class MonitorServer;
+
+/** \class CommandJournal is a SimControlNode that records the input of
+    the simulation, i.e. the connects and disconnects of agents, every
+    message an agent sent, every monitor (trainer) message, the
+    simulation step and the state of the salt::RandomEngine. In
+    contrast to the MonitorLogger, which records the resulting scene,
+    the journal is small and can be replayed with different settings.
+
+    While recording, the AgentControl and the MonitorServer pass their
+    input to the journal returned by GetRecording(). The records are
+    collected per cycle and written by a background thread, so the
+    runloop never waits for the disk.
+
+    A replay feeds the recorded input into the GameControlServer and
+    the MonitorServer at the same point of the same cycle, without
+    network, and queries the perceptors of the agents like the
+    AgentControl did, so that random numbers are drawn in the same
+    order. Together with the turbo mode of the SimulationServer the
+    replay runs as fast as the physics allows and quits after the last
+    recorded cycle; a MonitorLogger regenerates the monitor log.
+
+    A replay is only identical to the recording if the recording ran
+    single threaded, as the perceptors of the agent threads draw random
+    numbers in no defined order.
+
+    The journal consists of the magic "SPKJ", a version byte and a
+    sequence of records, each a type byte followed by unsigned LEB128
+    numbers and raw message bytes; see ERecordType.
+*/
+class OXYGEN_API CommandJournal : public SimControlNode
+{
+public:
+    enum EMode
+    {
+        JM_NONE,
+        JM_RECORD,
+        JM_REPLAY
+    };
+
+    enum ERecordType
+    {
+        /** length, "key value" lines: the simulation settings */
+        RT_CONFIG = 1,
+
+        /** length, the text state of the salt::RandomEngine */
+        RT_RANDOM = 2,
+
+        /** (cycle << 1) | late: the following records happened in
+            this cycle, before (0) or after (1) the physics step */
+        RT_CYCLE = 3,
+
+        /** client id */
+        RT_CONNECT = 4,
+
+        /** client id */
+        RT_DISCONNECT = 5,
+
+        /** client id, length, the message of an agent */
+        RT_AGENT = 6,
+
+        /** length, a monitor message */
+        RT_MONITOR = 7,
+
+        /** cycle, the number of physics steps of a cycle that did not
+            take exactly one step */
+        RT_STEPS = 8,
+
+        /** cycle: the last recorded cycle */
+        RT_END = 9
+    };
+
+public:
+    CommandJournal();
+    virtual ~CommandJournal();
+
+    /** returns the journal that is currently recording, or 0 */
+    static CommandJournal* GetRecording()
+    { return mRecording.load(std::memory_order_acquire); }
+
+    /** creates the journal file and records into it from the start of
+        the simulation on */
+    bool Record(const std::string& fileName);
+
+    /** reads a journal to be replayed from the start of the
+        simulation on */
+    bool Replay(const std::string& fileName);
+
+    /** writes the sense messages generated during a replay to the
+        given file, one "cycle id message" line each */
+    bool SetSenseLog(const std::string& fileName);
+
+    /** returns the current mode */
+    EMode GetMode() const { return mMode; }
+
+    /** returns the last cycle of the replayed journal */
+    int GetReplayCycles() const { return mEndCycle; }
+
+    /** records that the agent with the given client id connected */
+    void RecordConnect(int id);
+
+    /** records that the agent with the given client id disconnected */
+    void RecordDisconnect(int id);
+
+    /** records a message received from an agent */
+    void RecordAgentMessage(int id, const std::string& message);
+
+    /** records a message received from a monitor */
+    void RecordMonitorMessage(const std::string& message);
+
+    virtual void InitSimulation();
+    virtual void DoneSimulation();
+    virtual void StartCycle();
+    virtual void ActAgent();
+    virtual void EndCycle();
+
+protected:
+    /** a recorded input, the message refers to mData */
+    struct Event
+    {
+        int cycle;
+        bool late;
+        unsigned char type;
+        int id;
+        size_t offset;
+        size_t size;
+    };
+
+protected:
+    virtual void OnUnlink();
+
+    /** appends a cycle record to mBuffer if the input of the current
+        phase is not yet preceded by one; mMutex must be locked */
+    void MarkCycle();
+
+    /** passes the recorded records to the writer thread */
+    void FlushBuffer(bool force);
+
+    /** stops the writer thread and closes the journal */
+    void StopRecording();
+
+    /** the writer thread function */
+    void WriteJournal();
+
+    /** parses mData into the config and the events */
+    bool ParseJournal();
+
+    /** replays the events of the current cycle and phase */
+    void ReplayEvents(bool late);
+
+    /** queries the perceptors of the replayed agents in the order of
+        their ids, like the single threaded AgentControl */
+    void ReplaySenses();
+
+protected:
+    /** the recording journal, see GetRecording() */
+    static std::atomic<CommandJournal*> mRecording;
+
+    EMode mMode;
+
+    /** cached references */
+    std::shared_ptr<SimulationServer> mSimulationServer;
+    std::shared_ptr<GameControlServer> mGameControlServer;
+    std::shared_ptr<MonitorServer> mMonitorServer;
+
+    /** the cycle and phase of the last cycle record and whether the
+        journal's own ActAgent() already ran in the current cycle,
+        i.e. whether the physics step is done */
+    int mMarkCycle;
+    bool mMarkLate;
+    int mCycle;
+    bool mActed;
+
+    /** the simulation time at the end of the last cycle */
+    float mLastTime;
+
+    /** guards mBuffer and mWriteQueue */
+    std::mutex mMutex;
+    std::condition_variable mWriteCondition;
+
+    /** the records of the current cycle(s) */
+    std::string mBuffer;
+
+    /** the buffers waiting to be written */
+    std::deque<std::string> mWriteQueue;
+    bool mStopWriter;
+    std::thread mWriter;
+    FILE* mFile;
+
+    /** the replayed journal */
+    std::string mData;
+    std::map<std::string, std::string> mConfig;
+    std::string mRandomState;
+    std::vector<Event> mEvents;
+    std::map<int, int> mSteps;
+    size_t mNextEvent;
+    int mEndCycle;
+
+    /** the client ids of the replayed agents */
+    std::set<int> mAgents;
+
+    /** emulates the schedule of the recorded AgentControl */
+    float mAgentStep;
+    float mAgentTime;
+
+    /** the optional output of a replay */
+    FILE* mSenseLog;
+};
+
+DECLARE_CLASS(CommandJournal)
+
+} // namespace oxygen
+
+#endif // OXYGEN_COMMANDJOURNAL_H
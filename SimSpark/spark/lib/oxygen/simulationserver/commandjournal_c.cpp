@@ -0,0 +1,83 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2002,2003 Koblenz University
+   Copyright (C) 2004-2009 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#include "commandjournal.h"
+
+using namespace oxygen;
+using namespace std;
+
+FUNCTION(CommandJournal,record)
+{
+    string inFileName;
+
+    if (
+        (in.GetSize() != 1) ||
+        (! in.GetValue(in.begin(), inFileName))
+        )
+        {
+            return false;
+        }
+
+    return obj->Record(inFileName);
+}
+
+FUNCTION(CommandJournal,replay)
+{
+    string inFileName;
+
+    if (
+        (in.GetSize() != 1) ||
+        (! in.GetValue(in.begin(), inFileName))
+        )
+        {
+            return false;
+        }
+
+    return obj->Replay(inFileName);
+}
+
+FUNCTION(CommandJournal,setSenseLog)
+{
+    string inFileName;
+
+    if (
+        (in.GetSize() != 1) ||
+        (! in.GetValue(in.begin(), inFileName))
+        )
+        {
+            return false;
+        }
+
+    return obj->SetSenseLog(inFileName);
+}
+
+FUNCTION(CommandJournal,getReplayCycles)
+{
+    return obj->GetReplayCycles();
+}
+
+void CLASS(CommandJournal)::DefineClass()
+{
+    DEFINE_BASECLASS(oxygen/SimControlNode)
+    DEFINE_FUNCTION(record)
+    DEFINE_FUNCTION(replay)
+    DEFINE_FUNCTION(setSenseLog)
+    DEFINE_FUNCTION(getReplayCycles)
+}
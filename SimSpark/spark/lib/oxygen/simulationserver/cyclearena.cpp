@@ -0,0 +1,211 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2002,2003 Koblenz University
+   Copyright (C) 2004-2009 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#include "cyclearena.h"
+#include <sstream>
+
+using namespace oxygen;
+using namespace std;
+
+namespace
+{
+    std::atomic<bool> gEnabled(false);
+
+    /** statistics of all arenas */
+    std::atomic<unsigned long long> gAllocations(0);
+    std::atomic<unsigned long long> gHeapAllocations(0);
+    std::atomic<unsigned long long> gResets(0);
+    std::atomic<unsigned long long> gSkippedResets(0);
+    std::atomic<unsigned long long> gGrowths(0);
+
+    /** the arena of the calling thread while a Scope is active */
+    thread_local CycleArena* tActive = 0;
+
+    /** the heap behind the monotonic buffers; counts its allocations */
+    class HeapResource : public std::pmr::memory_resource
+    {
+    protected:
+        virtual void* do_allocate(std::size_t bytes, std::size_t alignment)
+        {
+            gHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        virtual void do_deallocate(void* p, std::size_t bytes,
+                                   std::size_t alignment)
+        {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        virtual bool do_is_equal(const std::pmr::memory_resource& other)
+            const noexcept
+        {
+            return (this == &other);
+        }
+    };
+
+    HeapResource gHeap;
+}
+
+CycleArena::Scope::Scope() : mPrevious(tActive)
+{
+    if (! gEnabled.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+    CycleArena& arena = GetThreadArena();
+    if (arena.mUsed < MAX_CAPACITY)
+        {
+            tActive = &arena;
+        }
+}
+
+CycleArena::Scope::~Scope()
+{
+    tActive = mPrevious;
+}
+
+CycleArena::CycleArena()
+    : mCapacity(INITIAL_CAPACITY), mLive(0), mUsed(0)
+{
+    mBuffer.reset(new char[mCapacity]);
+    mMonotonic.reset(new std::pmr::monotonic_buffer_resource
+                     (mBuffer.get(), mCapacity, &gHeap));
+}
+
+CycleArena::~CycleArena()
+{
+    if (mLive.load() != 0)
+        {
+            // something still points into the arena at thread exit;
+            // leak the memory rather than freeing it under its feet
+            mBuffer.release();
+            mMonotonic.release();
+        }
+}
+
+std::pmr::memory_resource* CycleArena::GetResource()
+{
+    if (tActive != 0)
+        {
+            return tActive;
+        }
+
+    return std::pmr::get_default_resource();
+}
+
+void CycleArena::SetEnabled(bool enabled)
+{
+    gEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool CycleArena::IsEnabled()
+{
+    return gEnabled.load(std::memory_order_relaxed);
+}
+
+CycleArena& CycleArena::GetThreadArena()
+{
+    thread_local CycleArena arena;
+    return arena;
+}
+
+void CycleArena::EndCycle()
+{
+    if (tActive != 0)
+        {
+            // never rewind below an active scope
+            return;
+        }
+
+    CycleArena& arena = GetThreadArena();
+    if (arena.mUsed > 0)
+        {
+            arena.Reset();
+        }
+}
+
+void CycleArena::Reset()
+{
+    if (mLive.load(std::memory_order_acquire) != 0)
+        {
+            gSkippedResets.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+    gResets.fetch_add(1, std::memory_order_relaxed);
+
+    if (mUsed <= mCapacity || mUsed >= MAX_CAPACITY)
+        {
+            mMonotonic->release();
+            mUsed = 0;
+            return;
+        }
+
+    // the cycle overflowed into heap blocks; allocate a buffer that
+    // holds the high-water mark, so the next cycles don't
+    std::size_t capacity = mCapacity;
+    while (capacity < mUsed)
+        {
+            capacity *= 2;
+        }
+
+    mMonotonic.reset();
+    mBuffer.reset(new char[capacity]);
+    mCapacity = capacity;
+    mMonotonic.reset(new std::pmr::monotonic_buffer_resource
+                     (mBuffer.get(), mCapacity, &gHeap));
+    mUsed = 0;
+    gGrowths.fetch_add(1, std::memory_order_relaxed);
+}
+
+void* CycleArena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    mLive.fetch_add(1, std::memory_order_relaxed);
+    mUsed += bytes + alignment;
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    return mMonotonic->allocate(bytes, alignment);
+}
+
+void CycleArena::do_deallocate(void* /*p*/, std::size_t /*bytes*/,
+                               std::size_t /*alignment*/)
+{
+    mLive.fetch_sub(1, std::memory_order_release);
+}
+
+bool CycleArena::do_is_equal(const std::pmr::memory_resource& other)
+    const noexcept
+{
+    return (this == &other);
+}
+
+std::string CycleArena::GetReport()
+{
+    std::ostringstream ss;
+    ss << "cycle arena " << (IsEnabled() ? "enabled" : "disabled")
+       << ": " << gAllocations.load() << " allocations, "
+       << gHeapAllocations.load() << " heap blocks, "
+       << gResets.load() << " resets, "
+       << gSkippedResets.load() << " skipped resets, "
+       << gGrowths.load() << " buffer growths\n";
+
+    return ss.str();
+}
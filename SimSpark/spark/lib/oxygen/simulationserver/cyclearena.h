@@ -0,0 +1,145 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2002,2003 Koblenz University
+   Copyright (C) 2004-2009 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#ifndef OXYGEN_CYCLEARENA_H
+#define OXYGEN_CYCLEARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <oxygen/oxygen_defines.h>
+
+namespace oxygen
+{
+
+/** \class CycleArena is a per thread memory resource for data that
+    lives no longer than one simulation cycle, e.g. the PredicateLists
+    that are parsed from agent messages or collected from the
+    perceptors.
+
+    Allocations are served from a monotonic buffer, i.e. by bumping a
+    pointer, and deallocation is a no-op. At the end of each cycle the
+    owning thread calls EndCycle(), which rewinds the buffer. If the
+    buffer overflowed during the cycle, it is replaced by one large
+    enough for the high-water mark, so that in steady state no cycle
+    calls malloc for arena data.
+
+    The arena counts its outstanding allocations and only rewinds if
+    all of them were released; data that accidentally outlives the
+    cycle therefore delays the reset instead of being overwritten.
+    Arena data must not be handed to another thread.
+
+    Code opts in with a Scope; while a Scope is active on a thread,
+    GetResource() returns the arena of the thread, otherwise the
+    default memory resource.
+ */
+class OXYGEN_API CycleArena : public std::pmr::memory_resource
+{
+public:
+    enum
+    {
+        /** the size of the initial buffer of each thread */
+        INITIAL_CAPACITY = 64 * 1024,
+
+        /** the arena stops serving new scopes if a cycle uses more */
+        MAX_CAPACITY = 16 * 1024 * 1024
+    };
+
+    /** \class Scope routes the allocations of the enclosing block on
+        the calling thread to the arena of the thread
+     */
+    class OXYGEN_API Scope
+    {
+    public:
+        Scope();
+        ~Scope();
+
+    private:
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+
+    protected:
+        CycleArena* mPrevious;
+    };
+
+public:
+    CycleArena();
+    virtual ~CycleArena();
+
+    /** returns the arena of the calling thread if a Scope is active,
+        the default memory resource otherwise
+    */
+    static std::pmr::memory_resource* GetResource();
+
+    /** enables or disables the arenas of all threads; while disabled
+        Scopes are ignored
+    */
+    static void SetEnabled(bool enabled);
+
+    /** returns true if the arenas are enabled */
+    static bool IsEnabled();
+
+    /** rewinds the arena of the calling thread; called by each thread
+        that runs agent or monitor code at the end of a cycle
+    */
+    static void EndCycle();
+
+    /** returns the number of allocations served by the arenas and the
+        number of allocations the arenas made from the heap
+    */
+    static std::string GetReport();
+
+protected:
+    /** returns the arena of the calling thread */
+    static CycleArena& GetThreadArena();
+
+    /** rewinds the buffer, growing it to the high-water mark */
+    void Reset();
+
+    virtual void* do_allocate(std::size_t bytes, std::size_t alignment);
+    virtual void do_deallocate(void* p, std::size_t bytes,
+                               std::size_t alignment);
+    virtual bool do_is_equal(const std::pmr::memory_resource& other)
+        const noexcept;
+
+protected:
+    /** the buffer allocations are served from first */
+    std::unique_ptr<char[]> mBuffer;
+
+    /** the size of mBuffer */
+    std::size_t mCapacity;
+
+    /** bumps through mBuffer, then through heap blocks */
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> mMonotonic;
+
+    /** the number of allocations not released yet; atomic as an
+        allocation might be released on another thread
+    */
+    std::atomic<long> mLive;
+
+    /** the number of bytes allocated since the last reset */
+    std::size_t mUsed;
+};
+
+} // namespace oxygen
+
+#endif // OXYGEN_CYCLEARENA_H
@@ -0,0 +1,518 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2002,2003 Koblenz University
+   Copyright (C) 2004-2009 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#include "cycleprofiler.h"
+#include <zeitgeist/logserver/logserver.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+using namespace oxygen;
+using namespace zeitgeist;
+using namespace std;
+
+std::atomic<CycleProfiler*> CycleProfiler::mActive(0);
+
+namespace
+{
+    // the section names, shared by all profiler instances
+    std::mutex& GetSectionMutex()
+    {
+        static std::mutex sectionMutex;
+        return sectionMutex;
+    }
+
+    vector<string>& GetSectionNames()
+    {
+        static vector<string> sectionNames;
+        return sectionNames;
+    }
+
+    map<string, int>& GetSectionIds()
+    {
+        static map<string, int> sectionIds;
+        return sectionIds;
+    }
+
+    // the serial number of the next profiler instance
+    std::atomic<int> nextSerial(1);
+
+    // the counters of the calling thread, cached for the profiler with
+    // the given serial number
+    thread_local int cachedSerial = 0;
+    thread_local void* cachedData = 0;
+
+    // increments a counter that only the calling thread writes
+    template <typename T>
+    inline void Increase(std::atomic<T>& counter, T value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value,
+                      std::memory_order_relaxed);
+    }
+
+    void EscapeJson(ostream& out, const string& str)
+    {
+        for (string::const_iterator iter = str.begin();
+             iter != str.end();
+             ++iter)
+            {
+                if ((*iter) == '"' || (*iter) == '\\')
+                    {
+                        out << '\\';
+                    }
+                out << (*iter);
+            }
+    }
+}
+
+CycleProfiler::CycleProfiler() : Leaf(),
+    mSerial(nextSerial.fetch_add(1)),
+    mEnabled(false),
+    mWindow(0),
+    mWindowCycles(250),
+    mCycleInWindow(0),
+    mOrigin(TClock::now()),
+    mTracing(false),
+    mTraceGeneration(0),
+    mTraceCapacity(0)
+{
+}
+
+CycleProfiler::~CycleProfiler()
+{
+    CycleProfiler* self = this;
+    mActive.compare_exchange_strong(self, 0);
+}
+
+void CycleProfiler::OnLink()
+{
+    mActive.store(this, std::memory_order_release);
+}
+
+void CycleProfiler::OnUnlink()
+{
+    CycleProfiler* self = this;
+    mActive.compare_exchange_strong(self, 0);
+}
+
+int CycleProfiler::RegisterSection(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(GetSectionMutex());
+    map<string, int>& ids = GetSectionIds();
+
+    map<string, int>::const_iterator iter = ids.find(name);
+    if (iter != ids.end())
+        {
+            return (*iter).second;
+        }
+
+    vector<string>& names = GetSectionNames();
+    if (names.size() >= MAX_SECTIONS)
+        {
+            return -1;
+        }
+
+    int id = static_cast<int>(names.size());
+    names.push_back(name);
+    ids[name] = id;
+    return id;
+}
+
+std::string CycleProfiler::GetSectionName(int section)
+{
+    std::lock_guard<std::mutex> lock(GetSectionMutex());
+    const vector<string>& names = GetSectionNames();
+
+    if (section < 0 || section >= static_cast<int>(names.size()))
+        {
+            return string();
+        }
+
+    return names[section];
+}
+
+void CycleProfiler::SetEnabled(bool enabled)
+{
+    mEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void CycleProfiler::SetWindowCycles(int cycles)
+{
+    mWindowCycles = std::max<int>(cycles, 1);
+}
+
+CycleProfiler::ThreadData& CycleProfiler::GetThreadData()
+{
+    if (cachedSerial == mSerial)
+        {
+            return *static_cast<ThreadData*>(cachedData);
+        }
+
+    // first record of this thread, the counters are zero initialized
+    ThreadData* data = new ThreadData();
+    data->traceGeneration.store(0);
+    data->traceCount.store(0);
+
+    std::lock_guard<std::mutex> lock(mThreadMutex);
+    data->index = static_cast<int>(mThreads.size());
+    mThreads.push_back(std::unique_ptr<ThreadData>(data));
+
+    cachedSerial = mSerial;
+    cachedData = data;
+    return *data;
+}
+
+int CycleProfiler::GetBucket(unsigned long long ns)
+{
+    if (ns < 64)
+        {
+            return 0;
+        }
+
+    // four buckets per power of two: the octave and the next two bits
+#ifdef __GNUC__
+    int octave = 63 - __builtin_clzll(ns);
+#else
+    int octave = 6;
+    while ((ns >> (octave + 1)) != 0)
+        {
+            ++octave;
+        }
+#endif
+    int sub = static_cast<int>((ns >> (octave - 2)) & 3);
+    int bucket = 1 + (octave - 6) * 4 + sub;
+
+    return std::min<int>(bucket, BUCKET_COUNT - 1);
+}
+
+double CycleProfiler::GetBucketLimit(int bucket)
+{
+    if (bucket == 0)
+        {
+            return 64.0;
+        }
+
+    int octave = 6 + (bucket - 1) / 4;
+    int sub = (bucket - 1) % 4;
+    return ldexp(1.0 + (sub + 1) * 0.25, octave);
+}
+
+void CycleProfiler::Record(int section, TClock::time_point start,
+                           TClock::time_point end)
+{
+    if (section < 0 || section >= MAX_SECTIONS)
+        {
+            return;
+        }
+
+    ThreadData& data = GetThreadData();
+    long long ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    unsigned long long duration = (ns > 0) ? ns : 0;
+
+    Histogram& hist =
+        data.hist[mWindow.load(std::memory_order_relaxed)][section];
+    Increase(hist.bucket[GetBucket(duration)], 1u);
+    Increase(hist.count, 1ull);
+    Increase(hist.sumNs, duration);
+    if (duration > hist.maxNs.load(std::memory_order_relaxed))
+        {
+            hist.maxNs.store(duration, std::memory_order_relaxed);
+        }
+
+    if (! mTracing.load(std::memory_order_acquire))
+        {
+            return;
+        }
+
+    // prepare the trace buffer of this thread for the current trace;
+    // only the owning thread changes it
+    int generation = mTraceGeneration.load(std::memory_order_relaxed);
+    if (data.traceGeneration.load(std::memory_order_relaxed) != generation)
+        {
+            data.traceCount.store(0, std::memory_order_relaxed);
+            data.trace.resize(mTraceCapacity.load(std::memory_order_relaxed));
+            data.traceGeneration.store(generation, std::memory_order_release);
+        }
+
+    size_t count = data.traceCount.load(std::memory_order_relaxed);
+    if (count < data.trace.size())
+        {
+            TraceEvent& event = data.trace[count];
+            event.section = section;
+            event.startNs =
+                std::chrono::duration_cast<std::chrono::nanoseconds>
+                (start - mOrigin).count();
+            event.durationNs = ns;
+            data.traceCount.store(count + 1, std::memory_order_release);
+        }
+}
+
+void CycleProfiler::ClearWindow(int window)
+{
+    std::lock_guard<std::mutex> lock(mThreadMutex);
+
+    for (vector<std::unique_ptr<ThreadData> >::iterator iter = mThreads.begin();
+         iter != mThreads.end();
+         ++iter)
+        {
+            for (int section = 0; section < MAX_SECTIONS; ++section)
+                {
+                    Histogram& hist = (*iter)->hist[window][section];
+                    if (hist.count.load(std::memory_order_relaxed) == 0)
+                        {
+                            continue;
+                        }
+
+                    for (int i = 0; i < BUCKET_COUNT; ++i)
+                        {
+                            hist.bucket[i].store(0, std::memory_order_relaxed);
+                        }
+                    hist.count.store(0, std::memory_order_relaxed);
+                    hist.sumNs.store(0, std::memory_order_relaxed);
+                    hist.maxNs.store(0, std::memory_order_relaxed);
+                }
+        }
+}
+
+void CycleProfiler::EndCycle()
+{
+    if (! IsEnabled())
+        {
+            return;
+        }
+
+    if (++mCycleInWindow < mWindowCycles)
+        {
+            return;
+        }
+
+    // the previous window is dropped and becomes the current one; no
+    // thread records into it while it is cleared
+    int next = 1 - mWindow.load(std::memory_order_relaxed);
+    ClearWindow(next);
+    mWindow.store(next, std::memory_order_relaxed);
+    mCycleInWindow = 0;
+}
+
+void CycleProfiler::Reset()
+{
+    ClearWindow(0);
+    ClearWindow(1);
+    mCycleInWindow = 0;
+}
+
+void CycleProfiler::GetStats(std::vector<SectionStats>& stats)
+{
+    vector<string> names;
+    {
+        std::lock_guard<std::mutex> lock(GetSectionMutex());
+        names = GetSectionNames();
+    }
+
+    stats.clear();
+
+    std::lock_guard<std::mutex> lock(mThreadMutex);
+
+    for (int section = 0; section < static_cast<int>(names.size()); ++section)
+        {
+            // merge both windows of all threads
+            unsigned long long buckets[BUCKET_COUNT] = { 0 };
+            unsigned long long count = 0;
+            unsigned long long sumNs = 0;
+            unsigned long long maxNs = 0;
+
+            for (vector<std::unique_ptr<ThreadData> >::const_iterator iter =
+                     mThreads.begin();
+                 iter != mThreads.end();
+                 ++iter)
+                {
+                    for (int window = 0; window < 2; ++window)
+                        {
+                            const Histogram& hist = (*iter)->hist[window][section];
+                            unsigned long long n =
+                                hist.count.load(std::memory_order_relaxed);
+                            if (n == 0)
+                                {
+                                    continue;
+                                }
+
+                            count += n;
+                            sumNs += hist.sumNs.load(std::memory_order_relaxed);
+                            maxNs = std::max<unsigned long long>
+                                (maxNs, hist.maxNs.load(std::memory_order_relaxed));
+                            for (int i = 0; i < BUCKET_COUNT; ++i)
+                                {
+                                    buckets[i] +=
+                                        hist.bucket[i].load(std::memory_order_relaxed);
+                                }
+                        }
+                }
+
+            if (count == 0)
+                {
+                    continue;
+                }
+
+            // the percentiles are the upper limits of their buckets,
+            // i.e. at most 19% too high
+            double percentile[2] = { 0.5, 0.99 };
+            double value[2] = { 0.0, 0.0 };
+            for (int p = 0; p < 2; ++p)
+                {
+                    unsigned long long rank = static_cast<unsigned long long>
+                        (ceil(percentile[p] * count));
+                    unsigned long long seen = 0;
+                    for (int i = 0; i < BUCKET_COUNT; ++i)
+                        {
+                            seen += buckets[i];
+                            if (seen >= rank)
+                                {
+                                    value[p] = std::min<double>
+                                        (GetBucketLimit(i), maxNs);
+                                    break;
+                                }
+                        }
+                }
+
+            SectionStats entry;
+            entry.name = names[section];
+            entry.count = count;
+            entry.mean = sumNs / 1000.0 / count;
+            entry.p50 = value[0] / 1000.0;
+            entry.p99 = value[1] / 1000.0;
+            entry.max = maxNs / 1000.0;
+            stats.push_back(entry);
+        }
+}
+
+std::string CycleProfiler::GetReport()
+{
+    vector<SectionStats> stats;
+    GetStats(stats);
+
+    size_t nameWidth = 8;
+    for (vector<SectionStats>::const_iterator iter = stats.begin();
+         iter != stats.end();
+         ++iter)
+        {
+            nameWidth = std::max(nameWidth, (*iter).name.size());
+        }
+
+    ostringstream ss;
+    ss << "(CycleProfiler) last " << (mCycleInWindow + mWindowCycles)
+       << " cycles at most, times in microseconds\n"
+       << left << setw(nameWidth) << "section" << right
+       << setw(10) << "count" << setw(10) << "mean"
+       << setw(10) << "p50" << setw(10) << "p99"
+       << setw(10) << "max" << "\n";
+    ss << fixed << setprecision(1);
+
+    for (vector<SectionStats>::const_iterator iter = stats.begin();
+         iter != stats.end();
+         ++iter)
+        {
+            ss << left << setw(nameWidth) << (*iter).name << right
+               << setw(10) << (*iter).count
+               << setw(10) << (*iter).mean
+               << setw(10) << (*iter).p50
+               << setw(10) << (*iter).p99
+               << setw(10) << (*iter).max << "\n";
+        }
+
+    return ss.str();
+}
+
+void CycleProfiler::StartTrace(int maxEvents)
+{
+    // the origin is written before tracing is published to the
+    // recording threads
+    mOrigin = TClock::now();
+    mTraceCapacity.store(std::max<int>(maxEvents, 1));
+    mTraceGeneration.fetch_add(1);
+    mTracing.store(true, std::memory_order_release);
+
+    GetLog()->Normal() << "(CycleProfiler) recording at most " << maxEvents
+                       << " trace events per thread\n";
+}
+
+bool CycleProfiler::StopTrace(const std::string& fileName)
+{
+    mTracing.store(false, std::memory_order_release);
+
+    ofstream out(fileName.c_str());
+    if (! out)
+        {
+            GetLog()->Error() << "(CycleProfiler) ERROR: cannot write trace file '"
+                              << fileName << "'\n";
+            return false;
+        }
+
+    vector<string> names;
+    {
+        std::lock_guard<std::mutex> lock(GetSectionMutex());
+        names = GetSectionNames();
+    }
+
+    int generation = mTraceGeneration.load();
+    size_t written = 0;
+
+    out << "{\"traceEvents\":[\n";
+    out << fixed << setprecision(3);
+
+    std::lock_guard<std::mutex> lock(mThreadMutex);
+    for (vector<std::unique_ptr<ThreadData> >::const_iterator iter =
+             mThreads.begin();
+         iter != mThreads.end();
+         ++iter)
+        {
+            const ThreadData& data = *(*iter);
+            if (data.traceGeneration.load(std::memory_order_acquire) != generation)
+                {
+                    continue;
+                }
+
+            size_t count = data.traceCount.load(std::memory_order_acquire);
+            for (size_t i = 0; i < count; ++i)
+                {
+                    const TraceEvent& event = data.trace[i];
+                    if (written > 0)
+                        {
+                            out << ",\n";
+                        }
+
+                    out << "{\"name\":\"";
+                    EscapeJson(out, names[event.section]);
+                    out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << data.index
+                        << ",\"ts\":" << (event.startNs / 1000.0)
+                        << ",\"dur\":" << (event.durationNs / 1000.0) << "}";
+                    ++written;
+                }
+        }
+
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    GetLog()->Normal() << "(CycleProfiler) wrote " << written
+                       << " trace events to '" << fileName << "'\n";
+    return true;
+}
@@ -0,0 +1,305 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2002,2003 Koblenz University
+   Copyright (C) 2004-2009 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#ifndef OXYGEN_CYCLEPROFILER_H
+#define OXYGEN_CYCLEPROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <zeitgeist/class.h>
+#include <zeitgeist/leaf.h>
+#include <oxygen/oxygen_defines.h>
+
+namespace oxygen
+{
+
+/** \class CycleProfiler measures how long the phases of the
+    simulation cycle take, e.g. each control node event, each physics
+    step or the perceptor generation of each agent.
+
+    Code sections are named and registered once (see
+    RegisterSection()); timing a section is done with a Scope object
+    or the OXYGEN_PROFILE_SCOPE macro. Each thread records into its
+    own counters, so recording is lock free and works in the
+    multi-threaded runloop as well.
+
+    The durations are aggregated into histograms with four buckets
+    per power of two. The histograms roll over every mWindowCycles
+    cycles, a report covers the last one to two windows. Optionally
+    every recorded section is also kept as an event and written as a
+    Chrome trace file (chrome://tracing, Perfetto).
+
+    Recording only happens while the profiler is enabled. The profiler
+    is compiled out completely, i.e. the scopes cost nothing, if
+    ENABLE_CYCLE_PROFILER is not defined.
+ */
+class OXYGEN_API CycleProfiler : public zeitgeist::Leaf
+{
+public:
+    typedef std::chrono::steady_clock TClock;
+
+    enum
+    {
+        /** the maximum number of registered sections */
+        MAX_SECTIONS = 128,
+
+        /** the number of histogram buckets; four per power of two,
+            starting at 64ns
+        */
+        BUCKET_COUNT = 128
+    };
+
+    /** the statistics of a section, times in microseconds */
+    struct SectionStats
+    {
+        std::string name;
+        unsigned long long count;
+        double mean;
+        double p50;
+        double p99;
+        double max;
+    };
+
+    /** \class Scope records the time from its construction to its
+        destruction for a section
+     */
+    class Scope
+    {
+    public:
+        Scope(int section) :
+            mProfiler(CycleProfiler::GetActive()), mSection(section)
+        {
+            if (mProfiler != 0 && section >= 0 && mProfiler->IsEnabled())
+                {
+                    mStart = TClock::now();
+                } else
+                {
+                    mProfiler = 0;
+                }
+        }
+
+        ~Scope()
+        {
+            if (mProfiler != 0)
+                {
+                    mProfiler->Record(mSection, mStart, TClock::now());
+                }
+        }
+
+    private:
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+
+    protected:
+        CycleProfiler* mProfiler;
+        int mSection;
+        TClock::time_point mStart;
+    };
+
+public:
+    CycleProfiler();
+    virtual ~CycleProfiler();
+
+    /** returns the id of the section with the given name, registering
+        it on first use. Section ids are shared by all profiler
+        instances. Takes a lock and a map lookup. Returns -1 if
+        MAX_SECTIONS is exceeded
+    */
+    static int RegisterSection(const std::string& name);
+
+    /** returns the name of a registered section */
+    static std::string GetSectionName(int section);
+
+    /** returns the profiler that is currently linked into the
+        hierarchy, or 0
+    */
+    static CycleProfiler* GetActive()
+    { return mActive.load(std::memory_order_acquire); }
+
+    /** returns true if there is an active profiler and it is enabled */
+    static bool IsRecording()
+    {
+        CycleProfiler* profiler = GetActive();
+        return (profiler != 0 && profiler->IsEnabled());
+    }
+
+    /** enables or disables recording */
+    void SetEnabled(bool enabled);
+
+    /** returns true if recording is enabled */
+    bool IsEnabled() const
+    { return mEnabled.load(std::memory_order_relaxed); }
+
+    /** sets the number of cycles per histogram window */
+    void SetWindowCycles(int cycles);
+
+    /** records the duration of a section for the calling thread */
+    void Record(int section, TClock::time_point start,
+                TClock::time_point end);
+
+    /** called by the SimulationServer after each cycle, rolls the
+        histograms over when a window is complete
+    */
+    void EndCycle();
+
+    /** clears all histograms */
+    void Reset();
+
+    /** returns a table with count, mean, p50, p99 and max (in
+        microseconds) of all sections recorded in the current and the
+        previous window
+    */
+    std::string GetReport();
+
+    /** returns the statistics that GetReport() prints */
+    void GetStats(std::vector<SectionStats>& stats);
+
+    /** starts recording trace events, at most maxEvents per thread */
+    void StartTrace(int maxEvents);
+
+    /** stops recording trace events and writes them as a Chrome trace
+        file; returns false if the file can't be written
+    */
+    bool StopTrace(const std::string& fileName);
+
+protected:
+    virtual void OnLink();
+    virtual void OnUnlink();
+
+    struct Histogram
+    {
+        std::atomic<unsigned int> bucket[BUCKET_COUNT];
+        std::atomic<unsigned long long> count;
+        std::atomic<unsigned long long> sumNs;
+        std::atomic<unsigned long long> maxNs;
+    };
+
+    struct TraceEvent
+    {
+        int section;
+        long long startNs;
+        long long durationNs;
+    };
+
+    /** the counters of one thread; only the owning thread writes,
+        readers see consistent (if slightly old) values through the
+        atomics
+    */
+    struct ThreadData
+    {
+        int index;
+
+        /** two rolling windows per section */
+        Histogram hist[2][MAX_SECTIONS];
+
+        /** the trace generation this buffer was prepared for */
+        std::atomic<int> traceGeneration;
+        std::vector<TraceEvent> trace;
+        std::atomic<size_t> traceCount;
+    };
+
+    /** returns the counters of the calling thread, registering them on
+        first use
+    */
+    ThreadData& GetThreadData();
+
+    /** returns the histogram bucket of a duration */
+    static int GetBucket(unsigned long long ns);
+
+    /** returns the upper bound of a histogram bucket in nanoseconds */
+    static double GetBucketLimit(int bucket);
+
+    /** clears the histograms of a window of all threads */
+    void ClearWindow(int window);
+
+protected:
+    /** the profiler that is linked into the hierarchy */
+    static std::atomic<CycleProfiler*> mActive;
+
+    /** identifies the instance in the thread local caches */
+    int mSerial;
+
+    std::atomic<bool> mEnabled;
+
+    /** the index of the window that is currently recorded */
+    std::atomic<int> mWindow;
+
+    /** the number of cycles per window */
+    int mWindowCycles;
+
+    /** the number of cycles recorded in the current window */
+    int mCycleInWindow;
+
+    /** the time origin of the trace events */
+    TClock::time_point mOrigin;
+
+    /** true while trace events are recorded */
+    std::atomic<bool> mTracing;
+
+    /** incremented by each StartTrace() */
+    std::atomic<int> mTraceGeneration;
+
+    /** the capacity of the per thread trace buffers */
+    std::atomic<int> mTraceCapacity;
+
+    /** protects mThreads */
+    std::mutex mThreadMutex;
+
+    /** the counters of all threads that recorded so far */
+    std::vector<std::unique_ptr<ThreadData> > mThreads;
+};
+
+DECLARE_CLASS(CycleProfiler)
+
+} // namespace oxygen
+
+#ifdef ENABLE_CYCLE_PROFILER
+
+#define OXYGEN_PROFILE_CONCAT2(a, b) a##b
+#define OXYGEN_PROFILE_CONCAT(a, b) OXYGEN_PROFILE_CONCAT2(a, b)
+
+/** times the rest of the enclosing block as section \param name (a
+    string literal); the section is registered once
+*/
+#define OXYGEN_PROFILE_SCOPE(name)                                      \
+    static const int OXYGEN_PROFILE_CONCAT(profileSection, __LINE__) =  \
+        oxygen::CycleProfiler::RegisterSection(name);                   \
+    oxygen::CycleProfiler::Scope OXYGEN_PROFILE_CONCAT(profileScope, __LINE__) \
+        (OXYGEN_PROFILE_CONCAT(profileSection, __LINE__))
+
+/** times the rest of the enclosing block as the section with the id
+    \param section, e.g. one registered for a node when it was created
+*/
+#define OXYGEN_PROFILE_SECTION(section)                                 \
+    oxygen::CycleProfiler::Scope OXYGEN_PROFILE_CONCAT(profileScope, __LINE__) \
+        (section)
+
+#else
+
+#define OXYGEN_PROFILE_SCOPE(name)
+#define OXYGEN_PROFILE_SECTION(section)
+
+#endif // ENABLE_CYCLE_PROFILER
+
+#endif // OXYGEN_CYCLEPROFILER_H
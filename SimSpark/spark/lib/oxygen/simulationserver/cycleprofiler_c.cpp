@@ -0,0 +1,115 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2002,2003 Koblenz University
+   Copyright (C) 2004-2009 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#include "cycleprofiler.h"
+
+using namespace oxygen;
+using namespace std;
+
+FUNCTION(CycleProfiler,setEnabled)
+{
+    bool inEnabled;
+
+    if (
+        (in.GetSize() != 1) ||
+        (! in.GetValue(in.begin(), inEnabled))
+        )
+        {
+            return false;
+        }
+
+    obj->SetEnabled(inEnabled);
+    return true;
+}
+
+FUNCTION(CycleProfiler,isEnabled)
+{
+    return obj->IsEnabled();
+}
+
+FUNCTION(CycleProfiler,setWindowCycles)
+{
+    int inCycles;
+
+    if (
+        (in.GetSize() != 1) ||
+        (! in.GetValue(in.begin(), inCycles))
+        )
+        {
+            return false;
+        }
+
+    obj->SetWindowCycles(inCycles);
+    return true;
+}
+
+FUNCTION(CycleProfiler,reset)
+{
+    obj->Reset();
+    return true;
+}
+
+FUNCTION(CycleProfiler,report)
+{
+    return obj->GetReport();
+}
+
+FUNCTION(CycleProfiler,startTrace)
+{
+    int inMaxEvents;
+
+    if (
+        (in.GetSize() != 1) ||
+        (! in.GetValue(in.begin(), inMaxEvents))
+        )
+        {
+            return false;
+        }
+
+    obj->StartTrace(inMaxEvents);
+    return true;
+}
+
+FUNCTION(CycleProfiler,stopTrace)
+{
+    string inFileName;
+
+    if (
+        (in.GetSize() != 1) ||
+        (! in.GetValue(in.begin(), inFileName))
+        )
+        {
+            return false;
+        }
+
+    return obj->StopTrace(inFileName);
+}
+
+void CLASS(CycleProfiler)::DefineClass()
+{
+    DEFINE_BASECLASS(zeitgeist/Leaf)
+    DEFINE_FUNCTION(setEnabled)
+    DEFINE_FUNCTION(isEnabled)
+    DEFINE_FUNCTION(setWindowCycles)
+    DEFINE_FUNCTION(reset)
+    DEFINE_FUNCTION(report)
+    DEFINE_FUNCTION(startTrace)
+    DEFINE_FUNCTION(stopTrace)
+}
@@ -535,8 +535,8 @@ void NetControl::ReadUDPMessages()
     FD_SET(fd,&readfds);
 
     timeval time;
-    time.tv_sec = mReadTimeout;
-    time.tv_usec = 0;
+    time.tv_sec = mReadTimeout / 1000000;
+    time.tv_usec = mReadTimeout % 1000000;
 
     for(;;)
         {
@@ -549,6 +549,7 @@ void NetControl::ReadUDPMessages()
 
             int ret = select(maxFd, &readfds, 0, 0, &time);
             time.tv_sec = 0;
+            time.tv_usec = 0;
 
             if (ret == 0)
                 {
@@ -620,12 +621,12 @@ void NetControl::ReadTCPMessages()
         }
 
     // test for pending fragments
-    int timeout = mReadTimeout;
+    long timeout = mReadTimeout;
     for(;;)
         {
             timeval time;
-            time.tv_sec = timeout;
-            time.tv_usec = 0;
+            time.tv_sec = timeout / 1000000;
+            time.tv_usec = timeout % 1000000;
 
             fd_set test_fds = client_fds;
             int ret = select(maxFd+1, &test_fds, 0, 0, &time);
@@ -691,10 +692,15 @@ void NetControl::BlockOnReadMessages(bool block)
 {
     if (block)
     {
-        mReadTimeout = 1;
+        mReadTimeout = 1000000;
     }
     else
     {
         mReadTimeout = 0;
     }
 }
+
+void NetControl::SetReadTimeout(long usec)
+{
+    mReadTimeout = std::max<long>(usec, 0);
+}
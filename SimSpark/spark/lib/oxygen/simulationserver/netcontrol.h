@@ -129,6 +129,14 @@ public:
      */
     void BlockOnReadMessages(bool block);
 
+    /** sets how long (in microseconds) ReadMessages waits for the first
+     * incoming message before it returns. 0 means don't wait at all.
+     */
+    void SetReadTimeout(long usec);
+
+    /** returns the current ReadMessages timeout in microseconds */
+    long GetReadTimeout() const { return mReadTimeout; }
+
 protected:
     /** returns a human readable description of the socket type and
         port*/
@@ -207,8 +215,9 @@ protected:
     /** the next available unique client id */
     int mClientId;
 
-    /** indicates how much ReadMessages should wait for new messages */
-    int mReadTimeout;
+    /** indicates how much ReadMessages should wait for new messages, in
+        microseconds */
+    long mReadTimeout;
 };
 
 DECLARE_CLASS(NetControl)
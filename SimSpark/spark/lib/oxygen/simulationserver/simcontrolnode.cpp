@@ -47,6 +47,21 @@ void SimControlNode::SetSimTime( float now )
     mTime = now + mStep;
 }
 
+void SimControlNode::SetProfileSection(int event, int section)
+{
+    if (event < 0)
+    {
+        return;
+    }
+
+    if (event >= static_cast<int>(mProfileSections.size()))
+    {
+        mProfileSections.resize(event + 1, -1);
+    }
+
+    mProfileSections[event] = section;
+}
+
 std::shared_ptr<Scene> SimControlNode::GetActiveScene()
 {
     std::shared_ptr<SceneServer> sceneServer =
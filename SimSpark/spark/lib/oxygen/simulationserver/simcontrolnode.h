@@ -22,6 +22,7 @@
 #ifndef OXYGEN_SIMCONTROLNODE_H
 #define OXYGEN_SIMCONTROLNODE_H
 
+#include <vector>
 #include <zeitgeist/node.h>
 #include <oxygen/oxygen_defines.h>
 #include <oxygen/sceneserver/scene.h>
@@ -71,10 +72,23 @@ public:
     float GetTime() const { return mTime; }
 
     void SetStep(float step) { mStep = step; }
+    float GetStep() const { return mStep; }
     void SetTime(float time) { mTime = time; }
 
     void SetSimTime(float now);
 
+    /** sets the CycleProfiler section of a SimulationServer control
+        event of this node */
+    void SetProfileSection(int event, int section);
+
+    /** returns the CycleProfiler section of a SimulationServer control
+        event of this node, or -1 */
+    int GetProfileSection(int event) const
+    {
+        return (event >= 0 && event < static_cast<int>(mProfileSections.size()))
+            ? mProfileSections[event] : -1;
+    }
+
 protected:
     /** returns a reference to the SimulationServer */
     std::shared_ptr<SimulationServer> GetSimulationServer();
@@ -85,6 +99,9 @@ protected:
     float mTime;
 
     float mStep;
+
+    /** the CycleProfiler sections, indexed by control event */
+    std::vector<int> mProfileSections;
 };
 
 DECLARE_CLASS(SimControlNode)
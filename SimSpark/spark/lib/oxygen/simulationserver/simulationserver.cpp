@@ -24,7 +24,10 @@
 #include <vector>
 #include "simcontrolnode.h"
 #include "timersystem.h"
+#include "cycleprofiler.h"
+#include "cyclearena.h"
 #include <zeitgeist/logserver/logserver.h>
+#include <zeitgeist/startuptrace.h>
 #include <signal.h>
 #include <algorithm>
 
@@ -35,6 +38,29 @@ using namespace std;
 
 std::vector<SimulationServer*> SimulationServer::mServers = std::vector<SimulationServer*>();
 
+#ifdef ENABLE_CYCLE_PROFILER
+/** returns the profiler section name of a control event of a node */
+static std::string GetProfileName(const SimControlNode& node, const char* event)
+{
+    return node.GetName() + "::" + event;
+}
+
+static const char* GetControlEventName(SimulationServer::EControlEvent event)
+{
+    switch (event)
+        {
+        case SimulationServer::CE_Init :       return "InitSimulation";
+        case SimulationServer::CE_Done :       return "DoneSimulation";
+        case SimulationServer::CE_StartCycle : return "StartCycle";
+        case SimulationServer::CE_SenseAgent : return "SenseAgent";
+        case SimulationServer::CE_ActAgent :   return "ActAgent";
+        case SimulationServer::CE_EndCycle :   return "EndCycle";
+        case SimulationServer::CE_WaitCycle :  return "WaitCycle";
+        default:                               return "Unknown";
+        }
+}
+#endif
+
 void SimulationServer::CatchSignal(int sig_num)
 {
     static bool exiting = false;
@@ -58,6 +84,8 @@ SimulationServer::SimulationServer() :
     mSimTime      = 0.0f;
     mSimStep      = 0.2f;
     mAutoTime     = true;
+    mTurboMode    = false;
+    mPrintStartupTrace = false;
     mCycle        = 0;
     mPausedCycle  = 0;
     mSumDeltaTime = 0;
@@ -169,6 +197,44 @@ bool SimulationServer::GetAutoTimeMode()
     return mAutoTime;
 }
 
+void SimulationServer::SetTurboMode(bool set)
+{
+    mTurboMode = set;
+}
+
+bool SimulationServer::GetTurboMode()
+{
+    return mTurboMode;
+}
+
+void SimulationServer::SetCycleArena(bool set)
+{
+    CycleArena::SetEnabled(set);
+}
+
+std::string SimulationServer::GetCycleArenaReport()
+{
+    return CycleArena::GetReport();
+}
+
+void SimulationServer::SetStartupTrace(bool set)
+{
+    mPrintStartupTrace = set;
+}
+
+float SimulationServer::GetRealTimeFactor()
+{
+    std::chrono::duration<float> wallTime =
+        std::chrono::steady_clock::now() - mRunStartTime;
+
+    if (wallTime.count() <= 0.0f)
+        {
+            return 0.0f;
+        }
+
+    return mSimTime / wallTime.count();
+}
+
 int SimulationServer::GetCycle()
 {
     return mCycle;
@@ -207,6 +273,15 @@ bool SimulationServer::InitControlNode(const std::string& className, const std::
         }
 
     control->SetName(name);
+#ifdef ENABLE_CYCLE_PROFILER
+    for (int event = CE_Init; event <= CE_WaitCycle; ++event)
+        {
+            control->SetProfileSection
+                (event, CycleProfiler::RegisterSection
+                 (GetProfileName(*control, GetControlEventName
+                                 (static_cast<EControlEvent>(event)))));
+        }
+#endif
     AddChildReference(control);
 
     GetLog()->Normal()
@@ -281,18 +356,30 @@ void SimulationServer::Step()
             return;
         }
 
+    OXYGEN_PROFILE_SCOPE("SimulationServer::Step");
+
     if (mSimStep > 0)
         {
-            // world is stepped in discrete steps
+            // world is stepped in discrete steps. Accumulated float
+            // errors smaller than a hundredth of a step still count as
+            // a full step, so the number of steps doesn't depend on
+            // rounding.
+            const float stepEps = mSimStep * 0.01f;
             float finalStep = 0;
-            while (int(mSumDeltaTime*100) >= int(mSimStep*100))
+            while (mSumDeltaTime + stepEps >= mSimStep)
                 {
-                    mSceneServer->PrePhysicsUpdate(mSimStep);
+                    {
+                        OXYGEN_PROFILE_SCOPE("SceneServer::PrePhysicsUpdate");
+                        mSceneServer->PrePhysicsUpdate(mSimStep);
+                    }
                     mSceneServer->PhysicsUpdate(mSimStep);
                     UpdateDeltaTimeAfterStep(mSumDeltaTime);
                     finalStep += mSimStep;
                 }
-            mSceneServer->PostPhysicsUpdate();
+            {
+                OXYGEN_PROFILE_SCOPE("SceneServer::PostPhysicsUpdate");
+                mSceneServer->PostPhysicsUpdate();
+            }
             mGameControlServer->Update(finalStep);
             mSimTime += finalStep;
 
@@ -322,7 +409,9 @@ void SimulationServer::ControlEvent(EControlEvent event)
                     continue;
                 }
 
-            if ( ctrNode->GetTime() - mSimTime > 0.005f ) continue;
+            if (! IsControlNodeActive(ctrNode)) continue;
+
+            OXYGEN_PROFILE_SECTION(ctrNode->GetProfileSection(event));
 
             switch (event)
                 {
@@ -364,6 +453,17 @@ void SimulationServer::ControlEvent(EControlEvent event)
         }
 }
 
+bool SimulationServer::IsControlNodeActive(
+    const std::shared_ptr<SimControlNode>& ctrNode)
+{
+    if (mTurboMode && ctrNode->GetName() == "RenderControl")
+        {
+            return false;
+        }
+
+    return ctrNode->GetTime() - mSimTime <= 0.005f;
+}
+
 void SimulationServer::Init(int argc, char** argv)
 {
     GetLog()->Normal() << "(SimulationServer) init\n";
@@ -382,14 +482,31 @@ void SimulationServer::Init(int argc, char** argv)
         {
             mTimerSystem->Initialize();
         }
+
+    mRunStartTime = std::chrono::steady_clock::now();
 }
 
 void SimulationServer::Run(int argc, char** argv)
 {
     Init(argc, argv);
+
+    // the startup ends with the runloop
+    StartupTrace::Finish();
+    if (mPrintStartupTrace)
+        {
+            GetLog()->Normal() << "(SimulationServer) "
+                               << StartupTrace::GetReport();
+        }
+
     GetLog()->Normal() << "(SimulationServer) entering runloop\n";
 
-    if ( !mAutoTime && !mTimerSystem )
+    if (mTurboMode)
+        {
+            GetLog()->Normal()<< "(SimulationServer) running in headless "
+                    "turbo mode\n";
+        }
+
+    if ( !mAutoTime && !mTurboMode && !mTimerSystem )
         {
             GetLog()->Error()<< "(SimulationServer) ERROR: can not get"
                     " any TimerSystem objects.\n";
@@ -457,18 +574,34 @@ void SimulationServer::Cycle()
     }
     else
     {
-        ++mCycle;
-        ControlEvent(CE_StartCycle);
-        ControlEvent(CE_SenseAgent);
-        ControlEvent(CE_ActAgent);
+        {
+            OXYGEN_PROFILE_SCOPE("SimulationServer::Cycle");
 
-        Step();
-        SyncTime();
+            ++mCycle;
+            ControlEvent(CE_StartCycle);
+            ControlEvent(CE_SenseAgent);
+            ControlEvent(CE_ActAgent);
+
+            Step();
+            SyncTime();
 
-        ControlEvent(CE_EndCycle);
+            ControlEvent(CE_EndCycle);
+        }
+
+        CycleArena::EndCycle();
+        EndProfileCycle();
     }
 }
 
+void SimulationServer::EndProfileCycle()
+{
+    CycleProfiler* profiler = CycleProfiler::GetActive();
+    if (profiler != 0)
+        {
+            profiler->EndCycle();
+        }
+}
+
 void SimulationServer::Done()
 {
     if (mTimerSystem)
@@ -484,6 +617,13 @@ void SimulationServer::Done()
     GetLog()->Normal()
         << "(SimulationServer) leaving runloop at t="
         << mSimTime << "\n";
+
+    if (mTurboMode)
+        {
+            GetLog()->Normal()
+                << "(SimulationServer) achieved " << GetRealTimeFactor()
+                << " simulated seconds per wall clock second\n";
+        }
 }
 
 std::shared_ptr<GameControlServer> SimulationServer::GetGameControlServer()
@@ -522,7 +662,11 @@ void SimulationServer::RunMultiThreaded()
             ctrThrdGroup.emplace_back(&SimulationServer::SimControlThread, this, ctrNode);
         }
 
-    std::shared_ptr<SimControlNode> renderControl = GetControlNode("RenderControl");
+    std::shared_ptr<SimControlNode> renderControl;
+    if (! mTurboMode)
+        {
+            renderControl = GetControlNode("RenderControl");
+        }
 
     //float initDelta, finalDelta;      //unused variables
     mExitThreads = false;
@@ -573,10 +717,15 @@ void SimulationServer::RunMultiThreaded()
 
                     if (renderControl
                         && renderControl->GetTime() - mSimTime < 0.005f )
-                        renderControl->EndCycle();
+                        {
+                            OXYGEN_PROFILE_SECTION(renderControl->GetProfileSection(CE_EndCycle));
+                            renderControl->EndCycle();
+                        }
 
                     // End Cycle
                     mThreadBarrier->wait();
+                    CycleArena::EndCycle();
+                    EndProfileCycle();
                 }
         }
 
@@ -604,7 +753,8 @@ void SimulationServer::SimControlThread(std::shared_ptr<SimControlNode> controlN
             if (mCyclePaused)
                 {
                     mThreadBarrier->wait();
-                    controlNode->WaitCycle();
+                    if (!isRenderControl || !mTurboMode)
+                        controlNode->WaitCycle();
                     mThreadBarrier->wait();
                 }
             else
@@ -612,12 +762,21 @@ void SimulationServer::SimControlThread(std::shared_ptr<SimControlNode> controlN
                     mThreadBarrier->wait();
 
                     newCycle = false;
-                    if ( controlNode->GetTime() - mSimTime <= 0.005f)
+                    if (IsControlNodeActive(controlNode))
                         {
                             newCycle = true;
-                            controlNode->StartCycle();
-                            controlNode->SenseAgent();
-                            controlNode->ActAgent();
+                            {
+                                OXYGEN_PROFILE_SECTION(controlNode->GetProfileSection(CE_StartCycle));
+                                controlNode->StartCycle();
+                            }
+                            {
+                                OXYGEN_PROFILE_SECTION(controlNode->GetProfileSection(CE_SenseAgent));
+                                controlNode->SenseAgent();
+                            }
+                            {
+                                OXYGEN_PROFILE_SECTION(controlNode->GetProfileSection(CE_ActAgent));
+                                controlNode->ActAgent();
+                            }
                             controlNode->SetSimTime(mSimTime);
                         }
 
@@ -626,7 +785,11 @@ void SimulationServer::SimControlThread(std::shared_ptr<SimControlNode> controlN
                     // wait for physics update
                     mThreadBarrier->wait();
                     if (!isRenderControl && newCycle)
-                        controlNode->EndCycle();
+                        {
+                            OXYGEN_PROFILE_SECTION(controlNode->GetProfileSection(CE_EndCycle));
+                            controlNode->EndCycle();
+                        }
+                    CycleArena::EndCycle();
                 }
         }
 }
@@ -666,7 +829,9 @@ inline void SimulationServer::UpdateDeltaTimeAfterStep(float &deltaTime)
 
 inline void SimulationServer::SyncTime()
 {
-    if (mAutoTime)
+    OXYGEN_PROFILE_SCOPE("SimulationServer::SyncTime");
+
+    if (mAutoTime || mTurboMode)
         {
             AdvanceTime(mSimStep);
         }
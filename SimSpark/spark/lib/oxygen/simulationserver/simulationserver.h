@@ -28,6 +28,7 @@
 #include <oxygen/sceneserver/sceneserver.h>
 #include <oxygen/monitorserver/monitorserver.h>
 #include <boost/thread/barrier.hpp>
+#include <chrono>
 
 namespace oxygen
 {
@@ -102,6 +103,33 @@ public:
     /** returns the current auto time setting */
     bool GetAutoTimeMode();
 
+    /** sets the headless turbo mode. In turbo mode the simulation
+        advances exactly mSimStep every cycle as soon as all control
+        nodes finished their cycle, i.e. no TimerSystem is used and the
+        RenderControl node is skipped.
+     */
+    void SetTurboMode(bool set);
+
+    /** returns the current turbo mode setting */
+    bool GetTurboMode();
+
+    /** enables or disables the per thread CycleArenas that hold the
+        predicates of the agent messages, the percepts and the monitor
+        data of a cycle
+     */
+    void SetCycleArena(bool set);
+
+    /** returns the allocation statistics of the CycleArenas */
+    std::string GetCycleArenaReport();
+
+    /** enables or disables printing the StartupTrace when the
+        runloop is entered */
+    void SetStartupTrace(bool set);
+
+    /** returns the simulated seconds per wall clock second since the
+        runloop was entered */
+    float GetRealTimeFactor();
+
     /** returns the instance of a registerd SimControlNode */
     std::shared_ptr<oxygen::SimControlNode>
     GetControlNode(const std::string& controlName);
@@ -196,6 +224,13 @@ protected:
     /** updates mSumDeltaTime after a step in discreet simulations */
     void UpdateDeltaTimeAfterStep(float &deltaTime);
 
+    /** returns true if the given control node should take part in the
+        current cycle */
+    bool IsControlNodeActive(const std::shared_ptr<SimControlNode>& ctrNode);
+
+    /** tells the active CycleProfiler, if any, that a cycle ended */
+    void EndProfileCycle();
+
     /** updates the accumulated time since last simulation step using the
      * specified timing method: it might use simulator's own clock (if mAutoTime
      * is true) or a TimerSystem provided using InitTimerSystem() */
@@ -239,6 +274,17 @@ protected:
         SimControlNode is responsible to advance the ime */
     bool mAutoTime;
 
+    /** true if the server runs in headless turbo mode, see
+        SetTurboMode() */
+    bool mTurboMode;
+
+    /** true if the StartupTrace is printed when the runloop is
+        entered */
+    bool mPrintStartupTrace;
+
+    /** the wall clock time the runloop was entered */
+    std::chrono::steady_clock::time_point mRunStartTime;
+
     /** the current simulation cycle */
     int mCycle;
 
@@ -117,6 +117,69 @@ FUNCTION(SimulationServer, getAutoTimeMode)
     return obj->GetAutoTimeMode();
 }
 
+FUNCTION(SimulationServer, setTurboMode)
+{
+    bool inSet;
+
+    if (
+        (in.GetSize() != 1) ||
+        (! in.GetValue(in[0], inSet))
+        )
+        {
+            return false;
+        }
+
+    obj->SetTurboMode(inSet);
+    return true;
+}
+
+FUNCTION(SimulationServer, getTurboMode)
+{
+    return obj->GetTurboMode();
+}
+
+FUNCTION(SimulationServer, setCycleArena)
+{
+    bool inSet;
+
+    if (
+        (in.GetSize() != 1) ||
+        (! in.GetValue(in[0], inSet))
+        )
+        {
+            return false;
+        }
+
+    obj->SetCycleArena(inSet);
+    return true;
+}
+
+FUNCTION(SimulationServer, getCycleArenaReport)
+{
+    return obj->GetCycleArenaReport();
+}
+
+FUNCTION(SimulationServer, setStartupTrace)
+{
+    bool inSet;
+
+    if (
+        (in.GetSize() != 1) ||
+        (! in.GetValue(in[0], inSet))
+        )
+        {
+            return false;
+        }
+
+    obj->SetStartupTrace(inSet);
+    return true;
+}
+
+FUNCTION(SimulationServer, getRealTimeFactor)
+{
+    return obj->GetRealTimeFactor();
+}
+
 FUNCTION(SimulationServer, setMultiThreads)
 {
     bool inSet;
@@ -177,6 +240,12 @@ void CLASS(SimulationServer)::DefineClass()
     DEFINE_FUNCTION(getSimStep)
     DEFINE_FUNCTION(setAutoTimeMode)
     DEFINE_FUNCTION(getAutoTimeMode)
+    DEFINE_FUNCTION(setTurboMode)
+    DEFINE_FUNCTION(getTurboMode)
+    DEFINE_FUNCTION(setCycleArena)
+    DEFINE_FUNCTION(getCycleArenaReport)
+    DEFINE_FUNCTION(setStartupTrace)
+    DEFINE_FUNCTION(getRealTimeFactor)
     DEFINE_FUNCTION(setMultiThreads)
     DEFINE_FUNCTION(setAdjustSpeed)
     DEFINE_FUNCTION(setMaxStepsPerCyle)
@@ -30,15 +30,25 @@ void AABB3::TransformBy(Matrix& matrix)
 
 	Vector3f v(minVec);
 	Vector3f w(maxVec);
-	
-	bb.Encapsulate(matrix.Transform(Vector3f(v.x(),v.y(),v.z())));
-	bb.Encapsulate(matrix.Transform(Vector3f(w.x(),v.y(),v.z())));
-	bb.Encapsulate(matrix.Transform(Vector3f(v.x(),w.y(),v.z())));
-	bb.Encapsulate(matrix.Transform(Vector3f(w.x(),w.y(),v.z())));
-	bb.Encapsulate(matrix.Transform(Vector3f(v.x(),v.y(),w.z())));
-	bb.Encapsulate(matrix.Transform(Vector3f(w.x(),v.y(),w.z())));
-	bb.Encapsulate(matrix.Transform(Vector3f(v.x(),w.y(),w.z())));
-	bb.Encapsulate(matrix.Transform(Vector3f(w.x(),w.y(),w.z())));
+
+	Vector3f corners[8] =
+	{
+		Vector3f(v.x(),v.y(),v.z()),
+		Vector3f(w.x(),v.y(),v.z()),
+		Vector3f(v.x(),w.y(),v.z()),
+		Vector3f(w.x(),w.y(),v.z()),
+		Vector3f(v.x(),v.y(),w.z()),
+		Vector3f(w.x(),v.y(),w.z()),
+		Vector3f(v.x(),w.y(),w.z()),
+		Vector3f(w.x(),w.y(),w.z())
+	};
+
+	matrix.TransformPoints(corners, corners, 8);
+
+	for (int i=0; i<8; ++i)
+	{
+		bb.Encapsulate(corners[i]);
+	}
 
 	minVec.Set(bb.minVec);
 	maxVec.Set(bb.maxVec);
@@ -66,4 +66,12 @@
 
 #define Assert(expression, desc)        assert(expression && desc)
 
+// SSE2 is available on every x86-64 target; define SALT_NO_SIMD to
+// build the plain C++ math routines only
+#if     !defined(SALT_NO_SIMD) && \
+        (defined(__SSE2__) || defined(_M_X64) || \
+         (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+        #define SALT_SSE 1
+#endif
+
 #endif //SALT_DEFINES_H
@@ -22,8 +22,152 @@
 
 #include <cstdio>
 
+#if defined(SALT_SSE) && defined(__GNUC__)
+#include <immintrin.h>
+#define SALT_AVX_DISPATCH 1
+#endif
+
 using namespace salt;
 
+namespace
+{
+	typedef void (*TTransformPoints)(const float* m, const Vector3f* in,
+									 Vector3f* out, size_t count);
+
+	void TransformPointsScalar(const float* m, const Vector3f* in,
+							   Vector3f* out, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			float x = in[i].x(), y = in[i].y(), z = in[i].z();
+
+			out[i].Set(x*m[0] + y*m[4] + z*m[8] + m[12],
+					   x*m[1] + y*m[5] + z*m[9] + m[13],
+					   x*m[2] + y*m[6] + z*m[10]+ m[14]);
+		}
+	}
+
+#ifdef SALT_SSE
+	// stores the first three floats of v to out
+	f_inline void StoreVector3f(Vector3f& out, __m128 v)
+	{
+		float* data = out.GetData();
+		_mm_storel_pi(reinterpret_cast<__m64*>(data), v);
+		_mm_store_ss(data + 2, _mm_movehl_ps(v, v));
+	}
+
+	void TransformPointsSSE(const float* m, const Vector3f* in,
+							Vector3f* out, size_t count)
+	{
+		const __m128 c0 = _mm_load_ps(m);
+		const __m128 c1 = _mm_load_ps(m + 4);
+		const __m128 c2 = _mm_load_ps(m + 8);
+		const __m128 c3 = _mm_load_ps(m + 12);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			__m128 r = _mm_mul_ps(c0, _mm_set1_ps(in[i].x()));
+			r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(in[i].y())));
+			r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(in[i].z())));
+			r = _mm_add_ps(r, c3);
+			StoreVector3f(out[i], r);
+		}
+	}
+#endif
+
+#ifdef SALT_AVX_DISPATCH
+	// two points per iteration, one in each 128 bit lane; no FMA, to
+	// keep the results identical to the scalar code
+	__attribute__((target("avx")))
+	void TransformPointsAVX(const float* m, const Vector3f* in,
+							Vector3f* out, size_t count)
+	{
+		const __m256 c0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m));
+		const __m256 c1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 4));
+		const __m256 c2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 8));
+		const __m256 c3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 12));
+
+		size_t i = 0;
+		for (; i + 1 < count; i += 2)
+		{
+			const Vector3f& a = in[i];
+			const Vector3f& b = in[i + 1];
+
+			__m256 r = _mm256_mul_ps(c0, _mm256_setr_ps(a.x(), a.x(), a.x(), a.x(),
+														b.x(), b.x(), b.x(), b.x()));
+			r = _mm256_add_ps(r, _mm256_mul_ps(c1, _mm256_setr_ps(a.y(), a.y(), a.y(), a.y(),
+																  b.y(), b.y(), b.y(), b.y())));
+			r = _mm256_add_ps(r, _mm256_mul_ps(c2, _mm256_setr_ps(a.z(), a.z(), a.z(), a.z(),
+																  b.z(), b.z(), b.z(), b.z())));
+			r = _mm256_add_ps(r, c3);
+
+			StoreVector3f(out[i], _mm256_castps256_ps128(r));
+			StoreVector3f(out[i + 1], _mm256_extractf128_ps(r, 1));
+		}
+
+		if (i < count)
+		{
+			TransformPointsSSE(m, in + i, out + i, count - i);
+		}
+	}
+#endif
+
+	// returns the best level the CPU supports
+	Matrix::ESimdLevel GetSupportedSimdLevel()
+	{
+#ifdef SALT_AVX_DISPATCH
+		if (__builtin_cpu_supports("avx"))
+		{
+			return Matrix::SL_AVX;
+		}
+#endif
+#ifdef SALT_SSE
+		return Matrix::SL_SSE;
+#else
+		return Matrix::SL_SCALAR;
+#endif
+	}
+
+	TTransformPoints GetTransformPoints(Matrix::ESimdLevel level)
+	{
+		switch (level)
+		{
+#ifdef SALT_AVX_DISPATCH
+		case Matrix::SL_AVX:
+			return TransformPointsAVX;
+#endif
+#ifdef SALT_SSE
+		case Matrix::SL_SSE:
+			return TransformPointsSSE;
+#endif
+		default:
+			return TransformPointsScalar;
+		}
+	}
+
+	// the selected batch routines; set up on first use, so that they
+	// can be used during static initialization
+	struct SimdDispatch
+	{
+		Matrix::ESimdLevel level;
+		TTransformPoints transformPoints;
+
+		SimdDispatch() { Select(GetSupportedSimdLevel()); }
+
+		void Select(Matrix::ESimdLevel newLevel)
+		{
+			level = newLevel;
+			transformPoints = GetTransformPoints(level);
+		}
+	};
+
+	SimdDispatch& GetDispatch()
+	{
+		static SimdDispatch dispatch;
+		return dispatch;
+	}
+}
+
 float Matrix::mIdentity[16]=
 {
 	1.0, 0.0, 0.0, 0.0,
@@ -156,6 +300,24 @@ void Matrix::CalcSpotLight(const Matrix &lightWorldTransform, float fov, float w
 	*this *= scale * proj * space;
 }
 
+void Matrix::TransformPoints(const Vector3f* in, Vector3f* out, size_t count) const
+{
+	GetDispatch().transformPoints(m, in, out, count);
+}
+
+Matrix::ESimdLevel Matrix::GetSimdLevel()
+{
+	return GetDispatch().level;
+}
+
+Matrix::ESimdLevel Matrix::SetSimdLevel(ESimdLevel level)
+{
+	ESimdLevel supported = GetSupportedSimdLevel();
+	GetDispatch().Select((level < supported) ? level : supported);
+
+	return GetDispatch().level;
+}
+
 bool Matrix::IsEqual(const Matrix& matrix) const
 {
 	for (int i=0; i<16; ++i)
@@ -24,19 +24,37 @@
 
 #include "salt_defines.h"
 #include "vector.h"
+#include <cstddef>
 #include <memory.h>
 
+#ifdef SALT_SSE
+#include <emmintrin.h>
+#endif
+
 namespace salt
 {
 
 /** Matrix provides a 4x4 float Matrix along with methods to set
   *     up and manipulate it.
+  *
+  *     The values are stored column major and 16 byte aligned, so that
+  *     each column can be loaded into one SSE register. The SSE code
+  *     paths add the products in the same order as the scalar code, so
+  *     both give bit identical results.
   */
 class SALT_API Matrix
 {
 public:
+    /** the instruction sets used by the batch routines */
+    enum ESimdLevel
+        {
+            SL_SCALAR = 0,
+            SL_SSE = 1,
+            SL_AVX = 2
+        };
+
     /** the values of the matrix */
-    float m[16];
+    alignas(16) float m[16];
 
     /** do nothing constructor, the matrix values are undefined for performance reasons*/
     f_inline Matrix(){}
@@ -144,6 +162,23 @@ public:
 
     /** inverse rotates the matrix by inVector */
     f_inline Vector3f   InverseRotate(const Vector3f & inVector) const;
+
+    /** applies the matrix to count points, i.e. out[i] =
+        Transform(in[i]). in and out may be the same array
+    */
+    void TransformPoints(const Vector3f* in, Vector3f* out, size_t count) const;
+
+    /** returns the instruction set used by the batch routines; it is
+        selected at startup from what the CPU supports
+    */
+    static ESimdLevel GetSimdLevel();
+
+    /** selects the instruction set of the batch routines, e.g. to
+        compare them in tests. Returns the level in effect, which is
+        lower if the CPU doesn't support the requested one
+    */
+    static ESimdLevel SetSimdLevel(ESimdLevel level);
+
     // special lighting matrices
 
     /** sets up an attenuation matrix without rotation */
@@ -416,9 +451,28 @@ f_inline const Matrix Matrix::operator*(const Matrix & inRHS) const
 {
     Matrix r;
 
+#ifdef SALT_SSE
+    // each column of the result is a combination of the columns of
+    // this matrix, summed up in the same order as below
+    const __m128 c0 = _mm_load_ps(m);
+    const __m128 c1 = _mm_load_ps(m + 4);
+    const __m128 c2 = _mm_load_ps(m + 8);
+    const __m128 c3 = _mm_load_ps(m + 12);
+
+    for (int j=0; j<4; j++)
+        {
+            const float* b = inRHS.m + j*4;
+            __m128 col = _mm_mul_ps(c0, _mm_set1_ps(b[0]));
+            col = _mm_add_ps(col, _mm_mul_ps(c1, _mm_set1_ps(b[1])));
+            col = _mm_add_ps(col, _mm_mul_ps(c2, _mm_set1_ps(b[2])));
+            col = _mm_add_ps(col, _mm_mul_ps(c3, _mm_set1_ps(b[3])));
+            _mm_store_ps(r.m + j*4, col);
+        }
+#else
     for (int i=0; i<4; i++)
         for (int j=0; j<4; j++)
             r(i,j) = El(i,0)*inRHS(0,j)+El(i,1)*inRHS(1,j)+El(i,2)*inRHS(2,j)+El(i,3)*inRHS(3,j);
+#endif
 
     return r;
 }
@@ -66,6 +66,22 @@ void SharedLibrary::Close()
         }
 }
 
+std::string SharedLibrary::GetFileName(void* address)
+{
+        HMODULE module = NULL;
+        char fileName[MAX_PATH];
+
+        if (! ::GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
+                                   GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                                   (LPCSTR)address, &module) ||
+            ::GetModuleFileNameA(module, fileName, MAX_PATH) == 0)
+        {
+                return std::string();
+        }
+
+        return fileName;
+}
+
 #else
 
 bool
@@ -137,6 +153,18 @@ SharedLibrary::Close()
     }
 }
 
+std::string
+SharedLibrary::GetFileName(void* address)
+{
+    Dl_info info;
+    if (address == 0 || ::dladdr(address, &info) == 0 || info.dli_fname == 0)
+    {
+        return std::string();
+    }
+
+    return info.dli_fname;
+}
+
 #endif // WIN32
 
 const std::string&
@@ -77,6 +77,12 @@ public:
     /** returns the name of the library */
     const std::string& GetName() const;
 
+    /** returns the file name of the loaded library that contains
+     *  address, e.g. of a function returned by GetProcAddress(), or
+     *  an empty string if it is unknown
+     */
+    static std::string GetFileName(void* address);
+
     //
     // members
     //
@@ -31,11 +31,16 @@
 #include "scriptserver/scriptserver.h"
 #include "randomserver/randomserver.h"
 #include "telnetserver/telnetserver.h"
+#include "startuptrace.h"
 
 #include <salt/path.h>
 #include <salt/sharedlibrary.h>
 #include <signal.h>
 #include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 
@@ -51,6 +56,48 @@ using namespace salt;
 using namespace std;
 using namespace zeitgeist;
 
+namespace
+{
+    /** the class object registered for a class of a lazily imported
+        bundle, until the bundle is loaded. It knows the base classes
+        of the real class, so SupportsClass() answers as the real
+        class would; it has no functions */
+    class LazyClass : public Class
+    {
+    public:
+        LazyClass(const std::string& name, const std::string& bundleName,
+                  const TStringList& baseClasses)
+            : Class(name), mBundleName(bundleName)
+        {
+            mBaseClasses = baseClasses;
+        }
+
+        const std::string& GetBundleName() const { return mBundleName; }
+
+    private:
+        void DefineClass() {}
+
+    protected:
+        std::string mBundleName;
+    };
+
+    /** reads size and modification time of a file */
+    bool StatFile(const std::string& fileName, long long& size, long long& mtime)
+    {
+        struct stat st;
+        if (stat(fileName.c_str(), &st) != 0)
+            {
+                return false;
+            }
+
+        size = st.st_size;
+        mtime = st.st_mtime;
+        return true;
+    }
+
+    const char* MANIFEST_HEADER = "# zeitgeist bundle manifest 2";
+}
+
 // -------- struct Core::CacheKey
 
 bool Core::CacheKey::operator == (const CacheKey& key) const
@@ -255,6 +302,21 @@ Core::New(const std::string& className)
     // here we will store our created instance
     std::shared_ptr<Object> instance;
 
+    // the class of a lazily imported bundle: load the bundle, which
+    // replaces the stub with the real class object
+    std::shared_ptr<LazyClass> stub = std::dynamic_pointer_cast<LazyClass>(theClass);
+    if (stub.get() != 0)
+        {
+            const std::string bundleName = stub->GetBundleName();
+            stub.reset();
+            theClass.reset();
+
+            std::lock_guard<std::recursive_mutex> guard(mBundleMutex);
+            LoadBundle(bundleName);
+            theClass = std::dynamic_pointer_cast<Class>
+                (context->Get("/classes/"+className));
+        }
+
     if (theClass.get() == 0)
         {
             mLogServer->Error() << "(Core::New) unkown class '"
@@ -294,26 +356,67 @@ void Core::AddLibraryLocation(const std::string &path)
 
 bool Core::ImportBundle(const std::string& bundleName)
 {
-    TBundleMap::const_iterator iter = mBundles.find(bundleName);
-    if (iter != mBundles.end())
+    std::lock_guard<std::recursive_mutex> guard(mBundleMutex);
+
+    if (
+        (mBundles.find(bundleName) != mBundles.end()) ||
+        (mLazyBundles.find(bundleName) != mLazyBundles.end())
+        )
         {
             // already imported
             return true;
         }
 
+    StartupTrace::Span span("bundle", bundleName);
+
+    if (ImportLazyBundle(bundleName))
+        {
+            return true;
+        }
+
     std::shared_ptr<SharedLibrary> bundle(new SharedLibrary());
-    if (!bundle->Open(bundleName, mLibraryLocations))
+
+    {
+        StartupTrace::Span openSpan("dlopen", bundleName);
+        if (!bundle->Open(bundleName, mLibraryLocations))
+            {
+                mLogServer->Error() << "(Core) ERROR: Could not open '"
+                                    << bundleName << "'" << endl;
+                return false;
+            }
+    }
+
+    return RegisterBundle(bundleName, bundle);
+}
+
+bool Core::ImportBundles(const std::vector<std::string>& bundleNames)
+{
+    // the bundles are opened one after the other: the static
+    // initializers of a bundle may register with other bundles or the
+    // class hierarchy, which is not safe to do concurrently
+    bool ok = true;
+
+    for (
+         std::vector<std::string>::const_iterator iter = bundleNames.begin();
+         iter != bundleNames.end();
+         ++iter
+         )
         {
-            mLogServer->Error() << "(Core) ERROR: Could not open '"
-                                << bundleName << "'" << endl;
-            return false;
+            ok = ImportBundle(*iter) && ok;
         }
 
+    return ok;
+}
+
+bool Core::RegisterBundle(const std::string& bundleName,
+                          const std::shared_ptr<SharedLibrary>& bundle)
+{
     std::list <std::shared_ptr<Class> > classes;
     void(*Zeitgeist_RegisterBundle)(std::list <std::shared_ptr<Class> > &) = NULL;
 
+    void* entryPoint = bundle->GetProcAddress("Zeitgeist_RegisterBundle");
     Zeitgeist_RegisterBundle = (void(*)(std::list <std::shared_ptr<Class> > &))
-        bundle->GetProcAddress("Zeitgeist_RegisterBundle");
+        entryPoint;
 
     if (Zeitgeist_RegisterBundle == NULL)
         {
@@ -323,6 +426,20 @@ bool Core::ImportBundle(const std::string& bundleName)
 
     Zeitgeist_RegisterBundle(classes);
 
+    BundleInfo info;
+    std::set<std::string> baseClasses;
+    for (
+         std::list<std::shared_ptr<Class> >::const_iterator iter = classes.begin();
+         iter != classes.end();
+         ++iter
+         )
+        {
+            const Class::TStringList& bases = (*iter)->GetBaseClasses();
+            info.classes.push_back((*iter)->GetName());
+            info.baseClasses[(*iter)->GetName()] = bases;
+            baseClasses.insert(bases.begin(), bases.end());
+        }
+
     bool usingClass = false;
     while(!classes.empty())
         {
@@ -340,9 +457,276 @@ bool Core::ImportBundle(const std::string& bundleName)
     if (usingClass)
         mBundles[bundleName] = bundle;
 
+    // the functions of a class are looked up along its base classes;
+    // load the lazily imported bundles of the base classes, so that
+    // the lookup never ends at a stub
+    std::shared_ptr<Leaf> classDir = Get("/classes");
+    for (
+         std::set<std::string>::const_iterator base = baseClasses.begin();
+         base != baseClasses.end();
+         ++base
+         )
+        {
+            std::shared_ptr<LazyClass> stub =
+                std::dynamic_pointer_cast<LazyClass>(Get(*base, classDir));
+
+            if (stub.get() != 0)
+                {
+                    LoadBundle(stub->GetBundleName());
+                }
+        }
+
+    // remember the classes for the next lazy import
+    if (mBundleManifestFile.empty())
+        {
+            return true;
+        }
+
+    info.fileName = SharedLibrary::GetFileName(entryPoint);
+    if (info.fileName.empty() || ! StatFile(info.fileName, info.size, info.mtime))
+        {
+            return true;
+        }
+
+    const BundleInfo& known = mBundleManifest[bundleName];
+    if (
+        (known.fileName != info.fileName) ||
+        (known.size != info.size) ||
+        (known.mtime != info.mtime) ||
+        (known.classes != info.classes) ||
+        (known.baseClasses != info.baseClasses)
+        )
+        {
+            mBundleManifest[bundleName] = info;
+            WriteBundleManifest();
+        }
+
     return true;
 }
 
+bool Core::ImportLazyBundle(const std::string& bundleName)
+{
+    if (mBundleManifestFile.empty())
+        {
+            return false;
+        }
+
+    TBundleManifest::const_iterator iter = mBundleManifest.find(bundleName);
+    if (iter == mBundleManifest.end())
+        {
+            return false;
+        }
+
+    // the bundle must be unchanged since its classes were recorded
+    const BundleInfo& info = iter->second;
+    long long size = 0;
+    long long mtime = 0;
+
+    if (
+        (info.classes.empty()) ||
+        (! StatFile(info.fileName, size, mtime)) ||
+        (size != info.size) ||
+        (mtime != info.mtime)
+        )
+        {
+            return false;
+        }
+
+    TClassList& stubs = mLazyBundles[bundleName];
+
+    for (
+         std::list<std::string>::const_iterator name = info.classes.begin();
+         name != info.classes.end();
+         ++name
+         )
+        {
+            if (ExistsClass(*name))
+                {
+                    continue;
+                }
+
+            TBaseClassMap::const_iterator bases = info.baseClasses.find(*name);
+            std::shared_ptr<Class> stub
+                (new LazyClass(*name, bundleName,
+                               (bases == info.baseClasses.end()) ?
+                               Class::TStringList() : bases->second));
+            if (RegisterClassObject(stub, ""))
+                {
+                    stubs.push_back(stub);
+                }
+        }
+
+    mLogServer->Debug() << "(Core) imported bundle '" << bundleName
+                        << "' lazily\n";
+
+    return true;
+}
+
+bool Core::LoadBundle(const std::string& bundleName)
+{
+    std::lock_guard<std::recursive_mutex> guard(mBundleMutex);
+
+    if (mBundles.find(bundleName) != mBundles.end())
+        {
+            return true;
+        }
+
+    TLazyBundleMap::iterator iter = mLazyBundles.find(bundleName);
+    if (iter == mLazyBundles.end())
+        {
+            return false;
+        }
+
+    // remove the stubs, the bundle registers the real class objects
+    for (
+         TClassList::iterator stub = iter->second.begin();
+         stub != iter->second.end();
+         ++stub
+         )
+        {
+            (*stub)->Unlink();
+        }
+
+    mLazyBundles.erase(iter);
+
+    mLogServer->Debug() << "(Core) loading bundle '" << bundleName
+                        << "' on first use\n";
+
+    StartupTrace::Span span("bundle", bundleName + " (on first use)");
+
+    std::shared_ptr<SharedLibrary> bundle(new SharedLibrary());
+    if (!bundle->Open(bundleName, mLibraryLocations))
+        {
+            mLogServer->Error() << "(Core) ERROR: Could not open '"
+                                << bundleName << "'" << endl;
+            return false;
+        }
+
+    return RegisterBundle(bundleName, bundle);
+}
+
+void Core::SetBundleManifest(const std::string& fileName)
+{
+    mBundleManifestFile = fileName;
+    mBundleManifest.clear();
+
+    if (! fileName.empty())
+        {
+            ReadBundleManifest();
+        }
+}
+
+void Core::ReadBundleManifest()
+{
+    std::ifstream ifs(mBundleManifestFile.c_str());
+    std::string line;
+
+    if (! getline(ifs, line) || line != MANIFEST_HEADER)
+        {
+            return;
+        }
+
+    // tab separated lines: 'bundle name size mtime file', followed
+    // by one line 'class name base...' per class of the bundle
+    BundleInfo* current = 0;
+
+    while (getline(ifs, line))
+        {
+            std::vector<std::string> fields;
+            std::stringstream ss(line);
+            std::string field;
+
+            while (getline(ss, field, '\t'))
+                {
+                    fields.push_back(field);
+                }
+
+            if (fields.size() == 5 && fields[0] == "bundle")
+                {
+                    current = &mBundleManifest[fields[1]];
+                    current->size = atoll(fields[2].c_str());
+                    current->mtime = atoll(fields[3].c_str());
+                    current->fileName = fields[4];
+                } else if (fields.size() >= 2 && fields[0] == "class" && current != 0)
+                {
+                    current->classes.push_back(fields[1]);
+                    current->baseClasses[fields[1]].assign
+                        (fields.begin() + 2, fields.end());
+                }
+        }
+}
+
+void Core::WriteBundleManifest() const
+{
+    // write a private temporary file and rename it, as several
+    // servers may start at the same time
+    std::stringstream tmpName;
+    tmpName << mBundleManifestFile << "." << getpid() << ".tmp";
+
+    {
+        std::ofstream ofs(tmpName.str().c_str(), std::ios::trunc);
+        ofs << MANIFEST_HEADER << "\n";
+
+        for (
+             TBundleManifest::const_iterator iter = mBundleManifest.begin();
+             iter != mBundleManifest.end();
+             ++iter
+             )
+            {
+                const BundleInfo& info = iter->second;
+                if (info.fileName.empty())
+                    {
+                        continue;
+                    }
+
+                ofs << "bundle\t" << iter->first << "\t" << info.size
+                    << "\t" << info.mtime << "\t" << info.fileName << "\n";
+
+                for (
+                     std::list<std::string>::const_iterator name = info.classes.begin();
+                     name != info.classes.end();
+                     ++name
+                     )
+                    {
+                        ofs << "class\t" << *name;
+
+                        TBaseClassMap::const_iterator bases =
+                            info.baseClasses.find(*name);
+                        if (bases != info.baseClasses.end())
+                            {
+                                for (
+                                     std::list<std::string>::const_iterator base = bases->second.begin();
+                                     base != bases->second.end();
+                                     ++base
+                                     )
+                                    {
+                                        ofs << "\t" << *base;
+                                    }
+                            }
+
+                        ofs << "\n";
+                    }
+            }
+
+        if (! ofs)
+            {
+                remove(tmpName.str().c_str());
+                return;
+            }
+    }
+
+#ifdef WIN32
+    remove(mBundleManifestFile.c_str());
+#endif
+
+    if (rename(tmpName.str().c_str(), mBundleManifestFile.c_str()) != 0)
+        {
+            remove(tmpName.str().c_str());
+            mLogServer->Debug() << "(Core) cannot write bundle manifest '"
+                                << mBundleManifestFile << "'\n";
+        }
+}
+
 const std::shared_ptr<FileServer>& Core::GetFileServer() const
 {
     return mFileServer;
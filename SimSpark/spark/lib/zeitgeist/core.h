@@ -28,6 +28,7 @@
 #include <map>
 #include <set>
 #include <memory>
+#include <mutex>
 #include "zeitgeist_defines.h"
 
 namespace salt
@@ -196,6 +197,35 @@ protected:
     typedef std::pair<std::string, std::shared_ptr<salt::SharedLibrary> > TBundlePair;
     typedef std::map<std::string, std::shared_ptr<salt::SharedLibrary> > TBundleMap;
 
+    /** TBaseClassMap maps a class name to the names of its base classes */
+    typedef std::map<std::string, std::list<std::string> > TBaseClassMap;
+
+    /** BundleInfo is the entry of a bundle in the bundle manifest */
+    struct BundleInfo
+    {
+        /** the file the bundle was loaded from */
+        std::string fileName;
+
+        /** size and modification time of the file */
+        long long size;
+        long long mtime;
+
+        /** the names of the classes the bundle exports */
+        std::list<std::string> classes;
+
+        /** the base classes of the exported classes */
+        TBaseClassMap baseClasses;
+
+        BundleInfo() : size(0), mtime(0) {}
+    };
+
+    typedef std::map<std::string, BundleInfo> TBundleManifest;
+
+    /** TLazyBundleMap holds the stub class objects of the bundles
+        that are imported but not loaded yet */
+    typedef std::list<std::shared_ptr<Class> > TClassList;
+    typedef std::map<std::string, TClassList> TLazyBundleMap;
+
     //
     // functions
     //
@@ -250,6 +280,22 @@ public:
      */
     bool ImportBundle(const std::string& bundleName);
 
+    /** imports several bundles in the given order */
+    bool ImportBundles(const std::vector<std::string>& bundleNames);
+
+    /** enables lazy bundle import. The classes of each loaded bundle
+     *  are recorded in the manifest file \param fileName. When a
+     *  bundle is imported again, e.g. on the next start, and its file
+     *  did not change, only stub class objects are registered; the
+     *  bundle is loaded when one of its classes is instantiated for
+     *  the first time. An empty file name disables lazy import.
+     */
+    void SetBundleManifest(const std::string& fileName);
+
+    /** loads a lazily imported bundle now; returns true if the bundle
+     *  is loaded */
+    bool LoadBundle(const std::string& bundleName);
+
     /** returns a reference to the FileServer */
     const std::shared_ptr<FileServer>& GetFileServer() const;
 
@@ -322,6 +368,21 @@ protected:
     std::shared_ptr<Leaf> GetInternal(const std::string &pathStr,
                                         const std::shared_ptr<Leaf>& base);
 
+    /** registers the classes of the opened bundle \param bundle and
+        records them in the bundle manifest
+    */
+    bool RegisterBundle(const std::string& bundleName,
+                        const std::shared_ptr<salt::SharedLibrary>& bundle);
+
+    /** registers stub class objects for the bundle if the bundle
+        manifest has a valid entry for it, returns true on success
+    */
+    bool ImportLazyBundle(const std::string& bundleName);
+
+    /** reads and writes the bundle manifest file */
+    void ReadBundleManifest();
+    void WriteBundleManifest() const;
+
     /** signal handler */
     static void CatchSignal(int sig_num);
 
@@ -386,6 +447,20 @@ private:
 
     /** a list of library locations */
     std::vector<std::string> mLibraryLocations;
+
+    /** the bundle manifest file; empty if bundles are loaded on import */
+    std::string mBundleManifestFile;
+
+    /** the bundle manifest, i.e. the classes of each known bundle */
+    TBundleManifest mBundleManifest;
+
+    /** the stub class objects of lazily imported bundles */
+    TLazyBundleMap mLazyBundles;
+
+    /** serializes opening bundles; a lazily imported bundle may be
+        loaded by the first thread that creates an instance of one of
+        its classes */
+    std::recursive_mutex mBundleMutex;
 };
 
 } //namespace zeitgeist
@@ -21,53 +21,148 @@
 */
 #include "logserver.h"
 #include "logserverstreambuf.h"
+#include <sstream>
 #include <stdarg.h>
 
 using namespace std;
 using namespace zeitgeist;
 
+namespace
+{
+    // the serial number of the next LogServer instance
+    std::atomic<int> nextSerial(1);
+
+    // the LogStream of the calling thread, cached for the LogServer
+    // with the given serial number; the LogServer owns the stream
+    thread_local int cachedSerial = 0;
+    thread_local LogStream* cachedStream = 0;
+}
+
 LogServer::LogServer(unsigned int size) :
-    Node(), ostream(new LogServerStreamBuf(size))
+    Node(),
+    mStreamBuf(new LogServerStreamBuf(size)),
+    mStreamMask(0),
+    mSerial(nextSerial.fetch_add(1)),
+    mPosted(0),
+    mWritten(0),
+    mStopSink(false),
+    mSyncErrors(false),
+    mRepeatLimit(10),
+    mRepeatPeriod(1.0f)
 {
+    mSinkThread = std::thread(&LogServer::Run, this);
 }
 
 LogServer::~LogServer()
 {
-    flush();
+    // hand over the text that is still pending in the LogStreams
+    {
+        std::lock_guard<std::mutex> lock(mThreadMutex);
+        for (
+             vector<std::unique_ptr<LogStream> >::iterator iter =
+                 mThreadStreams.begin();
+             iter != mThreadStreams.end();
+             ++iter
+             )
+        {
+            (*iter)->Commit(true);
+        }
+    }
+
+    // the sink writes all queued records before it stops
+    {
+        std::lock_guard<std::mutex> lock(mQueueMutex);
+        mStopSink = true;
+    }
+    mQueueCond.notify_one();
+
+    if (mSinkThread.joinable())
+    {
+        mSinkThread.join();
+    }
 
-    // delete the created streambuf
-    delete rdbuf();
+    mThreadStreamMap.clear();
+    mThreadStreams.clear();
 }
 
 void LogServer::AddStream(std::ostream* stream, unsigned int mask, bool syncStream)
 {
-    GetStreamBuf().AddStream(stream, mask, syncStream);
+    std::lock_guard<std::mutex> lock(mStreamMutex);
+    mStreamBuf->AddStream(stream, mask, syncStream);
+    UpdateStreamMask();
 }
 
 bool LogServer::RemoveStream(const std::ostream* stream)
 {
-    return GetStreamBuf().RemoveStream(stream);
+    Flush();
+
+    std::lock_guard<std::mutex> lock(mStreamMutex);
+    bool removed = mStreamBuf->RemoveStream(stream);
+    UpdateStreamMask();
+    return removed;
 }
 
 void LogServer::RemoveAllStreams()
 {
-    return GetStreamBuf().RemoveAllStreams();
+    Flush();
+
+    std::lock_guard<std::mutex> lock(mStreamMutex);
+    mStreamBuf->RemoveAllStreams();
+    UpdateStreamMask();
 }
 
 unsigned int LogServer::GetPriorityMask(const std::ostream* stream) const
 {
-    return GetStreamBuf().GetPriorityMask(stream);
+    std::lock_guard<std::mutex> lock(mStreamMutex);
+    return mStreamBuf->GetPriorityMask(stream);
 }
 
 bool LogServer::SetPriorityMask(const std::ostream* stream, unsigned int mask)
 {
-    return GetStreamBuf().SetPriorityMask(stream, mask);
+    Flush();
+
+    std::lock_guard<std::mutex> lock(mStreamMutex);
+    bool found = mStreamBuf->SetPriorityMask(stream, mask);
+    UpdateStreamMask();
+    return found;
+}
+
+void LogServer::UpdateStreamMask()
+{
+    mStreamMask.store(mStreamBuf->GetMaskUnion(), std::memory_order_relaxed);
 }
 
-LogServer& LogServer::Priority(unsigned int prio)
+LogStream& LogServer::GetThreadStream()
 {
-    GetStreamBuf().SetCurrentPriority(prio);
-    return *this;
+    if (cachedSerial == mSerial)
+    {
+        return *cachedStream;
+    }
+
+    // the cache holds another LogServer, or this is the first
+    // message of this thread
+    LogStream* stream = 0;
+    {
+        std::lock_guard<std::mutex> lock(mThreadMutex);
+        LogStream*& entry = mThreadStreamMap[std::this_thread::get_id()];
+        if (entry == 0)
+        {
+            entry = new LogStream(*this);
+            mThreadStreams.push_back(std::unique_ptr<LogStream>(entry));
+        }
+        stream = entry;
+    }
+
+    cachedSerial = mSerial;
+    cachedStream = stream;
+    return *stream;
+}
+
+LogStream& LogServer::Priority(unsigned int prio)
+{
+    LogStream& stream = GetThreadStream();
+    stream.SetPriority(prio, IsEnabled(prio));
+    return stream;
 }
 
 void
@@ -82,18 +177,203 @@ LogServer::Printf(const char *inFormat, ...)
         copyBuffer[size-1] = 0;
     }
     va_end(args);
-    (*this) << copyBuffer;
-    this->flush();
+
+    LogStream& stream = Priority(eNormal);
+    stream << copyBuffer;
+    stream.flush();
 }
 
-const LogServerStreamBuf& LogServer::GetStreamBuf() const
+void LogServer::Post(unsigned int priority, std::string& text)
 {
-    LogServerStreamBuf* streamBuf = (LogServerStreamBuf*)(rdbuf());
-    return *streamBuf;
+    std::unique_lock<std::mutex> lock(mQueueMutex);
+
+    if (mStopSink)
+    {
+        // the sink is shutting down, write directly
+        lock.unlock();
+        std::lock_guard<std::mutex> streamLock(mStreamMutex);
+        Forward(priority, text);
+        mStreamBuf->pubsync();
+        text.clear();
+        return;
+    }
+
+    mQueue.push_back(Record());
+    mQueue.back().priority = priority;
+    mQueue.back().text.swap(text);
+    unsigned long long id = ++mPosted;
+
+    mQueueCond.notify_one();
+
+    // errors are often followed by an exit, don't lose them
+    if (
+        (priority & eError) &&
+        mSyncErrors.load(std::memory_order_relaxed)
+        )
+    {
+        mWrittenCond.wait(lock, [this, id] { return mWritten >= id; });
+    }
+}
+
+void LogServer::Flush()
+{
+    std::unique_lock<std::mutex> lock(mQueueMutex);
+
+    unsigned long long id = mPosted;
+    mWrittenCond.wait
+        (lock, [this, id] { return (mWritten >= id) || mStopSink; });
+}
+
+void LogServer::SetSyncErrors(bool sync)
+{
+    mSyncErrors.store(sync);
+}
+
+void LogServer::SetRepeatLimit(unsigned int limit, float period)
+{
+    mRepeatLimit.store(limit);
+    mRepeatPeriod.store(period);
+}
+
+void LogServer::Run()
+{
+    std::unique_lock<std::mutex> lock(mQueueMutex);
+
+    for (;;)
+    {
+        // wake up regularly to report dropped repetitions
+        mQueueCond.wait_for
+            (lock, std::chrono::seconds(1),
+             [this] { return mStopSink || (! mQueue.empty()); });
+
+        std::deque<Record> records;
+        records.swap(mQueue);
+        bool stop = mStopSink && records.empty();
+
+        lock.unlock();
+        {
+            std::lock_guard<std::mutex> streamLock(mStreamMutex);
+
+            for (
+                 std::deque<Record>::const_iterator iter = records.begin();
+                 iter != records.end();
+                 ++iter
+                 )
+            {
+                Write(*iter);
+            }
+
+            ReportRepeats(stop);
+
+            mStreamBuf->pubsync();
+            mStreamBuf->SyncStreams();
+        }
+        lock.lock();
+
+        mWritten += records.size();
+        mWrittenCond.notify_all();
+
+        if (stop)
+        {
+            break;
+        }
+    }
+}
+
+void LogServer::Write(const Record& record)
+{
+    unsigned int limit = mRepeatLimit.load();
+    if (
+        (limit == 0) ||
+        ((record.priority & (eWarning | eError)) == 0)
+        )
+    {
+        Forward(record.priority, record.text);
+        return;
+    }
+
+    std::chrono::steady_clock::time_point now =
+        std::chrono::steady_clock::now();
+
+    TRepeatMap::iterator iter = mRepeats.find(record.text);
+    if (iter == mRepeats.end())
+    {
+        RepeatInfo info;
+        info.periodStart = now;
+        info.priority = record.priority;
+        info.count = 0;
+        info.dropped = 0;
+        iter = mRepeats.insert(TRepeatMap::value_type(record.text, info)).first;
+    }
+
+    RepeatInfo& info = (*iter).second;
+    if (
+        std::chrono::duration<float>(now - info.periodStart).count() >
+        mRepeatPeriod.load()
+        )
+    {
+        ReportDropped((*iter).first, info);
+
+        info.periodStart = now;
+        info.count = 0;
+        info.dropped = 0;
+    }
+
+    if (++info.count > limit)
+    {
+        ++info.dropped;
+        return;
+    }
+
+    Forward(record.priority, record.text);
+}
+
+void LogServer::ReportRepeats(bool all)
+{
+    std::chrono::steady_clock::time_point now =
+        std::chrono::steady_clock::now();
+    float period = mRepeatPeriod.load();
+
+    TRepeatMap::iterator iter = mRepeats.begin();
+    while (iter != mRepeats.end())
+    {
+        const RepeatInfo& info = (*iter).second;
+        if (
+            (! all) &&
+            (std::chrono::duration<float>(now - info.periodStart).count()
+             <= period)
+            )
+        {
+            ++iter;
+            continue;
+        }
+
+        ReportDropped((*iter).first, info);
+
+        mRepeats.erase(iter++);
+    }
+}
+
+void LogServer::ReportDropped(const std::string& text, const RepeatInfo& info)
+{
+    if (info.dropped == 0)
+    {
+        return;
+    }
+
+    std::ostringstream ss;
+    ss << "(LogServer) dropped " << info.dropped
+       << " repetitions of: " << text;
+    if (text.empty() || (text[text.size() - 1] != '\n'))
+    {
+        ss << '\n';
+    }
+
+    Forward(info.priority, ss.str());
 }
 
-LogServerStreamBuf& LogServer::GetStreamBuf()
+void LogServer::Forward(unsigned int priority, const std::string& text)
 {
-    LogServerStreamBuf* streamBuf = (LogServerStreamBuf*)(rdbuf());
-    return *streamBuf;
+    mStreamBuf->SetCurrentPriority(priority);
+    mStreamBuf->sputn(text.data(), text.size());
 }
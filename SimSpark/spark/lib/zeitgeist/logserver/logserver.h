@@ -30,8 +30,19 @@
 #ifndef ZEITGEIST_LOGSERVER_H
 #define ZEITGEIST_LOGSERVER_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 #include "../node.h"
+#include "logstream.h"
 
 namespace zeitgeist
 {
@@ -41,8 +52,21 @@ class LogServerStreamBuf;
 /** The log server is responsible for holding a bunch of ostreams,
     which data can be streamed to. It is THE logging facility used
     within zeitgeist.
+
+    Messages are written with GetLog()->Normal() << ... and the
+    like. Each thread streams into its own LogStream; the priority is
+    checked against the priority masks of all streams first, so
+    suppressed messages are not formatted at all. Completed records
+    are queued and written to the streams by a sink thread. Records
+    that are still queued are written when the LogServer is destroyed;
+    with SetSyncErrors(true) error records are written before Post()
+    returns.
+
+    The sink drops a warning or error that is repeated more than
+    mRepeatLimit times within mRepeatPeriod and reports the number of
+    dropped repetitions later.
 */
-class ZEITGEIST_API LogServer : public Node , public std::ostream
+class ZEITGEIST_API LogServer : public Node
 {
     // types
     //
@@ -61,6 +85,25 @@ public:
         eAll     = 0xffffffff
     };
 
+protected:
+    /** a completed message */
+    struct Record
+    {
+        unsigned int priority;
+        std::string text;
+    };
+
+    /** the repetition state of a warning or error text */
+    struct RepeatInfo
+    {
+        std::chrono::steady_clock::time_point periodStart;
+        unsigned int priority;
+        unsigned int count;
+        unsigned int dropped;
+    };
+
+    typedef std::map<std::string, RepeatInfo> TRepeatMap;
+
     //
     // functions
     //
@@ -104,39 +147,132 @@ public:
     */
     unsigned int GetPriorityMask(const std::ostream *stream) const;
 
+    /** returns true if any stream accepts messages of priority prio */
+    bool IsEnabled(unsigned int prio) const
+    { return (mStreamMask.load(std::memory_order_relaxed) & prio) != 0; }
+
     /** selects the priority for the messages to be written. It
-        returns a reference to this logserver instance, allowing
-        multiple priority changes in one stream expression,
-        e.g. log << Priority(eNormal) << "normal msg" <<
-        Priority(eDbug) << "debug msg"
+        returns the LogStream of the calling thread, e.g.
+        log->Priority(eNormal) << "normal msg" << std::endl
     */
-    LogServer& Priority(unsigned int prio);
+    LogStream& Priority(unsigned int prio);
 
-    /** selects the debug priority and returns a reference to this
-        logserver */
-    LogServer& Debug()    { return Priority(eDebug); }
+    /** selects the debug priority and returns the LogStream of the
+        calling thread */
+    LogStream& Debug()    { return Priority(eDebug); }
 
-    /** selects the normal priority and returns a reference to this
-        logserver */
-    LogServer& Normal()   { return Priority(eNormal); }
+    /** selects the normal priority and returns the LogStream of the
+        calling thread */
+    LogStream& Normal()   { return Priority(eNormal); }
 
-    /** selects the warning priority and returns a reference to this
-        logserver */
-    LogServer& Warning()  { return Priority(eWarning); }
+    /** selects the warning priority and returns the LogStream of the
+        calling thread */
+    LogStream& Warning()  { return Priority(eWarning); }
 
-    /** selects the error priority and returns a reference to this
-        logserver */
-    LogServer& Error()    { return Priority(eError); }
+    /** selects the error priority and returns the LogStream of the
+        calling thread */
+    LogStream& Error()    { return Priority(eError); }
 
     /** provides an printf-style interface. */
     void Printf(const char *inFormat, ...);
 
+    /** queues a record for the sink thread; text is moved out. Called
+        by the LogStreams
+    */
+    void Post(unsigned int priority, std::string& text);
+
+    /** waits until all queued records are written */
+    void Flush();
+
+    /** if sync is true, Post() waits until an error record is
+        written, so it survives an exit right after it; off by default
+    */
+    void SetSyncErrors(bool sync);
+
+    /** sets how often a warning or error text is written within a
+        period; a limit of 0 disables rate limiting
+    */
+    void SetRepeatLimit(unsigned int limit, float period);
+
 private:
     LogServer(const LogServer& obj);
     LogServer& operator=(const LogServer& obj);
 
-    const LogServerStreamBuf& GetStreamBuf() const;
-    LogServerStreamBuf& GetStreamBuf();
+    /** returns the LogStream of the calling thread, creating it on
+        first use. The last used stream is cached per thread, threads
+        that log to several LogServers find theirs in
+        mThreadStreamMap */
+    LogStream& GetThreadStream();
+
+    /** updates mStreamMask from the stream buffer; mStreamMutex must
+        be locked */
+    void UpdateStreamMask();
+
+    /** the sink thread */
+    void Run();
+
+    /** writes a record, applying the rate limit */
+    void Write(const Record& record);
+
+    /** writes a message to the streams; mStreamMutex must be locked */
+    void Forward(unsigned int priority, const std::string& text);
+
+    /** reports and forgets the dropped repetitions of the texts whose
+        period is over, or of all texts */
+    void ReportRepeats(bool all);
+
+    /** writes the number of dropped repetitions of text, if any */
+    void ReportDropped(const std::string& text, const RepeatInfo& info);
+
+    // members
+    //
+private:
+    /** multiplexes the written records into the streams */
+    std::unique_ptr<LogServerStreamBuf> mStreamBuf;
+
+    /** protects mStreamBuf */
+    mutable std::mutex mStreamMutex;
+
+    /** the union of the priority masks of all streams */
+    std::atomic<unsigned int> mStreamMask;
+
+    /** identifies the instance in the thread local caches */
+    int mSerial;
+
+    /** protects mThreadStreams and mThreadStreamMap */
+    std::mutex mThreadMutex;
+
+    /** the LogStreams of all threads that logged so far */
+    std::vector<std::unique_ptr<LogStream> > mThreadStreams;
+
+    /** the LogStream of each thread */
+    std::map<std::thread::id, LogStream*> mThreadStreamMap;
+
+    /** protects the queue */
+    std::mutex mQueueMutex;
+
+    /** signals new records to the sink thread */
+    std::condition_variable mQueueCond;
+
+    /** signals written records to Flush() */
+    std::condition_variable mWrittenCond;
+
+    std::deque<Record> mQueue;
+
+    /** the number of records posted and written so far */
+    unsigned long long mPosted;
+    unsigned long long mWritten;
+
+    bool mStopSink;
+
+    /** flag if Post() waits for error records */
+    std::atomic<bool> mSyncErrors;
+    std::thread mSinkThread;
+
+    /** rate limiting state; only used by the sink thread */
+    TRepeatMap mRepeats;
+    std::atomic<unsigned int> mRepeatLimit;
+    std::atomic<float> mRepeatPeriod;
 };
 
 DECLARE_CLASS(LogServer)
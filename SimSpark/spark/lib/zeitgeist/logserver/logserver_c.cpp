@@ -193,6 +193,47 @@ FUNCTION(LogServer,message)
     return true;
 }
 
+FUNCTION(LogServer,setRepeatLimit)
+{
+    int inLimit;
+    float inPeriod;
+
+    if (
+        (in.GetSize() != 2) ||
+        (! in.GetValue(in[0],inLimit)) ||
+        (! in.GetValue(in[1],inPeriod)) ||
+        (inLimit < 0)
+        )
+    {
+        return false;
+    }
+
+    obj->SetRepeatLimit(inLimit, inPeriod);
+    return true;
+}
+
+FUNCTION(LogServer,setSyncErrors)
+{
+    bool inSync;
+
+    if (
+        (in.GetSize() != 1) ||
+        (! in.GetValue(in.begin(),inSync))
+        )
+    {
+        return false;
+    }
+
+    obj->SetSyncErrors(inSync);
+    return true;
+}
+
+FUNCTION(LogServer,flush)
+{
+    obj->Flush();
+    return true;
+}
+
 void CLASS(LogServer)::DefineClass()
 {
     DEFINE_BASECLASS(zeitgeist/Node)
@@ -203,4 +244,7 @@ void CLASS(LogServer)::DefineClass()
     DEFINE_FUNCTION(warning)
     DEFINE_FUNCTION(error)
     DEFINE_FUNCTION(message)
+    DEFINE_FUNCTION(setRepeatLimit)
+    DEFINE_FUNCTION(setSyncErrors)
+    DEFINE_FUNCTION(flush)
 }
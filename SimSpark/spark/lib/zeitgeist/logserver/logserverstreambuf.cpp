@@ -137,6 +137,17 @@ unsigned int LogServerStreamBuf::GetPriorityMask(const std::ostream *stream) con
         return 0;
 }
 
+unsigned int LogServerStreamBuf::GetMaskUnion() const
+{
+        unsigned int mask = 0;
+        TMaskStreams::const_iterator i;
+        for (i=mStreams.begin(); i!= mStreams.end(); ++i)
+        {
+                mask |= i->mMask;
+        }
+        return mask;
+}
+
 void LogServerStreamBuf::SetCurrentPriority(unsigned int priority)
 {
     sync();
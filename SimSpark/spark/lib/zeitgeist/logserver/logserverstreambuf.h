@@ -116,6 +116,11 @@ public:
     */
     unsigned int GetPriorityMask(const std::ostream *stream) const;
 
+    /*! Get the union of the priority masks of all streams, i.e. the
+        priorities that are written to any stream
+    */
+    unsigned int GetMaskUnion() const;
+
     /*! Set the current priority level.
 
         All data which is streamed into the forwarder after this point
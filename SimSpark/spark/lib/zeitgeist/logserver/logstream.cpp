@@ -0,0 +1,110 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2002,2003 Koblenz University
+   Copyright (C) 2004-2009 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#include "logstream.h"
+#include "logserver.h"
+
+using namespace std;
+using namespace zeitgeist;
+
+LogStream::Buffer::int_type LogStream::Buffer::overflow(int_type c)
+{
+    if (c != traits_type::eof())
+    {
+        mText += traits_type::to_char_type(c);
+        if (c == '\n')
+        {
+            mStream.Commit(false);
+        }
+    }
+
+    return traits_type::not_eof(c);
+}
+
+std::streamsize LogStream::Buffer::xsputn(const char* s, std::streamsize n)
+{
+    mText.append(s, n);
+
+    // only look for a line end in the new text
+    if (traits_type::find(s, n, '\n') != 0)
+    {
+        mStream.Commit(false);
+    }
+
+    return n;
+}
+
+int LogStream::Buffer::sync()
+{
+    mStream.Commit(true);
+    return 0;
+}
+
+LogStream::LogStream(LogServer& server) :
+    std::ostream(0), mServer(server), mBuffer(*this),
+    mPriority(LogServer::eAll)
+{
+    rdbuf(&mBuffer);
+}
+
+LogStream::~LogStream()
+{
+}
+
+void LogStream::SetPriority(unsigned int priority, bool enabled)
+{
+    Commit(true);
+    mPriority = priority;
+
+    if (enabled)
+    {
+        clear();
+    } else
+    {
+        // the sentry of each << fails, nothing is formatted
+        setstate(std::ios_base::badbit);
+    }
+}
+
+void LogStream::Commit(bool all)
+{
+    string& text = mBuffer.GetText();
+    if (text.empty())
+    {
+        return;
+    }
+
+    size_t end = all ? text.size() : text.rfind('\n') + 1;
+    if (end == 0)
+    {
+        return;
+    }
+
+    if (end == text.size())
+    {
+        mServer.Post(mPriority, text);
+        text.clear();
+    } else
+    {
+        string record(text, 0, end);
+        mServer.Post(mPriority, record);
+        text.erase(0, end);
+    }
+}
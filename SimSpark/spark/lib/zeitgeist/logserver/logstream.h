@@ -0,0 +1,98 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2002,2003 Koblenz University
+   Copyright (C) 2004-2009 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#ifndef ZEITGEIST_LOGSTREAM_H
+#define ZEITGEIST_LOGSTREAM_H
+
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include "../zeitgeist_defines.h"
+
+namespace zeitgeist
+{
+
+class LogServer;
+
+/** \class LogStream is the per thread front end of the LogServer. The
+    LogServer returns the LogStream of the calling thread from
+    Priority() (and Debug(), Normal() etc.), so concurrent threads
+    never share a buffer.
+
+    Text is collected in a private buffer and handed to the LogServer
+    as a record for each completed line, on flush() and whenever the
+    priority changes. If no stream of the LogServer accepts the
+    selected priority, the LogStream is put into the bad state, so
+    that all following << operations return without formatting
+    anything.
+*/
+class ZEITGEIST_API LogStream : public std::ostream
+{
+protected:
+    /** collects the text of the current record */
+    class Buffer : public std::streambuf
+    {
+    public:
+        Buffer(LogStream& stream) : mStream(stream) {}
+
+        /** returns the collected text */
+        std::string& GetText() { return mText; }
+
+    protected:
+        virtual int_type overflow(int_type c);
+        virtual std::streamsize xsputn(const char* s, std::streamsize n);
+        virtual int sync();
+
+    protected:
+        LogStream& mStream;
+        std::string mText;
+    };
+
+public:
+    LogStream(LogServer& server);
+    virtual ~LogStream();
+
+    /** hands over the pending text and selects the priority of the
+        following text. If enabled is false, the following text is
+        dropped without being formatted
+    */
+    void SetPriority(unsigned int priority, bool enabled);
+
+    /** returns the current priority */
+    unsigned int GetPriority() const { return mPriority; }
+
+    /** hands the complete lines of the pending text to the LogServer;
+        if all is true, a trailing partial line is handed over as well
+    */
+    void Commit(bool all);
+
+private:
+    LogStream(const LogStream&);
+    LogStream& operator=(const LogStream&);
+
+protected:
+    LogServer& mServer;
+    Buffer mBuffer;
+    unsigned int mPriority;
+};
+
+} // namespace zeitgeist
+
+#endif // ZEITGEIST_LOGSTREAM_H
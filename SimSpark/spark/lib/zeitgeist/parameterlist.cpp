@@ -31,20 +31,73 @@ ParameterList::ParameterList()
 {
 }
 
+ParameterList::ParameterList(std::pmr::memory_resource* resource)
+    : mList(resource)
+{
+}
+
+ParameterList::ParameterList(const ParameterList& other)
+    : mList(other.mList, std::pmr::get_default_resource())
+{
+}
+
+ParameterList::ParameterList(ParameterList&& other)
+    : mList(std::pmr::get_default_resource())
+{
+    *this = std::move(other);
+}
+
 ParameterList::~ParameterList()
 {
 }
 
+ParameterList&
+ParameterList::operator=(const ParameterList& other)
+{
+    // a pmr vector keeps its resource on assignment and copies the
+    // elements; nested lists are copied to the default resource
+    mList = other.mList;
+    return *this;
+}
+
+ParameterList&
+ParameterList::operator=(ParameterList&& other)
+{
+    if (this == &other)
+        {
+            return *this;
+        }
+
+    if (mList.get_allocator() == other.mList.get_allocator())
+        {
+            mList = std::move(other.mList);
+            return *this;
+        }
+
+    // a plain vector move would move the std::any elements one by
+    // one and hand over the nested lists with their arena storage
+    mList = other.mList;
+    other.mList.clear();
+    return *this;
+}
+
 void
 ParameterList::AddValue(const std::any& value)
 {
     mList.push_back(value);
 }
 
+void
+ParameterList::AddValue(std::any&& value)
+{
+    mList.push_back(std::move(value));
+}
+
 ParameterList&
 ParameterList::AddList()
 {
-    mList.push_back(ParameterList());
+    mList.emplace_back(std::in_place_type<ParameterList>,
+                       mList.get_allocator().resource());
     return *std::any_cast<ParameterList>(&mList.back());
 }
 
@@ -23,6 +23,7 @@
 #define ZEITGEIST_PARAMETERLIST_H
 
 #include <any>
+#include <memory_resource>
 #include <vector>
 #include <string>
 #include <salt/vector.h>
@@ -36,22 +37,54 @@ class ParameterList;
 /** \class ParameterList manages a list of values. std::any is used
     as a typesafe container to realize a sequence of values of
     arbitrary types.
+
+    The sequence is allocated from a memory resource that is passed on
+    to the nested lists created with AddList(). A list constructed
+    from another one, by copy or by move, always uses the default
+    memory resource, so that a list leaving the cycle it was built in
+    never points into a CycleArena. Moving a list that uses the
+    default resource is cheap, moving an arena list copies it. Moving
+    the std::any that holds a nested list hands over its storage
+    unchanged; copy nested lists that have to outlive their parent.
 */
 class ZEITGEIST_API ParameterList
 {
 public:
-    typedef std::vector<std::any> TVector;
+    typedef std::pmr::vector<std::any> TVector;
 
 protected:
     TVector mList;
 
 public:
     ParameterList();
+
+    /** constructs an empty list that allocates from resource */
+    explicit ParameterList(std::pmr::memory_resource* resource);
+
+    /** constructs a deep copy of other in the default resource */
+    ParameterList(const ParameterList& other);
+
+    /** takes over the values of other if it uses the default
+        resource, otherwise copies them to the default resource
+    */
+    ParameterList(ParameterList&& other);
+
+    /** copies the values of other into the resource of this list */
+    ParameterList& operator=(const ParameterList& other);
+
+    /** takes over the values of other if both lists use the same
+        resource, otherwise copies them into the resource of this list
+    */
+    ParameterList& operator=(ParameterList&& other);
+
     virtual ~ParameterList();
 
     /** inserts a value at the end of the managed sequence */
     void AddValue(const std::any& value);
 
+    /** moves a value to the end of the managed sequence */
+    void AddValue(std::any&& value);
+
     /** inserts an empty ParameterList as a new value at the end of
         the managed sequence and returns a reference to the new
         list. Using AddList instead of AddValue avoids copying a list
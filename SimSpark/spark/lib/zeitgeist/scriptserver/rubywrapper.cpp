@@ -63,6 +63,14 @@ ScriptValue RubyWrapper::RbConstGet(const std::string& name)
   });
 }
 
+void RubyWrapper::RbGvSet(const std::string& name, const std::string& value)
+{
+  RequestRubyExecution([&name, &value]
+  {
+    return rb_gv_set(name.c_str(), rb_str_new(value.data(), value.size()));
+  });
+}
+
 ScriptValue RubyWrapper::CallMethod(const std::string& className, const std::string& methodName)
 {
   return RequestRubyExecution([&className, &methodName]
@@ -60,6 +60,9 @@ public:
     /** returns the constant identified by the supplied name */
     ScriptValue RbConstGet(const std::string& name);
 
+    /** sets the global variable name, e.g. "$name", to a string */
+    void RbGvSet(const std::string& name, const std::string& value);
+
     /** calls a method on the given class */
     ScriptValue CallMethod(const std::string& className, const std::string& methodName);
 
@@ -26,6 +26,7 @@
 #include <zeitgeist/corecontext.h>
 #include <zeitgeist/logserver/logserver.h>
 #include <zeitgeist/fileserver/fileserver.h>
+#include <zeitgeist/startuptrace.h>
 #include <sys/stat.h>
 #include "private/gcvalue.h"
 #include "rubywrapper.h"
@@ -184,6 +185,46 @@ importBundle(VALUE /*self*/, VALUE path)
     return Qnil;
 }
 
+static VALUE
+importBundles(VALUE /*self*/, VALUE paths)
+{
+    std::vector<std::string> bundles;
+    for (int i = 0; i < RARRAY_LEN(paths); ++i)
+    {
+        VALUE path = rb_ary_entry(paths, i);
+        bundles.push_back(STR2CSTR(path));
+    }
+
+    gMyPrivateContext->GetCore()->ImportBundles(bundles);
+    return Qnil;
+}
+
+static VALUE
+setLazyBundles(VALUE /*self*/, VALUE enable)
+{
+    std::shared_ptr<Core> core = gMyPrivateContext->GetCore();
+    string dotDir;
+
+    if (
+        RTEST(enable) &&
+        core->GetScriptServer()->GetDotDirName(dotDir)
+        )
+    {
+        core->SetBundleManifest(dotDir + salt::RFile::Sep() + "bundles.manifest");
+    } else
+    {
+        core->SetBundleManifest("");
+    }
+
+    return Qnil;
+}
+
+static VALUE
+startupTraceReport(VALUE /*self*/)
+{
+    return rb_str_new2(StartupTrace::GetReport().c_str());
+}
+
 static VALUE
 run (VALUE /*self*/, VALUE file)
 {
@@ -248,6 +289,9 @@ ScriptServer::ScriptServer() : mRubyWrapper(new RubyWrapper())
     mRubyWrapper->DefineGlobalFunction("selectCall",   selectCall);
     mRubyWrapper->DefineGlobalFunction("thisCall",     thisCall);
     mRubyWrapper->DefineGlobalFunction("importBundle", importBundle);
+    mRubyWrapper->DefineGlobalFunction("importBundles", importBundles);
+    mRubyWrapper->DefineGlobalFunction("setLazyBundles", setLazyBundles);
+    mRubyWrapper->DefineGlobalFunction("startupTraceReport", startupTraceReport);
     mRubyWrapper->DefineGlobalFunction("run",          run);
     mRubyWrapper->DefineGlobalFunction("new",          newObject);
     mRubyWrapper->DefineGlobalFunction("delete",       deleteObject);
@@ -292,6 +336,7 @@ ScriptServer::Run(std::shared_ptr<salt::RFile> file)
 bool
 ScriptServer::Run(const string &fileName)
 {
+    StartupTrace::Span span("script", fileName);
     return Run(GetFile()->OpenResource(fileName));
 }
 
@@ -338,6 +383,12 @@ ScriptServer::CreateVariable(const string &varName, const string &value)
     Eval(s.str());
 }
 
+void
+ScriptServer::SetGlobalVariable(const string &varName, const string &value)
+{
+    mRubyWrapper->RbGvSet(varName, value);
+}
+
 bool
 ScriptServer::ParseVarName(const string& varName, string& nameSpace, string& name)
 {
@@ -468,6 +519,7 @@ ScriptServer::RunInitScriptInternal(const string &sourceDir, const string &name,
 {
     // run the init script in the sourceDir
     string sourcePath = sourceDir + salt::RFile::Sep() + name;
+    StartupTrace::Span span("script", sourcePath);
     GetLog()->Debug() << "(ScriptServer) Running " << sourcePath << "... " << endl;
 
     std::shared_ptr<salt::StdFile> file(new(salt::StdFile));
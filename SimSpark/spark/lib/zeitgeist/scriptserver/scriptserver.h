@@ -136,6 +136,12 @@ public:
     /** creates a ruby string variable */
     void CreateVariable(const std::string &varName, const std::string &value);
 
+    /** sets the ruby global variable varName, e.g. "$name", to a
+        string. Unlike Eval, the value is not parsed as ruby code, so
+        it may contain any character, e.g. quotes in a file name
+    */
+    void SetGlobalVariable(const std::string &varName, const std::string &value);
+
     /** reads the value of a ruby integer, returns true on success */
     bool GetVariable(const std::string &varName, int &value);
 
@@ -154,6 +160,11 @@ public:
     /** creates dot directory and adds it to resource search paths */
     bool SetupDotDir();
 
+    /** construct the path of the local dot directory that contains
+        the users init scripts
+     */
+    bool GetDotDirName(std::string& dotDir);
+
 protected:
     /** initializes the ScriptServer and runs the default startup
         script 'sys/script/zeitgeist.rb', returning true on
@@ -180,11 +191,6 @@ protected:
     ERunScriptErrorType RunInitScriptInternal(const std::string &dir, const std::string &name,
                                               bool copy,  const std::string& destDir = "");
 
-    /** construct the path of the local dot directory that contains
-        the users init scripts
-     */
-    bool GetDotDirName(std::string& dotDir);
-
     /** checks if the directory <dotDir> exists and if not creates it
      */
     bool CreateDotDir(const std::string& dotDir);
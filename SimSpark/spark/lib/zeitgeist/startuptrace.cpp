@@ -0,0 +1,226 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2002,2003 Koblenz University
+   Copyright (C) 2004-2009 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#include "startuptrace.h"
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace zeitgeist;
+using namespace std;
+
+namespace
+{
+    struct Entry
+    {
+        string category;
+        string name;
+
+        /** ms since the start of the trace */
+        double start;
+        double duration;
+
+        /** the number of enclosing spans on the same thread */
+        int depth;
+
+        /** true if recorded on the thread that opened the first span */
+        bool mainThread;
+    };
+
+    typedef chrono::steady_clock TClock;
+
+    /** the trace state, created on first use */
+    struct Trace
+    {
+        Trace() : start(TClock::now()), total(-1),
+                  mainThread(this_thread::get_id()) {}
+
+        mutex lock;
+        TClock::time_point start;
+        vector<Entry> entries;
+
+        /** the startup time in ms, negative while recording */
+        double total;
+
+        thread::id mainThread;
+    };
+
+    Trace& GetTrace()
+    {
+        static Trace trace;
+        return trace;
+    }
+
+    double Now(const Trace& trace)
+    {
+        return chrono::duration<double, milli>
+            (TClock::now() - trace.start).count();
+    }
+
+    /** the number of open spans on the calling thread */
+    thread_local int tDepth = 0;
+}
+
+StartupTrace::Span::Span(const char* category, const string& name)
+    : mEntry(-1)
+{
+    Trace& trace = GetTrace();
+    lock_guard<mutex> guard(trace.lock);
+
+    if (trace.total >= 0)
+        {
+            return;
+        }
+
+    Entry entry;
+    entry.category = category;
+    entry.name = name;
+    entry.start = Now(trace);
+    entry.duration = 0;
+    entry.depth = tDepth++;
+    entry.mainThread = (this_thread::get_id() == trace.mainThread);
+
+    mEntry = trace.entries.size();
+    trace.entries.push_back(entry);
+}
+
+StartupTrace::Span::~Span()
+{
+    if (mEntry < 0)
+        {
+            return;
+        }
+
+    Trace& trace = GetTrace();
+    lock_guard<mutex> guard(trace.lock);
+
+    Entry& entry = trace.entries[mEntry];
+    entry.duration = Now(trace) - entry.start;
+    --tDepth;
+}
+
+void StartupTrace::Finish()
+{
+    Trace& trace = GetTrace();
+    lock_guard<mutex> guard(trace.lock);
+
+    if (trace.total < 0)
+        {
+            trace.total = Now(trace);
+        }
+}
+
+bool StartupTrace::IsRecording()
+{
+    Trace& trace = GetTrace();
+    lock_guard<mutex> guard(trace.lock);
+
+    return (trace.total < 0);
+}
+
+string StartupTrace::GetReport()
+{
+    Trace& trace = GetTrace();
+    lock_guard<mutex> guard(trace.lock);
+
+    const double total = (trace.total >= 0) ? trace.total : Now(trace);
+    const vector<Entry>& entries = trace.entries;
+
+    string report;
+    char line[256];
+
+    snprintf(line, sizeof(line), "startup trace: %.1f ms%s\n", total,
+             (trace.total >= 0) ? " until the simulation started" : " so far");
+    report += line;
+    report += "   start     total      self  step\n";
+
+    map<string, pair<int, double> > categories;
+
+    for (size_t i = 0; i < entries.size(); ++i)
+        {
+            const Entry& entry = entries[i];
+
+            // the self time excludes the directly nested spans, which
+            // follow the entry on the same thread
+            double self = entry.duration;
+            for (size_t j = i + 1; j < entries.size(); ++j)
+                {
+                    const Entry& child = entries[j];
+                    if (child.mainThread != entry.mainThread)
+                        {
+                            continue;
+                        }
+
+                    if (child.depth <= entry.depth)
+                        {
+                            break;
+                        }
+
+                    if (child.depth == entry.depth + 1)
+                        {
+                            self -= child.duration;
+                        }
+                }
+
+            snprintf(line, sizeof(line), "%8.1f  %8.1f  %8.1f  %*s%s %s%s\n",
+                     entry.start, entry.duration, self,
+                     2 * entry.depth, "", entry.category.c_str(),
+                     entry.name.c_str(),
+                     entry.mainThread ? "" : " (worker thread)");
+            report += line;
+
+            // the category totals sum up the main thread only, as
+            // worker threads overlap it; nested spans of the same
+            // category are already included in their parent
+            bool nested = false;
+            for (size_t j = i; j-- > 0 && ! nested; )
+                {
+                    nested =
+                        (entries[j].mainThread == entry.mainThread) &&
+                        (entries[j].depth < entry.depth) &&
+                        (entries[j].category == entry.category) &&
+                        (entries[j].start + entries[j].duration >= entry.start);
+                }
+
+            pair<int, double>& sum = categories[entry.category];
+            ++sum.first;
+            if (! nested && entry.mainThread)
+                {
+                    sum.second += entry.duration;
+                }
+        }
+
+    for (
+         map<string, pair<int, double> >::const_iterator iter = categories.begin();
+         iter != categories.end();
+         ++iter
+         )
+        {
+            snprintf(line, sizeof(line), "%-10s %4d steps %10.1f ms\n",
+                     iter->first.c_str(), iter->second.first,
+                     iter->second.second);
+            report += line;
+        }
+
+    return report;
+}
@@ -0,0 +1,80 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2002,2003 Koblenz University
+   Copyright (C) 2004-2009 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#ifndef ZEITGEIST_STARTUPTRACE_H
+#define ZEITGEIST_STARTUPTRACE_H
+
+#include <string>
+#include "zeitgeist_defines.h"
+
+namespace zeitgeist
+{
+
+/** \class StartupTrace records how long the steps of the application
+    startup take, i.e. the bundle imports, the init scripts and the
+    scene imports, until Finish() is called when the simulation
+    starts.
+
+    Steps are recorded with a Span on the stack. Spans nest, so the
+    report lists the time of each step both including and excluding
+    the steps it contains. Spans may be opened on any thread; spans of
+    threads other than the one that opened the first span are marked
+    in the report.
+
+    The trace records a few dozen entries per startup and is always
+    active; it is printed on request only.
+*/
+class ZEITGEIST_API StartupTrace
+{
+public:
+    /** \class Span records the time between its construction and
+        destruction as a step of the given category
+    */
+    class ZEITGEIST_API Span
+    {
+    public:
+        Span(const char* category, const std::string& name);
+        ~Span();
+
+    private:
+        Span(const Span&);
+        Span& operator=(const Span&);
+
+    protected:
+        /** the index of the entry of this span, -1 if not recorded */
+        int mEntry;
+    };
+
+public:
+    /** stops recording; the time until the first call is the startup
+        time of the report */
+    static void Finish();
+
+    /** returns true until Finish() was called */
+    static bool IsRecording();
+
+    /** returns a table with one line per recorded step and the total
+        time per category */
+    static std::string GetReport();
+};
+
+} // namespace zeitgeist
+
+#endif // ZEITGEIST_STARTUPTRACE_H
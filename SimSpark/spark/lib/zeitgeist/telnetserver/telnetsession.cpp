@@ -47,8 +47,16 @@ void TelnetSession::operator()()
 			}
 			else
 			{
-				mScriptServer->Eval(input);
-				//Send("Executing: '"+input+"'\r\n");
+				// send back the result of the command, e.g. a report
+				ScriptValue value;
+				std::string reply;
+				if (
+					mScriptServer->Eval(input, value) &&
+					value.GetString(reply)
+					)
+				{
+					Send(reply+"\r\n");
+				}
 			}
 		}
 	}
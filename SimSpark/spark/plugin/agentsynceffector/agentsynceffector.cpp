@@ -41,7 +41,7 @@ bool AgentSyncEffector::Realize(std::shared_ptr<ActionObject> action)
 
     if (mAgentAspect)
     {
-        mAgentAspect->SetSynced(true);
+        mAgentAspect->NotifySync();
     }
     return res;
 }
@@ -20,13 +20,19 @@
 
 #include "imageperceptor.h"
 #include <zeitgeist/logserver/logserver.h>
+#include <cstring>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 using namespace oxygen;
 using namespace zeitgeist;
 using namespace salt;
 using namespace std;
 
-ImagePerceptor::ImagePerceptor() : oxygen::Perceptor()
+ImagePerceptor::ImagePerceptor() : oxygen::Perceptor(),
+  mSoftwareRender(false), mOffScreen(false), mWidth(0), mHeight(0),
+  mEncoding(E_RAW)
 {
 }
 
@@ -36,8 +42,6 @@ ImagePerceptor::~ImagePerceptor()
 
 void ImagePerceptor::OnLink()
 {
-  mRender = std::dynamic_pointer_cast<ImageRender > (GetCore()->New("ImageRender"));
-
   mCamera = std::dynamic_pointer_cast<Camera > (GetCore()->New("oxygen/Camera"));
   if (0 != mCamera.get())
   {
@@ -48,25 +52,83 @@ void ImagePerceptor::OnLink()
       << "(ImagePerceptor) ERROR: can not create camera\n";
   }
 
-  mRender->SetCamera(mCamera);
-
   RegisterCachedPath(mRenderControl, "/sys/server/simulation/RenderControl");
+}
 
-  if (mRenderControl.expired())
+void ImagePerceptor::CreateRender()
+{
+  if (! mSoftwareRender && mRenderControl.expired())
+  {
+    GetLog()->Normal()
+      << "(ImagePerceptor) RenderControl not found, "
+      << "using the software renderer\n";
+    mSoftwareRender = true;
+  }
+
+  if (mSoftwareRender)
+  {
+    mSoftRender = std::shared_ptr<SoftImageRender>(new SoftImageRender());
+    mSoftRender->SetCamera(mCamera);
+
+    if (mWidth > 0 && mHeight > 0)
+    {
+      mSoftRender->SetResolution(mWidth, mHeight);
+    }
+
+    return;
+  }
+
+  mRender = std::dynamic_pointer_cast<ImageRender > (GetCore()->New("ImageRender"));
+  if (0 == mRender.get())
   {
     GetLog()->Error()
-      << "(ImagePerceptor) ERROR: RenderControl not found\n";
-  } else
+      << "(ImagePerceptor) ERROR: can not create ImageRender\n";
+    return;
+  }
+
+  mRender->SetCamera(mCamera);
+  mRenderControl->AddChildReference(mRender);
+
+  mRender->SetOffScreen(mOffScreen);
+  if (mWidth > 0 && mHeight > 0)
   {
-    mRenderControl->AddChildReference(mRender);
+    mRender->SetResolution(mWidth, mHeight);
   }
 }
 
 bool ImagePerceptor::Percept(std::shared_ptr<PredicateList> predList)
 {
-  mRender->RequestRender();
+  if (mRender.get() == 0 && mSoftRender.get() == 0)
+  {
+    CreateRender();
+  }
+
+  const char* data = 0;
+  int size = 0;
+  int width = 0;
+  int height = 0;
+
+  if (mSoftRender.get() != 0)
+  {
+    // the software renderer draws the current state right away
+    mSoftRender->Render();
+
+    data = mSoftRender->GetData();
+    size = mSoftRender->GetDataSize();
+    width = mSoftRender->GetWidth();
+    height = mSoftRender->GetHeight();
+  } else if (mRender.get() != 0)
+  {
+    // the image is rendered in the next render cycle, this percept
+    // sends the previous one
+    mRender->RequestRender();
+
+    data = mRender->GetData();
+    size = mRender->GetDataSize();
+    width = mRender->GetWidth();
+    height = mRender->GetHeight();
+  }
 
-  int size = mRender->GetDataSize();
   if (size == 0)
     return false;
 
@@ -76,21 +138,122 @@ bool ImagePerceptor::Percept(std::shared_ptr<PredicateList> predList)
 
   ParameterList &sizeElement = predicate.parameter.AddList();
   sizeElement.AddValue(std::string("s"));
-  sizeElement.AddValue(mRender->GetWidth());
-  sizeElement.AddValue(mRender->GetHeight());
+  sizeElement.AddValue(width);
+  sizeElement.AddValue(height);
 
   ParameterList &dataElement = predicate.parameter.AddList();
-  dataElement.AddValue(std::string("d"));
-  const char* data = mRender->GetData();
-  string datacode = mB64Encoder.encode(data, size);
-  dataElement.AddValue(datacode);
 
+  mBuffer.clear();
+  switch (mEncoding)
+  {
+  case E_RLE:
+    EncodeRLE(data, size);
+    dataElement.AddValue(std::string("rle"));
+    dataElement.AddValue(mB64Encoder.encode(&mBuffer[0], mBuffer.size()));
+    break;
+
+  case E_ZLIB:
+    if (EncodeZLIB(data, size))
+    {
+      dataElement.AddValue(std::string("z"));
+      dataElement.AddValue(mB64Encoder.encode(&mBuffer[0], mBuffer.size()));
+      break;
+    }
+    [[fallthrough]];
+
+  default:
+    dataElement.AddValue(std::string("d"));
+    dataElement.AddValue(mB64Encoder.encode(data, size));
+    break;
+  }
+
+  return true;
+}
+
+void ImagePerceptor::EncodeRLE(const char* data, int size)
+{
+  // PackBits on RGB pixels
+  const int numPixel = size / 3;
+  int i = 0;
+
+  while (i < numPixel)
+  {
+    // the length of the run starting at i
+    int run = 1;
+    while (
+           (i + run < numPixel) &&
+           (run < 129) &&
+           (memcmp(&data[i*3], &data[(i+run)*3], 3) == 0)
+           )
+    {
+      ++run;
+    }
+
+    if (run >= 2)
+    {
+      mBuffer.push_back((char)(run + 126));
+      mBuffer.insert(mBuffer.end(), &data[i*3], &data[i*3] + 3);
+      i += run;
+      continue;
+    }
+
+    // the literal pixels up to the next run of at least two pixels
+    int literal = 1;
+    while (
+           (i + literal < numPixel) &&
+           (literal < 128) &&
+           ! (
+              (i + literal + 1 < numPixel) &&
+              (memcmp(&data[(i+literal)*3], &data[(i+literal+1)*3], 3) == 0)
+              )
+           )
+    {
+      ++literal;
+    }
+
+    mBuffer.push_back((char)(literal - 1));
+    mBuffer.insert(mBuffer.end(), &data[i*3], &data[(i+literal)*3]);
+    i += literal;
+  }
+}
+
+bool ImagePerceptor::EncodeZLIB(const char* data, int size)
+{
+#ifdef HAVE_ZLIB
+  uLongf length = compressBound(size);
+  mBuffer.resize(length);
+
+  if (compress2(reinterpret_cast<Bytef*>(&mBuffer[0]), &length,
+                reinterpret_cast<const Bytef*>(data), size,
+                Z_BEST_SPEED) != Z_OK)
+  {
+    GetLog()->Error()
+      << "(ImagePerceptor) ERROR: can not compress the image\n";
+    mBuffer.clear();
+    return false;
+  }
+
+  mBuffer.resize(length);
   return true;
+#else
+  (void) data;
+  (void) size;
+  return false;
+#endif
 }
 
 void ImagePerceptor::SetResolution(unsigned int w, unsigned int h)
 {
-  mRender->SetResolution(w,h);
+  mWidth = w;
+  mHeight = h;
+
+  if (mRender.get() != 0)
+  {
+    mRender->SetResolution(w,h);
+  } else if (mSoftRender.get() != 0)
+  {
+    mSoftRender->SetResolution(w,h);
+  }
 }
 
 void ImagePerceptor::SetFOV(float fov)
@@ -110,5 +273,52 @@ void ImagePerceptor::SetZFar(float zFar)
 
 void ImagePerceptor::SetOffScreen(bool offScreen)
 {
-  mRender->SetOffScreen(offScreen);
+  mOffScreen = offScreen;
+
+  if (mRender.get() != 0)
+  {
+    mRender->SetOffScreen(offScreen);
+  }
+}
+
+void ImagePerceptor::SetSoftwareRender(bool softwareRender)
+{
+  if (mRender.get() != 0 || mSoftRender.get() != 0)
+  {
+    GetLog()->Error()
+      << "(ImagePerceptor) ERROR: the renderer can only be selected "
+      << "before the first percept\n";
+    return;
+  }
+
+  mSoftwareRender = softwareRender;
+}
+
+bool ImagePerceptor::SetImageEncoding(const std::string& encoding)
+{
+  if (encoding == "base64")
+  {
+    mEncoding = E_RAW;
+  } else if (encoding == "rle")
+  {
+    mEncoding = E_RLE;
+  } else if (encoding == "zlib")
+  {
+#ifdef HAVE_ZLIB
+    mEncoding = E_ZLIB;
+#else
+    GetLog()->Error()
+      << "(ImagePerceptor) ERROR: built without zlib, "
+      << "image encoding 'zlib' is not available\n";
+    return false;
+#endif
+  } else
+  {
+    GetLog()->Error()
+      << "(ImagePerceptor) ERROR: unknown image encoding '"
+      << encoding << "'\n";
+    return false;
+  }
+
+  return true;
 }
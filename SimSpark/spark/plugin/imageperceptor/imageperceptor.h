@@ -26,11 +26,25 @@
 #include <oxygen/sceneserver/camera.h>
 #include <kerosin/renderserver/rendercontrol.h>
 #include "imagerender.h"
+#include "softimagerender.h"
 
 /**
  * @class ImagePerceptor
  * @brief Perceptor representing a camera (receiving raw 2D images).
  * @ingroup perceptors
+ *
+ * The image is rendered with OpenGL by an ImageRender, or on the CPU
+ * by a SoftImageRender if software rendering is selected or no
+ * RenderControl is installed. The renderer is created on the first
+ * percept.
+ *
+ * The RGB image is sent as (IMG (s <width> <height>) (<enc> <data>)),
+ * where the data is base64 encoded and enc is
+ * - d for the raw image (the default),
+ * - rle for the image run length encoded per pixel: a header byte
+ *   h < 128 is followed by h + 1 literal pixels, a header byte
+ *   h >= 128 by one pixel repeated h - 126 times,
+ * - z for the image compressed with zlib, if available.
  */
 class ImagePerceptor : public oxygen::Perceptor
 {
@@ -52,12 +66,49 @@ public:
     void SetZFar(float zFar);
 
     void SetOffScreen(bool offScreen);
-    
+
+    /** selects the CPU renderer instead of OpenGL */
+    void SetSoftwareRender(bool softwareRender);
+
+    /** sets the image encoding: "base64", "rle" or "zlib"; returns
+        false if the encoding is not supported */
+    bool SetImageEncoding(const std::string& encoding);
+
+protected:
+    enum EEncoding
+    {
+        E_RAW,
+        E_RLE,
+        E_ZLIB
+    };
+
+    /** creates the renderer for the current settings */
+    void CreateRender();
+
+    /** appends the run length encoded image to mBuffer */
+    void EncodeRLE(const char* data, int size);
+
+    /** appends the zlib compressed image to mBuffer */
+    bool EncodeZLIB(const char* data, int size);
+
 private:
     std::shared_ptr<oxygen::Camera> mCamera;
 
     std::shared_ptr<ImageRender> mRender;
 
+    std::shared_ptr<SoftImageRender> mSoftRender;
+
+    /** the settings applied when the renderer is created */
+    bool mSoftwareRender;
+    bool mOffScreen;
+    int mWidth;
+    int mHeight;
+
+    EEncoding mEncoding;
+
+    /** the encoded image before base64 encoding */
+    std::vector<char> mBuffer;
+
     zeitgeist::Leaf::CachedPath<kerosin::RenderControl> mRenderControl;
 
     base64::Encoder mB64Encoder;
@@ -103,6 +103,37 @@ FUNCTION(ImagePerceptor, setOffScreen)
     return true;
 }
 
+FUNCTION(ImagePerceptor, setSoftwareRender)
+{
+    bool softwareRender;
+
+    if (
+        (in.GetSize() != 1) ||
+        (! in.GetValue(in[0], softwareRender) )
+         )
+    {
+        return false;
+    }
+
+    obj->SetSoftwareRender(softwareRender);
+    return true;
+}
+
+FUNCTION(ImagePerceptor, setImageEncoding)
+{
+    std::string encoding;
+
+    if (
+        (in.GetSize() != 1) ||
+        (! in.GetValue(in[0], encoding) )
+         )
+    {
+        return false;
+    }
+
+    return obj->SetImageEncoding(encoding);
+}
+
 void CLASS(ImagePerceptor)::DefineClass()
 {
     DEFINE_BASECLASS(oxygen/Perceptor)
@@ -111,4 +142,6 @@ void CLASS(ImagePerceptor)::DefineClass()
     DEFINE_FUNCTION(setZNear)
     DEFINE_FUNCTION(setZFar)
     DEFINE_FUNCTION(setOffScreen)
+    DEFINE_FUNCTION(setSoftwareRender)
+    DEFINE_FUNCTION(setImageEncoding)
 }
@@ -0,0 +1,326 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2008 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "softimagerender.h"
+#include <kerosin/imageserver/image.h>
+#include <kerosin/imageserver/imageserver.h>
+#include <kerosin/materialserver/material2dtexture.h>
+#include <kerosin/sceneserver/light.h>
+#include <oxygen/sceneserver/scene.h>
+#include <zeitgeist/logserver/logserver.h>
+#include <map>
+#include <mutex>
+
+using namespace kerosin;
+using namespace oxygen;
+using namespace zeitgeist;
+using namespace salt;
+using namespace std;
+
+namespace
+{
+    /** the textures are shared by all cameras; a texture that failed
+        to load is stored as 0 */
+    typedef map<string, std::shared_ptr<SoftRasterizer::Texture> > TTextureMap;
+
+    mutex gTextureMutex;
+    TTextureMap gTextures;
+
+    /** converts an image of the ImageServer to RGBA, returns false if
+        the format is not supported */
+    bool ConvertImage(Image& image, SoftRasterizer::Texture& texture)
+    {
+        const int width = image.Width();
+        const int height = image.Height();
+        const int bytes = image.BytesPP();
+        const unsigned char* data = image.Data();
+
+        if (width <= 0 || height <= 0 || data == 0 ||
+            bytes < 1 || bytes > 4)
+            {
+                return false;
+            }
+
+        bool bgr = false;
+#ifdef HAVE_IL_IL_H
+        if (image.Type() != IL_UNSIGNED_BYTE)
+            {
+                return false;
+            }
+
+        bgr = (image.Format() == IL_BGR || image.Format() == IL_BGRA);
+#endif
+
+        texture.width = width;
+        texture.height = height;
+        texture.rgba.resize(width * height * 4);
+
+        for (int i = 0; i < width * height; ++i)
+            {
+                const unsigned char* src = &data[i * bytes];
+                unsigned char* dst = &texture.rgba[i * 4];
+
+                if (bytes < 3)
+                    {
+                        // luminance with an optional alpha channel
+                        dst[0] = dst[1] = dst[2] = src[0];
+                        dst[3] = (bytes == 2) ? src[1] : 255;
+                    } else
+                    {
+                        dst[0] = src[bgr ? 2 : 0];
+                        dst[1] = src[1];
+                        dst[2] = src[bgr ? 0 : 2];
+                        dst[3] = (bytes == 4) ? src[3] : 255;
+                    }
+            }
+
+        return true;
+    }
+}
+
+SoftImageRender::SoftImageRender()
+    : mWidth(0), mHeight(0)
+{
+}
+
+SoftImageRender::~SoftImageRender()
+{
+}
+
+void SoftImageRender::SetCamera(std::shared_ptr<oxygen::Camera> camera)
+{
+    mCamera = camera;
+}
+
+void SoftImageRender::SetResolution(int w, int h)
+{
+    mCamera->SetViewport(0, 0, w, h);
+}
+
+void SoftImageRender::Render()
+{
+    if (mCamera.get() == 0)
+        {
+            return;
+        }
+
+    std::shared_ptr<Scene> scene = mCamera->GetScene();
+    if (scene.get() == 0)
+        {
+            return;
+        }
+
+    const int w = mCamera->GetViewportWidth();
+    const int h = mCamera->GetViewportHeight();
+    if (w <= 0 || h <= 0)
+        {
+            return;
+        }
+
+    mCamera->Bind();
+
+    mLights.clear();
+
+    Leaf::TLeafList lights;
+    scene->ListChildrenSupportingClass<kerosin::Light>(lights, true);
+
+    for (
+         Leaf::TLeafList::iterator iter = lights.begin();
+         iter != lights.end();
+         ++iter
+         )
+        {
+            std::shared_ptr<kerosin::Light> light =
+                static_pointer_cast<kerosin::Light>(*iter);
+
+            SoftRasterizer::Light softLight;
+            softLight.pos = light->GetWorldTransform().Pos();
+
+            const RGBA& ambient = light->GetAmbient();
+            const RGBA& diffuse = light->GetDiffuse();
+            for (int c = 0; c < 3; ++c)
+                {
+                    softLight.ambient[c] = ambient[c];
+                    softLight.diffuse[c] = diffuse[c];
+                }
+
+            mLights.push_back(softLight);
+        }
+
+    // opaque meshes are drawn before the transparent ones, like the
+    // two passes of the RenderServer
+    mMeshes.clear();
+    CollectMeshes(scene, false);
+    CollectMeshes(scene, true);
+
+    mData.resize(w * h * 3);
+    mRasterizer.Render(mCamera->GetViewTransform(),
+                       mCamera->GetProjectionTransform(),
+                       mMeshes, mLights, w, h,
+                       reinterpret_cast<unsigned char*>(&mData[0]));
+
+    mWidth = w;
+    mHeight = h;
+}
+
+void SoftImageRender::CollectMeshes(const std::shared_ptr<BaseNode>& node,
+                                    bool transparent)
+{
+    std::shared_ptr<RenderNode> renderNode =
+        dynamic_pointer_cast<RenderNode>(node);
+
+    if (renderNode.get() != 0)
+        {
+            if (! renderNode->IsVisible())
+                {
+                    return;
+                }
+
+            if (renderNode->IsTransparent() == transparent)
+                {
+                    std::shared_ptr<StaticMesh> staticMesh =
+                        dynamic_pointer_cast<StaticMesh>(renderNode);
+
+                    if (staticMesh.get() != 0)
+                        {
+                            AddStaticMesh(*staticMesh);
+                        }
+                }
+        }
+
+    for (Leaf::TLeafList::iterator i = node->begin(); i != node->end(); ++i)
+        {
+            std::shared_ptr<BaseNode> child = dynamic_pointer_cast<BaseNode>(*i);
+            if (child.get() == 0)
+                {
+                    continue;
+                }
+
+            CollectMeshes(child, transparent);
+        }
+}
+
+void SoftImageRender::AddStaticMesh(StaticMesh& staticMesh)
+{
+    const std::shared_ptr<TriMesh> triMesh = staticMesh.GetMesh();
+    if (triMesh.get() == 0 || triMesh->GetPos().get() == 0)
+        {
+            return;
+        }
+
+    SoftRasterizer::Mesh mesh;
+    mesh.transform = staticMesh.GetWorldTransform();
+    mesh.scale = staticMesh.GetScale();
+    mesh.pos = triMesh->GetPos().get();
+    mesh.normals = triMesh->GetNormals().get();
+    mesh.texCoords = triMesh->GetTexCoords().get();
+    mesh.numVertex = triMesh->GetVertexCount();
+    mesh.bounds = staticMesh.GetWorldBoundingBox();
+
+    const TriMesh::TFaces& faces = triMesh->GetFaces();
+    const StaticMesh::TMaterialList& materials = staticMesh.GetMaterials();
+
+    TriMesh::TFaces::const_iterator iter = faces.begin();
+    StaticMesh::TMaterialList::const_iterator miter = materials.begin();
+
+    for (; iter != faces.end() && miter != materials.end(); ++iter, ++miter)
+        {
+            const std::shared_ptr<Material>& material = (*miter);
+            const std::shared_ptr<IndexBuffer>& index = (*iter).indeces;
+
+            if (material.get() == 0 || index.get() == 0)
+                {
+                    continue;
+                }
+
+            mesh.index = index->GetIndex().get();
+            mesh.numIndex = index->GetNumIndex();
+            mesh.texture = 0;
+
+            // the OpenGL default material
+            for (int c = 0; c < 4; ++c)
+                {
+                    mesh.ambient[c] = (c < 3) ? 0.2f : 1.0f;
+                    mesh.diffuse[c] = (c < 3) ? 0.8f : 1.0f;
+                    mesh.emission[c] = (c < 3) ? 0.0f : 1.0f;
+                }
+
+            std::shared_ptr<MaterialSolid> solid =
+                dynamic_pointer_cast<MaterialSolid>(material);
+
+            if (solid.get() != 0)
+                {
+                    for (int c = 0; c < 4; ++c)
+                        {
+                            mesh.ambient[c] = solid->GetAmbient()[c];
+                            mesh.diffuse[c] = solid->GetDiffuse()[c];
+                            mesh.emission[c] = solid->GetEmission()[c];
+                        }
+                }
+
+            std::shared_ptr<Material2DTexture> textured =
+                dynamic_pointer_cast<Material2DTexture>(material);
+
+            if (textured.get() != 0 && textured->HasDiffuseTexture())
+                {
+                    mesh.texture = GetTexture(textured->GetDiffuseTextureName());
+                }
+
+            mMeshes.push_back(mesh);
+        }
+}
+
+const SoftRasterizer::Texture* SoftImageRender::GetTexture(const string& name)
+{
+    lock_guard<mutex> lock(gTextureMutex);
+
+    TTextureMap::iterator iter = gTextures.find(name);
+    if (iter != gTextures.end())
+        {
+            return iter->second.get();
+        }
+
+    std::shared_ptr<SoftRasterizer::Texture>& texture = gTextures[name];
+
+    std::shared_ptr<ImageServer> imageServer =
+        dynamic_pointer_cast<ImageServer>(mCamera->GetCore()->Get("/sys/server/image"));
+
+    if (imageServer.get() == 0)
+        {
+            mCamera->GetLog()->Error()
+                << "(SoftImageRender) ERROR: ImageServer not found, "
+                << "drawing '" << name << "' without texture\n";
+            return 0;
+        }
+
+    std::shared_ptr<Image> image = imageServer->Load(name);
+    std::shared_ptr<SoftRasterizer::Texture> loaded(new SoftRasterizer::Texture());
+
+    if (image.get() == 0 || ! ConvertImage(*image, *loaded))
+        {
+            mCamera->GetLog()->Error()
+                << "(SoftImageRender) ERROR: can not load texture '"
+                << name << "'\n";
+            return 0;
+        }
+
+    texture = loaded;
+    return texture.get();
+}
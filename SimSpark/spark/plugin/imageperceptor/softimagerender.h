@@ -0,0 +1,87 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2008 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef SOFTIMAGERENDER_H
+#define SOFTIMAGERENDER_H
+
+#include <oxygen/sceneserver/camera.h>
+#include <kerosin/sceneserver/staticmesh.h>
+#include "softrasterizer.h"
+
+/** \class SoftImageRender renders the image of an ImagePerceptor
+    camera with the SoftRasterizer instead of OpenGL. It needs neither
+    an OpenGLServer nor a RenderServer, so camera perceptors also run
+    on machines without a display or GPU.
+
+    The StaticMeshes of the scene are drawn with their materials and
+    the diffuse textures, which are loaded through the ImageServer if
+    it is installed, and lit by the Lights of the scene. Like the
+    ImageRender, the image is in RGB format starting with the bottom
+    row.
+*/
+class SoftImageRender
+{
+public:
+    SoftImageRender();
+    ~SoftImageRender();
+
+    void SetCamera(std::shared_ptr<oxygen::Camera> camera);
+
+    void SetResolution(int w, int h);
+
+    /** renders the scene of the camera */
+    void Render();
+
+    const char* GetData() const { return mData.empty() ? 0 : &mData[0]; }
+
+    int GetDataSize() const { return mData.size(); }
+
+    int GetWidth() const { return mWidth; }
+
+    int GetHeight() const { return mHeight; }
+
+protected:
+    /** adds the meshes of the visible StaticMeshes below node that
+        are (not) transparent */
+    void CollectMeshes(const std::shared_ptr<oxygen::BaseNode>& node,
+                       bool transparent);
+
+    /** adds the meshes of one StaticMesh */
+    void AddStaticMesh(kerosin::StaticMesh& staticMesh);
+
+    /** returns the diffuse texture with the given name or 0 if it
+        can not be loaded */
+    const SoftRasterizer::Texture* GetTexture(const std::string& name);
+
+protected:
+    std::shared_ptr<oxygen::Camera> mCamera;
+
+    SoftRasterizer mRasterizer;
+
+    /** the meshes and lights of the current frame */
+    std::vector<SoftRasterizer::Mesh> mMeshes;
+    std::vector<SoftRasterizer::Light> mLights;
+
+    std::vector<char> mData;
+    int mWidth;
+    int mHeight;
+};
+
+#endif // SOFTIMAGERENDER_H
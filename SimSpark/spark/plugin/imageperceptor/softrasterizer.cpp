@@ -0,0 +1,743 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2008 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "softrasterizer.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+using namespace salt;
+using namespace std;
+
+namespace
+{
+    /** runs the tiles of a frame on a fixed set of worker threads.
+        Several threads may render at the same time; the workers take
+        tiles from the oldest frame first, and the calling thread
+        rasterizes tiles of its own frame until none is left
+    */
+    class WorkerPool
+    {
+    public:
+        static WorkerPool& Get()
+        {
+            static WorkerPool pool;
+            return pool;
+        }
+
+        /** calls fn(0) ... fn(count - 1) and returns when all calls
+            finished */
+        void Run(int count, const function<void(int)>& fn)
+        {
+            if (mThreads.empty() || count <= 1)
+                {
+                    for (int i = 0; i < count; ++i)
+                        {
+                            fn(i);
+                        }
+                    return;
+                }
+
+            Job job(fn, count);
+            {
+                lock_guard<mutex> lock(mMutex);
+                mJobs.push_back(&job);
+            }
+            mWake.notify_all();
+
+            Process(job);
+
+            unique_lock<mutex> lock(mMutex);
+            deque<Job*>::iterator iter = find(mJobs.begin(), mJobs.end(), &job);
+            if (iter != mJobs.end())
+                {
+                    mJobs.erase(iter);
+                }
+
+            mFinished.wait(lock, [&job]()
+                { return job.done == job.count && job.users == 0; });
+        }
+
+    private:
+        struct Job
+        {
+            Job(const function<void(int)>& f, int c)
+                : fn(f), count(c), next(0), done(0), users(0) {}
+
+            const function<void(int)>& fn;
+            const int count;
+            atomic<int> next;
+            atomic<int> done;
+
+            /** the number of workers that hold a pointer to the job,
+                guarded by mMutex */
+            int users;
+        };
+
+        WorkerPool() : mStop(false)
+        {
+            unsigned int threads = thread::hardware_concurrency();
+            for (unsigned int i = 1; i < threads; ++i)
+                {
+                    mThreads.push_back(thread(&WorkerPool::Work, this));
+                }
+        }
+
+        ~WorkerPool()
+        {
+            {
+                lock_guard<mutex> lock(mMutex);
+                mStop = true;
+            }
+            mWake.notify_all();
+
+            for (size_t i = 0; i < mThreads.size(); ++i)
+                {
+                    mThreads[i].join();
+                }
+        }
+
+        static void Process(Job& job)
+        {
+            int i;
+            while ((i = job.next++) < job.count)
+                {
+                    job.fn(i);
+                    ++job.done;
+                }
+        }
+
+        void Work()
+        {
+            unique_lock<mutex> lock(mMutex);
+
+            while (true)
+                {
+                    mWake.wait(lock, [this]() { return mStop || ! mJobs.empty(); });
+                    if (mStop)
+                        {
+                            return;
+                        }
+
+                    Job* job = mJobs.front();
+                    if (job->next >= job->count)
+                        {
+                            // all tiles taken, the owner waits for the rest
+                            mJobs.pop_front();
+                            continue;
+                        }
+
+                    ++job->users;
+                    lock.unlock();
+                    Process(*job);
+                    lock.lock();
+                    --job->users;
+                    mFinished.notify_all();
+                }
+        }
+
+        mutex mMutex;
+        condition_variable mWake;
+        condition_variable mFinished;
+        deque<Job*> mJobs;
+        vector<thread> mThreads;
+        bool mStop;
+    };
+
+    inline float Clamp01(float v)
+    {
+        return (v < 0.0f) ? 0.0f : ((v > 1.0f) ? 1.0f : v);
+    }
+
+    inline unsigned char ToByte(float v)
+    {
+        return (unsigned char)(Clamp01(v) * 255.0f + 0.5f);
+    }
+
+    enum
+    {
+        OUT_LEFT   = 1,
+        OUT_RIGHT  = 2,
+        OUT_BOTTOM = 4,
+        OUT_TOP    = 8,
+        OUT_NEAR   = 16
+    };
+
+    inline int OutCode(const float* v)
+    {
+        // v points to x, y, z, w of a clip space vertex
+        return
+            ((v[0] < -v[3]) ? OUT_LEFT : 0) |
+            ((v[0] >  v[3]) ? OUT_RIGHT : 0) |
+            ((v[1] < -v[3]) ? OUT_BOTTOM : 0) |
+            ((v[1] >  v[3]) ? OUT_TOP : 0) |
+            ((v[2] < -v[3]) ? OUT_NEAR : 0);
+    }
+}
+
+SoftRasterizer::SoftRasterizer()
+    : mWidth(0), mHeight(0), mTilesX(0), mTilesY(0),
+      mMesh(0), mLights(0)
+{
+    SetAmbient(0.2f, 0.2f, 0.2f);
+    SetBackground(0.0f, 0.0f, 0.0f);
+}
+
+SoftRasterizer::~SoftRasterizer()
+{
+}
+
+void SoftRasterizer::SetAmbient(float r, float g, float b)
+{
+    mAmbient[0] = r;
+    mAmbient[1] = g;
+    mAmbient[2] = b;
+}
+
+void SoftRasterizer::SetBackground(float r, float g, float b)
+{
+    mBackground[0] = ToByte(r);
+    mBackground[1] = ToByte(g);
+    mBackground[2] = ToByte(b);
+}
+
+void SoftRasterizer::Render(const Matrix& view, const Matrix& projection,
+                            const vector<Mesh>& meshes,
+                            const vector<Light>& lights,
+                            int width, int height, unsigned char* rgb)
+{
+    if (width <= 0 || height <= 0)
+        {
+            return;
+        }
+
+    mWidth = width;
+    mHeight = height;
+    mTilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    mTilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+    mBins.resize(mTilesX * mTilesY);
+    for (size_t i = 0; i < mBins.size(); ++i)
+        {
+            mBins[i].clear();
+        }
+
+    mTriangles.clear();
+    mDepth.resize(width * height);
+
+    const Matrix viewProjection = projection * view;
+    for (size_t i = 0; i < meshes.size(); ++i)
+        {
+            SetupMesh(meshes[i], viewProjection, lights);
+        }
+
+    WorkerPool::Get().Run(mTilesX * mTilesY, [this, rgb](int tile)
+        { RasterizeTile(tile, rgb); });
+}
+
+void SoftRasterizer::SetupMesh(const Mesh& mesh, const Matrix& viewProjection,
+                               const vector<Light>& lights)
+{
+    if (mesh.pos == 0 || mesh.index == 0 || mesh.numVertex <= 0)
+        {
+            return;
+        }
+
+    if (mesh.bounds.minVec.x() <= mesh.bounds.maxVec.x())
+        {
+            // skip meshes whose bounding box is outside one plane of
+            // the frustum
+            const float* m = viewProjection.m;
+            int outCode = ~0;
+
+            for (int i = 0; i < 8 && outCode != 0; ++i)
+                {
+                    const float x = (i & 1) ? mesh.bounds.maxVec.x() : mesh.bounds.minVec.x();
+                    const float y = (i & 2) ? mesh.bounds.maxVec.y() : mesh.bounds.minVec.y();
+                    const float z = (i & 4) ? mesh.bounds.maxVec.z() : mesh.bounds.minVec.z();
+
+                    const float corner[4] = {
+                        m[0]*x + m[4]*y + m[8]*z  + m[12],
+                        m[1]*x + m[5]*y + m[9]*z  + m[13],
+                        m[2]*x + m[6]*y + m[10]*z + m[14],
+                        m[3]*x + m[7]*y + m[11]*z + m[15]
+                    };
+
+                    outCode &= OutCode(corner);
+                }
+
+            if (outCode != 0)
+                {
+                    return;
+                }
+        }
+
+    mMesh = &mesh;
+    mLights = &lights;
+
+    // the light that does not depend on the vertex
+    for (int c = 0; c < 3; ++c)
+        {
+            float ambient = mAmbient[c];
+            for (size_t l = 0; l < lights.size(); ++l)
+                {
+                    ambient += lights[l].ambient[c];
+                }
+
+            mBaseColor[c] = mesh.emission[c] + mesh.ambient[c] * ambient;
+        }
+
+    const Matrix mvp = viewProjection * mesh.transform;
+    const float* m = mvp.m;
+    const Vector3f& s = mesh.scale;
+
+    mVertices.resize(mesh.numVertex);
+    mLit.assign(mesh.numVertex, false);
+
+    for (int i = 0; i < mesh.numVertex; ++i)
+        {
+            const float px = mesh.pos[i*3+0] * s[0];
+            const float py = mesh.pos[i*3+1] * s[1];
+            const float pz = mesh.pos[i*3+2] * s[2];
+
+            Vertex& v = mVertices[i];
+            v.x = m[0]*px + m[4]*py + m[8]*pz  + m[12];
+            v.y = m[1]*px + m[5]*py + m[9]*pz  + m[13];
+            v.z = m[2]*px + m[6]*py + m[10]*pz + m[14];
+            v.w = m[3]*px + m[7]*py + m[11]*pz + m[15];
+
+            Project(v);
+        }
+
+    // vertices are lit on demand, as most triangles of distant or
+    // hidden meshes are culled
+    const unsigned int numVertex = mesh.numVertex;
+    for (int i = 0; i + 2 < mesh.numIndex; i += 3)
+        {
+            const unsigned int index[3] =
+                { mesh.index[i], mesh.index[i+1], mesh.index[i+2] };
+
+            if (index[0] >= numVertex || index[1] >= numVertex || index[2] >= numVertex)
+                {
+                    continue;
+                }
+
+            const Vertex& a = mVertices[index[0]];
+            const Vertex& b = mVertices[index[1]];
+            const Vertex& c = mVertices[index[2]];
+
+            const int outA = OutCode(&a.x);
+            const int outB = OutCode(&b.x);
+            const int outC = OutCode(&c.x);
+
+            if ((outA & outB & outC) != 0)
+                {
+                    // completely outside one plane of the frustum
+                    continue;
+                }
+
+            const bool clip = (((outA | outB | outC) & OUT_NEAR) != 0);
+
+            int box[4];
+            if (! clip && ! GetCoverage(a, b, c, box))
+                {
+                    continue;
+                }
+
+            for (int k = 0; k < 3; ++k)
+                {
+                    if (! mLit[index[k]])
+                        {
+                            LightVertex(index[k]);
+                            mLit[index[k]] = true;
+                        }
+                }
+
+            if (clip)
+                {
+                    ClipTriangle(a, b, c, mesh.texture);
+                } else
+                {
+                    AddTriangle(a, b, c, box, mesh.texture);
+                }
+        }
+}
+
+void SoftRasterizer::LightVertex(int i)
+{
+    const Mesh& mesh = *mMesh;
+    const vector<Light>& lights = *mLights;
+    Vertex& v = mVertices[i];
+
+    v.a = mesh.diffuse[3];
+
+    if (mesh.texCoords != 0)
+        {
+            v.u = mesh.texCoords[i*3+0];
+            v.v = mesh.texCoords[i*3+1];
+        } else
+        {
+            v.u = v.v = 0.0f;
+        }
+
+    if (lights.empty())
+        {
+            // lighting is disabled without lights
+            v.r = mesh.diffuse[0];
+            v.g = mesh.diffuse[1];
+            v.b = mesh.diffuse[2];
+            return;
+        }
+
+    const float* t = mesh.transform.m;
+    const Vector3f& s = mesh.scale;
+
+    // the normal is scaled inversely to the position
+    float nx = 0.0f, ny = 0.0f, nz = 1.0f;
+    if (mesh.normals != 0)
+        {
+            nx = mesh.normals[i*3+0] / s[0];
+            ny = mesh.normals[i*3+1] / s[1];
+            nz = mesh.normals[i*3+2] / s[2];
+        }
+
+    Vector3f n(t[0]*nx + t[4]*ny + t[8]*nz,
+               t[1]*nx + t[5]*ny + t[9]*nz,
+               t[2]*nx + t[6]*ny + t[10]*nz);
+    n.Normalize();
+
+    const float px = mesh.pos[i*3+0] * s[0];
+    const float py = mesh.pos[i*3+1] * s[1];
+    const float pz = mesh.pos[i*3+2] * s[2];
+
+    const Vector3f world(t[0]*px + t[4]*py + t[8]*pz  + t[12],
+                         t[1]*px + t[5]*py + t[9]*pz  + t[13],
+                         t[2]*px + t[6]*py + t[10]*pz + t[14]);
+
+    float light[3] = { 0.0f, 0.0f, 0.0f };
+    for (size_t l = 0; l < lights.size(); ++l)
+        {
+            Vector3f dir = lights[l].pos - world;
+            dir.Normalize();
+
+            const float lambert = n.Dot(dir);
+            if (lambert > 0.0f)
+                {
+                    light[0] += lights[l].diffuse[0] * lambert;
+                    light[1] += lights[l].diffuse[1] * lambert;
+                    light[2] += lights[l].diffuse[2] * lambert;
+                }
+        }
+
+    v.r = Clamp01(mBaseColor[0] + mesh.diffuse[0] * light[0]);
+    v.g = Clamp01(mBaseColor[1] + mesh.diffuse[1] * light[1]);
+    v.b = Clamp01(mBaseColor[2] + mesh.diffuse[2] * light[2]);
+}
+
+void SoftRasterizer::ClipTriangle(const Vertex& a, const Vertex& b, const Vertex& c,
+                                  const Texture* texture)
+{
+    // clip the polygon at the near plane z = -w, which leaves at most
+    // four vertices
+    const Vertex* in[3] = { &a, &b, &c };
+    Vertex out[4];
+    int numOut = 0;
+
+    for (int i = 0; i < 3; ++i)
+        {
+            const Vertex& p = *in[i];
+            const Vertex& q = *in[(i + 1) % 3];
+            const float dp = p.z + p.w;
+            const float dq = q.z + q.w;
+
+            if (dp >= 0.0f)
+                {
+                    out[numOut++] = p;
+                }
+
+            if ((dp >= 0.0f) != (dq >= 0.0f))
+                {
+                    const float f = dp / (dp - dq);
+                    const float* fp = &p.x;
+                    const float* fq = &q.x;
+                    float* fo = &out[numOut++].x;
+
+                    for (size_t k = 0; k < sizeof(Vertex) / sizeof(float); ++k)
+                        {
+                            fo[k] = fp[k] + f * (fq[k] - fp[k]);
+                        }
+                }
+        }
+
+    for (int i = 0; i < numOut; ++i)
+        {
+            Project(out[i]);
+        }
+
+    for (int i = 1; i + 1 < numOut; ++i)
+        {
+            int box[4];
+            if (GetCoverage(out[0], out[i], out[i+1], box))
+                {
+                    AddTriangle(out[0], out[i], out[i+1], box, texture);
+                }
+        }
+}
+
+void SoftRasterizer::Project(Vertex& v) const
+{
+    if (v.w <= 0.0f)
+        {
+            return;
+        }
+
+    v.invW = 1.0f / v.w;
+    v.sx = (v.x * v.invW * 0.5f + 0.5f) * mWidth;
+    v.sy = (v.y * v.invW * 0.5f + 0.5f) * mHeight;
+    v.sz = v.z * v.invW;
+}
+
+bool SoftRasterizer::GetCoverage(const Vertex& a, const Vertex& b, const Vertex& c,
+                                 int* box) const
+{
+    if (a.w <= 0.0f || b.w <= 0.0f || c.w <= 0.0f)
+        {
+            return false;
+        }
+
+    // counter clockwise triangles face the camera; the back faces are
+    // culled like the StaticMesh does
+    const float area =
+        (b.sx - a.sx) * (c.sy - a.sy) -
+        (c.sx - a.sx) * (b.sy - a.sy);
+
+    if (! (area > 0.0f))
+        {
+            return false;
+        }
+
+    // the pixels whose centers lie in the bounding box; distant
+    // triangles often cover no pixel center at all
+    const float minX = min(a.sx, min(b.sx, c.sx));
+    const float maxX = max(a.sx, max(b.sx, c.sx));
+    const float minY = min(a.sy, min(b.sy, c.sy));
+    const float maxY = max(a.sy, max(b.sy, c.sy));
+
+    box[0] = max(0, (int)ceil(minX - 0.5f));
+    box[1] = max(0, (int)ceil(minY - 0.5f));
+    box[2] = min(mWidth - 1, (int)floor(maxX - 0.5f));
+    box[3] = min(mHeight - 1, (int)floor(maxY - 0.5f));
+
+    return (box[0] <= box[2] && box[1] <= box[3]);
+}
+
+void SoftRasterizer::AddTriangle(const Vertex& a, const Vertex& b, const Vertex& c,
+                                 const int* box, const Texture* texture)
+{
+    Triangle tri;
+    const Vertex* v[3] = { &a, &b, &c };
+
+    for (int i = 0; i < 3; ++i)
+        {
+            const float invW = v[i]->invW;
+            tri.x[i] = v[i]->sx;
+            tri.y[i] = v[i]->sy;
+            tri.z[i] = v[i]->sz;
+            tri.invW[i] = invW;
+
+            tri.attr[i][0] = v[i]->r * invW;
+            tri.attr[i][1] = v[i]->g * invW;
+            tri.attr[i][2] = v[i]->b * invW;
+            tri.attr[i][3] = v[i]->a * invW;
+            tri.attr[i][4] = v[i]->u * invW;
+            tri.attr[i][5] = v[i]->v * invW;
+        }
+
+    tri.minX = box[0];
+    tri.minY = box[1];
+    tri.maxX = box[2];
+    tri.maxY = box[3];
+    tri.texture = texture;
+
+    const int index = (int)mTriangles.size();
+    mTriangles.push_back(tri);
+
+    for (int ty = box[1] / TILE_SIZE; ty <= box[3] / TILE_SIZE; ++ty)
+        {
+            for (int tx = box[0] / TILE_SIZE; tx <= box[2] / TILE_SIZE; ++tx)
+                {
+                    mBins[ty * mTilesX + tx].push_back(index);
+                }
+        }
+}
+
+void SoftRasterizer::RasterizeTile(int tile, unsigned char* rgb)
+{
+    const int x0 = (tile % mTilesX) * TILE_SIZE;
+    const int y0 = (tile / mTilesX) * TILE_SIZE;
+    const int x1 = min(x0 + TILE_SIZE, mWidth) - 1;
+    const int y1 = min(y0 + TILE_SIZE, mHeight) - 1;
+
+    for (int y = y0; y <= y1; ++y)
+        {
+            float* depth = &mDepth[y * mWidth];
+            unsigned char* color = &rgb[(y * mWidth) * 3];
+
+            for (int x = x0; x <= x1; ++x)
+                {
+                    depth[x] = 1.0f;
+                    color[x*3+0] = mBackground[0];
+                    color[x*3+1] = mBackground[1];
+                    color[x*3+2] = mBackground[2];
+                }
+        }
+
+    const vector<int>& bin = mBins[tile];
+
+    for (size_t i = 0; i < bin.size(); ++i)
+        {
+            const Triangle& tri = mTriangles[bin[i]];
+
+            const int minX = max(tri.minX, x0);
+            const int maxX = min(tri.maxX, x1);
+            const int minY = max(tri.minY, y0);
+            const int maxY = min(tri.maxY, y1);
+
+            if (minX > maxX || minY > maxY)
+                {
+                    continue;
+                }
+
+            // the edge functions e_i(x, y) are the barycentric
+            // weights of the vertex opposite to edge i, scaled by twice
+            // the area; they are evaluated relative to a vertex of the
+            // edge, as the constant term cancels out for small triangles
+            float A[3], B[3], X[3], Y[3];
+            for (int e = 0; e < 3; ++e)
+                {
+                    const int p = (e + 1) % 3;
+                    const int q = (e + 2) % 3;
+                    A[e] = tri.y[p] - tri.y[q];
+                    B[e] = tri.x[q] - tri.x[p];
+                    X[e] = tri.x[p];
+                    Y[e] = tri.y[p];
+                }
+
+            const Texture* texture = tri.texture;
+
+            for (int y = minY; y <= maxY; ++y)
+                {
+                    const float py = y + 0.5f;
+                    const float rowE0 = B[0] * (py - Y[0]);
+                    const float rowE1 = B[1] * (py - Y[1]);
+                    const float rowE2 = B[2] * (py - Y[2]);
+
+                    float* depth = &mDepth[y * mWidth];
+                    unsigned char* color = &rgb[(y * mWidth) * 3];
+
+                    for (int x = minX; x <= maxX; ++x)
+                        {
+                            const float px = x + 0.5f;
+                            const float e0 = rowE0 + A[0] * (px - X[0]);
+                            const float e1 = rowE1 + A[1] * (px - X[1]);
+                            const float e2 = rowE2 + A[2] * (px - X[2]);
+
+                            if (e0 < 0.0f || e1 < 0.0f || e2 < 0.0f)
+                                {
+                                    continue;
+                                }
+
+                            const float sum = e0 + e1 + e2;
+                            if (! (sum > 0.0f))
+                                {
+                                    continue;
+                                }
+
+                            const float invSum = 1.0f / sum;
+                            const float b0 = e0 * invSum;
+                            const float b1 = e1 * invSum;
+                            const float b2 = e2 * invSum;
+
+                            const float z = b0 * tri.z[0] + b1 * tri.z[1] + b2 * tri.z[2];
+                            if (! (z < depth[x]))
+                                {
+                                    continue;
+                                }
+
+                            const float w = 1.0f /
+                                (b0 * tri.invW[0] + b1 * tri.invW[1] + b2 * tri.invW[2]);
+
+                            float attr[6];
+                            for (int k = 0; k < 6; ++k)
+                                {
+                                    attr[k] = (b0 * tri.attr[0][k] +
+                                               b1 * tri.attr[1][k] +
+                                               b2 * tri.attr[2][k]) * w;
+                                }
+
+                            if (texture != 0)
+                                {
+                                    // nearest texel, repeated
+                                    float u = attr[4] - floor(attr[4]);
+                                    float v = attr[5] - floor(attr[5]);
+                                    int tu = min((int)(u * texture->width), texture->width - 1);
+                                    int tv = min((int)(v * texture->height), texture->height - 1);
+
+                                    const unsigned char* texel =
+                                        &texture->rgba[(tv * texture->width + tu) * 4];
+
+                                    const float scale = 1.0f / 255.0f;
+                                    attr[0] *= texel[0] * scale;
+                                    attr[1] *= texel[1] * scale;
+                                    attr[2] *= texel[2] * scale;
+                                    attr[3] *= texel[3] * scale;
+                                }
+
+                            // the alpha test of the RenderServer
+                            const float alpha = attr[3];
+                            if (alpha <= 0.1f)
+                                {
+                                    continue;
+                                }
+
+                            depth[x] = z;
+
+                            unsigned char* c = &color[x*3];
+                            if (alpha >= 1.0f)
+                                {
+                                    c[0] = ToByte(attr[0]);
+                                    c[1] = ToByte(attr[1]);
+                                    c[2] = ToByte(attr[2]);
+                                } else
+                                {
+                                    const float keep = (1.0f - alpha) / 255.0f;
+                                    c[0] = ToByte(attr[0] * alpha + c[0] * keep);
+                                    c[1] = ToByte(attr[1] * alpha + c[1] * keep);
+                                    c[2] = ToByte(attr[2] * alpha + c[2] * keep);
+                                }
+                        }
+                }
+        }
+}
@@ -0,0 +1,202 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2008 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#ifndef SOFTRASTERIZER_H
+#define SOFTRASTERIZER_H
+
+#include <salt/bounds.h>
+#include <salt/matrix.h>
+#include <salt/vector.h>
+#include <vector>
+
+/** \class SoftRasterizer renders triangle meshes into an RGB image on
+    the CPU. It reproduces what the OpenGL RenderServer draws for the
+    image perceptor: the fixed function lighting with point lights,
+    evaluated per vertex, modulated with the diffuse texture, depth
+    tested, alpha tested and blended.
+
+    The image is split into tiles of TILE_SIZE pixels. The triangles
+    are transformed, clipped at the near plane and binned into the
+    tiles they overlap on the calling thread; then the tiles are
+    rasterized in parallel by a pool of worker threads that all
+    SoftRasterizers share. Each tile is written by one thread only.
+
+    Like glReadPixels, the image starts with the bottom row.
+*/
+class SoftRasterizer
+{
+public:
+    enum
+    {
+        /** the edge length of a tile in pixels */
+        TILE_SIZE = 32
+    };
+
+    /** an RGBA image with 8 bits per channel; the first row is at
+        texture coordinate t = 0 */
+    struct Texture
+    {
+        int width;
+        int height;
+        std::vector<unsigned char> rgba;
+    };
+
+    /** a point light, see kerosin::Light */
+    struct Light
+    {
+        salt::Vector3f pos;
+        float ambient[3];
+        float diffuse[3];
+    };
+
+    /** a mesh with one material */
+    struct Mesh
+    {
+        /** the world transform of the mesh */
+        salt::Matrix transform;
+
+        /** the scale applied before the transform */
+        salt::Vector3f scale;
+
+        /** three floats per vertex; normals and texCoords may be 0 */
+        const float* pos;
+        const float* normals;
+        const float* texCoords;
+        int numVertex;
+
+        /** three indices per triangle */
+        const unsigned int* index;
+        int numIndex;
+
+        /** the material reflectance */
+        float ambient[4];
+        float diffuse[4];
+        float emission[4];
+
+        /** the diffuse texture or 0 */
+        const Texture* texture;
+
+        /** the world bounding box of the mesh; an empty box disables
+            the frustum test of the whole mesh */
+        salt::AABB3 bounds;
+    };
+
+public:
+    SoftRasterizer();
+    ~SoftRasterizer();
+
+    /** sets the global ambient light, (0.2, 0.2, 0.2) by default */
+    void SetAmbient(float r, float g, float b);
+
+    /** sets the color the image is cleared to, black by default */
+    void SetBackground(float r, float g, float b);
+
+    /** renders the meshes seen with the given view and projection
+        transforms into rgb, which receives width * height * 3 bytes
+    */
+    void Render(const salt::Matrix& view, const salt::Matrix& projection,
+                const std::vector<Mesh>& meshes,
+                const std::vector<Light>& lights,
+                int width, int height, unsigned char* rgb);
+
+protected:
+    /** a vertex in clip space with its lit color and its window
+        coordinates, which are valid if w > 0 */
+    struct Vertex
+    {
+        float x, y, z, w;
+        float r, g, b, a;
+        float u, v;
+        float sx, sy, sz, invW;
+    };
+
+    /** a triangle in window coordinates; the attributes are divided
+        by w for perspective correct interpolation */
+    struct Triangle
+    {
+        float x[3];
+        float y[3];
+        float z[3];
+        float invW[3];
+        float attr[3][6];
+        int minX, minY, maxX, maxY;
+        const Texture* texture;
+    };
+
+    /** transforms and lights the vertices of a mesh and sets up its
+        triangles */
+    void SetupMesh(const Mesh& mesh, const salt::Matrix& viewProjection,
+                   const std::vector<Light>& lights);
+
+    /** clips a triangle at the near plane and adds the result */
+    void ClipTriangle(const Vertex& a, const Vertex& b, const Vertex& c,
+                      const Texture* texture);
+
+    /** calculates the lit color and the texture coordinates of the
+        vertex with the given index in the current mesh */
+    void LightVertex(int i);
+
+    /** calculates the window coordinates of a vertex */
+    void Project(Vertex& v) const;
+
+    /** returns true if a projected triangle faces the camera and
+        covers at least one pixel center; box receives the pixel
+        bounds minX, minY, maxX and maxY */
+    bool GetCoverage(const Vertex& a, const Vertex& b, const Vertex& c,
+                     int* box) const;
+
+    /** sets up a covering triangle and bins it into tiles */
+    void AddTriangle(const Vertex& a, const Vertex& b, const Vertex& c,
+                     const int* box, const Texture* texture);
+
+    /** rasterizes all triangles binned into one tile */
+    void RasterizeTile(int tile, unsigned char* rgb);
+
+protected:
+    float mAmbient[3];
+    unsigned char mBackground[3];
+
+    /** the image of the current frame */
+    int mWidth;
+    int mHeight;
+    int mTilesX;
+    int mTilesY;
+
+    /** the vertices of the current mesh and whether they are lit */
+    std::vector<Vertex> mVertices;
+    std::vector<bool> mLit;
+
+    /** the current mesh, its lights and the part of its color that
+        does not depend on the vertex */
+    const Mesh* mMesh;
+    const std::vector<Light>* mLights;
+    float mBaseColor[3];
+
+    /** the triangles of the current frame */
+    std::vector<Triangle> mTriangles;
+
+    /** the indices of the triangles per tile, in submission order */
+    std::vector<std::vector<int> > mBins;
+
+    /** the depth buffer */
+    std::vector<float> mDepth;
+};
+
+#endif // SOFTRASTERIZER_H
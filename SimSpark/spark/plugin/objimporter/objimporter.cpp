@@ -24,6 +24,8 @@
 #include <kerosin/materialserver/materialserver.h>
 #include <kerosin/materialserver/material2dtexture.h>
 #include <kerosin/materialserver/materialsolid.h>
+#include <oxygen/geometryserver/geometryserver.h>
+#include <oxygen/geometryserver/meshcache.h>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -57,6 +59,95 @@ std::shared_ptr<TriMesh> ObjImporter::ImportMesh
             return std::shared_ptr<TriMesh>();
         }
 
+    // try the binary copy in the mesh cache first
+    std::shared_ptr<GeometryServer> geometryServer =
+        std::dynamic_pointer_cast<GeometryServer>(GetParent().lock());
+
+    string cacheFile;
+    unsigned long long hash = 0;
+    unsigned long long size = 0;
+
+    if (
+        (geometryServer.get() != 0) &&
+        (! geometryServer->GetMeshCacheDir().empty()) &&
+        (MeshCache::HashFile(fileName, hash, size))
+        )
+        {
+            cacheFile = MeshCache::GetCacheFileName
+                (geometryServer->GetMeshCacheDir(), fileName);
+
+            std::shared_ptr<TriMesh> triMesh =
+                LoadCachedMesh(name, cacheFile, hash, size);
+
+            if (triMesh.get() != 0)
+                {
+                    return triMesh;
+                }
+        }
+
+    string matLibName;
+    bool materialsSet = false;
+
+    std::shared_ptr<TriMesh> triMesh =
+        ParseMesh(name, fileName, matLibName, materialsSet);
+
+    if (
+        (triMesh.get() != 0) &&
+        (! cacheFile.empty()) &&
+        (! MeshCache::Save(cacheFile, *triMesh, hash, size,
+                           (materialsSet ? "1" : "0") + matLibName))
+        )
+        {
+            GetLog()->Debug()
+                << "(ObjImporter) WARNING: cannot write mesh cache file '"
+                << cacheFile << "'\n";
+        }
+
+    return triMesh;
+}
+
+std::shared_ptr<TriMesh> ObjImporter::LoadCachedMesh
+(const string& name, const string& cacheFile,
+ unsigned long long hash, unsigned long long size)
+{
+    // the tag holds whether the materials of the material library
+    // were used, followed by the name of the library
+    string tag;
+    std::shared_ptr<TriMesh> triMesh =
+        MeshCache::Load(cacheFile, hash, size, tag);
+
+    if (triMesh.get() == 0 || tag.empty())
+        {
+            return std::shared_ptr<TriMesh>();
+        }
+
+    string matLibName = tag.substr(1);
+    TObjMatValueVector materials;
+
+    if (! matLibName.empty() && ! SetupMaterials(matLibName, materials))
+        {
+            GetLog()->Debug()
+                << "(ObjImporter) WARNING: could not setup materials, "
+                << "will set default material matWhite which has to be defined manually.'\n";
+        }
+
+    // without materials, all faces of the mesh use matWhite; the
+    // cached copy is only valid if this did not change
+    if ((materials.size() != 0) != (tag[0] == '1'))
+        {
+            return std::shared_ptr<TriMesh>();
+        }
+
+    GetLog()->Normal() << "(ObjImporter) Loaded " << name
+                       << " from the mesh cache\n";
+
+    return triMesh;
+}
+
+std::shared_ptr<TriMesh> ObjImporter::ParseMesh
+(const string& name, const string& fileName,
+ string& matLibName, bool& materialsSet)
+{
     ifstream ifs;
     ifs.open(fileName.c_str());
 
@@ -99,6 +190,9 @@ std::shared_ptr<TriMesh> ObjImporter::ImportMesh
                 }
         }
 
+    matLibName = matlibname;
+    materialsSet = (materials.size() != 0);
+
     // skip object name
     getline(ifs, buffer);
 
@@ -57,6 +57,9 @@ typedef std::map<std::string, TFaceIndexList> TMatNameFaceIndexListMap;
      texture coordinates, the vertex normals, and the texture information.
      It also reads the materials in a mtllib file and sets them up with the
 	 MaterialServer.
+
+     Imported meshes are stored in the mesh cache of the GeometryServer
+     (see oxygen::MeshCache), so that each .obj file is only parsed once.
  */
 class ObjImporter : public oxygen::MeshImporter
 {
@@ -69,6 +72,22 @@ public:
 
 protected:
 
+    /** loads the mesh \param name from \param cacheFile and sets up
+        its materials; returns an empty pointer if the cache file is
+        missing or outdated
+    */
+    std::shared_ptr<oxygen::TriMesh> LoadCachedMesh
+    (const std::string& name, const std::string& cacheFile,
+     unsigned long long hash, unsigned long long size);
+
+    /** parses the .obj file \param fileName; \param matLibName
+        receives the name of its material library and \param
+        materialsSet whether the faces use the materials of it
+    */
+    std::shared_ptr<oxygen::TriMesh> ParseMesh
+    (const std::string& name, const std::string& fileName,
+     std::string& matLibName, bool& materialsSet);
+
     void ExplodeString(std::string & input, 
                        std::vector<std::string> & output, 
                        std::string & del);
@@ -21,6 +21,7 @@
 */
 
 #include "oderigidbody.h"
+#include <algorithm>
 
 using namespace oxygen;
 using namespace salt;
@@ -54,6 +55,26 @@ bool RigidBodyImp::IsEnabled(long bodyID) const
     return (dBodyIsEnabled(ODEBody) != 0);
 }
 
+void RigidBodyImp::SetAutoDisableFlag(bool flag, long bodyID)
+{
+    dBodyID ODEBody = (dBodyID) bodyID;
+    dBodySetAutoDisableFlag(ODEBody, static_cast<int>(flag));
+}
+
+void RigidBodyImp::SetAutoDisableParameters(float linearThreshold,
+                                            float angularThreshold,
+                                            int idleSteps, float idleTime,
+                                            int averageSamples, long bodyID)
+{
+    dBodyID ODEBody = (dBodyID) bodyID;
+    dBodySetAutoDisableLinearThreshold(ODEBody, linearThreshold);
+    dBodySetAutoDisableAngularThreshold(ODEBody, angularThreshold);
+    dBodySetAutoDisableSteps(ODEBody, idleSteps);
+    dBodySetAutoDisableTime(ODEBody, idleTime);
+    dBodySetAutoDisableAverageSamplesCount
+        (ODEBody, static_cast<unsigned int>(std::max<int>(1, averageSamples)));
+}
+
 void RigidBodyImp::UseGravity(bool f, long bodyID)
 {
     dBodyID ODEBody = (dBodyID) bodyID;
@@ -43,6 +43,11 @@ public:
     void Enable(long bodyID);
     void Disable(long bodyID);
     bool IsEnabled(long bodyID) const;
+    void SetAutoDisableFlag(bool flag, long bodyID);
+    void SetAutoDisableParameters(float linearThreshold,
+                                  float angularThreshold,
+                                  int idleSteps, float idleTime,
+                                  int averageSamples, long bodyID);
     void UseGravity(bool f, long bodyID);
     bool UsesGravity(long bodyID) const;
     void SetMass(float mass, long bodyID);
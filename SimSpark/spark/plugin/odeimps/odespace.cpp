@@ -22,6 +22,10 @@
 #include "odespace.h"
 #include <oxygen/physicsserver/collider.h>
 #include <oxygen/physicsserver/space.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
 
 using namespace oxygen;
 
@@ -31,7 +35,10 @@ void SpaceImp::collisionNearCallback(void* data, dGeomID obj1, dGeomID obj2)
     space->HandleCollide((long) obj1, (long) obj2);
 }
 
-SpaceImp::SpaceImp() : PhysicsObjectImp()
+SpaceImp::SpaceImp() : PhysicsObjectImp(),
+    mCacheEnabled(false), mMoveTolerance(0), mTurnCos(1),
+    mPersistTolerance(0), mMaxReuse(0), mStep(0),
+    mPairTests(0), mPairsReused(0), mContactsPersisted(0), mContactsTotal(0)
 {
 }
 
@@ -91,6 +98,9 @@ void SpaceImp::DestroySpace(long contactGroup, long spaceID)
 
     // release the ODE space
     dSpaceDestroy(SpaceImp);
+
+    // geom ids may be reused by the next scene
+    mContactPairs.clear();
 }
 
 bool SpaceImp::ObjectIsSpace(long objectID){
@@ -119,6 +129,14 @@ bool SpaceImp::AreConnectedWithJoint(long bodyID1, long bodyID2){
     return dAreConnectedExcluding(ODEBody1, ODEBody2, dJointTypeContact);
 }
 
+bool SpaceImp::IsBodyEnabled(long bodyID){
+    if (! bodyID)
+        return false;
+
+    dBodyID ODEBody = (dBodyID) bodyID;
+    return (dBodyIsEnabled(ODEBody) != 0);
+}
+
 void SpaceImp::CollideInternal(std::shared_ptr<Collider> collider, 
                               std::shared_ptr<Collider> collidee,
                               long geomID1, long geomID2)
@@ -131,22 +149,233 @@ void SpaceImp::CollideInternal(std::shared_ptr<Collider> collider,
     // mistakes and pass non-intersecting pairs. Thus we can not
     // expect that dCollide() will return contacts for every pair
     // passed to the callback.
-    static const int nContacts = 4;
-    static dContact contacts[nContacts];
+    static dContact contacts[MAX_CONTACTS];
 
-    int n = dCollide (geom1, geom2, nContacts,
-                     &contacts[0].geom, sizeof(dContact));
+    int n = 0;
+    dContact* pairContacts = contacts;
 
-    if (n == 0)
+    if (! mCacheEnabled)
     {
-        return;
-    }
+        n = dCollide (geom1, geom2, MAX_CONTACTS,
+                      &contacts[0].geom, sizeof(dContact));
+    } else
+    {
+        std::pair<TContactPairMap::iterator, bool> entry =
+            mContactPairs.insert
+            (TContactPairMap::value_type
+             (std::make_pair(collider->GetSerial(), collidee->GetSerial()),
+              ContactPair()));
+
+        ContactPair& pair = entry.first->second;
 
+        if (
+            (entry.second) ||
+            (pair.lastStep + 1 != mStep) ||
+            (pair.geoms[0] != geom1) ||
+            (pair.geoms[1] != geom2) ||
+            (pair.classes[0] != dGeomGetClass(geom1)) ||
+            (pair.classes[1] != dGeomGetClass(geom2))
+            )
+            {
+                // a new pair, the pair left the broad phase in
+                // between, or a collider replaced its geom
+                UpdateContactPair(geom1, geom2, pair, false);
+            } else if (
+                       (pair.reused < mMaxReuse) &&
+                       (IsAtPose(geom1, pair.pose[0])) &&
+                       (IsAtPose(geom2, pair.pose[1]))
+                       )
+            {
+                // nothing moved, the last result is still valid
+                ++pair.reused;
+                ++mPairsReused;
+                mContactsTotal += pair.count;
+            } else
+            {
+                UpdateContactPair(geom1, geom2, pair, true);
+            }
+
+        pair.lastStep = mStep;
+        n = pair.count;
+        pairContacts = pair.contacts;
+    }
 
     for (int i=0;i<n;++i)
         {
             // notify the collider nodes
-            collider->OnCollision(collidee,(GenericContact&) contacts[i],Collider::CT_DIRECT);
-            collidee->OnCollision(collider,(GenericContact&) contacts[i],Collider::CT_SYMMETRIC);
+            collider->OnCollision(collidee,(GenericContact&) pairContacts[i],Collider::CT_DIRECT);
+            collidee->OnCollision(collider,(GenericContact&) pairContacts[i],Collider::CT_SYMMETRIC);
+        }
+}
+
+void SpaceImp::BeginCollide()
+{
+    ++mStep;
+
+    // forget the pairs that were not passed to CollideInternal() in
+    // the last step
+    TContactPairMap::iterator iter = mContactPairs.begin();
+    while (iter != mContactPairs.end())
+        {
+            if (iter->second.lastStep + 1 < mStep)
+                {
+                    iter = mContactPairs.erase(iter);
+                } else
+                {
+                    ++iter;
+                }
+        }
+}
+
+void SpaceImp::SetContactCache(bool enable, float moveTolerance,
+                               float turnTolerance, float persistTolerance,
+                               int maxReuse)
+{
+    mCacheEnabled = enable;
+    mMoveTolerance = std::max<float>(0.0f, moveTolerance);
+    mTurnCos = std::cos(0.5f * std::max<float>(0.0f, turnTolerance));
+    mPersistTolerance = std::max<float>(0.0f, persistTolerance);
+    mMaxReuse = std::max<int>(0, maxReuse);
+
+    mContactPairs.clear();
+    mPairTests = 0;
+    mPairsReused = 0;
+    mContactsPersisted = 0;
+    mContactsTotal = 0;
+}
+
+std::string SpaceImp::GetContactCacheReport()
+{
+    std::ostringstream report;
+
+    if (! mCacheEnabled)
+    {
+        report << "contact cache disabled";
+        return report.str();
+    }
+
+    const unsigned long long pairs = mPairTests + mPairsReused;
+
+    report << "cached pairs: " << mContactPairs.size()
+           << ", narrow phase tests: " << mPairTests
+           << ", reused: " << mPairsReused;
+
+    if (pairs > 0)
+        {
+            report << " (" << (100.0 * mPairsReused / pairs) << "%)";
         }
+
+    report << ", contacts: " << mContactsTotal
+           << ", persistent: " << mContactsPersisted;
+
+    return report.str();
+}
+
+void SpaceImp::GetGeomPose(dGeomID geom, GeomPose& pose)
+{
+    // planes are not placeable and never move
+    if (dGeomGetClass(geom) == dPlaneClass)
+        {
+            memset(&pose, 0, sizeof(GeomPose));
+            return;
+        }
+
+    const dReal* pos = dGeomGetPosition(geom);
+    pose.pos[0] = pos[0];
+    pose.pos[1] = pos[1];
+    pose.pos[2] = pos[2];
+    dGeomGetQuaternion(geom, pose.quat);
+}
+
+bool SpaceImp::IsAtPose(dGeomID geom, const GeomPose& pose) const
+{
+    if (dGeomGetClass(geom) == dPlaneClass)
+        {
+            return true;
+        }
+
+    const dReal* pos = dGeomGetPosition(geom);
+    const dReal dx = pos[0] - pose.pos[0];
+    const dReal dy = pos[1] - pose.pos[1];
+    const dReal dz = pos[2] - pose.pos[2];
+
+    if (dx*dx + dy*dy + dz*dz > mMoveTolerance * mMoveTolerance)
+        {
+            return false;
+        }
+
+    // q and -q are the same rotation
+    dQuaternion quat;
+    dGeomGetQuaternion(geom, quat);
+    const dReal dot =
+        quat[0] * pose.quat[0] + quat[1] * pose.quat[1] +
+        quat[2] * pose.quat[2] + quat[3] * pose.quat[3];
+
+    return (std::fabs(dot) >= mTurnCos);
+}
+
+void SpaceImp::UpdateContactPair(dGeomID geom1, dGeomID geom2,
+                                 ContactPair& pair, bool persist)
+{
+    dContact contacts[MAX_CONTACTS];
+    const int n = dCollide (geom1, geom2, MAX_CONTACTS,
+                            &contacts[0].geom, sizeof(dContact));
+    ++mPairTests;
+    mContactsTotal += n;
+
+    if (persist)
+        {
+            // a point that is close to a point of the last step, with
+            // about the same normal, keeps its old position so that a
+            // resting contact does not jitter between the steps
+            const dReal tolerance2 = mPersistTolerance * mPersistTolerance;
+            bool matched[MAX_CONTACTS] = { false, false, false, false };
+
+            for (int i=0;i<n;++i)
+                {
+                    dContactGeom& contact = contacts[i].geom;
+
+                    for (int j=0;j<pair.count;++j)
+                        {
+                            if (matched[j])
+                                {
+                                    continue;
+                                }
+
+                            const dContactGeom& last = pair.contacts[j].geom;
+                            const dReal dx = contact.pos[0] - last.pos[0];
+                            const dReal dy = contact.pos[1] - last.pos[1];
+                            const dReal dz = contact.pos[2] - last.pos[2];
+                            const dReal dot =
+                                contact.normal[0] * last.normal[0] +
+                                contact.normal[1] * last.normal[1] +
+                                contact.normal[2] * last.normal[2];
+
+                            if (
+                                (dx*dx + dy*dy + dz*dz > tolerance2) ||
+                                (dot < 0.99)
+                                )
+                                {
+                                    continue;
+                                }
+
+                            contact.pos[0] = last.pos[0];
+                            contact.pos[1] = last.pos[1];
+                            contact.pos[2] = last.pos[2];
+                            matched[j] = true;
+                            ++mContactsPersisted;
+                            break;
+                        }
+                }
+        }
+
+    memcpy(pair.contacts, contacts, n * sizeof(dContact));
+    pair.count = n;
+    pair.reused = 0;
+    pair.geoms[0] = geom1;
+    pair.geoms[1] = geom2;
+    pair.classes[0] = dGeomGetClass(geom1);
+    pair.classes[1] = dGeomGetClass(geom2);
+    GetGeomPose(geom1, pair.pose[0]);
+    GetGeomPose(geom2, pair.pose[1]);
 }
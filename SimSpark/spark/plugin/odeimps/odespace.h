@@ -24,6 +24,7 @@
 
 #include "odephysicsobject.h"
 #include <oxygen/physicsserver/int/spaceint.h>
+#include <unordered_map>
 
 class SpaceImp : public oxygen::SpaceInt, public PhysicsObjectImp
 {
@@ -50,12 +51,100 @@ public:
     long FetchBody(long geomID);
     long FetchSpace(long geomID);
     bool AreConnectedWithJoint(long bodyID1, long bodyID2);
+    bool IsBodyEnabled(long bodyID);
     void CollideInternal(std::shared_ptr<oxygen::Collider> collider, 
                         std::shared_ptr<oxygen::Collider> collidee,
                         long geomID1, long geomID2);
-    
+    void BeginCollide();
+    void SetContactCache(bool enable, float moveTolerance,
+                         float turnTolerance, float persistTolerance,
+                         int maxReuse);
+    std::string GetContactCacheReport();
+
 private:
     static void collisionNearCallback(void* data, dGeomID obj1, dGeomID obj2);
+
+    enum { MAX_CONTACTS = 4 };
+
+    /** the pose of a geom at the time of the last narrow phase test */
+    struct GeomPose
+    {
+        dVector3 pos;
+        dQuaternion quat;
+    };
+
+    /** the cached contacts of an ordered collider pair */
+    struct ContactPair
+    {
+        /** the step the pair was last passed to CollideInternal() */
+        unsigned int lastStep;
+
+        /** the geoms of the colliders at the last test */
+        dGeomID geoms[2];
+
+        /** the number of steps the contacts were reused without a test */
+        int reused;
+
+        int classes[2];
+        GeomPose pose[2];
+
+        int count;
+        dContact contacts[MAX_CONTACTS];
+    };
+
+    /** a pair of Collider serial numbers; unlike geom addresses they
+        are not reused when a geom is freed and another one allocated
+    */
+    typedef std::pair<unsigned long, unsigned long> TColliderPair;
+
+    struct ColliderPairHash
+    {
+        size_t operator()(const TColliderPair& p) const
+        {
+            size_t h1 = static_cast<size_t>(p.first);
+            size_t h2 = static_cast<size_t>(p.second);
+            return h1 ^ (h2 + 0x9e3779b9 + (h1 << 6) + (h1 >> 2));
+        }
+    };
+
+    typedef std::unordered_map<TColliderPair, ContactPair,
+                               ColliderPairHash> TContactPairMap;
+
+    /** stores the current pose of a geom */
+    static void GetGeomPose(dGeomID geom, GeomPose& pose);
+
+    /** returns true if a geom is within the move and turn tolerance of
+        a stored pose
+    */
+    bool IsAtPose(dGeomID geom, const GeomPose& pose) const;
+
+    /** runs the narrow phase test for a pair and updates its cache
+        entry; persistent points keep their previous position
+    */
+    void UpdateContactPair(dGeomID geom1, dGeomID geom2, ContactPair& pair,
+                           bool persist);
+
+private:
+    bool mCacheEnabled;
+    float mMoveTolerance;
+
+    /** the cosine of half the turn tolerance, compared against the
+        dot product of two quaternions
+    */
+    float mTurnCos;
+    float mPersistTolerance;
+    int mMaxReuse;
+
+    /** counts the calls to BeginCollide() */
+    unsigned int mStep;
+
+    TContactPairMap mContactPairs;
+
+    /** statistics since the cache was enabled */
+    unsigned long long mPairTests;
+    unsigned long long mPairsReused;
+    unsigned long long mContactsPersisted;
+    unsigned long long mContactsTotal;
 };
 
 DECLARE_CLASS(SpaceImp)
@@ -20,6 +20,7 @@
 */
 
 #include "odeworld.h"
+#include <algorithm>
 
 using namespace oxygen;
 using namespace salt;
@@ -87,6 +88,20 @@ void WorldImp::SetAutoDisableFlag(bool flag, long worldID)
     dWorldSetAutoDisableFlag(WorldImp, static_cast<int>(flag));
 }
 
+void WorldImp::SetAutoDisableParameters(float linearThreshold,
+                                        float angularThreshold,
+                                        int idleSteps, float idleTime,
+                                        int averageSamples, long worldID)
+{
+    dWorldID WorldImp = (dWorldID) worldID;
+    dWorldSetAutoDisableLinearThreshold(WorldImp, linearThreshold);
+    dWorldSetAutoDisableAngularThreshold(WorldImp, angularThreshold);
+    dWorldSetAutoDisableSteps(WorldImp, idleSteps);
+    dWorldSetAutoDisableTime(WorldImp, idleTime);
+    dWorldSetAutoDisableAverageSamplesCount
+        (WorldImp, static_cast<unsigned int>(std::max<int>(1, averageSamples)));
+}
+
 void WorldImp::SetContactSurfaceLayer(float depth, long worldID)
 {
     dWorldID WorldImp = (dWorldID) worldID;
@@ -49,6 +49,10 @@ public:
     void Step(float deltaTime, long worldID);
     bool GetAutoDisableFlag(long worldID) const;
     void SetAutoDisableFlag(bool flag, long worldID);
+    void SetAutoDisableParameters(float linearThreshold,
+                                  float angularThreshold,
+                                  int idleSteps, float idleTime,
+                                  int averageSamples, long worldID);
     void SetContactSurfaceLayer(float depth, long worldID);
     float GetContactSurfaceLayer(long worldID) const;
     long CreateWorld();
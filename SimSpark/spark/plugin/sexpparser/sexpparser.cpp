@@ -42,7 +42,7 @@ SexpParser::Parse(const std::string& input)
 {
     size_t len = input.length();
 
-    std::shared_ptr<PredicateList> predList(new PredicateList);
+    std::shared_ptr<PredicateList> predList = PredicateList::Create();
     if (len == 0)
     {
             return predList;
@@ -158,6 +158,11 @@ SexpParser::ListToString(stringstream& ss, const ParameterList& lst)
             ss << space;
             ss <<std::any_cast<int>(*i);
         }
+        else if (i->type() == typeid(PreformattedText))
+        {
+            ss << space;
+            ss << std::any_cast<const PreformattedText&>(*i).text;
+        }
         else if (i->type() == typeid(ParameterList))
         {
             const any* v = &(*i);
@@ -180,6 +185,13 @@ SexpParser::ListToString(stringstream& ss, const ParameterList& lst)
 void
 SexpParser::PredicateToString(stringstream& ss, const Predicate& plist)
 {
+    if (plist.name.empty())
+    {
+        // preformatted output of a perceptor, see PreformattedText
+        ListToString(ss,plist.parameter);
+        return;
+    }
+
     ss << '(';
     ss << plist.name;
     ss << ' ';
@@ -27,6 +27,7 @@
 #include "timeperceptor.h"
 #include "universaljointeffector.h"
 #include "universaljointperceptor.h"
+#include "jointstateperceptor.h"
 
 ZEITGEIST_EXPORT_BEGIN()
     ZEITGEIST_EXPORT(Hinge2Effector);
@@ -36,4 +37,5 @@ ZEITGEIST_EXPORT_BEGIN()
     ZEITGEIST_EXPORT(HingePerceptor);
     ZEITGEIST_EXPORT(UniversalJointEffector);
     ZEITGEIST_EXPORT(UniversalJointPerceptor);
+    ZEITGEIST_EXPORT(JointStatePerceptor);
 ZEITGEIST_EXPORT_END()
@@ -0,0 +1,206 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2004-2009 RoboCup Soccer Server 3D Maintenance Group
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#include "jointstateperceptor.h"
+#include "hingeperceptor.h"
+#include "universaljointperceptor.h"
+#include <cstdio>
+#include <oxygen/agentaspect/agentaspect.h>
+#include <zeitgeist/logserver/logserver.h>
+
+using namespace oxygen;
+using namespace zeitgeist;
+using namespace std;
+
+JointStatePerceptor::JointStatePerceptor()
+    : Perceptor(), mDirty(true), mSendRates(false), mLastLength(0)
+{
+}
+
+JointStatePerceptor::~JointStatePerceptor()
+{
+}
+
+void JointStatePerceptor::SetSendRates(bool send)
+{
+    mSendRates = send;
+}
+
+void JointStatePerceptor::OnUnlink()
+{
+    Perceptor::OnUnlink();
+    ReleasePerceptors();
+    mJoints.clear();
+    mDirty = true;
+}
+
+void JointStatePerceptor::UpdateCacheInternal()
+{
+    Perceptor::UpdateCacheInternal();
+    mDirty = true;
+}
+
+void JointStatePerceptor::ReleasePerceptors()
+{
+    for (
+         vector<std::weak_ptr<Perceptor> >::iterator iter = mBatched.begin();
+         iter != mBatched.end();
+         ++iter
+         )
+        {
+            std::shared_ptr<Perceptor> perceptor = iter->lock();
+            if (perceptor.get() != 0)
+                {
+                    perceptor->SetBatched(false);
+                }
+        }
+
+    mBatched.clear();
+}
+
+void JointStatePerceptor::BuildTemplate()
+{
+    ReleasePerceptors();
+    mJoints.clear();
+    mDirty = false;
+
+    // the joints of a robot are spread over nested AgentAspects, so
+    // start at the outermost one
+    std::shared_ptr<AgentAspect> agent;
+    std::shared_ptr<AgentAspect> parent =
+        FindParentSupportingClass<AgentAspect>().lock();
+
+    while (parent.get() != 0)
+        {
+            agent = parent;
+            parent = agent->FindParentSupportingClass<AgentAspect>().lock();
+        }
+
+    if (agent.get() == 0)
+        {
+            GetLog()->Error()
+                << "(JointStatePerceptor) ERROR: found no AgentAspect parent\n";
+            return;
+        }
+
+    TLeafList perceptors;
+    agent->ListChildrenSupportingClass<Perceptor>(perceptors, true);
+
+    for (
+         TLeafList::iterator iter = perceptors.begin();
+         iter != perceptors.end();
+         ++iter
+         )
+        {
+            JointEntry entry;
+
+            if (std::dynamic_pointer_cast<HingePerceptor>(*iter).get() != 0)
+                {
+                    entry.hinge = (*iter)->FindParentSupportingClass<HingeJoint>().lock();
+                    entry.prefix = "(HJ (n " + (*iter)->GetName() + ") (ax ";
+                } else if (std::dynamic_pointer_cast<UniversalJointPerceptor>(*iter).get() != 0)
+                {
+                    entry.universal = (*iter)->FindParentSupportingClass<UniversalJoint>().lock();
+                    entry.prefix = "(UJ (n " + (*iter)->GetName() + ") (ax1 ";
+                }
+
+            if (
+                (entry.hinge.get() == 0) &&
+                (entry.universal.get() == 0)
+                )
+                {
+                    continue;
+                }
+
+            std::shared_ptr<Perceptor> perceptor =
+                std::static_pointer_cast<Perceptor>(*iter);
+            perceptor->SetBatched(true);
+            mBatched.push_back(perceptor);
+
+            mJoints.push_back(entry);
+        }
+}
+
+void JointStatePerceptor::AppendValue(std::string& out, float value)
+{
+    // the SexpParser writes floats in fixed notation with two digits
+    char buffer[32];
+    int len = snprintf(buffer, sizeof(buffer), "%.2f", value);
+    if (len > 0)
+        {
+            out.append(buffer, len);
+        }
+}
+
+bool JointStatePerceptor::Percept(std::shared_ptr<oxygen::PredicateList> predList)
+{
+    if (mDirty)
+        {
+            BuildTemplate();
+        }
+
+    if (mJoints.empty())
+        {
+            return false;
+        }
+
+    std::string text;
+    text.reserve(mLastLength + 16);
+
+    for (
+         vector<JointEntry>::const_iterator iter = mJoints.begin();
+         iter != mJoints.end();
+         ++iter
+         )
+        {
+            text += iter->prefix;
+
+            if (iter->hinge.get() != 0)
+                {
+                    AppendValue(text, iter->hinge->GetAngle());
+                    if (mSendRates)
+                        {
+                            text += ") (rt ";
+                            AppendValue(text, iter->hinge->GetAngleRate());
+                        }
+                } else
+                {
+                    AppendValue(text, iter->universal->GetAngle(Joint::AI_FIRST));
+                    if (mSendRates)
+                        {
+                            text += ") (rt1 ";
+                            AppendValue(text, iter->universal->GetAngleRate(Joint::AI_FIRST));
+                        }
+
+                    text += ") (ax2 ";
+                    AppendValue(text, iter->universal->GetAngle(Joint::AI_SECOND));
+                    if (mSendRates)
+                        {
+                            text += ") (rt2 ";
+                            AppendValue(text, iter->universal->GetAngleRate(Joint::AI_SECOND));
+                        }
+                }
+
+            text += "))";
+        }
+
+    mLastLength = text.size();
+    predList->AddPreformatted(text);
+
+    return true;
+}
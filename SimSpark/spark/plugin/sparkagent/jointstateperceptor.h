@@ -0,0 +1,101 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2004-2009 RoboCup Soccer Server 3D Maintenance Group
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+#ifndef JOINTSTATEPERCEPTOR_H
+#define JOINTSTATEPERCEPTOR_H
+
+#include <string>
+#include <vector>
+#include <oxygen/agentaspect/perceptor.h>
+#include <oxygen/physicsserver/hingejoint.h>
+#include <oxygen/physicsserver/universaljoint.h>
+
+/**
+ * @class JointStatePerceptor
+ * @brief Perceptor for all hinge and universal joints of a robot.
+ * @ingroup perceptors
+ *
+ * The JointStatePerceptor takes over all HingePerceptors and
+ * UniversalJointPerceptors below the AgentAspect of the robot. It
+ * reads the joints in one pass and writes the output into a
+ * preformatted template, so that only the numbers are formatted each
+ * cycle. The output is identical to the one of the single perceptors,
+ * e.g. (HJ (n hj1) (ax 12.34))(UJ (n uj1) (ax1 1.00) (ax2 2.00)).
+ *
+ * Add one JointStatePerceptor anywhere below the AgentAspect; the
+ * single perceptors then stop sending themselves.
+ */
+class JointStatePerceptor : public oxygen::Perceptor
+{
+public:
+    JointStatePerceptor();
+    virtual ~JointStatePerceptor();
+
+    //! \return true, if valid data is available and false otherwise.
+    bool Percept(std::shared_ptr<oxygen::PredicateList> predList);
+
+    /** enables the angle rates (rt, rt1 and rt2) in the output; they
+        are disabled by default, like in the single perceptors
+    */
+    void SetSendRates(bool send);
+
+protected:
+    virtual void OnUnlink();
+
+    /** rebuilds the template after the scene changed */
+    virtual void UpdateCacheInternal();
+
+    /** collects the joint perceptors of the robot and builds the
+        template
+    */
+    void BuildTemplate();
+
+    /** hands the output back to the single perceptors */
+    void ReleasePerceptors();
+
+    /** appends a value like the parser formats a float */
+    static void AppendValue(std::string& out, float value);
+
+protected:
+    struct JointEntry
+    {
+        std::shared_ptr<oxygen::HingeJoint> hinge;
+        std::shared_ptr<oxygen::UniversalJoint> universal;
+
+        /** e.g. "(HJ (n hj1) (ax " */
+        std::string prefix;
+    };
+
+    /** the joints in the order of the single perceptors */
+    std::vector<JointEntry> mJoints;
+
+    /** the perceptors that are batched by this perceptor */
+    std::vector<std::weak_ptr<oxygen::Perceptor> > mBatched;
+
+    /** true if the template must be rebuilt */
+    bool mDirty;
+
+    bool mSendRates;
+
+    /** the length of the last output, reserved for the next one */
+    size_t mLastLength;
+};
+
+DECLARE_CLASS(JointStatePerceptor)
+
+#endif //JOINTSTATEPERCEPTOR_H
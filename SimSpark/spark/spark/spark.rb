@@ -55,6 +55,9 @@ $agentStep = 0.02
 $agentType = 'tcp'
 $agentPort = 3100
 $agentSyncMode = false
+# maximum time in microseconds to wait for all agents to sync in sync
+# mode, 0 waits until every agent has synced
+$agentSyncTimeout = 0
 $threadedAgentControl = true
 
 # (MonitorControl) constants
@@ -79,11 +82,83 @@ $monitorType = 'tcp'
 $physicsGlobalCFM = 0.00001
 $physicsGlobalGravity = -9.81
 
+# bodies at rest are disabled (put to sleep) and skipped by the
+# physics step and the collision detection. A body sleeps once its
+# linear (m/s) and angular (rad/s) speed, averaged over the given
+# number of steps, stayed below the thresholds for the idle steps and
+# the idle time (seconds). Individual bodies can override this with
+# RigidBody.setAutoDisableParameters in their rsg. Moving a body,
+# setting its velocity, applying a force, motor commands and contacts
+# with awake bodies wake it up again; World.getSleepReport tells how
+# many bodies are asleep.
+$physicsAutoDisable = true
+$autoDisableLinearThreshold = 0.01
+$autoDisableAngularThreshold = 0.01
+$autoDisableIdleSteps = 10
+$autoDisableIdleTime = 0.0
+$autoDisableAverageSamples = 1
+
+# the contact cache reuses the contacts of a geom pair while neither
+# geom moved more than the move tolerance (meters) or turned more than
+# the turn tolerance (radians), for at most $contactCacheMaxReuse
+# steps; new contact points within the persist tolerance (meters) of
+# an old point keep the old position
+$enableContactCache = false
+$contactCacheMoveTolerance = 0.0005
+$contactCacheTurnTolerance = 0.002
+$contactCachePersistTolerance = 0.002
+$contactCacheMaxReuse = 10
+
 # (Simulation) constants
 #
 $monitorMultiThreadedMode = false
 $serverMultiThreadedMode = true
 
+# headless turbo mode: the simulation advances as soon as all agents
+# have synced (or $turboAgentTimeout microseconds passed), without a
+# timer and without rendering
+$enableTurboMode = false
+$turboAgentTimeout = 1000000
+
+# the cycle profiler records the duration of each phase of the
+# simulation cycle; query it over telnet with sparkProfileReport
+$enableCycleProfiler = false
+$cycleProfilerWindow = 250
+
+# the predicates of agent messages, percepts and monitor data are
+# allocated from per thread arenas that are rewound every cycle; query
+# the allocation counts over telnet with sparkCycleArenaReport. Off
+# until simspark-bench --cycle-arena shows a cycle time gain
+$enableCycleArena = false
+
+# imported .obj meshes are stored in a binary mesh cache in the users
+# dot directory, so that later starts map them instead of parsing them
+$enableMeshCache = true
+
+# bundles are imported lazily: the classes of each bundle are recorded
+# in a manifest in the users dot directory, and a bundle that is
+# unchanged since is only loaded when one of its classes is first
+# instantiated. Off until the startup trace ($printStartupTrace) shows
+# a gain over importing the bundles on startup
+$lazyBundles = false
+
+# print how long the bundle imports, scripts and scene imports took
+# when the simulation starts; query it over telnet with
+# sparkStartupReport
+$printStartupTrace = false
+
+# the random seed (a seed of 0 means: use a random random seed)
+$randomSeed = 0
+
+# the command journal records the input of the simulation (agent and
+# monitor messages, connects, the random state) into $journalRecord; a
+# replay of $journalReplay runs headless in turbo mode without network
+# and quits after the last recorded cycle. The senses generated during
+# a replay are written to $journalSenseLog, if set
+$journalRecord = ''
+$journalReplay = ''
+$journalSenseLog = ''
+
 #
 # below is a set of utility functions for the user app
 #
@@ -193,6 +268,26 @@ def sparkGetSimulationServer
   return sparkGetOrCreate('oxygen/SimulationServer', $serverPath+'simulation')
 end
 
+def sparkGetCycleProfiler
+  return sparkGetOrCreate('oxygen/CycleProfiler', $serverPath+'profiler')
+end
+
+def sparkProfileReport
+  profiler = get($serverPath+'profiler')
+  if (profiler == nil)
+    return 'no cycle profiler installed'
+  end
+  return profiler.report()
+end
+
+def sparkCycleArenaReport
+  return sparkGetSimulationServer().getCycleArenaReport()
+end
+
+def sparkStartupReport
+  return startupTraceReport()
+end
+
 def sparkGetGeometryServer
   return sparkGetOrCreate('oxygen/GeometryServer', $serverPath+'geometry')
 end
@@ -237,10 +332,20 @@ def sparkResetScene
   world = new('oxygen/World', $scenePath+'world')
   world.setGravity(0.0, 0.0, $physicsGlobalGravity)
   world.setCFM($physicsGlobalCFM)
-  world.setAutoDisableFlag(true)             #not in simspark
+  world.setAutoDisableFlag($physicsAutoDisable)
+  world.setAutoDisableParameters($autoDisableLinearThreshold,
+                                 $autoDisableAngularThreshold,
+                                 $autoDisableIdleSteps,
+                                 $autoDisableIdleTime,
+                                 $autoDisableAverageSamples)
   world.setContactSurfaceLayer(0.001)	     #not in simspark
 
-  new('oxygen/Space', $scenePath+'space')
+  space = new('oxygen/Space', $scenePath+'space')
+  space.setContactCache($enableContactCache,
+                        $contactCacheMoveTolerance,
+                        $contactCacheTurnTolerance,
+                        $contactCachePersistTolerance,
+                        $contactCacheMaxReuse)
 
   # invalidate all cached references
   scriptServer = get($serverPath+'script')
@@ -388,11 +493,42 @@ end
 
 def sparkSetupServer
 
-  # add the agent control node
+  # a journal replay runs headless and as fast as possible
+  if ($journalReplay != '')
+    $enableTurboMode = true
+  end
+
+  # turbo mode runs lock-step and single threaded to stay deterministic
+  if ($enableTurboMode)
+    $agentSyncMode = true
+    $agentSyncTimeout = $turboAgentTimeout
+    $threadedAgentControl = false
+    $serverMultiThreadedMode = false
+  end
+
+  # a journal is only replayed identically if it was recorded single
+  # threaded
+  if ($journalRecord != '')
+    $threadedAgentControl = false
+    $serverMultiThreadedMode = false
+  end
+
   simulationServer = sparkGetSimulationServer()
 
   if (simulationServer != nil)
+    simulationServer.setTurboMode($enableTurboMode)
+    simulationServer.setCycleArena($enableCycleArena)
+    simulationServer.setStartupTrace($printStartupTrace)
     simulationServer.setMultiThreads($serverMultiThreadedMode)
+  end
+
+  if ($journalReplay != '')
+    sparkSetupJournalReplay()
+    return
+  end
+
+  # add the agent control node
+  if (simulationServer != nil)
     simulationServer.initControlNode('oxygen/AgentControl','AgentControl')
 
     # set auto speed adjust mode.
@@ -401,6 +537,18 @@ def sparkSetupServer
     simulationServer.setMaxStepsPerCyle(1)
   end
 
+  if (! $enableMeshCache)
+    sparkGetGeometryServer().setMeshCacheDir('')
+  end
+
+  # install the cycle profiler; it stays idle until enabled
+  profiler = sparkGetCycleProfiler()
+
+  if (profiler != nil)
+    profiler.setWindowCycles($cycleProfilerWindow)
+    profiler.setEnabled($enableCycleProfiler)
+  end
+
   # set port and socket type for agent control
   agentControl = get($serverPath+'simulation/AgentControl');
 
@@ -408,6 +556,7 @@ def sparkSetupServer
     agentControl.setServerPort($agentPort)
     agentControl.setStep($agentStep)
     agentControl.setSyncMode($agentSyncMode)
+    agentControl.setSyncTimeout($agentSyncTimeout)
     agentControl.setMultiThreaded($threadedAgentControl)
   end
 
@@ -436,6 +585,15 @@ def sparkSetupServer
   #
   # log recording setup
 
+  sparkSetupMonitorLogger()
+
+  if ($journalRecord != '')
+    journal = sparkCreate('oxygen/CommandJournal', $serverPath+'simulation/CommandJournal')
+    journal.record($journalRecord)
+  end
+end
+
+def sparkSetupMonitorLogger
   if ($recordLogfile == true)
     logNormal($sparkPrefix + " recording Logfile as 'sparkmonitor.log'\n")
     monitorLogger = sparkCreate('oxygen/MonitorLogger', $serverPath+'simulation/MonitorLogger')
@@ -443,6 +601,20 @@ def sparkSetupServer
   end
 end
 
+# replaces the agent and monitor network with a replay of $journalReplay
+def sparkSetupJournalReplay
+  logNormal($sparkPrefix + " replaying journal '" + $journalReplay + "'\n")
+
+  journal = sparkCreate('oxygen/CommandJournal', $serverPath+'simulation/CommandJournal')
+  journal.replay($journalReplay)
+
+  if ($journalSenseLog != '')
+    journal.setSenseLog($journalSenseLog)
+  end
+
+  sparkSetupMonitorLogger()
+end
+
 def sparkSetupRendering(openGLSystem = $defaultOpenGLSystem, active = nil)
   logNormal($sparkPrefix + " sparkSetupRendering\n")
   logNormal($sparkPrefix + " using OpenGLSystem '" + openGLSystem + "'\n")
@@ -726,7 +898,25 @@ logNormal($sparkPrefix + " setup\n")
 #import the implementations of the desired physics engine
 #currently supported: odeimps (uses Open Dynamics Engine), bulletimps
 logNormal($sparkPrefix + " Loading physics implementation:" + $defaultPhysicsBundle +"\n")
-importBundle($defaultPhysicsBundle)
+setLazyBundles($lazyBundles)
+
+# import the bundles of the default setup in one go; the importBundle
+# calls below are no-ops then
+importBundles([
+  $defaultPhysicsBundle,
+  'objimporter',
+  'rubysceneimporter',
+  'rosimporter',
+  'sparkmonitor',
+  'sexpparser',
+  'sceneeffector',
+  'sparkagent',
+  'gyrorateperceptor',
+  'collisionperceptor',
+  'accelerometer',
+  'agentsynceffector',
+  'imageperceptor'
+])
 #logNormal($sparkPrefix + " using ODE, to change the physics engine go to line 559 in spark.rb\n")
 
 #
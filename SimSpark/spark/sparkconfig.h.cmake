@@ -24,6 +24,10 @@
 
 #cmakedefine HAVE_POLL_H 1
 
+#cmakedefine HAVE_SYS_EPOLL_H 1
+
+#cmakedefine HAVE_SYS_TIMERFD_H 1
+
 #cmakedefine HAVE_EXECINFO_H 1
 
 #cmakedefine HAVE_IL_IL_H 1
@@ -36,6 +40,8 @@
 
 #cmakedefine SHARED_LIB_COMPILE 1
 
+#cmakedefine ENABLE_CYCLE_PROFILER 1
+
 #define PACKAGE_NAME "${CMAKE_PROJECT_NAME}"
 
 #define PREFIX "${prefix}"
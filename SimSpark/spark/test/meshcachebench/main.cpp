@@ -0,0 +1,137 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2002,2003 Koblenz University
+   Copyright (C) 2004-2009 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+/* meshcachebench imports all .obj models of a data directory the way
+   the server does at startup, once without the mesh cache, once with
+   an empty cache (parse and write) and once with a filled cache
+   (memory mapped), and prints the time each pass takes.
+*/
+#include <zeitgeist/zeitgeist.h>
+#include <zeitgeist/fileserver/fileserver.h>
+#include <oxygen/oxygen.h>
+#include <oxygen/geometryserver/geometryserver.h>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace zeitgeist;
+using namespace oxygen;
+
+#ifdef GetObject
+#undef GetObject
+#endif
+
+namespace
+{
+    /** imports all models with a new GeometryServer, returns the time
+        in ms or a negative value if a model failed to import */
+    double ImportAll(const std::shared_ptr<CoreContext>& context,
+                     const vector<string>& models, const string& cacheDir)
+    {
+        std::shared_ptr<GeometryServer> geometryServer =
+            std::dynamic_pointer_cast<GeometryServer>
+            (context->New("oxygen/GeometryServer", "/sys/server/geometrybench"));
+
+        if (geometryServer.get() == 0 ||
+            ! geometryServer->InitMeshImporter("ObjImporter"))
+            {
+                return -1;
+            }
+
+        geometryServer->SetMeshCacheDir(cacheDir);
+
+        ParameterList parameter;
+        bool ok = true;
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+        for (size_t i = 0; i < models.size(); ++i)
+            {
+                ok = ok && (geometryServer->GetMesh(models[i], parameter).get() != 0);
+            }
+
+        double ms = chrono::duration<double, milli>
+            (chrono::steady_clock::now() - start).count();
+
+        geometryServer->Unlink();
+
+        return ok ? ms : -1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+        {
+            cerr << "usage: meshcachebench <data dir> [cache dir]\n";
+            return 1;
+        }
+
+    const string dataDir = argv[1];
+    const string cacheDir = (argc > 2) ? argv[2] :
+        (filesystem::temp_directory_path() / "meshcachebench").string();
+
+    // the cold pass starts with an empty cache
+    filesystem::remove_all(cacheDir);
+
+    vector<string> models;
+    for (const filesystem::directory_entry& entry :
+             filesystem::directory_iterator(filesystem::path(dataDir) / "models"))
+        {
+            if (entry.path().extension() == ".obj")
+                {
+                    models.push_back("models/" + entry.path().filename().string());
+                }
+        }
+
+    Zeitgeist zg("." PACKAGE_NAME);
+    std::shared_ptr<CoreContext> context = zg.CreateContext();
+    Oxygen kOxygen(zg);
+
+    std::shared_ptr<ScriptServer> scriptServer =
+        std::static_pointer_cast<ScriptServer>(context->Get("/sys/server/script"));
+    std::shared_ptr<FileServer> fileServer =
+        std::static_pointer_cast<FileServer>(context->Get("/sys/server/file"));
+
+    scriptServer->Eval("importBundle 'filesystemstd'");
+    scriptServer->Eval("importBundle 'objimporter'");
+
+    if (! fileServer->Mount("FileSystemSTD", dataDir))
+        {
+            cerr << "cannot mount " << dataDir << "\n";
+            return 1;
+        }
+
+    const double text = ImportAll(context, models, "");
+    const double cold = ImportAll(context, models, cacheDir);
+    const double warm = ImportAll(context, models, cacheDir);
+
+    printf("%zu models\n", models.size());
+    printf("no cache     %10.1f ms\n", text);
+    printf("empty cache  %10.1f ms\n", cold);
+    printf("filled cache %10.1f ms\n", warm);
+
+    return (text < 0 || cold < 0 || warm < 0) ? 1 : 0;
+}
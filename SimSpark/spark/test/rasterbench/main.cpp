@@ -0,0 +1,290 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2002,2003 Koblenz University
+   Copyright (C) 2004-2009 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+/* rasterbench renders a soccer scene with the software rasterizer of
+   the image perceptor: a textured field and 22 robots of about 18000
+   triangles each, seen by one camera per robot. It prints the
+   frames per second for all 22 cameras at 80x60 and 320x240 pixels
+   and writes the image of the first camera to rasterbench.ppm.
+*/
+#include <plugin/imageperceptor/softrasterizer.h>
+#include <salt/gmath.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+using namespace salt;
+
+namespace
+{
+    const int NUM_ROBOTS = 22;
+
+    /** a triangle mesh with three floats per vertex */
+    struct Geometry
+    {
+        vector<float> pos;
+        vector<float> normals;
+        vector<float> texCoords;
+        vector<unsigned int> index;
+    };
+
+    /** a capsule shaped robot of (2 * slices * stacks) triangles */
+    void MakeRobot(Geometry& geometry, int slices, int stacks)
+    {
+        for (int j = 0; j <= stacks; ++j)
+            {
+                const float phi = gPI * j / stacks;
+                for (int i = 0; i <= slices; ++i)
+                    {
+                        const float theta = 2.0f * gPI * i / slices;
+                        const float nx = sin(phi) * cos(theta);
+                        const float ny = sin(phi) * sin(theta);
+                        const float nz = cos(phi);
+
+                        geometry.pos.push_back(0.1f * nx);
+                        geometry.pos.push_back(0.1f * ny);
+                        geometry.pos.push_back(0.25f * nz + 0.3f);
+                        geometry.normals.push_back(nx);
+                        geometry.normals.push_back(ny);
+                        geometry.normals.push_back(nz);
+                        geometry.texCoords.push_back(0.0f);
+                        geometry.texCoords.push_back(0.0f);
+                        geometry.texCoords.push_back(0.0f);
+                    }
+            }
+
+        for (int j = 0; j < stacks; ++j)
+            {
+                for (int i = 0; i < slices; ++i)
+                    {
+                        const unsigned int a = j * (slices + 1) + i;
+                        const unsigned int b = a + slices + 1;
+
+                        geometry.index.push_back(a);
+                        geometry.index.push_back(b);
+                        geometry.index.push_back(a + 1);
+                        geometry.index.push_back(a + 1);
+                        geometry.index.push_back(b);
+                        geometry.index.push_back(b + 1);
+                    }
+            }
+    }
+
+    /** a 30m x 20m field of two triangles with a repeated texture */
+    void MakeField(Geometry& geometry)
+    {
+        const float corners[4][2] = { {-15, -10}, {15, -10}, {15, 10}, {-15, 10} };
+        for (int i = 0; i < 4; ++i)
+            {
+                geometry.pos.push_back(corners[i][0]);
+                geometry.pos.push_back(corners[i][1]);
+                geometry.pos.push_back(0.0f);
+                geometry.normals.push_back(0.0f);
+                geometry.normals.push_back(0.0f);
+                geometry.normals.push_back(1.0f);
+                geometry.texCoords.push_back(corners[i][0]);
+                geometry.texCoords.push_back(corners[i][1]);
+                geometry.texCoords.push_back(0.0f);
+            }
+
+        const unsigned int index[6] = { 0, 1, 2, 0, 2, 3 };
+        geometry.index.assign(index, index + 6);
+    }
+
+    void MakeGrass(SoftRasterizer::Texture& texture)
+    {
+        texture.width = texture.height = 64;
+        texture.rgba.resize(64 * 64 * 4);
+        for (int i = 0; i < 64 * 64; ++i)
+            {
+                const bool stripe = ((i % 64) / 32) != 0;
+                texture.rgba[i*4+0] = 40;
+                texture.rgba[i*4+1] = stripe ? 160 : 130;
+                texture.rgba[i*4+2] = 40;
+                texture.rgba[i*4+3] = 255;
+            }
+    }
+
+    SoftRasterizer::Mesh MakeMesh(const Geometry& geometry, const Matrix& transform,
+                                  float r, float g, float b,
+                                  const SoftRasterizer::Texture* texture)
+    {
+        SoftRasterizer::Mesh mesh;
+        mesh.transform = transform;
+        mesh.scale = Vector3f(1, 1, 1);
+        mesh.pos = &geometry.pos[0];
+        mesh.normals = &geometry.normals[0];
+        mesh.texCoords = &geometry.texCoords[0];
+        mesh.numVertex = geometry.pos.size() / 3;
+        mesh.index = &geometry.index[0];
+        mesh.numIndex = geometry.index.size();
+
+        const float color[4] = { r, g, b, 1.0f };
+        for (int i = 0; i < 4; ++i)
+            {
+                mesh.ambient[i] = color[i];
+                mesh.diffuse[i] = color[i];
+                mesh.emission[i] = (i == 3) ? 1.0f : 0.0f;
+            }
+
+        mesh.texture = texture;
+
+        for (size_t i = 0; i < geometry.pos.size(); i += 3)
+            {
+                mesh.bounds.Encapsulate
+                    (transform * Vector3f(geometry.pos[i], geometry.pos[i+1],
+                                          geometry.pos[i+2]));
+            }
+
+        return mesh;
+    }
+
+    /** the robot positions, the robots look at the center of the field */
+    Vector3f RobotPos(int robot)
+    {
+        const float angle = 2.0f * gPI * robot / NUM_ROBOTS;
+        return Vector3f(9.0f * cos(angle), 6.0f * sin(angle), 0.0f);
+    }
+
+    /** the view transform of the camera in the head of a robot, set up
+        like oxygen::Camera::Bind() */
+    Matrix CameraView(int robot)
+    {
+        const Vector3f pos = RobotPos(robot);
+
+        Matrix world;
+        world.Identity();
+        world.Translate(Vector3f(pos[0], pos[1], 0.5f));
+        world.RotateZ(atan2(-pos[1], -pos[0]) - gPI / 2.0f);
+
+        Matrix view = world;
+        view.RotateX(gPI / 2.0f);
+        view.InvertRotationMatrix();
+        return view;
+    }
+
+    Matrix CameraProjection(int width, int height)
+    {
+        const float zNear = 0.003f;
+        const float halfWidth = zNear * tan(gDegToRad(120.0f * 0.5f));
+        const float halfHeight = halfWidth * height / (float)width;
+
+        Matrix projection;
+        projection.CalcInfiniteFrustum(-halfWidth, halfWidth,
+                                       -halfHeight, halfHeight, zNear);
+        return projection;
+    }
+
+    void WriteImage(const char* fileName, const vector<unsigned char>& rgb,
+                    int width, int height)
+    {
+        FILE* file = fopen(fileName, "wb");
+        if (file == 0)
+            {
+                return;
+            }
+
+        fprintf(file, "P6\n%d %d\n255\n", width, height);
+        for (int y = height - 1; y >= 0; --y)
+            {
+                fwrite(&rgb[y * width * 3], 1, width * 3, file);
+            }
+
+        fclose(file);
+    }
+}
+
+int main()
+{
+    Geometry robot;
+    MakeRobot(robot, 120, 75);
+
+    Geometry field;
+    MakeField(field);
+
+    SoftRasterizer::Texture grass;
+    MakeGrass(grass);
+
+    vector<SoftRasterizer::Mesh> meshes;
+    meshes.push_back(MakeMesh(field, Matrix(Matrix::GetIdentity()), 1, 1, 1, &grass));
+
+    for (int i = 0; i < NUM_ROBOTS; ++i)
+        {
+            Matrix transform;
+            transform.Identity();
+            transform.Translate(RobotPos(i));
+
+            const bool left = (i < NUM_ROBOTS / 2);
+            meshes.push_back(MakeMesh(robot, transform,
+                                      left ? 0.8f : 0.2f, 0.2f, left ? 0.2f : 0.8f, 0));
+        }
+
+    vector<SoftRasterizer::Light> lights(1);
+    lights[0].pos = Vector3f(0, 0, 20);
+    for (int i = 0; i < 3; ++i)
+        {
+            lights[0].ambient[i] = 0.2f;
+            lights[0].diffuse[i] = 0.8f;
+        }
+
+    printf("%d robots of %d triangles, %d cameras\n",
+           NUM_ROBOTS, (int)robot.index.size() / 3, NUM_ROBOTS);
+
+    const int resolutions[2][2] = { {80, 60}, {320, 240} };
+    SoftRasterizer rasterizer;
+
+    for (int r = 0; r < 2; ++r)
+        {
+            const int width = resolutions[r][0];
+            const int height = resolutions[r][1];
+            const Matrix projection = CameraProjection(width, height);
+            vector<unsigned char> rgb(width * height * 3);
+
+            const int frames = 10;
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+            for (int f = 0; f < frames; ++f)
+                {
+                    for (int c = 0; c < NUM_ROBOTS; ++c)
+                        {
+                            rasterizer.Render(CameraView(c), projection, meshes,
+                                              lights, width, height, &rgb[0]);
+                        }
+                }
+
+            const double ms = chrono::duration<double, milli>
+                (chrono::steady_clock::now() - start).count() / frames;
+
+            printf("%3dx%3d: %7.2f ms for %d cameras, %6.1f fps\n",
+                   width, height, ms, NUM_ROBOTS, 1000.0 / ms);
+
+            rasterizer.Render(CameraView(0), projection, meshes,
+                              lights, width, height, &rgb[0]);
+            if (r == 1)
+                {
+                    WriteImage("rasterbench.ppm", rgb, width, height);
+                }
+        }
+
+    return 0;
+}
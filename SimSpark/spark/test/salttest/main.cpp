@@ -0,0 +1,269 @@
+#include <salt/matrix.h>
+#include <salt/random.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace salt;
+
+namespace
+{
+	int gFailures = 0;
+
+	void Check(bool condition, const char* what)
+	{
+		if (! condition)
+		{
+			cerr << "FAILED: " << what << endl;
+			++gFailures;
+		}
+	}
+
+	bool SameBits(const float* a, const float* b, size_t count)
+	{
+		return memcmp(a, b, count * sizeof(float)) == 0;
+	}
+
+	float Random(float min, float max)
+	{
+		return min + (max - min) * (rand() / float(RAND_MAX));
+	}
+
+	Matrix RandomMatrix()
+	{
+		Matrix m;
+		for (int i=0; i<16; ++i)
+		{
+			m.m[i] = Random(-10.0f, 10.0f);
+		}
+		return m;
+	}
+
+	Matrix RandomRigidMatrix()
+	{
+		Matrix m;
+		m.RotationX(Random(-3.0f, 3.0f));
+		m.RotateY(Random(-3.0f, 3.0f));
+		m.RotateZ(Random(-3.0f, 3.0f));
+		m.Pos() = Vector3f(Random(-20.0f, 20.0f),
+						   Random(-20.0f, 20.0f),
+						   Random(-1.0f, 2.0f));
+		return m;
+	}
+
+	// the plain C++ versions the SIMD code has to match
+	Matrix ReferenceMultiply(const Matrix& a, const Matrix& b)
+	{
+		Matrix r;
+		for (int i=0; i<4; i++)
+			for (int j=0; j<4; j++)
+				r(i,j) = a(i,0)*b(0,j)+a(i,1)*b(1,j)+a(i,2)*b(2,j)+a(i,3)*b(3,j);
+		return r;
+	}
+
+	Matrix ReferenceInvertRotation(const Matrix& m)
+	{
+		Matrix r(m);
+		std::swap(r(0, 1), r(1, 0));
+		std::swap(r(0, 2), r(2, 0));
+		std::swap(r(1, 2), r(2, 1));
+
+		float x = r.m[12], y = r.m[13], z = r.m[14];
+		r.m[12] = -(x*r.m[0] + y*r.m[4] + z*r.m[8]);
+		r.m[13] = -(x*r.m[1] + y*r.m[5] + z*r.m[9]);
+		r.m[14] = -(x*r.m[2] + y*r.m[6] + z*r.m[10]);
+		return r;
+	}
+
+	const char* GetLevelName(Matrix::ESimdLevel level)
+	{
+		switch (level)
+		{
+		case Matrix::SL_AVX: return "avx";
+		case Matrix::SL_SSE: return "sse";
+		default:             return "scalar";
+		}
+	}
+
+	void TestMultiply()
+	{
+		for (int n=0; n<10000; ++n)
+		{
+			Matrix a = RandomMatrix();
+			Matrix b = RandomMatrix();
+			Matrix r = a * b;
+			Matrix ref = ReferenceMultiply(a, b);
+			if (! SameBits(r.m, ref.m, 16))
+			{
+				Check(false, "operator*(Matrix) matches the scalar product");
+				return;
+			}
+
+			a *= b;
+			if (! SameBits(a.m, ref.m, 16))
+			{
+				Check(false, "operator*=(Matrix) matches the scalar product");
+				return;
+			}
+		}
+	}
+
+	void TestInvertRotation()
+	{
+		Matrix identity;
+		identity.Identity();
+
+		for (int n=0; n<10000; ++n)
+		{
+			Matrix m = (n % 2) ? RandomRigidMatrix() : RandomMatrix();
+			Matrix inv(m);
+			inv.InvertRotationMatrix();
+			Matrix ref = ReferenceInvertRotation(m);
+			if (! SameBits(inv.m, ref.m, 16))
+			{
+				Check(false, "InvertRotationMatrix matches the scalar inverse");
+				return;
+			}
+
+			if (n % 2)
+			{
+				Matrix p = m * inv;
+				for (int i=0; i<16; ++i)
+				{
+					if (gAbs(p.m[i] - identity.m[i]) > 1e-4f)
+					{
+						Check(false, "InvertRotationMatrix inverts a rigid transform");
+						return;
+					}
+				}
+			}
+		}
+	}
+
+	void TestTransformPoints()
+	{
+		const size_t count = 1001;
+		vector<Vector3f> points(count);
+		for (size_t i=0; i<count; ++i)
+		{
+			points[i] = Vector3f(Random(-50.0f, 50.0f),
+								 Random(-50.0f, 50.0f),
+								 Random(-50.0f, 50.0f));
+		}
+
+		Matrix m = RandomMatrix();
+		vector<Vector3f> ref(count);
+		for (size_t i=0; i<count; ++i)
+		{
+			ref[i] = m.Transform(points[i]);
+		}
+
+		Matrix::ESimdLevel best = Matrix::GetSimdLevel();
+		for (int level = Matrix::SL_SCALAR; level <= best; ++level)
+		{
+			Matrix::SetSimdLevel(Matrix::ESimdLevel(level));
+
+			// all counts up to 9 cover the remainder handling
+			for (size_t n=0; n<10; ++n)
+			{
+				vector<Vector3f> out(n + 1, Vector3f(7.0f, 7.0f, 7.0f));
+				m.TransformPoints(&points[0], &out[0], n);
+				Check(SameBits(out[0].GetData(), ref[0].GetData(), 3 * n),
+					  GetLevelName(Matrix::ESimdLevel(level)));
+				Check((out[n].x() == 7.0f) && (out[n].y() == 7.0f) && (out[n].z() == 7.0f),
+					  "TransformPoints writes count points only");
+			}
+
+			vector<Vector3f> inPlace(points);
+			m.TransformPoints(&inPlace[0], &inPlace[0], count);
+			Check(SameBits(inPlace[0].GetData(), ref[0].GetData(), 3 * count),
+				  "TransformPoints in place");
+		}
+		Matrix::SetSimdLevel(best);
+	}
+
+	template <typename F>
+	double Time(F f, int iterations)
+	{
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		for (int i=0; i<iterations; ++i)
+		{
+			f(i);
+		}
+		chrono::duration<double, nano> d = chrono::steady_clock::now() - start;
+		return d.count() / iterations;
+	}
+
+	void Benchmark()
+	{
+		const int iterations = 2000000;
+		vector<Matrix> mats(64);
+		for (size_t i=0; i<mats.size(); ++i)
+		{
+			mats[i] = RandomRigidMatrix();
+		}
+		Matrix acc;
+		acc.Identity();
+
+		// dependency chains, so that nothing is optimized away
+		cout << "matrix * matrix, reference: "
+			 << Time([&](int i) { acc = ReferenceMultiply(acc, mats[i & 63]); },
+					 iterations)
+			 << " ns" << endl;
+		cout << "matrix * matrix:            "
+			 << Time([&](int i) { acc = acc * mats[i & 63]; }, iterations)
+			 << " ns" << endl;
+		cout << "rigid inverse, reference:   "
+			 << Time([&](int) { acc = ReferenceInvertRotation(acc); }, iterations)
+			 << " ns" << endl;
+		cout << "rigid inverse:              "
+			 << Time([&](int) { acc.InvertRotationMatrix(); }, iterations)
+			 << " ns" << endl;
+
+		vector<Vector3f> points(1024, Vector3f(1.0f, 2.0f, 3.0f));
+		vector<Vector3f> out(points.size());
+		Matrix::ESimdLevel best = Matrix::GetSimdLevel();
+		for (int level = Matrix::SL_SCALAR; level <= best; ++level)
+		{
+			Matrix::SetSimdLevel(Matrix::ESimdLevel(level));
+			double t = Time([&](int i)
+							{ mats[i & 63].TransformPoints(&points[0], &out[0], points.size()); },
+							iterations / 1000);
+			cout << "transform 1024 points, " << GetLevelName(Matrix::ESimdLevel(level))
+				 << ": " << t / points.size() << " ns/point" << endl;
+		}
+		Matrix::SetSimdLevel(best);
+
+		// keep the results alive
+		cout << "(" << acc.m[0] + out[0].x() << ")" << endl;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	srand(42);
+
+	cout << "salt batch routines use " << GetLevelName(Matrix::GetSimdLevel())
+		 << ", alignof(Matrix) = " << alignof(Matrix) << endl;
+
+	Check(alignof(Matrix) >= 16, "Matrix is 16 byte aligned");
+	TestMultiply();
+	TestInvertRotation();
+	TestTransformPoints();
+
+	if ((argc > 1) && (strcmp(argv[1], "bench") == 0))
+	{
+		Benchmark();
+	}
+
+	if (gFailures > 0)
+	{
+		cerr << gFailures << " check(s) failed" << endl;
+		return 1;
+	}
+
+	cout << "all checks passed" << endl;
+	return 0;
+}
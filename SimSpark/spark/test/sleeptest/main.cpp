@@ -0,0 +1,192 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2004-2025 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+/* sleeptest lets a box fall asleep on the ground plane and drops a
+   second box onto it. The falling box wakes the sleeping one during
+   the physics step, after the collision detection ran; the sleeping
+   box must still have its ground contacts then and may not sink into
+   the ground.
+*/
+
+#include <spark/spark.h>
+#include <zeitgeist/scriptserver/scriptserver.h>
+#include <oxygen/sceneserver/sceneserver.h>
+#include <oxygen/physicsserver/rigidbody.h>
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+using namespace spark;
+using namespace oxygen;
+
+namespace
+{
+    int gFailures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (! condition)
+        {
+            cerr << "FAILED: " << what << endl;
+            ++gFailures;
+        }
+    }
+
+    const float SIM_STEP = 0.02f;
+
+    /** the edge length of the box that falls asleep */
+    const float BASE_SIZE = 0.2f;
+
+    /** the distance a woken box may sink; without ground contacts it
+        falls more than twice as far in the step it is woken
+    */
+    const float MAX_SINK = 0.01f;
+}
+
+class SleepTest : public Spark
+{
+public:
+    SleepTest() : Spark() {}
+
+    /** runs the test, returns false if the scene could not be set up */
+    bool Run();
+
+protected:
+    /** adds a box with the given mass and edge length at the given
+        height above the ground plane, returns its body
+    */
+    std::shared_ptr<RigidBody> AddBox(const string& name, float mass,
+                                      float size, float height);
+
+    void Step();
+};
+
+std::shared_ptr<RigidBody> SleepTest::AddBox(const string& name, float mass,
+                                             float size, float height)
+{
+    std::ostringstream ss;
+    ss << "box = new('oxygen/Transform', $scenePath+'" << name << "')\n"
+       << "box.setLocalPos(0.0, 0.0, " << height << ")\n"
+       << "body = new('oxygen/RigidBody', $scenePath+'" << name << "/body')\n"
+       << "body.setBoxTotal(" << mass << ", " << size << ", " << size
+       << ", " << size << ")\n"
+       << "geom = new('oxygen/BoxCollider', $scenePath+'" << name
+       << "/geometry')\n"
+       << "geom.setBoxLengths(" << size << ", " << size << ", " << size
+       << ")\n"
+       << "new('oxygen/ContactJointHandler', $scenePath+'" << name
+       << "/geometry/contact')\n";
+    GetScriptServer()->Eval(ss.str());
+
+    return std::dynamic_pointer_cast<RigidBody>
+        (GetCore()->Get("/usr/scene/" + name + "/body"));
+}
+
+void SleepTest::Step()
+{
+    mSceneServer->PrePhysicsUpdate(SIM_STEP);
+    mSceneServer->PhysicsUpdate(SIM_STEP);
+    mSceneServer->PostPhysicsUpdate();
+}
+
+bool SleepTest::Run()
+{
+    // a fresh world and space with the default auto disable
+    // parameters, and a static ground plane without a body
+    GetScriptServer()->Eval("sparkResetScene()");
+    GetScriptServer()->Eval
+        (
+         "ground = new('oxygen/PlaneCollider', $scenePath+'ground')\n"
+         "ground.setParams(0.0, 0.0, 1.0, 0.0)\n"
+         "new('oxygen/ContactJointHandler', $scenePath+'ground/contact')\n"
+         );
+
+    std::shared_ptr<RigidBody> base =
+        AddBox("base", 1.0f, BASE_SIZE, BASE_SIZE / 2.0f);
+    if (base.get() == 0)
+    {
+        cerr << "FAILED: could not create the scene" << endl;
+        return false;
+    }
+
+    int steps = 0;
+    while (base->IsEnabled() && steps < 500)
+    {
+        Step();
+        ++steps;
+    }
+
+    Check(! base->IsEnabled(), "the box falls asleep on the ground");
+    const float restHeight = base->GetPosition().z();
+    Check(restHeight > BASE_SIZE / 2.0f - MAX_SINK,
+          "the sleeping box rests on the ground");
+
+    // drop a box of the same mass from 0.3m onto the sleeping one
+    std::shared_ptr<RigidBody> top =
+        AddBox("top", 1.0f, BASE_SIZE / 2.0f, BASE_SIZE + 0.35f);
+    if (top.get() == 0)
+    {
+        cerr << "FAILED: could not create the scene" << endl;
+        return false;
+    }
+
+    bool woken = false;
+    float minHeight = restHeight;
+    for (int i = 0; i < 100; ++i)
+    {
+        Step();
+        woken = woken || base->IsEnabled();
+        minHeight = std::min(minHeight, base->GetPosition().z());
+    }
+
+    cout << "rest height " << restHeight << ", lowest height after waking "
+         << minHeight << endl;
+
+    Check(woken, "the falling box wakes the sleeping one");
+    Check(restHeight - minHeight < MAX_SINK,
+          "the woken box does not sink into the ground");
+    Check(top->GetPosition().z() > BASE_SIZE,
+          "the falling box lands on the woken one");
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    SleepTest test;
+
+    if (
+        (! test.Init(argc, argv)) ||
+        (! test.Run())
+        )
+    {
+        return 1;
+    }
+
+    if (gFailures > 0)
+    {
+        cerr << gFailures << " check(s) failed" << endl;
+        return 1;
+    }
+
+    cout << "all checks passed" << endl;
+    return 0;
+}
@@ -0,0 +1,204 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+   this file is part of rcssserver3D
+   Copyright (C) 2004-2025 RoboCup Soccer Server 3D Maintenance Group
+   $Id$
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+/* timerwheeltest schedules timers on the TimerWheel of the
+   ProxyServer and compares NextDeadline() and the fired timers with
+   a plain list of the scheduled deadlines.
+*/
+
+#include <oxygen/proxyserver/timerwheel.h>
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace oxygen;
+
+namespace
+{
+    int gFailures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (! condition)
+        {
+            cerr << "FAILED: " << what << endl;
+            ++gFailures;
+        }
+    }
+
+    typedef TimerWheel::TTimePoint TTimePoint;
+    typedef map<int, TTimePoint> TTimerMap;
+
+    TTimePoint Ms(TTimePoint origin, long long ms)
+    {
+        return origin + chrono::milliseconds(ms);
+    }
+
+    /** returns true if the wheel reports the earliest deadline of timers */
+    bool HasEarliest(const TimerWheel& wheel, const TTimerMap& timers)
+    {
+        TTimePoint deadline;
+        if (! wheel.NextDeadline(deadline))
+        {
+            return timers.empty();
+        }
+
+        if (timers.empty())
+        {
+            return false;
+        }
+
+        TTimePoint earliest = (*timers.begin()).second;
+        for (
+             TTimerMap::const_iterator iter = timers.begin();
+             iter != timers.end();
+             ++iter
+             )
+        {
+            earliest = min(earliest, (*iter).second);
+        }
+
+        return (deadline == earliest);
+    }
+
+    /** a timer parked in the farthest second level slot must not hide
+        an earlier timer in a block that is scanned after it */
+    void TestParkedSlot()
+    {
+        TimerWheel wheel(1000);
+        const TTimePoint origin = TimerWheel::TClock::now();
+        wheel.Reset(origin);
+
+        TTimerMap timers;
+
+        // parked in the slot of block 63
+        timers[0] = Ms(origin, 100000);
+        wheel.Schedule(0, timers[0]);
+
+        // move to block 10; block 63 is scanned before block 70 now
+        vector<int> expired;
+        wheel.Advance(Ms(origin, 2560), expired);
+        Check(expired.empty(), "the parked timer does not fire early");
+
+        timers[1] = Ms(origin, 2560 + 60 * 256);
+        wheel.Schedule(1, timers[1]);
+
+        Check(HasEarliest(wheel, timers),
+              "a timer behind the parked slot is the next deadline");
+
+        // and a nearer block in first level range
+        timers[2] = Ms(origin, 2560 + 300);
+        wheel.Schedule(2, timers[2]);
+        Check(HasEarliest(wheel, timers),
+              "a timer in a nearer block is the next deadline");
+    }
+
+    /** schedules, reschedules and cancels random timers up to 30s out
+        and compares the wheel with the plain list */
+    void TestRandom()
+    {
+        TimerWheel wheel(1000);
+        const TTimePoint origin = TimerWheel::TClock::now();
+        wheel.Reset(origin);
+
+        mt19937 rng(1);
+        uniform_int_distribution<int> uid(0, 31);
+        uniform_int_distribution<int> uop(0, 9);
+        uniform_int_distribution<long long> uout(0, 30000);
+        uniform_int_distribution<long long> ustep(0, 500);
+
+        TTimerMap timers;
+        long long now = 0;
+        bool earliestOk = true;
+        bool firedOk = true;
+
+        for (int i = 0; i < 20000; ++i)
+        {
+            const int id = uid(rng);
+            const int op = uop(rng);
+
+            if (op < 6)
+            {
+                timers[id] = Ms(origin, now + uout(rng));
+                wheel.Schedule(id, timers[id]);
+            } else if (op < 7)
+            {
+                timers.erase(id);
+                wheel.Cancel(id);
+            } else
+            {
+                now += ustep(rng);
+                const TTimePoint t = Ms(origin, now);
+
+                vector<int> expired;
+                wheel.Advance(t, expired);
+
+                for (size_t e = 0; e < expired.size(); ++e)
+                {
+                    TTimerMap::iterator iter = timers.find(expired[e]);
+                    if (
+                        (iter == timers.end()) ||
+                        ((*iter).second > t)
+                        )
+                    {
+                        firedOk = false;
+                        continue;
+                    }
+                    timers.erase(iter);
+                }
+
+                for (
+                     TTimerMap::const_iterator iter = timers.begin();
+                     iter != timers.end();
+                     ++iter
+                     )
+                {
+                    if ((*iter).second <= t)
+                    {
+                        firedOk = false;
+                    }
+                }
+            }
+
+            earliestOk = earliestOk && HasEarliest(wheel, timers);
+        }
+
+        Check(firedOk, "Advance() fires exactly the due timers");
+        Check(earliestOk, "NextDeadline() returns the earliest deadline");
+    }
+}
+
+int main()
+{
+    TestParkedSlot();
+    TestRandom();
+
+    if (gFailures > 0)
+    {
+        cerr << gFailures << " check(s) failed" << endl;
+        return 1;
+    }
+
+    cout << "all checks passed" << endl;
+    return 0;
+}